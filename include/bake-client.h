@@ -111,6 +111,59 @@ int bake_provider_handle_get_eager_limit(bake_provider_handle_t handle,
 int bake_provider_handle_set_eager_limit(bake_provider_handle_t handle,
                                          uint64_t               limit);
 
+/**
+ * Get the size of the packed messages of bake_create_write_persist_multi()
+ * and bake_read_multi() on this provider handle.
+ *
+ * @param[in] handle provider handle
+ * @param[out] size message size in bytes
+ *
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_provider_handle_get_multi_msg_size(bake_provider_handle_t handle,
+                                            uint64_t*              size);
+
+/**
+ * Set the size of the packed messages of bake_create_write_persist_multi()
+ * and bake_read_multi() on this provider handle (4096 by default).  It
+ * bounds the request and the response of a batch, counting the data of the
+ * objects along with their sizes and region ids, and should not exceed the
+ * eager message size of the transport.
+ *
+ * @param[in] handle provider handle
+ * @param[in] size message size in bytes
+ *
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_provider_handle_set_multi_msg_size(bake_provider_handle_t handle,
+                                            uint64_t               size);
+
+/**
+ * Get the number of times this provider handle retries a read or a write
+ * that the provider turned away with BAKE_ERR_BUSY.
+ *
+ * @param[in] handle provider handle
+ * @param[out] retries number of retries
+ *
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_provider_handle_get_busy_retries(bake_provider_handle_t handle,
+                                          uint32_t*              retries);
+
+/**
+ * Set the number of times this provider handle retries a read or a write
+ * that the provider turned away with BAKE_ERR_BUSY (8 by default, 0 to
+ * return BAKE_ERR_BUSY right away).  Retries back off exponentially from
+ * the delay suggested by the provider, with random jitter.
+ *
+ * @param[in] handle provider handle
+ * @param[in] retries number of retries
+ *
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_provider_handle_set_busy_retries(bake_provider_handle_t handle,
+                                          uint32_t               retries);
+
 /**
  * Decrement the reference counter of the provider handle,
  * effectively freeing the provider handle when the reference count
@@ -156,6 +209,21 @@ int bake_create(bake_provider_handle_t provider,
                 uint64_t               region_size,
                 bake_region_id_t*      rid);
 
+/**
+ * Creates a bounded-size BAKE data region like bake_create(), on a target
+ * chosen by the provider according to its placement policy.
+ *
+ * @param [in] provider provider handle
+ * @param [in] region_size size of region to be created
+ * @param [out] bti BAKE target identifier of the target chosen
+ * @param [out] rid identifier for new region
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_create_placed(bake_provider_handle_t provider,
+                       uint64_t               region_size,
+                       bake_target_id_t*      bti,
+                       bake_region_id_t*      rid);
+
 /**
  * Writes into a BAKE region that was previously created with bake_create().
  * Result is not guaranteed to be persistent until explicit
@@ -178,6 +246,29 @@ int bake_write(bake_provider_handle_t provider,
                void const*            buf,
                uint64_t               buf_size);
 
+/**
+ * Writes into a BAKE region like bake_write(), giving up after timeout_ms
+ * milliseconds.  The timeout is sent to the provider as a deadline, so
+ * that it drops the write instead of carrying it out if the deadline
+ * passes while the write is queued or in progress.
+ *
+ * @param [in] provider provider handle
+ * @param [in] rid identifier for region
+ * @param [in] region_offset offset into the target region to write
+ * @param [in] buf local memory buffer to write
+ * @param [in] buf_size size of local memory buffer to write
+ * @param [in] timeout_ms timeout in milliseconds
+ * @return BAKE_SUCCESS, BAKE_ERR_TIMEOUT if the deadline passed, or
+ * corresponding error code.
+ */
+int bake_write_timed(bake_provider_handle_t provider,
+                     bake_target_id_t       bti,
+                     bake_region_id_t       rid,
+                     uint64_t               region_offset,
+                     void const*            buf,
+                     uint64_t               buf_size,
+                     double                 timeout_ms);
+
 /**
  * Writes data into a previously created BAKE region like bake_write(),
  * except the write is performed on behalf of some remote entity.
@@ -238,6 +329,67 @@ int bake_create_write_persist(bake_provider_handle_t provider,
                               uint64_t               buf_size,
                               bake_region_id_t*      rid);
 
+/**
+ * Creates, writes, and persists a region like bake_create_write_persist(),
+ * giving up after timeout_ms milliseconds, see bake_write_timed().
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] buf local memory buffer to write
+ * @param [in] buf_size size of local memory buffer to write
+ * @param [out] rid identifier for new region
+ * @param [in] timeout_ms timeout in milliseconds
+ * @return BAKE_SUCCESS, BAKE_ERR_TIMEOUT if the deadline passed, or
+ * corresponding error code.
+ */
+int bake_create_write_persist_timed(bake_provider_handle_t provider,
+                                    bake_target_id_t       bti,
+                                    void const*            buf,
+                                    uint64_t               buf_size,
+                                    bake_region_id_t*      rid,
+                                    double                 timeout_ms);
+
+/**
+ * Creates, writes, and persists a region like bake_create_write_persist(),
+ * on a target chosen by the provider according to its placement policy.
+ *
+ * @param [in] provider provider handle
+ * @param [in] buf local memory buffer to write
+ * @param [in] buf_size size of local memory buffer to write
+ * @param [out] bti BAKE target identifier of the target chosen
+ * @param [out] rid identifier for new region
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_create_write_persist_placed(bake_provider_handle_t provider,
+                                     void const*            buf,
+                                     uint64_t               buf_size,
+                                     bake_target_id_t*      bti,
+                                     bake_region_id_t*      rid);
+
+/**
+ * Creates, writes, and persists many small regions on a target at once.
+ * Their contents follow each other in data and are packed into as few
+ * RPCs as the multi message size of the provider handle allows, the
+ * provider creating all the regions of an RPC in one go; a region that
+ * does not fit in a message is created on its own, with a bulk transfer
+ * if it is larger than the eager limit.  If any region cannot be
+ * created, the ones already created are removed.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] count number of regions
+ * @param [in] sizes size of each region
+ * @param [in] data contents of the regions, back to back
+ * @param [out] rids identifiers of the new regions
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_create_write_persist_multi(bake_provider_handle_t provider,
+                                    bake_target_id_t       bti,
+                                    uint64_t               count,
+                                    const uint64_t*        sizes,
+                                    void const*            data,
+                                    bake_region_id_t*      rids);
+
 /**
  * Issues a bake_create_write_persist on behalf of a remote entity (remote_addr)
  * that previously sent an hg_bulk_t.
@@ -327,6 +479,29 @@ int bake_read(bake_provider_handle_t provider,
               uint64_t               buf_size,
               uint64_t*              bytes_read);
 
+/**
+ * Reads from a BAKE region like bake_read(), giving up after timeout_ms
+ * milliseconds, see bake_write_timed().
+ *
+ * @param [in] provider provider handle
+ * @param [in] rid region identifier
+ * @param [in] region_offset offset into the target region to read from
+ * @param [in] buf local memory buffer read into
+ * @param [in] buf_size size of local memory buffer to read into
+ * @param [out] bytes_read number of bytes effectively read into the buffer
+ * @param [in] timeout_ms timeout in milliseconds
+ * @return BAKE_SUCCESS, BAKE_ERR_TIMEOUT if the deadline passed, or
+ * corresponding error code.
+ */
+int bake_read_timed(bake_provider_handle_t provider,
+                    bake_target_id_t       bti,
+                    bake_region_id_t       rid,
+                    uint64_t               region_offset,
+                    void*                  buf,
+                    uint64_t               buf_size,
+                    uint64_t*              bytes_read,
+                    double                 timeout_ms);
+
 /**
  * Reads data from a previously persisted BAKE region like bake_read(),
  * except the read is performed on behalf of some remote entity.
@@ -356,6 +531,64 @@ int bake_proxy_read(bake_provider_handle_t provider,
                     uint64_t               size,
                     uint64_t*              bytes_read);
 
+/**
+ * Reads many small regions of a target at once, from their beginning,
+ * batching them like bake_create_write_persist_multi().  The contents of
+ * region i are read into buf at the sum of the sizes before it.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] count number of regions
+ * @param [in] rids identifiers of the regions
+ * @param [in] sizes number of bytes to read from each region
+ * @param [in] buf local memory buffer of at least the sum of the sizes
+ * @param [out] bytes_read number of bytes effectively read from each region
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_read_multi(bake_provider_handle_t  provider,
+                    bake_target_id_t        bti,
+                    uint64_t                count,
+                    const bake_region_id_t* rids,
+                    const uint64_t*         sizes,
+                    void*                   buf,
+                    uint64_t*               bytes_read);
+
+/**
+ * Writes into several regions, possibly on several targets of the
+ * provider, in one RPC.  The buffers of all the segments are exposed
+ * through a single bulk handle, and the provider transfers the segments
+ * concurrently, which makes accessing many small regions much cheaper
+ * than one bake_write() per region.  Segments are not written in any
+ * particular order.
+ *
+ * @param [in] provider provider handle
+ * @param [in] num_segments number of segments
+ * @param [in] segments regions and ranges in them to write
+ * @param [in] bufs buffers holding the data of each segment
+ * @return BAKE_SUCCESS or the error of the first segment that failed.
+ */
+int bake_writev(bake_provider_handle_t provider,
+                uint64_t               num_segments,
+                const bake_segment_t*  segments,
+                void const* const*     bufs);
+
+/**
+ * Reads from several regions in one RPC, see bake_writev().
+ *
+ * @param [in] provider provider handle
+ * @param [in] num_segments number of segments
+ * @param [in] segments regions and ranges in them to read
+ * @param [in] bufs buffers receiving the data of each segment
+ * @param [out] bytes_read number of bytes read for each segment (may be
+ * NULL)
+ * @return BAKE_SUCCESS or the error of the first segment that failed.
+ */
+int bake_readv(bake_provider_handle_t provider,
+               uint64_t               num_segments,
+               const bake_segment_t*  segments,
+               void* const*           bufs,
+               uint64_t*              bytes_read);
+
 /**
  * @brief Requests the source provider to migrate a particular
  * region (source_rid) to a destination provider. After the call,
@@ -432,6 +665,115 @@ int bake_remove(bake_provider_handle_t provider,
                 bake_target_id_t       bti,
                 bake_region_id_t       rid);
 
+/**
+ * Creates several regions on a target in one RPC, like as many calls to
+ * bake_create().  Backends that support it create all the regions in one
+ * operation.  The sizes and region ids travel in the RPC messages, or
+ * through a bulk transfer when they do not fit in the eager limit of the
+ * provider handle.  If any region cannot be created, none is.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] count number of regions
+ * @param [in] sizes size of each region
+ * @param [out] rids identifiers of the new regions
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_create_multi(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               count,
+                      const uint64_t*        sizes,
+                      bake_region_id_t*      rids);
+
+/**
+ * Same as bake_create_multi(), tagging the new regions with a group so
+ * that they can all be removed at once with bake_remove_group(), e.g. the
+ * regions of one checkpoint epoch.  The regions may also be removed one by
+ * one.  Not all backends keep track of groups; pmem and file targets do.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] group group of the regions, not 0
+ * @param [in] count number of regions
+ * @param [in] sizes size of each region
+ * @param [out] rids identifiers of the new regions
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_create_group(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               group,
+                      uint64_t               count,
+                      const uint64_t*        sizes,
+                      bake_region_id_t*      rids);
+
+/**
+ * Removes several regions of a target in one RPC, see bake_create_multi().
+ * All the regions that can be removed are.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] count number of regions
+ * @param [in] rids identifiers of the regions to remove
+ * @return BAKE_SUCCESS or the first error encountered.
+ */
+int bake_remove_multi(bake_provider_handle_t  provider,
+                      bake_target_id_t        bti,
+                      uint64_t                count,
+                      const bake_region_id_t* rids);
+
+/**
+ * Removes all the regions of a group from a target in one RPC, see
+ * bake_create_group().  Removing a group that has no region left succeeds.
+ *
+ * @param [in] provider provider handle
+ * @param [in] bti BAKE target identifier
+ * @param [in] group group of the regions to remove, not 0
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_remove_group(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               group);
+
+/**
+ * Runs a list of operations on a target in one RPC.  The provider runs
+ * them in order and stops at the first one that fails; an operation may
+ * work on the region created by an earlier one of the list (see
+ * bake_op_t), so that e.g. a region can be created, written, persisted
+ * and read back in one round trip.  The data written and read travel in
+ * the RPC messages, so the operations are meant for small data.  If bti
+ * is null, the provider chooses the target like bake_create_placed() does
+ * and returns it in bti.
+ *
+ * @param [in] provider provider handle
+ * @param [in,out] bti BAKE target identifier, set to the target the
+ * operations ran on
+ * @param [in] count number of operations
+ * @param [in] ops operations to run
+ * @param [out] results result of each operation run; those of the
+ * operations after a failed one are left untouched
+ * @return BAKE_SUCCESS or the error of the operation that failed.
+ */
+int bake_compound(bake_provider_handle_t provider,
+                  bake_target_id_t*      bti,
+                  uint64_t               count,
+                  bake_op_t*             ops,
+                  bake_op_result_t*      results);
+
+/**
+ * Changes a parameter of a running provider, as bake_provider_set_param()
+ * does on the server side; the parameters that can be changed are listed
+ * with bake_provider_set_param().
+ *
+ * @param [in] provider provider handle
+ * @param [in] key parameter name, e.g. "pipeline_first_buffer_size"
+ * @param [in] value parameter value, e.g. "1048576" or "true"
+ *
+ * @return BAKE_SUCCESS or corresponding error code.
+ */
+int bake_set_param(bake_provider_handle_t provider,
+                   const char*            key,
+                   const char*            value);
+
 #ifdef __cplusplus
 }
 #endif
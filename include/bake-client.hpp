@@ -138,6 +138,21 @@ class client {
             const target& tid,
             uint64_t region_size) const;
 
+    /**
+     * @brief Creates a region of a given size on a target chosen
+     * by the provider.
+     *
+     * @param ph Provider handle.
+     * @param region_size Size of the region.
+     * @param tgt Target on which the region was created.
+     *
+     * @return a region object corresponding to the newly created region.
+     */
+    region create(
+            const provider_handle& ph,
+            uint64_t region_size,
+            target& tgt) const;
+
     /**
      * @brief Writes to a region that has been created.
      * The offset is relative to the region. If bake we compiled
@@ -217,6 +232,23 @@ class client {
             void const *buf,
             size_t buf_size) const;
 
+    /**
+     * @brief Creates, writes, and persists a region in a single RPC,
+     * on a target chosen by the provider.
+     *
+     * @param ph Provider handle.
+     * @param buf Buffer containing the data to write.
+     * @param buf_size Buffer size.
+     * @param tgt Target on which the region was created.
+     *
+     * @return region instance corresponding to the newly created region.
+     */
+    region create_write_persist(
+            const provider_handle& ph,
+            void const *buf,
+            size_t buf_size,
+            target& tgt) const;
+
     /**
      * @brief Creates, writes, and persists a region in a single RPC,
      * using a bulk handle instead of a pointer to local data.
@@ -325,6 +357,150 @@ class client {
             const target& tid,
             const region& rid) const;
 
+    /**
+     * @brief Writes into several regions in one RPC.
+     *
+     * @param ph Provider handle.
+     * @param segments Regions and ranges in them to write.
+     * @param bufs Buffers holding the data of each segment.
+     */
+    void writev(
+            const provider_handle& ph,
+            const std::vector<bake_segment_t>& segments,
+            const std::vector<const void*>& bufs) const;
+
+    /**
+     * @brief Reads from several regions in one RPC.
+     *
+     * @param ph Provider handle.
+     * @param segments Regions and ranges in them to read.
+     * @param bufs Buffers receiving the data of each segment.
+     *
+     * @return The amount of data read for each segment.
+     */
+    std::vector<uint64_t> readv(
+            const provider_handle& ph,
+            const std::vector<bake_segment_t>& segments,
+            const std::vector<void*>& bufs) const;
+
+    /**
+     * @brief Creates, writes, and persists many small regions at once.
+     *
+     * @param ph Provider handle.
+     * @param tid Target on which to create the regions.
+     * @param sizes Size of each region.
+     * @param data Contents of the regions, back to back.
+     *
+     * @return The newly created regions.
+     */
+    std::vector<region> create_write_persist_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<uint64_t>& sizes,
+            void const* data) const;
+
+    /**
+     * @brief Reads many small regions at once, from their beginning.
+     *
+     * @param ph Provider handle.
+     * @param tid Target to read from.
+     * @param rids Regions to read.
+     * @param sizes Amount of data to read from each region.
+     * @param buf Buffer of at least the sum of the sizes, receiving
+     * the contents of the regions back to back.
+     *
+     * @return The amount of data read from each region.
+     */
+    std::vector<uint64_t> read_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<region>& rids,
+            const std::vector<uint64_t>& sizes,
+            void* buf) const;
+
+    /**
+     * @brief Creates several regions in one RPC.
+     *
+     * @param ph Provider handle.
+     * @param tid Target on which to create the regions.
+     * @param sizes Size of each region.
+     *
+     * @return The newly created regions.
+     */
+    std::vector<region> create_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<uint64_t>& sizes) const;
+
+    /**
+     * @brief Creates several regions in one RPC, tagged with a group.
+     *
+     * @param ph Provider handle.
+     * @param tid Target on which to create the regions.
+     * @param group Group of the regions, not 0.
+     * @param sizes Size of each region.
+     *
+     * @return The newly created regions.
+     */
+    std::vector<region> create_group(
+            const provider_handle& ph,
+            const target& tid,
+            uint64_t group,
+            const std::vector<uint64_t>& sizes) const;
+
+    /**
+     * @brief Removes several regions in one RPC.
+     *
+     * @param ph Provider handle.
+     * @param tid Target containing the regions to remove.
+     * @param rids Regions to remove.
+     */
+    void remove_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<region>& rids) const;
+
+    /**
+     * @brief Removes all the regions of a group from a target.
+     *
+     * @param ph Provider handle.
+     * @param tid Target containing the regions to remove.
+     * @param group Group of the regions to remove, not 0.
+     */
+    void remove_group(
+            const provider_handle& ph,
+            const target& tid,
+            uint64_t group) const;
+
+    /**
+     * @brief Runs a list of operations on a target in one RPC.
+     * If an operation fails, the exception carries its error and
+     * the results of the operations are lost.
+     *
+     * @param ph Provider handle.
+     * @param tid Target on which to run the operations; if it is
+     * a default target, set to the target chosen by the provider.
+     * @param ops Operations to run.
+     *
+     * @return The result of each operation.
+     */
+    std::vector<bake_op_result_t> compound(
+            const provider_handle& ph,
+            target& tid,
+            std::vector<bake_op_t>& ops) const;
+
+    /**
+     * @brief Changes a parameter of a running provider.
+     *
+     * @param ph Provider handle.
+     * @param key Parameter name.
+     * @param value Parameter value.
+     */
+    void set_param(
+            const provider_handle& ph,
+            const std::string& key,
+            const std::string& value) const;
+
     /**
      * @brief Migrate a region from a target to another.
      *
@@ -514,6 +690,49 @@ class provider_handle {
         int ret = bake_provider_handle_set_eager_limit(m_ph, limit);
         _CHECK_RET(ret);
     }
+
+    /**
+     * @brief Get the size of the packed messages of
+     * create_write_persist_multi and read_multi.
+     *
+     * @return The multi message size.
+     */
+    uint64_t get_multi_msg_size() const {
+        uint64_t result;
+        int ret = bake_provider_handle_get_multi_msg_size(m_ph, &result);
+        _CHECK_RET(ret);
+        return result;
+    }
+
+    /**
+     * @brief Sets the multi message size.
+     */
+    void set_multi_msg_size(uint64_t size) {
+        int ret = bake_provider_handle_set_multi_msg_size(m_ph, size);
+        _CHECK_RET(ret);
+    }
+
+    /**
+     * @brief Get the number of times a read or a write is retried
+     * when the provider is busy.
+     *
+     * @return The number of retries.
+     */
+    uint32_t get_busy_retries() const {
+        uint32_t result;
+        int ret = bake_provider_handle_get_busy_retries(m_ph, &result);
+        _CHECK_RET(ret);
+        return result;
+    }
+
+    /**
+     * @brief Sets the number of times a read or a write is retried
+     * when the provider is busy.
+     */
+    void set_busy_retries(uint32_t retries) {
+        int ret = bake_provider_handle_set_busy_retries(m_ph, retries);
+        _CHECK_RET(ret);
+    }
 };
 
 inline std::vector<target> client::probe(
@@ -555,6 +774,16 @@ inline region client::create(
     return r;
 }
 
+inline region client::create(
+            const provider_handle& ph,
+            uint64_t region_size,
+            target& tgt) const {
+    region r;
+    int ret = bake_create_placed(ph.m_ph, region_size, &(tgt.m_tid), &(r.m_rid));
+    _CHECK_RET(ret);
+    return r;
+}
+
 inline void client::write(
             const provider_handle& ph,
             const target& tid,
@@ -618,6 +847,22 @@ inline region client::create_write_persist(
     return r;
 }
 
+inline region client::create_write_persist(
+            const provider_handle& ph,
+            void const *buf,
+            size_t buf_size,
+            target& tgt) const {
+    region r;
+    int ret = bake_create_write_persist_placed(
+            ph.m_ph,
+            buf,
+            buf_size,
+            &tgt.m_tid,
+            &r.m_rid);
+    _CHECK_RET(ret);
+    return r;
+}
+
 inline region client::create_write_persist(
             const provider_handle& ph,
             const target& tid,
@@ -750,6 +995,130 @@ inline void client::remove(
     _CHECK_RET(ret);
 }
 
+inline void client::writev(
+            const provider_handle& ph,
+            const std::vector<bake_segment_t>& segments,
+            const std::vector<const void*>& bufs) const {
+    if(bufs.size() != segments.size())
+        throw exception(BAKE_ERR_INVALID_ARG);
+    int ret = bake_writev(ph.m_ph, segments.size(),
+            segments.data(), bufs.data());
+    _CHECK_RET(ret);
+}
+
+inline std::vector<uint64_t> client::readv(
+            const provider_handle& ph,
+            const std::vector<bake_segment_t>& segments,
+            const std::vector<void*>& bufs) const {
+    if(bufs.size() != segments.size())
+        throw exception(BAKE_ERR_INVALID_ARG);
+    std::vector<uint64_t> bytes_read(segments.size());
+    int ret = bake_readv(ph.m_ph, segments.size(),
+            segments.data(), bufs.data(), bytes_read.data());
+    _CHECK_RET(ret);
+    return bytes_read;
+}
+
+inline std::vector<region> client::create_write_persist_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<uint64_t>& sizes,
+            void const* data) const {
+    std::vector<bake_region_id_t> rids(sizes.size());
+    int ret = bake_create_write_persist_multi(ph.m_ph, tid.m_tid,
+            sizes.size(), sizes.data(), data, rids.data());
+    _CHECK_RET(ret);
+    std::vector<region> result(rids.size());
+    for(unsigned i=0; i < rids.size(); i++)
+        result[i].m_rid = rids[i];
+    return result;
+}
+
+inline std::vector<uint64_t> client::read_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<region>& rids,
+            const std::vector<uint64_t>& sizes,
+            void* buf) const {
+    if(sizes.size() != rids.size())
+        throw exception(BAKE_ERR_INVALID_ARG);
+    std::vector<bake_region_id_t> ids(rids.size());
+    for(unsigned i=0; i < rids.size(); i++)
+        ids[i] = rids[i].m_rid;
+    std::vector<uint64_t> bytes_read(rids.size());
+    int ret = bake_read_multi(ph.m_ph, tid.m_tid, ids.size(),
+            ids.data(), sizes.data(), buf, bytes_read.data());
+    _CHECK_RET(ret);
+    return bytes_read;
+}
+
+inline std::vector<region> client::create_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<uint64_t>& sizes) const {
+    std::vector<bake_region_id_t> rids(sizes.size());
+    int ret = bake_create_multi(ph.m_ph, tid.m_tid,
+            sizes.size(), sizes.data(), rids.data());
+    _CHECK_RET(ret);
+    std::vector<region> result(rids.size());
+    for(unsigned i=0; i < rids.size(); i++)
+        result[i].m_rid = rids[i];
+    return result;
+}
+
+inline std::vector<region> client::create_group(
+            const provider_handle& ph,
+            const target& tid,
+            uint64_t group,
+            const std::vector<uint64_t>& sizes) const {
+    std::vector<bake_region_id_t> rids(sizes.size());
+    int ret = bake_create_group(ph.m_ph, tid.m_tid, group,
+            sizes.size(), sizes.data(), rids.data());
+    _CHECK_RET(ret);
+    std::vector<region> result(rids.size());
+    for(unsigned i=0; i < rids.size(); i++)
+        result[i].m_rid = rids[i];
+    return result;
+}
+
+inline void client::remove_multi(
+            const provider_handle& ph,
+            const target& tid,
+            const std::vector<region>& rids) const {
+    std::vector<bake_region_id_t> ids(rids.size());
+    for(unsigned i=0; i < rids.size(); i++)
+        ids[i] = rids[i].m_rid;
+    int ret = bake_remove_multi(ph.m_ph, tid.m_tid, ids.size(), ids.data());
+    _CHECK_RET(ret);
+}
+
+inline void client::remove_group(
+            const provider_handle& ph,
+            const target& tid,
+            uint64_t group) const {
+    int ret = bake_remove_group(ph.m_ph, tid.m_tid, group);
+    _CHECK_RET(ret);
+}
+
+inline std::vector<bake_op_result_t> client::compound(
+            const provider_handle& ph,
+            target& tid,
+            std::vector<bake_op_t>& ops) const {
+    std::vector<bake_op_result_t> results(ops.size());
+    int ret = bake_compound(ph.m_ph, &(tid.m_tid),
+            ops.size(), ops.data(), results.data());
+    _CHECK_RET(ret);
+    return results;
+}
+
+inline void client::set_param(
+            const provider_handle& ph,
+            const std::string& key,
+            const std::string& value) const {
+    int ret = bake_set_param(ph.m_ph, key.c_str(), value.c_str());
+    _CHECK_RET(ret);
+}
+
 }
 
 #undef _CHECK_RET
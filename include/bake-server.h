@@ -37,6 +37,9 @@ struct bake_provider_init_info {
     abt_io_instance_id aid;           /* optional abt-io instance, used by file backend */
     remi_provider_t    remi_provider; /* optional REMI provider */
     remi_client_t      remi_client;   /* optional REMI client */
+    ABT_pool*          target_pools;  /* optional per-target pools, see below */
+    unsigned           num_target_pools;
+    ABT_pool           transfer_pool; /* optional pool for pipelining */
 };
 
 /**
@@ -55,18 +58,32 @@ struct bake_provider_init_info {
     "targets":[
       "./pmem-target-A.dat"
     ]
+  },
+  "target_pools":{
+    "file:./file-target-A.dat":{
+      "num_xstreams":2,
+      "cpus":[4,5]
+    },
+    "pmem:./pmem-target-A.dat":0
   }
 }
 
+ * Each entry of "target_pools" runs the RPCs of the named target on a pool
+ * of its own: either one the provider creates with the given number of
+ * execution streams (optionally bound to the given cpus), or the given
+ * index in the target_pools array of bake_provider_init_info.  Targets
+ * that are not listed use rpc_pool.
+
  * See the examples/ subdirectory in this repository for more advanced json
  * specifications.
  *
  * ----------------------------------------------
  */
 
-#define BAKE_PROVIDER_INIT_INFO_INITIALIZER                   \
-    {                                                         \
-        NULL, ABT_POOL_NULL, ABT_IO_INSTANCE_NULL, NULL, NULL \
+#define BAKE_PROVIDER_INIT_INFO_INITIALIZER                             \
+    {                                                                   \
+        NULL, ABT_POOL_NULL, ABT_IO_INSTANCE_NULL, NULL, NULL, NULL, 0, \
+            ABT_POOL_NULL                                               \
     }
 
 /**
@@ -168,13 +185,18 @@ int bake_provider_list_targets(bake_provider_t   provider,
                                bake_target_id_t* targets);
 
 /**
- * Sets configuration parameters
+ * Sets configuration parameters, while the provider runs.  The parameters
+ * that can be changed are "pipeline_enable" and the other "pipeline_*"
+ * buffer settings, "qos.*", "backpressure.*", the weights of
+ * "priority_lanes", "file_backend.sync" and "file_backend.io_max_threads";
+ * nested ones are named with dots.  Changing the pipeline settings waits
+ * for the transfers in progress before rebuilding the buffers.
  *
  * @param [in] provider Bake provider
  * @param [in] key parameter name
  * @param [in] value parameter value
  *
- * @returns 0 on success, -1 on failure
+ * @returns 0 on success, a BAKE_ERR_* code on failure
  */
 int bake_provider_set_param(bake_provider_t provider,
                             const char*     key,
@@ -187,6 +209,16 @@ int bake_provider_set_param(bake_provider_t provider,
  */
 char* bake_provider_get_config(bake_provider_t provider);
 
+/**
+ * Retrieves run time statistics of the provider's targets (e.g., cache hit
+ * rates), encoded as json.  Targets whose backend keeps no statistics are
+ * omitted.
+ *
+ * @param [in] provider bake provider
+ * @returns null terminated string that must be free'd by caller
+ */
+char* bake_provider_get_stats(bake_provider_t provider);
+
 /**
  * Creates a raw storage target, not connected to a provider.  This would
  * mainly be used by external utilities, not a server daemon itself.
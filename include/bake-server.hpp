@@ -222,6 +222,15 @@ class provider {
         free(cfg);
         return str_cfg;
     }
+
+    std::string get_stats() const
+    {
+        char* stats = bake_provider_get_stats(m_provider);
+        if (!stats) return std::string();
+        auto str_stats = std::string(stats);
+        free(stats);
+        return str_stats;
+    }
 };
 
 } // namespace bake
@@ -35,6 +35,46 @@ typedef struct {
     char     data[BAKE_REGION_ID_DATA_SIZE];
 } bake_region_id_t;
 
+/**
+ * Part of a region accessed by a vectored read or write.
+ */
+typedef struct {
+    bake_target_id_t bti;
+    bake_region_id_t rid;
+    uint64_t         region_offset;
+    uint64_t         size;
+} bake_segment_t;
+
+/**
+ * Operation of a compound request (see bake_compound).  The operation
+ * works on rid, or, if rid_step is not BAKE_OP_RID, on the region created
+ * by the BAKE_OP_CREATE operation of index rid_step of the same request.
+ */
+#define BAKE_OP_CREATE   0 /* creates a region of size bytes */
+#define BAKE_OP_WRITE    1 /* writes size bytes of buf at offset */
+#define BAKE_OP_PERSIST  2 /* persists size bytes at offset */
+#define BAKE_OP_GET_SIZE 3 /* gets the size of the region */
+#define BAKE_OP_READ     4 /* reads up to size bytes at offset into buf */
+#define BAKE_OP_REMOVE   5 /* removes the region */
+#define BAKE_OP_RID      (-1) /* rid_step of an operation on rid */
+typedef struct {
+    int32_t          type;
+    int32_t          rid_step;
+    bake_region_id_t rid;
+    uint64_t         offset;
+    uint64_t         size;
+    void*            buf;
+} bake_op_t;
+
+/**
+ * Result of an operation of a compound request.
+ */
+typedef struct {
+    int32_t          ret;
+    bake_region_id_t rid;  /* region created or worked on */
+    uint64_t         size; /* region size, or bytes read */
+} bake_op_result_t;
+
 #define BAKE_SUCCESS         0    /* Success */
 #define BAKE_ERR_ALLOCATION  (-1) /* Error allocating something */
 #define BAKE_ERR_INVALID_ARG (-2) /* An argument is invalid */
@@ -58,7 +98,9 @@ typedef struct {
 #define BAKE_ERR_NOENT          (-15) /* entry does not exist */
 #define BAKE_ERR_EXIST          (-16) /* entry already exists */
 #define BAKE_ERR_NOMEM          (-17) /* entry already exists */
-#define BAKE_ERR_END            (-18) /* End of valid bake error codes */
+#define BAKE_ERR_BUSY           (-18) /* Provider overloaded, retry later */
+#define BAKE_ERR_TIMEOUT        (-19) /* Deadline of the request passed */
+#define BAKE_ERR_END            (-20) /* End of valid bake error codes */
 
 /**
  * Print bake errors in human-friendly form
@@ -33,7 +33,9 @@ const char* const bake_error_messages[] = {
     "Backend I/O error",
     "Entry does not exist",
     "Entry already exists",
-    "Not enough memory"
+    "Not enough memory",
+    "Provider busy",
+    "Deadline passed"
 };
 
 class client;
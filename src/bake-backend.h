@@ -78,6 +78,34 @@ typedef int (*bake_get_region_data_fn)(backend_context_t context,
 
 typedef int (*bake_remove_fn)(backend_context_t context, bake_region_id_t rid);
 
+/* batch versions of create and remove, for backends that can do better
+ * than one call per region; a failed batch create leaves no region behind,
+ * while a batch remove removes what it can, reports the size of the
+ * regions it did remove and returns the first error
+ */
+typedef int (*bake_create_multi_fn)(backend_context_t context,
+                                    size_t            count,
+                                    const uint64_t*   sizes,
+                                    bake_region_id_t* rids);
+
+typedef int (*bake_remove_multi_fn)(backend_context_t       context,
+                                    size_t                  count,
+                                    const bake_region_id_t* rids,
+                                    size_t*                 bytes_removed);
+
+/* creation of regions tagged with a group (not 0), and removal of all the
+ * regions of a group at once, which reports their size like _remove_multi
+ */
+typedef int (*bake_create_group_fn)(backend_context_t context,
+                                    uint64_t          group,
+                                    size_t            count,
+                                    const uint64_t*   sizes,
+                                    bake_region_id_t* rids);
+
+typedef int (*bake_remove_group_fn)(backend_context_t context,
+                                    uint64_t          group,
+                                    size_t*           bytes_removed);
+
 typedef int (*bake_migrate_region_fn)(backend_context_t context,
                                       bake_region_id_t  source_rid,
                                       size_t            region_size,
@@ -89,6 +117,20 @@ typedef int (*bake_migrate_region_fn)(backend_context_t context,
 
 typedef int (*bake_create_raw_target_fn)(const char* path, size_t size);
 
+/* adds the statistics of the target to the given json object; backends
+ * that know how much of their storage is held by regions report it as an
+ * integer "bytes_used", which the provider reads when the target is
+ * attached
+ */
+struct json_object;
+typedef int (*bake_get_stats_fn)(backend_context_t   context,
+                                 struct json_object* stats);
+
+/* re-reads the tuning settings of the target from the provider's json,
+ * after they were changed with bake_provider_set_param
+ */
+typedef int (*bake_reconfigure_fn)(backend_context_t context);
+
 #ifdef USE_REMI
 typedef int (*bake_create_fileset_fn)(backend_context_t context,
                                       remi_fileset_t*   fileset);
@@ -111,6 +153,12 @@ typedef struct bake_backend {
     bake_remove_fn                    _remove;
     bake_migrate_region_fn            _migrate_region;
     bake_create_raw_target_fn         _create_raw_target;
+    bake_get_stats_fn                 _get_stats; /* optional, may be NULL */
+    bake_reconfigure_fn               _reconfigure; /* optional, may be NULL */
+    bake_create_multi_fn              _create_multi; /* optional, may be NULL */
+    bake_remove_multi_fn              _remove_multi; /* optional, may be NULL */
+    bake_create_group_fn              _create_group; /* optional, may be NULL */
+    bake_remove_group_fn              _remove_group; /* optional, may be NULL */
 #ifdef USE_REMI
     bake_create_fileset_fn _create_fileset;
 #endif
@@ -118,4 +166,88 @@ typedef struct bake_backend {
 
 typedef bake_backend* bake_backend_t;
 
+/* returns the backend registered under the given name (the prefix of a
+ * target name), or NULL if there is none
+ */
+bake_backend_t bake_backend_lookup(const char* backend_type);
+
+/* splits a target name of the form "<backend>:<path>" (or just "<path>",
+ * meaning pmem) and returns its backend, or NULL if there is none
+ */
+bake_backend_t bake_backend_parse_target(const char* name, const char** path);
+
+/* removes a path from the list of targets recorded in the configuration of
+ * the given backend; used by backends that wrap other backends
+ */
+void bake_backend_unlist_target(bake_provider_t provider,
+                                bake_backend_t  backend,
+                                const char*     path);
+
+/* returns the "bytes_used" statistic of a target, or 0 if its backend does
+ * not report one
+ */
+uint64_t bake_backend_bytes_used(bake_backend_t    backend,
+                                 backend_context_t context);
+
+/* create or remove a batch of regions of a target (creating them with a
+ * group if it is not 0), through the backend's batch hooks if it has
+ * them and one region at a time otherwise; for the provider and for the
+ * backends that wrap other backends.  bake_backend_remove_multi() reports
+ * the size of the regions it removed in bytes_removed if not NULL.
+ */
+int bake_backend_create_multi(bake_backend_t    backend,
+                              backend_context_t context,
+                              uint64_t          group,
+                              size_t            count,
+                              const uint64_t*   sizes,
+                              bake_region_id_t* rids);
+
+int bake_backend_remove_multi(bake_backend_t          backend,
+                              backend_context_t       context,
+                              size_t                  count,
+                              const bake_region_id_t* rids,
+                              size_t*                 bytes_removed);
+
+/* sends a region exposed by the given bulk handle to another provider with
+ * a create_write_persist, for the _migrate_region implementations; retries
+ * with backoff while the destination answers BAKE_ERR_BUSY.  Returns 0 or
+ * a BAKE_ERR_ code, and the new region id in dest_rid.
+ */
+int bake_backend_migrate_region(bake_provider_t   provider,
+                                hg_addr_t         dest_addr,
+                                uint16_t          dest_provider_id,
+                                bake_target_id_t  dest_target_id,
+                                hg_bulk_t         bulk,
+                                size_t            region_size,
+                                bake_region_id_t* dest_rid);
+
+/* moves one chunk of a pipelined transfer between a pipeline buffer and
+ * the backend's storage; extent_offset is the position of the chunk in
+ * the extent being transferred.  Returns 0 or a BAKE_ERR_ code.
+ */
+typedef int (*bake_pipeline_relay_fn)(void*  arg,
+                                      void*  buffer,
+                                      size_t extent_offset,
+                                      size_t size);
+
+/* relays a bulk transfer through the provider's pipeline buffers, for
+ * backends that cannot expose their storage to RDMA directly.  The
+ * backend's extent of extent_size bytes is cut into buffer-sized chunks,
+ * each handled by a ULT on the provider's transfer pool; the bulk_size
+ * bytes exchanged with the client are those starting skip bytes into the
+ * extent.  For HG_BULK_PULL (writes) relay is called after a chunk has
+ * been pulled, for HG_BULK_PUSH (reads) before it is pushed; a NULL relay
+ * does nothing.  Fails with BAKE_ERR_INVALID_ARG if pipelining is off.
+ */
+int bake_backend_pipeline_transfer(bake_provider_t        provider,
+                                   hg_bulk_op_t           op,
+                                   size_t                 extent_size,
+                                   size_t                 skip,
+                                   hg_bulk_t              remote_bulk,
+                                   hg_addr_t              remote_addr,
+                                   size_t                 remote_offset,
+                                   size_t                 bulk_size,
+                                   bake_pipeline_relay_fn relay,
+                                   void*                  arg);
+
 #endif
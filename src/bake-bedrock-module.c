@@ -16,6 +16,7 @@ static int bake_register_provider(bedrock_args_t             args,
                                   bedrock_module_provider_t* provider)
 {
     int                            ret;
+    unsigned                       i;
     struct bake_provider_init_info bpargs = {0};
     margo_instance_id              mid = bedrock_args_get_margo_instance(args);
     uint16_t    provider_id            = bedrock_args_get_provider_id(args);
@@ -43,6 +44,27 @@ static int bake_register_provider(bedrock_args_t             args,
         bpargs.remi_client = NULL;
     }
 
+    if (bedrock_args_get_num_dependencies(args, "transfer_pool")) {
+        bpargs.transfer_pool
+            = bedrock_args_get_dependency(args, "transfer_pool", 0);
+    } else {
+        bpargs.transfer_pool = ABT_POOL_NULL;
+    }
+
+    /* pools that the "target_pools" entries of the config refer to by
+     * index; the provider keeps its own copy of the array
+     */
+    bpargs.num_target_pools
+        = bedrock_args_get_num_dependencies(args, "target_pools");
+    if (bpargs.num_target_pools) {
+        bpargs.target_pools
+            = calloc(bpargs.num_target_pools, sizeof(*bpargs.target_pools));
+        if (!bpargs.target_pools) return (-1);
+        for (i = 0; i < bpargs.num_target_pools; i++)
+            bpargs.target_pools[i]
+                = bedrock_args_get_dependency(args, "target_pools", i);
+    }
+
     BAKE_TRACE(mid, "bake_register_provider()");
     BAKE_TRACE(mid, " -> mid           = %p", (void*)mid);
     BAKE_TRACE(mid, " -> provider id   = %d", provider_id);
@@ -52,11 +74,14 @@ static int bake_register_provider(bedrock_args_t             args,
     BAKE_TRACE(mid, " -> abt_io        = %p", bpargs.aid);
     BAKE_TRACE(mid, " -> remi_provider = %p", bpargs.remi_provider);
     BAKE_TRACE(mid, " -> remi_client   = %p", bpargs.remi_client);
+    BAKE_TRACE(mid, " -> target_pools  = %u", bpargs.num_target_pools);
+    BAKE_TRACE(mid, " -> transfer_pool = %p", (void*)bpargs.transfer_pool);
 
     bpargs.json_config = config;
     bpargs.rpc_pool    = pool;
     ret                = bake_provider_register(mid, provider_id, &bpargs,
                                                 (bake_provider_t*)provider);
+    free(bpargs.target_pools);
     if (ret < 0) return (-1);
 
     return BEDROCK_SUCCESS;
@@ -134,11 +159,16 @@ static int bake_destroy_provider_handle(bedrock_module_provider_handle_t ph)
  * - only used by some backends (the file one, specifically)
  * - if needed by not provided as a dependency, then the backend will create
  *   one of it's own implicitly
+ * optional target_pools can be specified for the "target_pools" entries of
+ * the config to refer to by index, and an optional transfer_pool to run
+ * pipelined transfers
  */
-struct bedrock_dependency bake_provider_deps[4]
+struct bedrock_dependency bake_provider_deps[6]
     = {{"abt_io", "abt_io", 0},
        {"remi_provider", "remi", 0},
        {"remi_client", "remi", 0},
+       {"target_pools", "pool", BEDROCK_ARRAY},
+       {"transfer_pool", "pool", 0},
        BEDROCK_NO_MORE_DEPENDENCIES};
 
 struct bedrock_dependency bake_client_deps[1] = {BEDROCK_NO_MORE_DEPENDENCIES};
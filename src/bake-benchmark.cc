@@ -74,6 +74,13 @@ class AbstractBenchmark {
     virtual void execute()  = 0;
     virtual void teardown() = 0;
 
+    /**
+     * @brief Number of operations and of bytes moved by the last execute(),
+     * used to report rates in addition to timings.
+     */
+    virtual size_t ops_per_execution() const { return 0; }
+    virtual size_t bytes_per_execution() const { return 0; }
+
     /**
      * @brief Factory function used to create benchmark instances.
      */
@@ -137,6 +144,10 @@ class AbstractAccessBenchmark : public AbstractBenchmark {
         size_t eager_size = getConfigInt(config, "eager-limit", 2048);
         ph().set_eager_limit(eager_size);
     }
+
+    virtual size_t ops_per_execution() const override {
+        return m_num_entries;
+    }
 };
 
 /**
@@ -266,6 +277,10 @@ class CreateWritePersistBenchmark : public AbstractAccessBenchmark {
         m_region_ids.resize(0);   m_region_ids.shrink_to_fit();
         m_data.resize(0);         m_data.shrink_to_fit();
     }
+
+    virtual size_t bytes_per_execution() const override {
+        return std::accumulate(m_region_sizes.begin(), m_region_sizes.end(), (size_t)0);
+    }
 };
 REGISTER_BENCHMARK("create-write-persist", CreateWritePersistBenchmark);
 
@@ -355,6 +370,10 @@ class WriteBenchmark : public AbstractAccessBenchmark {
             margo_bulk_free(m_bulk);
         }
     }
+
+    virtual size_t bytes_per_execution() const override {
+        return std::accumulate(m_access_sizes.begin(), m_access_sizes.end(), (size_t)0);
+    }
 };
 REGISTER_BENCHMARK("write", WriteBenchmark);
 
@@ -392,7 +411,7 @@ class ReadBenchmark : public AbstractAccessBenchmark {
         size_t read_data_size = 0;
         size_t region_size = 0;
         std::vector<char> write_data;
-        m_access_sizes.reserve(m_num_entries);
+        m_access_sizes.resize(m_num_entries);
         for(unsigned i=0; i < m_num_entries; i++) {
             size_t size = m_region_size_range.first + (rand() % (m_region_size_range.second - m_region_size_range.first));
             m_access_sizes[i] = size;
@@ -447,6 +466,10 @@ class ReadBenchmark : public AbstractAccessBenchmark {
             margo_bulk_free(m_bulk);
         }
     }
+
+    virtual size_t bytes_per_execution() const override {
+        return std::accumulate(m_access_sizes.begin(), m_access_sizes.end(), (size_t)0);
+    }
 };
 REGISTER_BENCHMARK("read", ReadBenchmark);
 
@@ -580,8 +603,13 @@ static void run_server(MPI_Comm comm, Json::Value& config) {
     // send server address to client
     MPI_Bcast(&buf_size, sizeof(hg_size_t), MPI_BYTE, 0, MPI_COMM_WORLD);
     MPI_Bcast(server_addr_str.data(), buf_size, MPI_BYTE, 0, MPI_COMM_WORLD);
-    // initialize sdskv provider
-    auto provider = bake::provider::create(mid);
+    // initialize bake provider
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    std::string provider_config = "{}";
+    if(server_config.isMember("provider-config"))
+        provider_config = Json::writeString(builder, server_config["provider-config"]);
+    auto provider = bake::provider::create(mid, 0, ABT_POOL_NULL, provider_config);
     // initialize database
     auto& target_config = server_config["target"];
     std::string tgt_path = target_config["path"].asString();
@@ -642,6 +670,7 @@ static void run_client(MPI_Comm comm, Json::Value& config) {
             // reset the RNG
             srand(seed + rank*1789);
             std::vector<double> local_timings(rep);
+            double local_ops = 0, local_bytes = 0;
             for(unsigned j = 0; j < rep; j++) {
                 MPI_Barrier(comm);
                 // benchmark setup
@@ -652,15 +681,20 @@ static void run_client(MPI_Comm comm, Json::Value& config) {
                 bench->execute();
                 double t_end = MPI_Wtime();
                 local_timings[j] = t_end - t_start;
+                local_ops   += bench->ops_per_execution();
+                local_bytes += bench->bytes_per_execution();
                 MPI_Barrier(comm);
                 // teardown
                 bench->teardown();
             }
             // exchange timings
             std::vector<double> global_timings(rep*num_clients);
+            double global_ops = local_ops, global_bytes = local_bytes;
             if(num_clients != 1) {
                 MPI_Gather(local_timings.data(), local_timings.size(), MPI_DOUBLE,
                        global_timings.data(), local_timings.size(), MPI_DOUBLE, 0, comm);
+                MPI_Reduce(&local_ops, &global_ops, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+                MPI_Reduce(&local_bytes, &global_bytes, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
             } else {
                 std::copy(local_timings.begin(), local_timings.end(), global_timings.begin());
             }
@@ -677,6 +711,15 @@ static void run_client(MPI_Comm comm, Json::Value& config) {
                     });
                 variance /= n;
                 double stddev = std::sqrt(variance);
+                // aggregate rates: all clients run each repetition concurrently,
+                // so a repetition lasts as long as its slowest client
+                double wall_time = 0.0;
+                for(unsigned j = 0; j < rep; j++) {
+                    double t = 0.0;
+                    for(int r = 0; r < num_clients; r++)
+                        t = std::max(t, global_timings[r*rep + j]);
+                    wall_time += t;
+                }
                 std::sort(global_timings.begin(), global_timings.end());
                 double min = global_timings[0];
                 double max = global_timings[global_timings.size()-1];
@@ -693,6 +736,12 @@ static void run_client(MPI_Comm comm, Json::Value& config) {
                 std::cout << "Median(sec)     : " << median << std::endl;
                 std::cout << "Q3(sec)         : " << q3 << std::endl;
                 std::cout << "Maximum(sec)    : " << max << std::endl;
+                if(wall_time > 0.0 && global_ops > 0) {
+                    std::cout << "Ops/sec         : " << global_ops / wall_time << std::endl;
+                }
+                if(wall_time > 0.0 && global_bytes > 0) {
+                    std::cout << "Bandwidth(MiB/s): " << global_bytes / wall_time / (1024.0*1024.0) << std::endl;
+                }
             }
         }
         // wait for all the clients to be done with their tasks
@@ -0,0 +1,399 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "bake-config.h"
+
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <bake.h>
+#include "bake-buffer-pool.h"
+#include "bake-numa.h"
+
+#define BAKE_BUFFER_MAX_CLASSES 16
+#define BAKE_BUFFER_MAX_NODES   8
+#define BAKE_HUGEPAGE_SIZE      (2 * 1024 * 1024)
+/* number of transfers after which the histogram is halved, so that it
+ * follows the recent workload
+ */
+#define BAKE_BUFFER_HISTORY 4096
+
+typedef struct bake_buffer_class {
+    size_t size;
+    /* per node, most recently released first */
+    bake_buffer_t* free[BAKE_BUFFER_MAX_NODES];
+    uint64_t       transfers;
+} bake_buffer_class_t;
+
+struct bake_buffer_pool {
+    margo_instance_id         mid;
+    bake_buffer_pool_config_t config;
+    ABT_mutex                 mutex; /* protects everything below */
+    ABT_cond                  released;
+    unsigned                  num_waiters; /* for a buffer to be released */
+    bake_buffer_class_t       classes[BAKE_BUFFER_MAX_CLASSES];
+    unsigned                  num_classes;
+    size_t                    memory;
+    uint64_t                  transfers;
+    int                       stopping;
+    ABT_cond                  stop;
+    ABT_thread                sweeper;
+    unsigned                  refcount; /* protected by shared_mutex */
+    struct bake_buffer_pool*  next;     /* in shared_pools */
+};
+
+/* pools of the process, shared by providers with the same margo instance
+ * and configuration
+ */
+static bake_buffer_pool_t shared_pools;
+static pthread_mutex_t    shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int same_config(const bake_buffer_pool_config_t* a,
+                       const bake_buffer_pool_config_t* b)
+{
+    return a->min_size == b->min_size && a->max_size == b->max_size
+        && a->multiplier == b->multiplier && a->max_memory == b->max_memory
+        && a->num_kept == b->num_kept && a->idle_sec == b->idle_sec
+        && a->numa == b->numa && a->hugepages == b->hugepages;
+}
+
+static unsigned class_of(bake_buffer_pool_t pool, size_t size)
+{
+    unsigned c;
+
+    for (c = 0; c < pool->num_classes - 1; c++)
+        if (pool->classes[c].size >= size) break;
+    return c;
+}
+
+/* node whose buffers the caller should use */
+static unsigned current_node(bake_buffer_pool_t pool)
+{
+    int node;
+
+    if (!pool->config.numa) return 0;
+    node = bake_numa_current_node();
+    return node < 0 ? 0 : node % BAKE_BUFFER_MAX_NODES;
+}
+
+/* maps the memory of a buffer, on hugepages and on its node if asked to */
+static int map_buffer(bake_buffer_pool_t pool, bake_buffer_t* buffer)
+{
+    int   flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* ptr   = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    /* takes from the reserved hugepages, if any are left */
+    if (pool->config.hugepages && buffer->size % BAKE_HUGEPAGE_SIZE == 0)
+        ptr = mmap(NULL, buffer->size, PROT_READ | PROT_WRITE,
+                   flags | MAP_HUGETLB, -1, 0);
+#endif
+    if (ptr == MAP_FAILED) {
+        ptr = mmap(NULL, buffer->size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (ptr == MAP_FAILED) return -1;
+#ifdef MADV_HUGEPAGE
+        /* otherwise let transparent hugepages back it */
+        if (pool->config.hugepages)
+            madvise(ptr, buffer->size, MADV_HUGEPAGE);
+#endif
+    }
+    /* before the pages are first touched by the registration */
+    if (pool->config.numa) bake_numa_bind(ptr, buffer->size, buffer->node);
+    buffer->ptr = ptr;
+    return 0;
+}
+
+static void free_buffer(bake_buffer_pool_t pool, bake_buffer_t* buffer)
+{
+    pool->memory -= buffer->size;
+    margo_bulk_free(buffer->bulk);
+    munmap(buffer->ptr, buffer->size);
+    free(buffer);
+}
+
+/* frees unused buffers, those of the least used classes first, until a
+ * buffer of the given size fits in the memory limit; returns 0 if there
+ * was nothing to free
+ */
+static int reclaim(bake_buffer_pool_t pool, size_t size)
+{
+    bake_buffer_class_t* cls;
+    bake_buffer_t**      list;
+    bake_buffer_t*       buffer;
+    unsigned             c, n;
+    int                  freed = 0;
+
+    while (pool->memory + size > pool->config.max_memory) {
+        cls  = NULL;
+        list = NULL;
+        for (c = 0; c < pool->num_classes; c++)
+            for (n = 0; n < BAKE_BUFFER_MAX_NODES; n++)
+                if (pool->classes[c].free[n]
+                    && (!cls || pool->classes[c].transfers < cls->transfers)) {
+                    cls  = &pool->classes[c];
+                    list = &cls->free[n];
+                }
+        if (!list) break;
+        buffer = *list;
+        *list  = buffer->next;
+        free_buffer(pool, buffer);
+        freed = 1;
+    }
+    return freed;
+}
+
+/* Frees the buffers that have not been used for idle_sec, except for the
+ * num_kept most recently used ones (on each node) of the classes that get
+ * at least their share of the transfers.
+ */
+static void sweep(bake_buffer_pool_t pool)
+{
+    bake_buffer_class_t* cls;
+    bake_buffer_t**      link;
+    bake_buffer_t*       buffer;
+    double               now = ABT_get_wtime();
+    unsigned             c, n, keep, kept;
+
+    for (c = 0; c < pool->num_classes; c++) {
+        cls  = &pool->classes[c];
+        keep = cls->transfers * pool->num_classes >= pool->transfers
+                 && cls->transfers
+                 ? pool->config.num_kept
+                 : 0;
+        for (n = 0; n < BAKE_BUFFER_MAX_NODES; n++) {
+            kept = keep;
+            for (link = &cls->free[n]; *link && kept; link = &(*link)->next)
+                kept--;
+            /* the list is in release order, the rest is idle from here on */
+            while (*link && now - (*link)->released < pool->config.idle_sec)
+                link = &(*link)->next;
+            while ((buffer = *link) != NULL) {
+                *link = buffer->next;
+                free_buffer(pool, buffer);
+            }
+        }
+    }
+}
+
+static void sweeper_ult(void* arg)
+{
+    bake_buffer_pool_t pool = arg;
+    struct timespec    wake;
+    double             period = pool->config.idle_sec / 2;
+
+    ABT_mutex_lock(pool->mutex);
+    while (!pool->stopping) {
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += (time_t)period;
+        wake.tv_nsec += (long)((period - (time_t)period) * 1e9);
+        if (wake.tv_nsec >= 1000000000) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000;
+        }
+        ABT_cond_timedwait(pool->stop, pool->mutex, &wake);
+        sweep(pool);
+    }
+    ABT_mutex_unlock(pool->mutex);
+}
+
+int bake_buffer_pool_create(margo_instance_id                mid,
+                            const bake_buffer_pool_config_t* config,
+                            bake_buffer_pool_t*              pool)
+{
+    bake_buffer_pool_t p;
+    ABT_pool           handler_pool;
+    size_t             size;
+
+    if (config->min_size == 0 || config->max_size < config->min_size
+        || config->multiplier < 2 || config->idle_sec <= 0)
+        return BAKE_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&shared_mutex);
+    for (p = shared_pools; p; p = p->next) {
+        if (p->mid == mid && same_config(&p->config, config)) {
+            p->refcount++;
+            pthread_mutex_unlock(&shared_mutex);
+            *pool = p;
+            return BAKE_SUCCESS;
+        }
+    }
+
+    p = calloc(1, sizeof(*p));
+    if (!p) {
+        pthread_mutex_unlock(&shared_mutex);
+        return BAKE_ERR_ALLOCATION;
+    }
+    p->mid      = mid;
+    p->config   = *config;
+    p->refcount = 1;
+    for (size = config->min_size; p->num_classes < BAKE_BUFFER_MAX_CLASSES;
+         size *= config->multiplier) {
+        p->classes[p->num_classes++].size = size;
+        if (size >= config->max_size) break;
+    }
+
+    if (ABT_mutex_create(&p->mutex) != ABT_SUCCESS
+        || ABT_cond_create(&p->released) != ABT_SUCCESS
+        || ABT_cond_create(&p->stop) != ABT_SUCCESS)
+        goto error;
+    margo_get_handler_pool(mid, &handler_pool);
+    if (ABT_thread_create(handler_pool, sweeper_ult, p, ABT_THREAD_ATTR_NULL,
+                          &p->sweeper)
+        != ABT_SUCCESS)
+        goto error;
+
+    p->next      = shared_pools;
+    shared_pools = p;
+    pthread_mutex_unlock(&shared_mutex);
+    *pool = p;
+    return BAKE_SUCCESS;
+
+error:
+    pthread_mutex_unlock(&shared_mutex);
+    if (p->stop) ABT_cond_free(&p->stop);
+    if (p->released) ABT_cond_free(&p->released);
+    if (p->mutex) ABT_mutex_free(&p->mutex);
+    free(p);
+    return BAKE_ERR_ARGOBOTS;
+}
+
+void bake_buffer_pool_destroy(bake_buffer_pool_t pool)
+{
+    bake_buffer_pool_t* link;
+    bake_buffer_t*      buffer;
+    unsigned            c, n;
+
+    pthread_mutex_lock(&shared_mutex);
+    if (--pool->refcount > 0) {
+        pthread_mutex_unlock(&shared_mutex);
+        return;
+    }
+    for (link = &shared_pools; *link != pool; link = &(*link)->next)
+        ;
+    *link = pool->next;
+    pthread_mutex_unlock(&shared_mutex);
+
+    ABT_mutex_lock(pool->mutex);
+    pool->stopping = 1;
+    ABT_cond_signal(pool->stop);
+    ABT_mutex_unlock(pool->mutex);
+    ABT_thread_join(pool->sweeper);
+    ABT_thread_free(&pool->sweeper);
+
+    for (c = 0; c < pool->num_classes; c++) {
+        for (n = 0; n < BAKE_BUFFER_MAX_NODES; n++) {
+            while ((buffer = pool->classes[c].free[n]) != NULL) {
+                pool->classes[c].free[n] = buffer->next;
+                free_buffer(pool, buffer);
+            }
+        }
+    }
+    ABT_cond_free(&pool->stop);
+    ABT_cond_free(&pool->released);
+    ABT_mutex_free(&pool->mutex);
+    free(pool);
+}
+
+size_t bake_buffer_pool_chunk_size(bake_buffer_pool_t pool,
+                                   size_t             transfer_size)
+{
+    unsigned c = class_of(pool, transfer_size);
+    unsigned i;
+
+    ABT_mutex_lock(pool->mutex);
+    pool->classes[c].transfers++;
+    if (++pool->transfers >= BAKE_BUFFER_HISTORY) {
+        pool->transfers = 0;
+        for (i = 0; i < pool->num_classes; i++) {
+            pool->classes[i].transfers /= 2;
+            pool->transfers += pool->classes[i].transfers;
+        }
+    }
+    ABT_mutex_unlock(pool->mutex);
+
+    return pool->classes[c].size;
+}
+
+int bake_buffer_get(bake_buffer_pool_t pool,
+                    size_t             size,
+                    bake_buffer_t**    buffer)
+{
+    bake_buffer_class_t* cls  = &pool->classes[class_of(pool, size)];
+    unsigned             node = current_node(pool);
+    bake_buffer_t*       b;
+    hg_return_t          hret;
+
+    if (size > cls->size) return BAKE_ERR_INVALID_ARG;
+
+    ABT_mutex_lock(pool->mutex);
+    while (!cls->free[node]) {
+        /* a buffer larger than the limit is let through when it would be
+         * the only one
+         */
+        if (pool->memory == 0
+            || pool->memory + cls->size <= pool->config.max_memory)
+            break;
+        if (reclaim(pool, cls->size)) continue;
+        pool->num_waiters++;
+        ABT_cond_wait(pool->released, pool->mutex);
+        pool->num_waiters--;
+    }
+    if (cls->free[node]) {
+        *buffer         = cls->free[node];
+        cls->free[node] = (*buffer)->next;
+        ABT_mutex_unlock(pool->mutex);
+        return BAKE_SUCCESS;
+    }
+    /* grow the pool, outside of the lock */
+    pool->memory += cls->size;
+    ABT_mutex_unlock(pool->mutex);
+
+    b = calloc(1, sizeof(*b));
+    if (!b) goto error;
+    b->size       = cls->size;
+    b->size_class = cls - pool->classes;
+    b->node       = node;
+    if (map_buffer(pool, b) != 0) goto error;
+    hret = margo_bulk_create(pool->mid, 1, &b->ptr, &b->size,
+                             HG_BULK_READWRITE, &b->bulk);
+    if (hret != HG_SUCCESS) goto error;
+
+    *buffer = b;
+    return BAKE_SUCCESS;
+
+error:
+    if (b && b->ptr) munmap(b->ptr, b->size);
+    free(b);
+    ABT_mutex_lock(pool->mutex);
+    pool->memory -= cls->size;
+    if (pool->num_waiters) ABT_cond_broadcast(pool->released);
+    ABT_mutex_unlock(pool->mutex);
+    return BAKE_ERR_ALLOCATION;
+}
+
+void bake_buffer_release(bake_buffer_pool_t pool, bake_buffer_t* buffer)
+{
+    bake_buffer_class_t* cls = &pool->classes[buffer->size_class];
+
+    ABT_mutex_lock(pool->mutex);
+    buffer->released        = ABT_get_wtime();
+    buffer->next            = cls->free[buffer->node];
+    cls->free[buffer->node] = buffer;
+    /* waiters for other classes may reclaim it */
+    if (pool->num_waiters) ABT_cond_broadcast(pool->released);
+    ABT_mutex_unlock(pool->mutex);
+}
+
+size_t bake_buffer_pool_memory(bake_buffer_pool_t pool)
+{
+    size_t memory;
+
+    ABT_mutex_lock(pool->mutex);
+    memory = pool->memory;
+    ABT_mutex_unlock(pool->mutex);
+    return memory;
+}
@@ -0,0 +1,78 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __BAKE_BUFFER_POOL_H
+#define __BAKE_BUFFER_POOL_H
+
+#include <margo.h>
+
+/* A pool of registered intermediate buffers for pipelined transfers.
+ * Unlike a margo_bulk_poolset, it starts empty and allocates buffers on
+ * demand, in size classes growing geometrically from min_size to
+ * max_size, as long as they fit within max_memory.  Buffers that stay
+ * unused for idle_sec are freed again, except for a few in the classes
+ * that recent transfers use the most.  Providers of a process that use
+ * the same margo instance and configuration share a single pool.
+ *
+ * With numa, the buffers are kept per NUMA node, and a transfer gets one
+ * on the node of the execution stream that asks for it.  With hugepages,
+ * they are backed by 2 MiB pages when their size allows it, which cuts
+ * the cost of registering them and of TLB misses.
+ */
+typedef struct bake_buffer_pool* bake_buffer_pool_t;
+
+typedef struct bake_buffer {
+    hg_bulk_t           bulk; /* registered for HG_BULK_READWRITE */
+    void*               ptr;  /* page-aligned */
+    size_t              size;
+    unsigned            size_class;
+    unsigned            node;
+    double              released; /* when last put back in the pool */
+    struct bake_buffer* next;
+} bake_buffer_t;
+
+typedef struct bake_buffer_pool_config {
+    size_t   min_size;
+    size_t   max_size;
+    unsigned multiplier;
+    size_t   max_memory;
+    unsigned num_kept;  /* per frequently used class, when idle */
+    double   idle_sec;
+    int      numa;
+    int      hugepages;
+} bake_buffer_pool_config_t;
+
+/* creates a pool, or takes a reference to the one already created for
+ * the same margo instance and configuration
+ */
+int bake_buffer_pool_create(margo_instance_id                mid,
+                            const bake_buffer_pool_config_t* config,
+                            bake_buffer_pool_t*              pool);
+
+/* drops a reference to the pool, destroying it with the last one; all
+ * the buffers must have been released by then
+ */
+void bake_buffer_pool_destroy(bake_buffer_pool_t pool);
+
+/* size in which to cut a transfer of the given size, i.e. of the smallest
+ * buffers that hold it, or of the largest buffers; also records the size
+ * in the histogram that decides which buffers to keep
+ */
+size_t bake_buffer_pool_chunk_size(bake_buffer_pool_t pool,
+                                   size_t             transfer_size);
+
+/* gets a buffer of at least the given size, waiting for one to be
+ * released if the pool is at its memory limit
+ */
+int bake_buffer_get(bake_buffer_pool_t pool,
+                    size_t             size,
+                    bake_buffer_t**    buffer);
+
+void bake_buffer_release(bake_buffer_pool_t pool, bake_buffer_t* buffer);
+
+/* memory currently allocated for buffers, in use or not */
+size_t bake_buffer_pool_memory(bake_buffer_pool_t pool);
+
+#endif
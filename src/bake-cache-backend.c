@@ -0,0 +1,809 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <json-c/json.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+#include "uthash.h"
+
+/* bake-cache-backend
+ *
+ * This is a stacking back end for the Bake provider that keeps a DRAM
+ * cache of hot regions in front of another back end, named by the rest of
+ * the target name (e.g., "cache:file:/tmp/foo.dat").  Whole regions (up to
+ * max_item_size bytes) are copied into memory on the first read and
+ * registered with Mercury once, so that later bulk reads of them are served
+ * with a single RDMA push and eager reads with a memcpy.
+ *
+ * The cache is split into shards, each with its own lock, hash table, and
+ * LRU list, and each bounded to an equal part of the capacity.  Writes,
+ * removes, and migrations that remove the source invalidate the region.
+ * Every invalidation also bumps an epoch counter in the shard; a fill that
+ * started before an invalidation in the same shard is not inserted, so
+ * data read from the inner back end before a write completed can never be
+ * cached after it.  Items are reference counted so that an item evicted or
+ * invalidated while a transfer is using it is only freed afterwards.
+ * Regions that cannot be cached (empty, or larger than max_item_size) get
+ * an item without data, so that later reads of them go straight to the
+ * inner back end; such items take part in the LRU like the others.
+ */
+
+typedef struct cache_item {
+    char               key[BAKE_REGION_ID_DATA_SIZE];
+    char*              data;     /* NULL if the region cannot be cached */
+    size_t             size;
+    size_t             charge;   /* bytes counted against the capacity */
+    hg_bulk_t          bulk;     /* registered once, when the item is filled */
+    int                refcount; /* protected by the shard mutex */
+    struct cache_item* prev;     /* LRU list, most recently used first */
+    struct cache_item* next;
+    UT_hash_handle     hh;
+} cache_item_t;
+
+typedef struct {
+    ABT_mutex     mutex;
+    cache_item_t* table;
+    cache_item_t* lru_head;
+    cache_item_t* lru_tail;
+    size_t        bytes;
+    uint64_t      epoch; /* bumped by every invalidation */
+    uint64_t      hits;
+    uint64_t      misses;
+    uint64_t      bypasses; /* reads of regions that cannot be cached */
+    uint64_t      fills;
+    uint64_t      evictions;
+    uint64_t      invalidations;
+} cache_shard_t;
+
+typedef struct {
+    bake_provider_t   provider;
+    bake_backend_t    inner;         /* wrapped back end */
+    backend_context_t inner_context; /* context of the wrapped target */
+    free_fn           inner_free;    /* free function of inner read_raw */
+    cache_shard_t*    shards;
+    unsigned          num_shards;
+    size_t            shard_capacity; /* bytes */
+    size_t            max_item_size;  /* larger regions are not cached */
+} bake_cache_entry_t;
+
+static cache_shard_t* cache_shard_of(bake_cache_entry_t* entry,
+                                     bake_region_id_t    rid)
+{
+    /* FNV-1a over the region id */
+    uint64_t h = 14695981039346656037ULL;
+    int      i;
+
+    for (i = 0; i < BAKE_REGION_ID_DATA_SIZE; i++) {
+        h ^= (unsigned char)rid.data[i];
+        h *= 1099511628211ULL;
+    }
+    return &entry->shards[h % entry->num_shards];
+}
+
+static void cache_item_free(cache_item_t* item)
+{
+    if (item->bulk != HG_BULK_NULL) margo_bulk_free(item->bulk);
+    free(item->data);
+    free(item);
+}
+
+/* the following helpers must be called with the shard mutex held */
+static void cache_lru_unlink(cache_shard_t* shard, cache_item_t* item)
+{
+    if (item->prev)
+        item->prev->next = item->next;
+    else
+        shard->lru_head = item->next;
+    if (item->next)
+        item->next->prev = item->prev;
+    else
+        shard->lru_tail = item->prev;
+    item->prev = item->next = NULL;
+}
+
+static void cache_lru_push_front(cache_shard_t* shard, cache_item_t* item)
+{
+    item->prev = NULL;
+    item->next = shard->lru_head;
+    if (shard->lru_head)
+        shard->lru_head->prev = item;
+    else
+        shard->lru_tail = item;
+    shard->lru_head = item;
+}
+
+/* takes an item out of the shard; returns nonzero if the caller must free
+ * it (i.e., nobody else holds a reference)
+ */
+static int cache_detach(cache_shard_t* shard, cache_item_t* item)
+{
+    HASH_DEL(shard->table, item);
+    cache_lru_unlink(shard, item);
+    shard->bytes -= item->charge;
+    return --item->refcount == 0;
+}
+
+static void cache_item_put(cache_shard_t* shard, cache_item_t* item)
+{
+    int last;
+
+    ABT_mutex_lock(shard->mutex);
+    last = --item->refcount == 0;
+    ABT_mutex_unlock(shard->mutex);
+    if (last) cache_item_free(item);
+}
+
+static void cache_invalidate(bake_cache_entry_t* entry, bake_region_id_t rid)
+{
+    cache_shard_t* shard = cache_shard_of(entry, rid);
+    cache_item_t*  item  = NULL;
+    int            last  = 0;
+
+    ABT_mutex_lock(shard->mutex);
+    shard->epoch++;
+    HASH_FIND(hh, shard->table, rid.data, BAKE_REGION_ID_DATA_SIZE, item);
+    if (item) {
+        shard->invalidations++;
+        last = cache_detach(shard, item);
+    }
+    ABT_mutex_unlock(shard->mutex);
+    if (last) cache_item_free(item);
+}
+
+/* drops every item, for removals whose regions are not known one by one */
+static void cache_invalidate_all(bake_cache_entry_t* entry)
+{
+    cache_shard_t* shard;
+    cache_item_t * item, *tmp, *freed;
+    unsigned       i;
+
+    for (i = 0; i < entry->num_shards; i++) {
+        shard = &entry->shards[i];
+        freed = NULL;
+        ABT_mutex_lock(shard->mutex);
+        shard->epoch++;
+        HASH_ITER(hh, shard->table, item, tmp)
+        {
+            shard->invalidations++;
+            if (cache_detach(shard, item)) {
+                /* the LRU links are free once detached */
+                item->next = freed;
+                freed      = item;
+            }
+        }
+        ABT_mutex_unlock(shard->mutex);
+        while (freed) {
+            item  = freed;
+            freed = item->next;
+            cache_item_free(item);
+        }
+    }
+}
+
+/* copies a whole region from the inner back end into a new item, or
+ * makes an item without data if the region cannot be cached
+ */
+static cache_item_t* cache_fill(bake_cache_entry_t* entry, bake_region_id_t rid)
+{
+    cache_item_t* item;
+    size_t        region_size;
+    void*         data       = NULL;
+    uint64_t      data_size  = 0;
+    free_fn       inner_free = NULL;
+    hg_return_t   hret;
+    int           ret;
+
+    ret = entry->inner->_get_region_size(entry->inner_context, rid,
+                                         &region_size);
+    if (ret != BAKE_SUCCESS) return NULL;
+    if (region_size == 0 || region_size > entry->max_item_size) {
+        item = calloc(1, sizeof(*item));
+        if (!item) return NULL;
+        memcpy(item->key, rid.data, BAKE_REGION_ID_DATA_SIZE);
+        item->size   = region_size;
+        item->charge = sizeof(*item);
+        return item;
+    }
+
+    ret = entry->inner->_read_raw(entry->inner_context, rid, 0, region_size,
+                                  &data, &data_size, &inner_free);
+    if (ret != BAKE_SUCCESS) return NULL;
+
+    item = calloc(1, sizeof(*item));
+    if (item) item->data = malloc(region_size);
+    if (!item || !item->data || data_size != region_size) {
+        if (inner_free) inner_free(entry->inner_context, data);
+        if (item) free(item->data);
+        free(item);
+        return NULL;
+    }
+    memcpy(item->key, rid.data, BAKE_REGION_ID_DATA_SIZE);
+    memcpy(item->data, data, region_size);
+    item->size   = region_size;
+    item->charge = region_size;
+    if (inner_free) inner_free(entry->inner_context, data);
+
+    hret = margo_bulk_create(entry->provider->mid, 1, (void**)&item->data,
+                             &item->size, HG_BULK_READ_ONLY, &item->bulk);
+    if (hret != HG_SUCCESS) {
+        item->bulk = HG_BULK_NULL;
+        cache_item_free(item);
+        return NULL;
+    }
+
+    return item;
+}
+
+/* returns a referenced item holding the whole region, filling the cache on
+ * a miss, or NULL if the region cannot be cached (or filling it failed)
+ */
+static cache_item_t* cache_get(bake_cache_entry_t* entry, bake_region_id_t rid)
+{
+    cache_shard_t* shard = cache_shard_of(entry, rid);
+    cache_item_t*  item  = NULL;
+    cache_item_t*  victim;
+    cache_item_t*  existing = NULL;
+    uint64_t       epoch;
+
+    ABT_mutex_lock(shard->mutex);
+    HASH_FIND(hh, shard->table, rid.data, BAKE_REGION_ID_DATA_SIZE, item);
+    if (item) {
+        cache_lru_unlink(shard, item);
+        cache_lru_push_front(shard, item);
+        if (!item->data) {
+            shard->bypasses++;
+            ABT_mutex_unlock(shard->mutex);
+            return NULL;
+        }
+        shard->hits++;
+        item->refcount++;
+        ABT_mutex_unlock(shard->mutex);
+        return item;
+    }
+    epoch = shard->epoch;
+    ABT_mutex_unlock(shard->mutex);
+
+    item = cache_fill(entry, rid);
+    if (!item) return NULL;
+    item->refcount = 1; /* caller's reference */
+
+    ABT_mutex_lock(shard->mutex);
+    if (item->data)
+        shard->misses++;
+    else
+        shard->bypasses++;
+    if (shard->epoch != epoch || item->charge > entry->shard_capacity) {
+        /* the region may have changed while we read it; hand the item to
+         * the caller for this access only
+         */
+        ABT_mutex_unlock(shard->mutex);
+        if (item->data) return item;
+        cache_item_free(item);
+        return NULL;
+    }
+    HASH_FIND(hh, shard->table, rid.data, BAKE_REGION_ID_DATA_SIZE, existing);
+    if (existing) {
+        /* another ULT filled the same region concurrently */
+        if (existing->data) existing->refcount++;
+        ABT_mutex_unlock(shard->mutex);
+        cache_item_free(item);
+        return existing->data ? existing : NULL;
+    }
+    while (shard->bytes + item->charge > entry->shard_capacity) {
+        victim = shard->lru_tail;
+        shard->evictions++;
+        if (cache_detach(shard, victim)) cache_item_free(victim);
+    }
+    item->refcount++; /* the cache's reference */
+    HASH_ADD(hh, shard->table, key, BAKE_REGION_ID_DATA_SIZE, item);
+    cache_lru_push_front(shard, item);
+    shard->bytes += item->charge;
+    if (item->data) shard->fills++;
+    ABT_mutex_unlock(shard->mutex);
+
+    if (item->data) return item;
+    cache_item_put(shard, item);
+    return NULL;
+}
+
+static int bake_cache_makepool(const char* name, size_t size)
+{
+    bake_backend_t inner;
+    const char*    inner_path;
+
+    inner = bake_backend_parse_target(name, &inner_path);
+    if (!inner) return BAKE_ERR_BACKEND_TYPE;
+
+    return inner->_create_raw_target(inner_path, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_cache_backend_initialize(bake_provider_t    provider,
+                                         const char*        path,
+                                         bake_target_id_t*  target,
+                                         backend_context_t* context)
+{
+    bake_cache_entry_t* new_entry;
+    bake_backend_t      inner;
+    backend_context_t   inner_context = NULL;
+    const char*         inner_path;
+    struct json_object* cache_backend_json = NULL;
+    struct json_object* target_array       = NULL;
+    struct json_object* val;
+    int64_t             capacity, max_item_size, num_shards;
+    unsigned            i;
+    int                 ret;
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "cache_backend",
+                                "cache_backend", cache_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(cache_backend_json, "targets",
+                               "cache_backend.targets", target_array);
+    /* total bytes of region data kept in memory, per target */
+    CONFIG_HAS_OR_CREATE(cache_backend_json, int64, "capacity", 268435456,
+                         "cache_backend.capacity", val);
+    capacity = json_object_get_int64(val);
+    CONFIG_HAS_OR_CREATE(cache_backend_json, int64, "shards", 16,
+                         "cache_backend.shards", val);
+    num_shards = json_object_get_int64(val);
+    CONFIG_HAS_OR_CREATE(cache_backend_json, int64, "max_item_size", 1048576,
+                         "cache_backend.max_item_size", val);
+    max_item_size = json_object_get_int64(val);
+    if (capacity <= 0 || num_shards <= 0 || max_item_size <= 0) {
+        BAKE_ERROR(provider->mid,
+                   "cache_backend capacity, shards, and max_item_size must be "
+                   "positive");
+        return BAKE_ERR_INVALID_ARG;
+    }
+
+    inner = bake_backend_parse_target(path, &inner_path);
+    if (!inner) return BAKE_ERR_BACKEND_TYPE;
+    if (strcmp(inner->name, "cache") == 0) {
+        BAKE_ERROR(provider->mid, "cache backend cannot wrap itself");
+        return BAKE_ERR_BACKEND_TYPE;
+    }
+
+    ret = inner->_initialize(provider, inner_path, target, &inner_context);
+    if (ret != BAKE_SUCCESS) return ret;
+    /* the target is recorded under this back end only */
+    bake_backend_unlist_target(provider, inner, inner_path);
+
+    new_entry                 = calloc(1, sizeof(*new_entry));
+    new_entry->provider       = provider;
+    new_entry->inner          = inner;
+    new_entry->inner_context  = inner_context;
+    new_entry->num_shards     = num_shards;
+    new_entry->shard_capacity = capacity / num_shards;
+    new_entry->max_item_size  = max_item_size;
+    new_entry->shards = calloc(num_shards, sizeof(*new_entry->shards));
+    for (i = 0; i < new_entry->num_shards; i++)
+        ABT_mutex_create(&new_entry->shards[i].mutex);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_cache_backend_finalize(backend_context_t context)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    cache_item_t *      item, *tmp;
+    unsigned            i;
+    int                 ret;
+
+    for (i = 0; i < entry->num_shards; i++) {
+        HASH_ITER(hh, entry->shards[i].table, item, tmp)
+        {
+            HASH_DEL(entry->shards[i].table, item);
+            cache_item_free(item);
+        }
+        ABT_mutex_free(&entry->shards[i].mutex);
+    }
+    free(entry->shards);
+
+    ret = entry->inner->_finalize(entry->inner_context);
+    free(entry);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_cache_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return entry->inner->_create(entry->inner_context, size, rid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_cache_write_raw(backend_context_t context,
+                                bake_region_id_t  rid,
+                                size_t            offset,
+                                size_t            size,
+                                const void*       data)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    int                 ret;
+
+    ret = entry->inner->_write_raw(entry->inner_context, rid, offset, size,
+                                   data);
+    cache_invalidate(entry, rid);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_cache_write_bulk(backend_context_t context,
+                                 bake_region_id_t  rid,
+                                 size_t            region_offset,
+                                 size_t            size,
+                                 hg_bulk_t         bulk,
+                                 hg_addr_t         source,
+                                 size_t            bulk_offset)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    int                 ret;
+
+    ret = entry->inner->_write_bulk(entry->inner_context, rid, region_offset,
+                                    size, bulk, source, bulk_offset);
+    cache_invalidate(entry, rid);
+    return ret;
+}
+
+static void bake_cache_read_raw_free(backend_context_t context, void* ptr)
+{
+    free(ptr);
+}
+
+static void bake_cache_inner_read_raw_free(backend_context_t context, void* ptr)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    entry->inner_free(entry->inner_context, ptr);
+}
+
+static int bake_cache_read_raw(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            offset,
+                               size_t            size,
+                               void**            data,
+                               uint64_t*         data_size,
+                               free_fn*          free_data)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    cache_item_t*       item;
+    free_fn             inner_free = NULL;
+    void*               buffer;
+    int                 ret;
+
+    *free_data = NULL;
+
+    item = cache_get(entry, rid);
+    if (item && offset <= item->size) {
+        /* like the inner back ends, a read past the end of the region is
+         * cut short
+         */
+        if (size > item->size - offset) size = item->size - offset;
+        /* eager reads are small; copy out rather than pin the item until
+         * the response has been sent
+         */
+        buffer = malloc(size ? size : 1);
+        if (buffer) {
+            memcpy(buffer, item->data + offset, size);
+            cache_item_put(cache_shard_of(entry, rid), item);
+            *data      = buffer;
+            *data_size = size;
+            *free_data = bake_cache_read_raw_free;
+            return BAKE_SUCCESS;
+        }
+    }
+    if (item) cache_item_put(cache_shard_of(entry, rid), item);
+
+    /* not cacheable, or outside of the region; let the inner back end
+     * handle it
+     */
+    ret = entry->inner->_read_raw(entry->inner_context, rid, offset, size,
+                                  data, data_size, &inner_free);
+    if (inner_free) {
+        /* the free function of a back end is the same for every call */
+        entry->inner_free = inner_free;
+        *free_data        = bake_cache_inner_read_raw_free;
+    }
+    return ret;
+}
+
+static int bake_cache_read_bulk(backend_context_t context,
+                                bake_region_id_t  rid,
+                                size_t            region_offset,
+                                size_t            size,
+                                hg_bulk_t         bulk,
+                                hg_addr_t         source,
+                                size_t            bulk_offset,
+                                size_t*           bytes_read)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    cache_item_t*       item;
+    hg_return_t         hret;
+
+    *bytes_read = 0;
+
+    item = cache_get(entry, rid);
+    if (item && region_offset <= item->size) {
+        /* a read past the end of the region is cut short */
+        if (size > item->size - region_offset)
+            size = item->size - region_offset;
+        hret = size ? margo_bulk_transfer(entry->provider->mid, HG_BULK_PUSH,
+                                          source, bulk, bulk_offset,
+                                          item->bulk, region_offset, size)
+                    : HG_SUCCESS;
+        cache_item_put(cache_shard_of(entry, rid), item);
+        if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+        *bytes_read = size;
+        return BAKE_SUCCESS;
+    }
+    if (item) cache_item_put(cache_shard_of(entry, rid), item);
+
+    return entry->inner->_read_bulk(entry->inner_context, rid, region_offset,
+                                    size, bulk, source, bulk_offset,
+                                    bytes_read);
+}
+
+static int bake_cache_persist(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return entry->inner->_persist(entry->inner_context, rid, offset, size);
+}
+
+static int bake_cache_create_write_persist_raw(backend_context_t context,
+                                               const void*       data,
+                                               size_t            size,
+                                               bake_region_id_t* rid)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    bake_backend_t      inner = entry->inner;
+    int                 ret;
+
+    /* new regions are not in the cache; they are cached on first read */
+    if (inner->_create_write_persist_raw)
+        return inner->_create_write_persist_raw(entry->inner_context, data,
+                                                size, rid);
+
+    ret = inner->_create(entry->inner_context, size, rid);
+    if (ret == BAKE_SUCCESS)
+        ret = inner->_write_raw(entry->inner_context, *rid, 0, size, data);
+    if (ret == BAKE_SUCCESS)
+        ret = inner->_persist(entry->inner_context, *rid, 0, size);
+    return ret;
+}
+
+static int bake_cache_create_write_persist_bulk(backend_context_t context,
+                                                hg_bulk_t         bulk,
+                                                hg_addr_t         source,
+                                                size_t            bulk_offset,
+                                                size_t            size,
+                                                bake_region_id_t* rid)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    bake_backend_t      inner = entry->inner;
+    int                 ret;
+
+    if (inner->_create_write_persist_bulk)
+        return inner->_create_write_persist_bulk(
+            entry->inner_context, bulk, source, bulk_offset, size, rid);
+
+    ret = inner->_create(entry->inner_context, size, rid);
+    if (ret == BAKE_SUCCESS)
+        ret = inner->_write_bulk(entry->inner_context, *rid, 0, size, bulk,
+                                 source, bulk_offset);
+    if (ret == BAKE_SUCCESS)
+        ret = inner->_persist(entry->inner_context, *rid, 0, size);
+    return ret;
+}
+
+static int bake_cache_get_region_size(backend_context_t context,
+                                      bake_region_id_t  rid,
+                                      size_t*           size)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return entry->inner->_get_region_size(entry->inner_context, rid, size);
+}
+
+static int bake_cache_get_region_data(backend_context_t context,
+                                      bake_region_id_t  rid,
+                                      void**            data)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return entry->inner->_get_region_data(entry->inner_context, rid, data);
+}
+
+static int bake_cache_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    int                 ret;
+
+    ret = entry->inner->_remove(entry->inner_context, rid);
+    cache_invalidate(entry, rid);
+    return ret;
+}
+
+static int bake_cache_create_multi(backend_context_t context,
+                                   size_t            count,
+                                   const uint64_t*   sizes,
+                                   bake_region_id_t* rids)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return bake_backend_create_multi(entry->inner, entry->inner_context, 0,
+                                     count, sizes, rids);
+}
+
+static int bake_cache_remove_multi(backend_context_t       context,
+                                   size_t                  count,
+                                   const bake_region_id_t* rids,
+                                   size_t*                 bytes_removed)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    size_t              i;
+    int                 ret;
+
+    ret = bake_backend_remove_multi(entry->inner, entry->inner_context, count,
+                                    rids, bytes_removed);
+    for (i = 0; i < count; i++) cache_invalidate(entry, rids[i]);
+    return ret;
+}
+
+static int bake_cache_create_group(backend_context_t context,
+                                   uint64_t          group,
+                                   size_t            count,
+                                   const uint64_t*   sizes,
+                                   bake_region_id_t* rids)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+
+    if (!entry->inner->_create_group) return BAKE_ERR_OP_UNSUPPORTED;
+    return entry->inner->_create_group(entry->inner_context, group, count,
+                                       sizes, rids);
+}
+
+/* the regions of the group are not known here, and their ids may be
+ * reused by later creates, so the whole cache goes
+ */
+static int bake_cache_remove_group(backend_context_t context,
+                                   uint64_t          group,
+                                   size_t*           bytes_removed)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    int                 ret;
+
+    *bytes_removed = 0;
+    if (!entry->inner->_remove_group) return BAKE_ERR_OP_UNSUPPORTED;
+    ret = entry->inner->_remove_group(entry->inner_context, group,
+                                      bytes_removed);
+    cache_invalidate_all(entry);
+    return ret;
+}
+
+static int bake_cache_migrate_region(backend_context_t context,
+                                     bake_region_id_t  source_rid,
+                                     size_t            region_size,
+                                     int               remove_source,
+                                     const char*       dest_addr_str,
+                                     uint16_t          dest_provider_id,
+                                     bake_target_id_t  dest_target_id,
+                                     bake_region_id_t* dest_rid)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    int                 ret;
+
+    ret = entry->inner->_migrate_region(
+        entry->inner_context, source_rid, region_size, remove_source,
+        dest_addr_str, dest_provider_id, dest_target_id, dest_rid);
+    if (remove_source) cache_invalidate(entry, source_rid);
+    return ret;
+}
+
+static int bake_cache_get_stats(backend_context_t   context,
+                                struct json_object* stats)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    struct json_object* cache_stats;
+    uint64_t            hits = 0, misses = 0, fills = 0, evictions = 0;
+    uint64_t            bypasses = 0;
+    uint64_t            invalidations = 0, bytes = 0, items = 0;
+    unsigned            i;
+
+    for (i = 0; i < entry->num_shards; i++) {
+        cache_shard_t* shard = &entry->shards[i];
+        ABT_mutex_lock(shard->mutex);
+        hits += shard->hits;
+        misses += shard->misses;
+        bypasses += shard->bypasses;
+        fills += shard->fills;
+        evictions += shard->evictions;
+        invalidations += shard->invalidations;
+        bytes += shard->bytes;
+        items += HASH_COUNT(shard->table);
+        ABT_mutex_unlock(shard->mutex);
+    }
+
+    if (entry->inner->_get_stats)
+        entry->inner->_get_stats(entry->inner_context, stats);
+
+    cache_stats = json_object_new_object();
+    json_object_object_add(cache_stats, "hits", json_object_new_int64(hits));
+    json_object_object_add(cache_stats, "misses",
+                           json_object_new_int64(misses));
+    json_object_object_add(
+        cache_stats, "hit_rate",
+        json_object_new_double(hits + misses ? (double)hits / (hits + misses)
+                                             : 0.0));
+    json_object_object_add(cache_stats, "bypasses",
+                           json_object_new_int64(bypasses));
+    json_object_object_add(cache_stats, "fills", json_object_new_int64(fills));
+    json_object_object_add(cache_stats, "evictions",
+                           json_object_new_int64(evictions));
+    json_object_object_add(cache_stats, "invalidations",
+                           json_object_new_int64(invalidations));
+    json_object_object_add(cache_stats, "items", json_object_new_int64(items));
+    json_object_object_add(cache_stats, "bytes", json_object_new_int64(bytes));
+    json_object_object_add(stats, "cache", cache_stats);
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_cache_reconfigure(backend_context_t context)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    if (!entry->inner->_reconfigure) return BAKE_SUCCESS;
+    return entry->inner->_reconfigure(entry->inner_context);
+}
+
+#ifdef USE_REMI
+static int bake_cache_create_fileset(backend_context_t context,
+                                     remi_fileset_t*   fileset)
+{
+    bake_cache_entry_t* entry = (bake_cache_entry_t*)context;
+    return entry->inner->_create_fileset(entry->inner_context, fileset);
+}
+#endif
+
+bake_backend g_bake_cache_backend = {
+    .name                       = "cache",
+    ._initialize                = bake_cache_backend_initialize,
+    ._finalize                  = bake_cache_backend_finalize,
+    ._create                    = bake_cache_create,
+    ._write_raw                 = bake_cache_write_raw,
+    ._write_bulk                = bake_cache_write_bulk,
+    ._read_raw                  = bake_cache_read_raw,
+    ._read_bulk                 = bake_cache_read_bulk,
+    ._persist                   = bake_cache_persist,
+    ._create_write_persist_raw  = bake_cache_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_cache_create_write_persist_bulk,
+    ._get_region_size           = bake_cache_get_region_size,
+    ._get_region_data           = bake_cache_get_region_data,
+    ._remove                    = bake_cache_remove,
+    ._migrate_region            = bake_cache_migrate_region,
+    ._create_raw_target         = bake_cache_makepool,
+    ._get_stats                 = bake_cache_get_stats,
+    ._reconfigure               = bake_cache_reconfigure,
+    ._create_multi              = bake_cache_create_multi,
+    ._remove_multi              = bake_cache_remove_multi,
+    ._create_group              = bake_cache_create_group,
+    ._remove_group              = bake_cache_remove_group,
+#ifdef USE_REMI
+    ._create_fileset = bake_cache_create_fileset,
+#endif
+};
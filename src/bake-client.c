@@ -7,13 +7,26 @@
 #include "bake-config.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <time.h>
 #include <margo.h>
 #include <bake-client.h>
 #include "uthash.h"
 #include "bake-rpc.h"
 #include "bake-timing.h"
 
-#define BAKE_DEFAULT_EAGER_LIMIT 2048
+#define BAKE_DEFAULT_EAGER_LIMIT    2048
+#define BAKE_DEFAULT_MULTI_MSG_SIZE 4096
+#define BAKE_DEFAULT_BUSY_RETRIES   8
+#define BAKE_MAX_BUSY_BACKOFF_MS    1000
+
+/* encoded sizes of the parts of the packed multi messages: the fields
+ * common to a message (target id, counts, deadline, return code), and the
+ * size and region id of each item
+ */
+#define BAKE_MULTI_MSG_HEADER 64
+#define BAKE_MULTI_SIZE_BYTES sizeof(uint64_t)
+#define BAKE_MULTI_RID_BYTES  (sizeof(uint32_t) + BAKE_REGION_ID_DATA_SIZE)
 
 /* Refers to a single Margo initialization, for now this is shared by
  * all remote BAKE targets.  In the future we probably need to support
@@ -26,15 +39,24 @@ struct bake_client {
     hg_id_t bake_create_id;
     hg_id_t bake_eager_write_id;
     hg_id_t bake_eager_read_id;
+    hg_id_t bake_eager_read_multi_id;
+    hg_id_t bake_writev_id;
+    hg_id_t bake_readv_id;
+    hg_id_t bake_compound_id;
     hg_id_t bake_write_id;
     hg_id_t bake_persist_id;
     hg_id_t bake_create_write_persist_id;
     hg_id_t bake_eager_create_write_persist_id;
+    hg_id_t bake_eager_create_write_persist_multi_id;
     hg_id_t bake_get_size_id;
     hg_id_t bake_get_data_id;
     hg_id_t bake_read_id;
     hg_id_t bake_noop_id;
     hg_id_t bake_remove_id;
+    hg_id_t bake_create_multi_id;
+    hg_id_t bake_remove_multi_id;
+    hg_id_t bake_remove_group_id;
+    hg_id_t bake_set_param_id;
     hg_id_t bake_migrate_region_id;
     hg_id_t bake_migrate_target_id;
 
@@ -47,6 +69,9 @@ struct bake_provider_handle {
     uint16_t            provider_id;
     uint64_t            refcount;
     uint64_t            eager_limit;
+    uint64_t            multi_msg_size; /* of packed multi messages */
+    uint32_t            busy_retries; /* after BAKE_ERR_BUSY responses */
+    unsigned            backoff_seed;
 };
 
 static int bake_client_register(bake_client_t client, margo_instance_id mid)
@@ -70,6 +95,14 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
                               &client->bake_eager_write_id, &flag);
         margo_registered_name(mid, "bake_eager_read_rpc",
                               &client->bake_eager_read_id, &flag);
+        margo_registered_name(mid, "bake_eager_read_multi_rpc",
+                              &client->bake_eager_read_multi_id, &flag);
+        margo_registered_name(mid, "bake_writev_rpc", &client->bake_writev_id,
+                              &flag);
+        margo_registered_name(mid, "bake_readv_rpc", &client->bake_readv_id,
+                              &flag);
+        margo_registered_name(mid, "bake_compound_rpc",
+                              &client->bake_compound_id, &flag);
         margo_registered_name(mid, "bake_persist_rpc", &client->bake_persist_id,
                               &flag);
         margo_registered_name(mid, "bake_create_write_persist_rpc",
@@ -77,6 +110,9 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
         margo_registered_name(mid, "bake_eager_create_write_persist_rpc",
                               &client->bake_eager_create_write_persist_id,
                               &flag);
+        margo_registered_name(
+            mid, "bake_eager_create_write_persist_multi_rpc",
+            &client->bake_eager_create_write_persist_multi_id, &flag);
         margo_registered_name(mid, "bake_get_size_rpc",
                               &client->bake_get_size_id, &flag);
         margo_registered_name(mid, "bake_get_data_rpc",
@@ -87,6 +123,14 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
                               &flag);
         margo_registered_name(mid, "bake_remove_rpc", &client->bake_remove_id,
                               &flag);
+        margo_registered_name(mid, "bake_create_multi_rpc",
+                              &client->bake_create_multi_id, &flag);
+        margo_registered_name(mid, "bake_remove_multi_rpc",
+                              &client->bake_remove_multi_id, &flag);
+        margo_registered_name(mid, "bake_remove_group_rpc",
+                              &client->bake_remove_group_id, &flag);
+        margo_registered_name(mid, "bake_set_param_rpc",
+                              &client->bake_set_param_id, &flag);
         margo_registered_name(mid, "bake_migrate_region_rpc",
                               &client->bake_migrate_region_id, &flag);
         margo_registered_name(mid, "bake_migrate_target_rpc",
@@ -106,6 +150,17 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
         client->bake_eager_read_id
             = MARGO_REGISTER(mid, "bake_eager_read_rpc", bake_eager_read_in_t,
                              bake_eager_read_out_t, NULL);
+        client->bake_eager_read_multi_id
+            = MARGO_REGISTER(mid, "bake_eager_read_multi_rpc",
+                             bake_eager_read_multi_in_t,
+                             bake_eager_read_multi_out_t, NULL);
+        client->bake_writev_id = MARGO_REGISTER(
+            mid, "bake_writev_rpc", bake_writev_in_t, bake_writev_out_t, NULL);
+        client->bake_readv_id = MARGO_REGISTER(
+            mid, "bake_readv_rpc", bake_readv_in_t, bake_readv_out_t, NULL);
+        client->bake_compound_id
+            = MARGO_REGISTER(mid, "bake_compound_rpc", bake_compound_in_t,
+                             bake_compound_out_t, NULL);
         client->bake_persist_id
             = MARGO_REGISTER(mid, "bake_persist_rpc", bake_persist_in_t,
                              bake_persist_out_t, NULL);
@@ -117,6 +172,10 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
             = MARGO_REGISTER(mid, "bake_eager_create_write_persist_rpc",
                              bake_eager_create_write_persist_in_t,
                              bake_eager_create_write_persist_out_t, NULL);
+        client->bake_eager_create_write_persist_multi_id
+            = MARGO_REGISTER(mid, "bake_eager_create_write_persist_multi_rpc",
+                             bake_eager_create_write_persist_multi_in_t,
+                             bake_eager_create_write_persist_multi_out_t, NULL);
         client->bake_get_size_id
             = MARGO_REGISTER(mid, "bake_get_size_rpc", bake_get_size_in_t,
                              bake_get_size_out_t, NULL);
@@ -129,6 +188,21 @@ static int bake_client_register(bake_client_t client, margo_instance_id mid)
             = MARGO_REGISTER(mid, "bake_noop_rpc", void, void, NULL);
         client->bake_remove_id = MARGO_REGISTER(
             mid, "bake_remove_rpc", bake_remove_in_t, bake_remove_out_t, NULL);
+        client->bake_create_multi_id
+            = MARGO_REGISTER(mid, "bake_create_multi_rpc",
+                             bake_create_multi_in_t, bake_create_multi_out_t,
+                             NULL);
+        client->bake_remove_multi_id
+            = MARGO_REGISTER(mid, "bake_remove_multi_rpc",
+                             bake_remove_multi_in_t, bake_remove_multi_out_t,
+                             NULL);
+        client->bake_remove_group_id
+            = MARGO_REGISTER(mid, "bake_remove_group_rpc",
+                             bake_remove_group_in_t, bake_remove_group_out_t,
+                             NULL);
+        client->bake_set_param_id
+            = MARGO_REGISTER(mid, "bake_set_param_rpc", bake_set_param_in_t,
+                             bake_set_param_out_t, NULL);
         client->bake_migrate_region_id = MARGO_REGISTER(
             mid, "bake_migrate_region_rpc", bake_migrate_region_in_t,
             bake_migrate_region_out_t, NULL);
@@ -243,10 +317,13 @@ int bake_provider_handle_create(bake_client_t           client,
         return BAKE_ERR_MERCURY;
     }
 
-    provider->client      = client;
-    provider->provider_id = provider_id;
-    provider->refcount    = 1;
-    provider->eager_limit = BAKE_DEFAULT_EAGER_LIMIT;
+    provider->client       = client;
+    provider->provider_id  = provider_id;
+    provider->refcount     = 1;
+    provider->eager_limit    = BAKE_DEFAULT_EAGER_LIMIT;
+    provider->multi_msg_size = BAKE_DEFAULT_MULTI_MSG_SIZE;
+    provider->busy_retries   = BAKE_DEFAULT_BUSY_RETRIES;
+    provider->backoff_seed   = (unsigned)time(NULL) ^ (uintptr_t)provider;
 
     client->num_provider_handles += 1;
 
@@ -270,6 +347,38 @@ int bake_provider_handle_set_eager_limit(bake_provider_handle_t handle,
     return BAKE_SUCCESS;
 }
 
+int bake_provider_handle_get_multi_msg_size(bake_provider_handle_t handle,
+                                            uint64_t*              size)
+{
+    if (handle == BAKE_PROVIDER_HANDLE_NULL) return BAKE_ERR_INVALID_ARG;
+    *size = handle->multi_msg_size;
+    return BAKE_SUCCESS;
+}
+
+int bake_provider_handle_set_multi_msg_size(bake_provider_handle_t handle,
+                                            uint64_t               size)
+{
+    if (handle == BAKE_PROVIDER_HANDLE_NULL) return BAKE_ERR_INVALID_ARG;
+    handle->multi_msg_size = size;
+    return BAKE_SUCCESS;
+}
+
+int bake_provider_handle_get_busy_retries(bake_provider_handle_t handle,
+                                          uint32_t*              retries)
+{
+    if (handle == BAKE_PROVIDER_HANDLE_NULL) return BAKE_ERR_INVALID_ARG;
+    *retries = handle->busy_retries;
+    return BAKE_SUCCESS;
+}
+
+int bake_provider_handle_set_busy_retries(bake_provider_handle_t handle,
+                                          uint32_t               retries)
+{
+    if (handle == BAKE_PROVIDER_HANDLE_NULL) return BAKE_ERR_INVALID_ARG;
+    handle->busy_retries = retries;
+    return BAKE_SUCCESS;
+}
+
 int bake_provider_handle_ref_incr(bake_provider_handle_t handle)
 {
     if (handle == BAKE_PROVIDER_HANDLE_NULL) return BAKE_ERR_INVALID_ARG;
@@ -309,12 +418,65 @@ int bake_shutdown_service(bake_client_t client, hg_addr_t addr)
     return margo_shutdown_remote_instance(client->mid, addr);
 }
 
+/* deadline for an operation given a timeout, see bake_deadline_now() */
+static uint64_t deadline_after(double timeout_ms)
+{
+    return bake_deadline_now() + (uint64_t)(timeout_ms * 1000);
+}
+
+/* Forwards an RPC and gets its output, forwarding it again for as long as
+ * the provider answers BAKE_ERR_BUSY and the handle has retries left.
+ * Each retry waits for the retry-after hint of the provider, doubled on
+ * every attempt, less a random part of up to half of it so that clients
+ * turned away together do not come back together.  ret and retry_after_ms
+ * point into out.  If deadline_us is not 0, gives up with HG_TIMEOUT when
+ * it passes, and stops retrying when the next retry would come too late.
+ */
+static hg_return_t forward_with_backoff(bake_provider_handle_t provider,
+                                        hg_handle_t            handle,
+                                        void*                  in,
+                                        void*                  out,
+                                        const int32_t*         ret,
+                                        const uint32_t*        retry_after_ms,
+                                        uint64_t               deadline_us)
+{
+    hg_return_t hret;
+    uint32_t    attempt;
+    double      delay_ms;
+    double      left_ms = 0;
+
+    for (attempt = 0;; attempt++) {
+        if (deadline_us) {
+            left_ms = ((double)deadline_us - bake_deadline_now()) / 1000;
+            if (left_ms <= 0) return HG_TIMEOUT;
+            hret = margo_provider_forward_timed(provider->provider_id, handle,
+                                                in, left_ms);
+        } else
+            hret = margo_provider_forward(provider->provider_id, handle, in);
+        if (hret != HG_SUCCESS) return hret;
+        hret = margo_get_output(handle, out);
+        if (hret != HG_SUCCESS) return hret;
+        if (*ret != BAKE_ERR_BUSY || attempt >= provider->busy_retries)
+            return HG_SUCCESS;
+
+        delay_ms = *retry_after_ms ? *retry_after_ms : 1;
+        delay_ms *= 1 << (attempt < 10 ? attempt : 10);
+        if (delay_ms > BAKE_MAX_BUSY_BACKOFF_MS)
+            delay_ms = BAKE_MAX_BUSY_BACKOFF_MS;
+        delay_ms -= delay_ms / 2 * rand_r(&provider->backoff_seed) / RAND_MAX;
+        if (deadline_us && delay_ms >= left_ms) return HG_SUCCESS;
+        margo_free_output(handle, out);
+        margo_thread_sleep(provider->client->mid, delay_ms);
+    }
+}
+
 static int bake_eager_write(bake_provider_handle_t provider,
                             bake_target_id_t       tid,
                             bake_region_id_t       rid,
                             uint64_t               region_offset,
                             void const*            buf,
-                            uint64_t               buf_size)
+                            uint64_t               buf_size,
+                            uint64_t               deadline_us)
 {
     TIMERS_INITIALIZE("start", "forward", "end");
     hg_return_t            hret;
@@ -327,6 +489,7 @@ static int bake_eager_write(bake_provider_handle_t provider,
     in.rid           = rid;
     in.region_offset = region_offset;
     in.size          = buf_size;
+    in.deadline_us   = deadline_us;
     in.buffer        = (char*)buf;
 
     hret = margo_create(provider->client->mid, provider->addr,
@@ -339,20 +502,15 @@ static int bake_eager_write(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        margo_destroy(handle);
-        return BAKE_ERR_MERCURY;
-    }
-
     ret = out.ret;
 
 finish:
@@ -364,12 +522,13 @@ finish:
     return ret;
 }
 
-int bake_write(bake_provider_handle_t provider,
-               bake_target_id_t       tid,
-               bake_region_id_t       rid,
-               uint64_t               region_offset,
-               void const*            buf,
-               uint64_t               buf_size)
+static int bake_write_internal(bake_provider_handle_t provider,
+                               bake_target_id_t       tid,
+                               bake_region_id_t       rid,
+                               uint64_t               region_offset,
+                               void const*            buf,
+                               uint64_t               buf_size,
+                               uint64_t               deadline_us)
 {
     hg_return_t     hret;
     hg_handle_t     handle = HG_HANDLE_NULL;
@@ -379,8 +538,8 @@ int bake_write(bake_provider_handle_t provider,
     int              ret;
 
     if (buf_size <= provider->eager_limit)
-        return (
-            bake_eager_write(provider, tid, rid, region_offset, buf, buf_size));
+        return (bake_eager_write(provider, tid, rid, region_offset, buf,
+                                 buf_size, deadline_us));
 
     TIMERS_INITIALIZE("bulk_create", "forward", "end");
 
@@ -392,6 +551,7 @@ int bake_write(bake_provider_handle_t provider,
     in.bulk_size     = buf_size;
     in.remote_addr_str
         = NULL; /* set remote_addr to NULL to disable proxy write */
+    in.deadline_us = deadline_us;
 
     hret = margo_bulk_create(provider->client->mid, 1, (void**)(&buf),
                              &buf_size, HG_BULK_READ_ONLY, &in.bulk_handle);
@@ -410,20 +570,15 @@ int bake_write(bake_provider_handle_t provider,
         goto finish;
     }
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret = out.ret;
 
 finish:
@@ -438,6 +593,29 @@ finish:
     return ret;
 }
 
+int bake_write(bake_provider_handle_t provider,
+               bake_target_id_t       tid,
+               bake_region_id_t       rid,
+               uint64_t               region_offset,
+               void const*            buf,
+               uint64_t               buf_size)
+{
+    return bake_write_internal(provider, tid, rid, region_offset, buf,
+                               buf_size, 0);
+}
+
+int bake_write_timed(bake_provider_handle_t provider,
+                     bake_target_id_t       tid,
+                     bake_region_id_t       rid,
+                     uint64_t               region_offset,
+                     void const*            buf,
+                     uint64_t               buf_size,
+                     double                 timeout_ms)
+{
+    return bake_write_internal(provider, tid, rid, region_offset, buf,
+                               buf_size, deadline_after(timeout_ms));
+}
+
 int bake_proxy_write(bake_provider_handle_t provider,
                      bake_target_id_t       tid,
                      bake_region_id_t       rid,
@@ -461,6 +639,7 @@ int bake_proxy_write(bake_provider_handle_t provider,
     in.bulk_offset     = remote_offset;
     in.bulk_size       = size;
     in.remote_addr_str = (char*)remote_addr;
+    in.deadline_us     = 0;
 
     hret = margo_create(provider->client->mid, provider->addr,
                         provider->client->bake_write_id, &handle);
@@ -472,20 +651,15 @@ int bake_proxy_write(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret = out.ret;
 
 finish:
@@ -499,10 +673,13 @@ finish:
     return (ret);
 }
 
-int bake_create(bake_provider_handle_t provider,
-                bake_target_id_t       bti,
-                uint64_t               region_size,
-                bake_region_id_t*      rid)
+/* issues a create RPC for the target in *bti, or for a target chosen by
+ * the provider if *bti is all zeroes; *bti is set to the target used
+ */
+static int bake_create_internal(bake_provider_handle_t provider,
+                                bake_target_id_t*      bti,
+                                uint64_t               region_size,
+                                bake_region_id_t*      rid)
 {
     TIMERS_INITIALIZE("start", "forward", "end");
     hg_return_t       hret;
@@ -511,7 +688,7 @@ int bake_create(bake_provider_handle_t provider,
     bake_create_out_t out;
     int               ret = 0;
 
-    in.bti         = bti;
+    in.bti         = *bti;
     in.region_size = region_size;
 
     hret = margo_create(provider->client->mid, provider->addr,
@@ -542,7 +719,10 @@ int bake_create(bake_provider_handle_t provider,
 
 finish:
 
-    if (ret == BAKE_SUCCESS) *rid = out.rid;
+    if (ret == BAKE_SUCCESS) {
+        *bti = out.bti;
+        *rid = out.rid;
+    }
 
     margo_free_output(handle, &out);
     margo_destroy(handle);
@@ -553,6 +733,23 @@ finish:
     return (ret);
 }
 
+int bake_create(bake_provider_handle_t provider,
+                bake_target_id_t       bti,
+                uint64_t               region_size,
+                bake_region_id_t*      rid)
+{
+    return bake_create_internal(provider, &bti, region_size, rid);
+}
+
+int bake_create_placed(bake_provider_handle_t provider,
+                       uint64_t               region_size,
+                       bake_target_id_t*      bti,
+                       bake_region_id_t*      rid)
+{
+    memset(bti, 0, sizeof(*bti));
+    return bake_create_internal(provider, bti, region_size, rid);
+}
+
 int bake_persist(bake_provider_handle_t provider,
                  bake_target_id_t       tid,
                  bake_region_id_t       rid,
@@ -608,10 +805,11 @@ finish:
 }
 
 static int bake_eager_create_write_persist(bake_provider_handle_t provider,
-                                           bake_target_id_t       bti,
+                                           bake_target_id_t*      bti,
                                            void const*            buf,
                                            uint64_t               buf_size,
-                                           bake_region_id_t*      rid)
+                                           bake_region_id_t*      rid,
+                                           uint64_t               deadline_us)
 {
     TIMERS_INITIALIZE("start", "forward", "end");
     hg_return_t                           hret;
@@ -620,9 +818,10 @@ static int bake_eager_create_write_persist(bake_provider_handle_t provider,
     bake_eager_create_write_persist_out_t out;
     int                                   ret;
 
-    in.bti    = bti;
-    in.buffer = (char*)buf;
-    in.size   = buf_size;
+    in.bti         = *bti;
+    in.buffer      = (char*)buf;
+    in.size        = buf_size;
+    in.deadline_us = deadline_us;
 
     hret = margo_create(provider->client->mid, provider->addr,
                         provider->client->bake_eager_create_write_persist_id,
@@ -634,25 +833,23 @@ static int bake_eager_create_write_persist(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret = out.ret;
 
 finish:
 
-    if (ret == 0) *rid = out.rid;
+    if (ret == 0) {
+        *bti = out.bti;
+        *rid = out.rid;
+    }
 
     margo_free_output(handle, &out);
     margo_destroy(handle);
@@ -663,11 +860,13 @@ finish:
     return (ret);
 }
 
-int bake_create_write_persist(bake_provider_handle_t provider,
-                              bake_target_id_t       bti,
-                              void const*            buf,
-                              uint64_t               buf_size,
-                              bake_region_id_t*      rid)
+/* same as bake_create_internal, for create_write_persist */
+static int bake_create_write_persist_internal(bake_provider_handle_t provider,
+                                              bake_target_id_t*      bti,
+                                              void const*            buf,
+                                              uint64_t               buf_size,
+                                              bake_region_id_t*      rid,
+                                              uint64_t deadline_us)
 {
     hg_return_t                    hret;
     hg_handle_t                    handle = HG_HANDLE_NULL;
@@ -677,17 +876,18 @@ int bake_create_write_persist(bake_provider_handle_t provider,
     int                             ret;
 
     if (buf_size <= provider->eager_limit)
-        return (
-            bake_eager_create_write_persist(provider, bti, buf, buf_size, rid));
+        return (bake_eager_create_write_persist(provider, bti, buf, buf_size,
+                                                rid, deadline_us));
 
     TIMERS_INITIALIZE("bulk_create", "forward", "end");
 
-    in.bti         = bti;
+    in.bti         = *bti;
     in.bulk_offset = 0;
     in.bulk_size   = buf_size;
     in.region_size = buf_size;
     in.remote_addr_str
         = NULL; /* set remote_addr to NULL to disable proxy write */
+    in.deadline_us = deadline_us;
 
     hret = margo_bulk_create(provider->client->mid, 1, (void**)(&buf),
                              &buf_size, HG_BULK_READ_ONLY, &in.bulk_handle);
@@ -707,34 +907,188 @@ int bake_create_write_persist(bake_provider_handle_t provider,
         goto finish;
     }
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
+    ret = out.ret;
+
+finish:
+
+    if (ret == 0) {
+        *bti = out.bti;
+        *rid = out.rid;
+    }
+
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+    return (ret);
+}
+
+int bake_create_write_persist(bake_provider_handle_t provider,
+                              bake_target_id_t       bti,
+                              void const*            buf,
+                              uint64_t               buf_size,
+                              bake_region_id_t*      rid)
+{
+    return bake_create_write_persist_internal(provider, &bti, buf, buf_size,
+                                              rid, 0);
+}
+
+int bake_create_write_persist_timed(bake_provider_handle_t provider,
+                                    bake_target_id_t       bti,
+                                    void const*            buf,
+                                    uint64_t               buf_size,
+                                    bake_region_id_t*      rid,
+                                    double                 timeout_ms)
+{
+    return bake_create_write_persist_internal(provider, &bti, buf, buf_size,
+                                              rid, deadline_after(timeout_ms));
+}
+
+int bake_create_write_persist_placed(bake_provider_handle_t provider,
+                                     void const*            buf,
+                                     uint64_t               buf_size,
+                                     bake_target_id_t*      bti,
+                                     bake_region_id_t*      rid)
+{
+    memset(bti, 0, sizeof(*bti));
+    return bake_create_write_persist_internal(provider, bti, buf, buf_size,
+                                              rid, 0);
+}
+
+/* number of items, from the first one, that fit in one packed multi
+ * message pair; the message carrying the data holds the size of each item
+ * and its data, and the other one data_less bytes per item (its region id,
+ * and for a read its size), so that both stay within the multi message
+ * size of the provider handle whatever the sizes of the items.  Sets
+ * data_size to the data of the batch.
+ */
+static uint64_t multi_batch(bake_provider_handle_t provider,
+                            uint64_t               count,
+                            const uint64_t*        sizes,
+                            uint64_t               data_less,
+                            uint64_t*              data_size)
+{
+    uint64_t budget, with_data = 0, without_data = 0, n;
+
+    *data_size = 0;
+    if (provider->multi_msg_size <= BAKE_MULTI_MSG_HEADER) return 0;
+    budget = provider->multi_msg_size - BAKE_MULTI_MSG_HEADER;
+
+    for (n = 0; n < count && sizes[n] <= provider->eager_limit; n++) {
+        if (sizes[n] > budget
+            || with_data + BAKE_MULTI_SIZE_BYTES + sizes[n] > budget
+            || without_data + data_less > budget)
+            break;
+        with_data += BAKE_MULTI_SIZE_BYTES + sizes[n];
+        without_data += data_less;
+        *data_size += sizes[n];
+    }
+    return n;
+}
+
+static int
+bake_eager_create_write_persist_multi(bake_provider_handle_t provider,
+                                      bake_target_id_t*      bti,
+                                      uint64_t               count,
+                                      const uint64_t*        sizes,
+                                      void const*            data,
+                                      bake_region_id_t*      rids)
+{
+    TIMERS_INITIALIZE("start", "forward", "end");
+    hg_return_t                                 hret;
+    hg_handle_t                                 handle = HG_HANDLE_NULL;
+    bake_eager_create_write_persist_multi_in_t  in;
+    bake_eager_create_write_persist_multi_out_t out = {0};
+    int                                         ret;
+
+    in.bti         = *bti;
+    in.count       = count;
+    in.sizes       = (uint64_t*)sizes;
+    in.buffer      = (char*)data;
+    in.deadline_us = 0;
+
+    hret = margo_create(
+        provider->client->mid, provider->addr,
+        provider->client->bake_eager_create_write_persist_multi_id, &handle);
     if (hret != HG_SUCCESS) {
         ret = BAKE_ERR_MERCURY;
         goto finish;
     }
 
-    ret = out.ret;
+    TIMERS_END_STEP(0);
 
-finish:
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
+    if (hret != HG_SUCCESS) {
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
+        goto finish;
+    }
 
-    if (ret == 0) *rid = out.rid;
+    TIMERS_END_STEP(1);
+
+    ret = out.ret;
+    if (ret == BAKE_SUCCESS) {
+        *bti = out.bti;
+        memcpy(rids, out.rids, out.count * sizeof(*rids));
+    }
 
+finish:
     margo_free_output(handle, &out);
-    margo_bulk_free(in.bulk_handle);
     margo_destroy(handle);
+
     TIMERS_END_STEP(2);
     TIMERS_FINALIZE();
+
     return (ret);
 }
 
+int bake_create_write_persist_multi(bake_provider_handle_t provider,
+                                    bake_target_id_t       bti,
+                                    uint64_t               count,
+                                    const uint64_t*        sizes,
+                                    void const*            data,
+                                    bake_region_id_t*      rids)
+{
+    const char* payload = data;
+    uint64_t    first   = 0, n, size;
+    int         ret;
+
+    while (first < count) {
+        /* consecutive payloads travel together up to the multi message
+         * size, and one that does not fit in a message with its header
+         * goes on its own, by bulk transfer if larger than the eager limit
+         */
+        n = multi_batch(provider, count - first, sizes + first,
+                        BAKE_MULTI_RID_BYTES, &size);
+        if (n == 0) {
+            n    = 1;
+            size = sizes[first];
+            ret  = bake_create_write_persist_internal(provider, &bti, payload,
+                                                      size, &rids[first], 0);
+        } else
+            ret = bake_eager_create_write_persist_multi(
+                provider, &bti, n, sizes + first, payload, rids + first);
+        if (ret != BAKE_SUCCESS) {
+            /* remove the regions of the batches that went through */
+            bake_remove_multi(provider, bti, first, rids);
+            return ret;
+        }
+        first += n;
+        payload += size;
+    }
+    return BAKE_SUCCESS;
+}
+
 int bake_create_write_persist_proxy(bake_provider_handle_t provider,
                                     bake_target_id_t       bti,
                                     hg_bulk_t              remote_bulk,
@@ -755,6 +1109,7 @@ int bake_create_write_persist_proxy(bake_provider_handle_t provider,
     in.bulk_offset     = remote_offset;
     in.bulk_size       = size;
     in.remote_addr_str = (char*)remote_addr;
+    in.deadline_us     = 0;
 
     hret
         = margo_create(provider->client->mid, provider->addr,
@@ -767,20 +1122,15 @@ int bake_create_write_persist_proxy(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret = out.ret;
     if (ret == BAKE_SUCCESS) *rid = out.rid;
 
@@ -1071,7 +1421,8 @@ static int bake_eager_read(bake_provider_handle_t provider,
                            uint64_t               region_offset,
                            void*                  buf,
                            uint64_t               buf_size,
-                           uint64_t*              bytes_read)
+                           uint64_t*              bytes_read,
+                           uint64_t               deadline_us)
 {
     TIMERS_INITIALIZE("start", "forward", "memcpy", "end");
     hg_return_t           hret;
@@ -1086,6 +1437,7 @@ static int bake_eager_read(bake_provider_handle_t provider,
     in.rid           = rid;
     in.region_offset = region_offset;
     in.size          = buf_size;
+    in.deadline_us   = deadline_us;
 
     hret = margo_create(provider->client->mid, provider->addr,
                         provider->client->bake_eager_read_id, &handle);
@@ -1097,20 +1449,15 @@ static int bake_eager_read(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret = out.ret;
     if (ret == 0) memcpy(buf, out.buffer, out.size);
     *bytes_read = out.size;
@@ -1128,13 +1475,14 @@ finish:
     return (ret);
 }
 
-int bake_read(bake_provider_handle_t provider,
-              bake_target_id_t       bti,
-              bake_region_id_t       rid,
-              uint64_t               region_offset,
-              void*                  buf,
-              uint64_t               buf_size,
-              uint64_t*              bytes_read)
+static int bake_read_internal(bake_provider_handle_t provider,
+                              bake_target_id_t       bti,
+                              bake_region_id_t       rid,
+                              uint64_t               region_offset,
+                              void*                  buf,
+                              uint64_t               buf_size,
+                              uint64_t*              bytes_read,
+                              uint64_t               deadline_us)
 {
     hg_return_t    hret;
     hg_handle_t    handle = HG_HANDLE_NULL;
@@ -1145,7 +1493,7 @@ int bake_read(bake_provider_handle_t provider,
 
     if (buf_size <= provider->eager_limit)
         return (bake_eager_read(provider, bti, rid, region_offset, buf,
-                                buf_size, bytes_read));
+                                buf_size, bytes_read, deadline_us));
 
     TIMERS_INITIALIZE("bulk_create", "forward", "end");
 
@@ -1156,6 +1504,7 @@ int bake_read(bake_provider_handle_t provider,
     in.bulk_size     = buf_size;
     in.remote_addr_str
         = NULL; /* set remote_addr to NULL to disable proxy read */
+    in.deadline_us = deadline_us;
 
     hret = margo_bulk_create(provider->client->mid, 1, (void**)(&buf),
                              &buf_size, HG_BULK_WRITE_ONLY, &in.bulk_handle);
@@ -1174,20 +1523,15 @@ int bake_read(bake_provider_handle_t provider,
         goto finish;
     }
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
-    }
-
     ret         = out.ret;
     *bytes_read = out.size;
 
@@ -1201,34 +1545,55 @@ finish:
     return (ret);
 }
 
-int bake_proxy_read(bake_provider_handle_t provider,
-                    bake_target_id_t       tid,
+int bake_read(bake_provider_handle_t provider,
+              bake_target_id_t       bti,
+              bake_region_id_t       rid,
+              uint64_t               region_offset,
+              void*                  buf,
+              uint64_t               buf_size,
+              uint64_t*              bytes_read)
+{
+    return bake_read_internal(provider, bti, rid, region_offset, buf,
+                              buf_size, bytes_read, 0);
+}
+
+int bake_read_timed(bake_provider_handle_t provider,
+                    bake_target_id_t       bti,
                     bake_region_id_t       rid,
                     uint64_t               region_offset,
-                    hg_bulk_t              remote_bulk,
-                    uint64_t               remote_offset,
-                    const char*            remote_addr,
-                    uint64_t               size,
-                    uint64_t*              bytes_read)
+                    void*                  buf,
+                    uint64_t               buf_size,
+                    uint64_t*              bytes_read,
+                    double                 timeout_ms)
 {
-    TIMERS_INITIALIZE("start", "forward", "end");
-    hg_return_t     hret;
-    hg_handle_t     handle = HG_HANDLE_NULL;
-    bake_read_in_t  in;
-    bake_read_out_t out;
-    int             ret;
+    return bake_read_internal(provider, bti, rid, region_offset, buf,
+                              buf_size, bytes_read, deadline_after(timeout_ms));
+}
 
-    in.bti             = tid;
-    in.rid             = rid;
-    in.region_offset   = region_offset;
-    in.bulk_handle     = remote_bulk;
-    in.bulk_offset     = remote_offset;
-    in.bulk_size       = size;
-    in.remote_addr_str = (char*)remote_addr;
+static int bake_eager_read_multi(bake_provider_handle_t  provider,
+                                 bake_target_id_t        bti,
+                                 uint64_t                count,
+                                 const bake_region_id_t* rids,
+                                 const uint64_t*         sizes,
+                                 void*                   buf,
+                                 uint64_t*               bytes_read)
+{
+    TIMERS_INITIALIZE("start", "forward", "memcpy", "end");
+    hg_return_t                 hret;
+    hg_handle_t                 handle = HG_HANDLE_NULL;
+    bake_eager_read_multi_in_t  in;
+    bake_eager_read_multi_out_t out = {0};
+    uint64_t                    i, offset = 0, packed = 0;
+    int                         ret;
 
-    hret = margo_create(provider->client->mid, provider->addr,
-                        provider->client->bake_read_id, &handle);
+    in.bti         = bti;
+    in.count       = count;
+    in.rids        = (bake_region_id_t*)rids;
+    in.sizes       = (uint64_t*)sizes;
+    in.deadline_us = 0;
 
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_eager_read_multi_id, &handle);
     if (hret != HG_SUCCESS) {
         ret = BAKE_ERR_MERCURY;
         goto finish;
@@ -1236,34 +1601,291 @@ int bake_proxy_read(bake_provider_handle_t provider,
 
     TIMERS_END_STEP(0);
 
-    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
     if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
         goto finish;
     }
 
     TIMERS_END_STEP(1);
 
-    hret = margo_get_output(handle, &out);
-    if (hret != HG_SUCCESS) {
-        ret = BAKE_ERR_MERCURY;
-        goto finish;
+    ret = out.ret;
+    if (ret != BAKE_SUCCESS) goto finish;
+    /* the contents come back packed; each goes to its place in buf */
+    for (i = 0; i < out.count; i++) {
+        memcpy((char*)buf + offset, out.buffer + packed, out.sizes[i]);
+        bytes_read[i] = out.sizes[i];
+        offset += sizes[i];
+        packed += out.sizes[i];
     }
 
-    ret         = out.ret;
-    *bytes_read = out.size;
+    TIMERS_END_STEP(2);
 
 finish:
-
     margo_free_output(handle, &out);
     margo_destroy(handle);
 
-    TIMERS_END_STEP(2);
+    TIMERS_END_STEP(3);
     TIMERS_FINALIZE();
+
     return (ret);
 }
 
-int bake_remove(bake_provider_handle_t provider,
+int bake_read_multi(bake_provider_handle_t  provider,
+                    bake_target_id_t        bti,
+                    uint64_t                count,
+                    const bake_region_id_t* rids,
+                    const uint64_t*         sizes,
+                    void*                   buf,
+                    uint64_t*               bytes_read)
+{
+    char*    dest  = buf;
+    uint64_t first = 0, n, size;
+    int      ret;
+
+    while (first < count) {
+        /* same batching as bake_create_write_persist_multi(), the
+         * request holding the region id and size of each item
+         */
+        n = multi_batch(provider, count - first, sizes + first,
+                        BAKE_MULTI_RID_BYTES + BAKE_MULTI_SIZE_BYTES, &size);
+        if (n == 0) {
+            n    = 1;
+            size = sizes[first];
+            ret  = bake_read_internal(provider, bti, rids[first], 0, dest,
+                                      size, &bytes_read[first], 0);
+        } else
+            ret = bake_eager_read_multi(provider, bti, n, rids + first,
+                                        sizes + first, dest,
+                                        bytes_read + first);
+        if (ret != BAKE_SUCCESS) return ret;
+        first += n;
+        dest += size;
+    }
+    return BAKE_SUCCESS;
+}
+
+int bake_proxy_read(bake_provider_handle_t provider,
+                    bake_target_id_t       tid,
+                    bake_region_id_t       rid,
+                    uint64_t               region_offset,
+                    hg_bulk_t              remote_bulk,
+                    uint64_t               remote_offset,
+                    const char*            remote_addr,
+                    uint64_t               size,
+                    uint64_t*              bytes_read)
+{
+    TIMERS_INITIALIZE("start", "forward", "end");
+    hg_return_t     hret;
+    hg_handle_t     handle = HG_HANDLE_NULL;
+    bake_read_in_t  in;
+    bake_read_out_t out;
+    int             ret;
+
+    in.bti             = tid;
+    in.rid             = rid;
+    in.region_offset   = region_offset;
+    in.bulk_handle     = remote_bulk;
+    in.bulk_offset     = remote_offset;
+    in.bulk_size       = size;
+    in.remote_addr_str = (char*)remote_addr;
+    in.deadline_us     = 0;
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_read_id, &handle);
+
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
+    if (hret != HG_SUCCESS) {
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    ret         = out.ret;
+    *bytes_read = out.size;
+
+finish:
+
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+    return (ret);
+}
+
+/* exposes the buffers of the segments of a vectored read or write through
+ * a single bulk handle, in the order of the segments
+ */
+static hg_return_t create_segments_bulk(bake_provider_handle_t provider,
+                                        uint64_t               num_segments,
+                                        const bake_segment_t*  segments,
+                                        void* const*           bufs,
+                                        hg_uint8_t             flags,
+                                        hg_bulk_t*             bulk)
+{
+    void**      ptrs;
+    hg_size_t*  sizes;
+    uint32_t    count = 0;
+    uint64_t    i;
+    hg_return_t hret = HG_SUCCESS;
+
+    *bulk = HG_BULK_NULL;
+    ptrs  = malloc(num_segments * sizeof(*ptrs));
+    sizes = malloc(num_segments * sizeof(*sizes));
+    if (!ptrs || !sizes) {
+        hret = HG_NOMEM;
+        goto finish;
+    }
+    /* empty segments take no room in the bulk handle */
+    for (i = 0; i < num_segments; i++) {
+        if (segments[i].size == 0) continue;
+        ptrs[count]  = bufs[i];
+        sizes[count] = segments[i].size;
+        count++;
+    }
+    if (count)
+        hret = margo_bulk_create(provider->client->mid, count, ptrs, sizes,
+                                 flags, bulk);
+
+finish:
+    free(ptrs);
+    free(sizes);
+    return hret;
+}
+
+int bake_writev(bake_provider_handle_t provider,
+                uint64_t               num_segments,
+                const bake_segment_t*  segments,
+                void const* const*     bufs)
+{
+    hg_return_t       hret;
+    hg_handle_t       handle = HG_HANDLE_NULL;
+    bake_writev_in_t  in;
+    bake_writev_out_t out;
+    int               ret;
+
+    if (num_segments == 0) return BAKE_SUCCESS;
+
+    TIMERS_INITIALIZE("bulk_create", "forward", "end");
+
+    in.num_segments = num_segments;
+    in.segments     = (bake_segment_t*)segments;
+    in.deadline_us  = 0;
+
+    hret = create_segments_bulk(provider, num_segments, segments,
+                                (void* const*)bufs, HG_BULK_READ_ONLY,
+                                &in.bulk_handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_writev_id, &handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
+    if (hret != HG_SUCCESS) {
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    ret = out.ret;
+
+finish:
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+
+    return ret;
+}
+
+int bake_readv(bake_provider_handle_t provider,
+               uint64_t               num_segments,
+               const bake_segment_t*  segments,
+               void* const*           bufs,
+               uint64_t*              bytes_read)
+{
+    hg_return_t      hret;
+    hg_handle_t      handle = HG_HANDLE_NULL;
+    bake_readv_in_t  in;
+    bake_readv_out_t out = {0};
+    uint64_t         i;
+    int              ret;
+
+    if (num_segments == 0) return BAKE_SUCCESS;
+
+    TIMERS_INITIALIZE("bulk_create", "forward", "end");
+
+    in.num_segments = num_segments;
+    in.segments     = (bake_segment_t*)segments;
+    in.deadline_us  = 0;
+
+    hret = create_segments_bulk(provider, num_segments, segments, bufs,
+                                HG_BULK_WRITE_ONLY, &in.bulk_handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_readv_id, &handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
+    if (hret != HG_SUCCESS) {
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    ret = out.ret;
+    if (ret == BAKE_SUCCESS && bytes_read) {
+        for (i = 0; i < num_segments; i++)
+            bytes_read[i] = i < out.num_segments ? out.sizes[i] : 0;
+    }
+
+finish:
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+
+    return ret;
+}
+
+int bake_remove(bake_provider_handle_t provider,
                 bake_target_id_t       tid,
                 bake_region_id_t       rid)
 {
@@ -1311,3 +1933,320 @@ finish:
     TIMERS_FINALIZE();
     return (ret);
 }
+
+static int bake_create_multi_internal(bake_provider_handle_t provider,
+                                      bake_target_id_t       bti,
+                                      uint64_t               group,
+                                      uint64_t               count,
+                                      const uint64_t*        sizes,
+                                      bake_region_id_t*      rids)
+{
+    TIMERS_INITIALIZE("bulk_create", "forward", "end");
+    hg_return_t             hret;
+    hg_handle_t             handle = HG_HANDLE_NULL;
+    bake_create_multi_in_t  in;
+    bake_create_multi_out_t out = {0};
+    void*                   bufs[2];
+    hg_size_t               buf_sizes[2];
+    int                     ret;
+
+    if (count == 0) return BAKE_SUCCESS;
+
+    in.bti         = bti;
+    in.group       = group;
+    in.count       = count;
+    in.sizes       = (uint64_t*)sizes;
+    in.bulk_handle = HG_BULK_NULL;
+
+    /* the provider pulls the sizes of a large batch and pushes the region
+     * ids back, rather than having them in the messages
+     */
+    if (count * (sizeof(*sizes) + sizeof(*rids)) > provider->eager_limit) {
+        bufs[0]      = (void*)sizes;
+        buf_sizes[0] = count * sizeof(*sizes);
+        bufs[1]      = rids;
+        buf_sizes[1] = count * sizeof(*rids);
+        hret = margo_bulk_create(provider->client->mid, 2, bufs, buf_sizes,
+                                 HG_BULK_READWRITE, &in.bulk_handle);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            goto finish;
+        }
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_create_multi_id, &handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    ret = out.ret;
+    if (ret == BAKE_SUCCESS && out.count)
+        memcpy(rids, out.rids, out.count * sizeof(*rids));
+
+finish:
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+    return (ret);
+}
+
+int bake_create_multi(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               count,
+                      const uint64_t*        sizes,
+                      bake_region_id_t*      rids)
+{
+    return bake_create_multi_internal(provider, bti, 0, count, sizes, rids);
+}
+
+int bake_create_group(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               group,
+                      uint64_t               count,
+                      const uint64_t*        sizes,
+                      bake_region_id_t*      rids)
+{
+    if (group == 0) return BAKE_ERR_INVALID_ARG;
+    return bake_create_multi_internal(provider, bti, group, count, sizes,
+                                      rids);
+}
+
+int bake_remove_multi(bake_provider_handle_t  provider,
+                      bake_target_id_t        bti,
+                      uint64_t                count,
+                      const bake_region_id_t* rids)
+{
+    TIMERS_INITIALIZE("bulk_create", "forward", "end");
+    hg_return_t             hret;
+    hg_handle_t             handle = HG_HANDLE_NULL;
+    bake_remove_multi_in_t  in;
+    bake_remove_multi_out_t out;
+    hg_size_t               size = count * sizeof(*rids);
+    int                     ret;
+
+    if (count == 0) return BAKE_SUCCESS;
+
+    in.bti         = bti;
+    in.count       = count;
+    in.rids        = (bake_region_id_t*)rids;
+    in.bulk_handle = HG_BULK_NULL;
+
+    /* the provider pulls the ids of a large batch */
+    if (size > provider->eager_limit) {
+        hret = margo_bulk_create(provider->client->mid, 1, (void**)&rids,
+                                 &size, HG_BULK_READ_ONLY, &in.bulk_handle);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            goto finish;
+        }
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_remove_multi_id, &handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    ret = out.ret;
+
+finish:
+    margo_free_output(handle, &out);
+    margo_bulk_free(in.bulk_handle);
+    margo_destroy(handle);
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+    return (ret);
+}
+
+int bake_remove_group(bake_provider_handle_t provider,
+                      bake_target_id_t       bti,
+                      uint64_t               group)
+{
+    TIMERS_INITIALIZE("start", "forward", "end");
+    hg_return_t             hret;
+    hg_handle_t             handle;
+    bake_remove_group_in_t  in;
+    bake_remove_group_out_t out;
+    int                     ret;
+
+    in.bti   = bti;
+    in.group = group;
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_remove_group_id, &handle);
+    if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+
+    TIMERS_END_STEP(0);
+
+    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    ret = out.ret;
+    margo_free_output(handle, &out);
+
+finish:
+    margo_destroy(handle);
+    TIMERS_END_STEP(2);
+    TIMERS_FINALIZE();
+    return (ret);
+}
+
+int bake_compound(bake_provider_handle_t provider,
+                  bake_target_id_t*      bti,
+                  uint64_t               count,
+                  bake_op_t*             ops,
+                  bake_op_result_t*      results)
+{
+    TIMERS_INITIALIZE("start", "forward", "memcpy", "end");
+    hg_return_t         hret;
+    hg_handle_t         handle = HG_HANDLE_NULL;
+    bake_compound_in_t  in;
+    bake_compound_out_t out = {0};
+    uint64_t            i, offset = 0;
+    int                 ret;
+
+    in.bti         = *bti;
+    in.count       = count;
+    in.ops         = ops;
+    in.deadline_us = 0;
+    in.data_size   = 0;
+    in.data        = NULL;
+
+    /* the data of the writes travel packed in the request */
+    for (i = 0; i < count; i++)
+        if (ops[i].type == BAKE_OP_WRITE) in.data_size += ops[i].size;
+    if (in.data_size) {
+        in.data = malloc(in.data_size);
+        if (!in.data) return BAKE_ERR_ALLOCATION;
+        for (i = 0; i < count; i++) {
+            if (ops[i].type != BAKE_OP_WRITE) continue;
+            memcpy(in.data + offset, ops[i].buf, ops[i].size);
+            offset += ops[i].size;
+        }
+    }
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_compound_id, &handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(0);
+
+    hret = forward_with_backoff(provider, handle, &in, &out, &out.ret,
+                                &out.retry_after_ms, in.deadline_us);
+    if (hret != HG_SUCCESS) {
+        ret = hret == HG_TIMEOUT ? BAKE_ERR_TIMEOUT : BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    TIMERS_END_STEP(1);
+
+    ret = out.ret;
+    /* the operations that ran, even if one failed, ran on this target */
+    if (out.count) *bti = out.bti;
+    /* the data read come back packed, in the order of the operations */
+    for (i = 0, offset = 0; i < out.count && i < count; i++) {
+        results[i] = out.results[i];
+        if (ops[i].type != BAKE_OP_READ || results[i].ret != BAKE_SUCCESS)
+            continue;
+        memcpy(ops[i].buf, out.data + offset, results[i].size);
+        offset += results[i].size;
+    }
+
+    TIMERS_END_STEP(2);
+
+finish:
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    free(in.data);
+
+    TIMERS_END_STEP(3);
+    TIMERS_FINALIZE();
+
+    return (ret);
+}
+
+int bake_set_param(bake_provider_handle_t provider,
+                   const char*            key,
+                   const char*            value)
+{
+    hg_return_t          hret;
+    hg_handle_t          handle;
+    bake_set_param_in_t  in;
+    bake_set_param_out_t out;
+    int                  ret;
+
+    in.key   = key;
+    in.value = value;
+
+    hret = margo_create(provider->client->mid, provider->addr,
+                        provider->client->bake_set_param_id, &handle);
+    if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+
+    hret = margo_provider_forward(provider->provider_id, handle, &in);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return BAKE_ERR_MERCURY;
+    }
+
+    hret = margo_get_output(handle, &out);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return BAKE_ERR_MERCURY;
+    }
+    ret = out.ret;
+
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    return ret;
+}
@@ -0,0 +1,659 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+/* for FALLOC_FL_PUNCH_HOLE */
+#define _GNU_SOURCE
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <json-c/json.h>
+#include <libpmem.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+
+/* bake-dax-backend
+ *
+ * This is an implementation of a back end for the Bake provider that stores
+ * all data in a single memory-mapped, log-structured file.  It is intended
+ * for files on a DAX-capable file system (or device), but will also work
+ * with any file that can be mapped (e.g., on tmpfs for testing).  Regions
+ * are allocated by bumping a persistent log tail; there is no per-region
+ * allocator metadata.  Data is moved directly between the mapping and the
+ * network, and made durable with cache line flushes when the mapping is
+ * real persistent memory or with msync() otherwise.
+ */
+
+#define BAKE_ALIGN_UP(x, _alignment) \
+    ((((unsigned long)(x)) + (_alignment - 1)) & (~(_alignment - 1)))
+#define BAKE_ALIGN_DOWN(x, _alignment) \
+    ((unsigned long)(x) & (~(_alignment - 1)))
+
+/* The superblock contains metadata at the front of the log.  This size is
+ * not tunable; it is set when the target is created.
+ */
+#define BAKE_SUPERBLOCK_SIZE 4096
+
+/* definition of BAKE root data structure */
+typedef struct {
+    bake_target_id_t pool_id;
+    uint64_t         log_offset; /* persistent tail of the log */
+} bake_root_t;
+
+/* definition of internal BAKE region_id_t identifier for dax back end */
+typedef struct {
+    uint64_t log_entry_offset;
+    uint64_t log_entry_size;
+} dax_region_id_t;
+
+typedef struct {
+    bake_provider_t provider;
+    char*           base;          /* base address of the mapping */
+    size_t          mapped_len;    /* size of the mapping */
+    int             is_pmem;       /* can we flush with cpu instructions? */
+    int             fd;            /* used to punch holes on remove */
+    int             log_alignment; /* alignment for region allocation */
+    ABT_mutex log_offset_mutex; /* protects root->log_offset during concurrent
+                                   region creation */
+    bake_root_t* dax_root;
+    char*        root;
+    char*        filename;
+} bake_dax_entry_t;
+
+static void dax_persist(bake_dax_entry_t* entry, const void* addr, size_t len)
+{
+    if (entry->is_pmem)
+        pmem_persist(addr, len);
+    else
+        pmem_msync(addr, len);
+}
+
+/* find the memory backing (part of) a region, checking bounds; the region
+ * must lie within the allocated part of the log, so that a forged or stale
+ * rid cannot reach past its tail
+ */
+static char* dax_region_ptr(bake_dax_entry_t* entry,
+                            dax_region_id_t*  drid,
+                            size_t            offset,
+                            size_t            size)
+{
+    uint64_t tail
+        = __atomic_load_n(&entry->dax_root->log_offset, __ATOMIC_ACQUIRE);
+
+    if (offset > drid->log_entry_size || size > drid->log_entry_size - offset)
+        return NULL;
+    if (drid->log_entry_offset < BAKE_SUPERBLOCK_SIZE
+        || drid->log_entry_offset > tail
+        || drid->log_entry_size > tail - drid->log_entry_offset)
+        return NULL;
+    return entry->base + drid->log_entry_offset + offset;
+}
+
+static int bake_dax_makepool(const char* file_name, size_t file_size)
+{
+    bake_root_t* root;
+    size_t       mapped_len;
+    int          is_pmem;
+
+    if (file_size < 2 * BAKE_SUPERBLOCK_SIZE) {
+        fprintf(stderr, "dax target must be at least %d bytes\n",
+                2 * BAKE_SUPERBLOCK_SIZE);
+        return BAKE_ERR_INVALID_ARG;
+    }
+
+    root = pmem_map_file(file_name, file_size,
+                         PMEM_FILE_CREATE | PMEM_FILE_EXCL, 0644, &mapped_len,
+                         &is_pmem);
+    if (!root) {
+        perror("pmem_map_file");
+        return BAKE_ERR_IO;
+    }
+
+    /* store the target id for this bake pool at the root, and start the
+     * log right after the superblock
+     */
+    memset(root, 0, BAKE_SUPERBLOCK_SIZE);
+    uuid_generate(root->pool_id.id);
+    root->log_offset = BAKE_SUPERBLOCK_SIZE;
+    if (is_pmem)
+        pmem_persist(root, BAKE_SUPERBLOCK_SIZE);
+    else
+        pmem_msync(root, BAKE_SUPERBLOCK_SIZE);
+
+    pmem_unmap(root, mapped_len);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_dax_backend_initialize(bake_provider_t    provider,
+                                       const char*        path,
+                                       bake_target_id_t*  target,
+                                       backend_context_t* context)
+{
+    int                 ret              = BAKE_SUCCESS;
+    bake_dax_entry_t*   new_entry        = NULL;
+    struct json_object* dax_backend_json = NULL;
+    struct json_object* target_array     = NULL;
+    struct json_object* val;
+    const char*         tmp;
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "dax_backend",
+                                "dax_backend", dax_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(dax_backend_json, "targets",
+                               "dax_backend.targets", target_array);
+    /* alignment of regions in the log; defaults to a cache line */
+    CONFIG_HAS_OR_CREATE(dax_backend_json, int64, "alignment", 64,
+                         "dax_backend.alignment", val);
+    /* size used when a target listed in the json must be created */
+    CONFIG_HAS_OR_CREATE(dax_backend_json, int64,
+                         "default_initial_target_size", 1073741824,
+                         "dax_backend.default_initial_target_size", val);
+
+    new_entry           = calloc(1, sizeof(*new_entry));
+    new_entry->provider = provider;
+    new_entry->fd       = -1;
+
+    /* get and check alignment; must be positive and must be power of 2 */
+    new_entry->log_alignment = json_object_get_int(
+        json_object_object_get(dax_backend_json, "alignment"));
+    if (new_entry->log_alignment <= 0
+        || ((unsigned)new_entry->log_alignment
+            & ((unsigned)new_entry->log_alignment - 1))
+               != 0) {
+        BAKE_ERROR(provider->mid, "alignment %d is not a power of 2",
+                   new_entry->log_alignment);
+        ret = BAKE_ERR_INVALID_ARG;
+        goto error_cleanup;
+    }
+
+    tmp = strrchr(path, '/');
+    if (tmp) {
+        /* provided path includes a directory component */
+        ptrdiff_t d         = tmp - path;
+        new_entry->filename = strdup(tmp);
+        new_entry->root     = strndup(path, d);
+    } else {
+        /* target is in current directory */
+        new_entry->filename = strdup(path);
+        new_entry->root     = strdup("./");
+    }
+
+    new_entry->base = pmem_map_file(path, 0, 0, 0, &new_entry->mapped_len,
+                                    &new_entry->is_pmem);
+    if (!new_entry->base) {
+        BAKE_ERROR(provider->mid, "pmem_map_file(): %s on %s",
+                   strerror(errno), path);
+        ret = (errno == ENOENT) ? BAKE_ERR_NOENT : BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+    if (!new_entry->is_pmem)
+        BAKE_DEBUG(provider->mid,
+                   "target %s is not persistent memory; using msync()", path);
+
+    /* this descriptor is only used to release space on remove */
+    new_entry->fd = open(path, O_RDWR);
+
+    /* check to make sure the root is properly set */
+    new_entry->dax_root = (bake_root_t*)new_entry->base;
+    *target             = new_entry->dax_root->pool_id;
+    if (new_entry->mapped_len < BAKE_SUPERBLOCK_SIZE
+        || uuid_is_null(target->id)
+        || new_entry->dax_root->log_offset < BAKE_SUPERBLOCK_SIZE
+        || new_entry->dax_root->log_offset > new_entry->mapped_len) {
+        BAKE_ERROR(provider->mid, "pool %s is not properly formatted", path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+
+    ABT_mutex_create(&new_entry->log_offset_mutex);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+
+error_cleanup:
+    if (new_entry->base) pmem_unmap(new_entry->base, new_entry->mapped_len);
+    if (new_entry->fd > -1) close(new_entry->fd);
+    if (new_entry->filename) free(new_entry->filename);
+    if (new_entry->root) free(new_entry->root);
+    free(new_entry);
+    return (ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_dax_backend_finalize(backend_context_t context)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    pmem_unmap(entry->base, entry->mapped_len);
+    if (entry->fd > -1) close(entry->fd);
+    ABT_mutex_free(&entry->log_offset_mutex);
+    free(entry->filename);
+    free(entry->root);
+    free(entry);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_dax_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid->data;
+    size_t            aligned_size;
+    int               ret = BAKE_SUCCESS;
+
+    assert(sizeof(dax_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    aligned_size = BAKE_ALIGN_UP(size, entry->log_alignment);
+
+    /* The log tail lives in the superblock; it is persisted before the
+     * region id is handed out so that a restarted daemon will never hand
+     * out the same extent twice.
+     */
+    ABT_mutex_lock(entry->log_offset_mutex);
+    if (entry->dax_root->log_offset + aligned_size > entry->mapped_len) {
+        ret = BAKE_ERR_ALLOCATION;
+    } else {
+        drid->log_entry_offset = entry->dax_root->log_offset;
+        drid->log_entry_size   = size;
+        __atomic_add_fetch(&entry->dax_root->log_offset, aligned_size,
+                           __ATOMIC_RELEASE);
+        dax_persist(entry, &entry->dax_root->log_offset,
+                    sizeof(entry->dax_root->log_offset));
+    }
+    ABT_mutex_unlock(entry->log_offset_mutex);
+
+    return (ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_dax_write_raw(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size,
+                              const void*       data)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid.data;
+    char*             ptr;
+
+    ptr = dax_region_ptr(entry, drid, offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    memcpy(ptr, data, size);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_dax_write_bulk(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            region_offset,
+                               size_t            size,
+                               hg_bulk_t         bulk,
+                               hg_addr_t         source,
+                               size_t            bulk_offset)
+{
+    bake_dax_entry_t* entry       = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid        = (dax_region_id_t*)rid.data;
+    hg_bulk_t         bulk_handle = HG_BULK_NULL;
+    hg_size_t         bulk_size   = size;
+    hg_return_t       hret;
+    char*             ptr;
+    int               ret = BAKE_SUCCESS;
+
+    ptr = dax_region_ptr(entry, drid, region_offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* NOTE: there is no pipelining in this backend; the mapping is plain
+     * memory so the data is pulled directly into place.
+     */
+    hret = margo_bulk_create(entry->provider->mid, 1, (void**)(&ptr),
+                             &bulk_size, HG_BULK_WRITE_ONLY, &bulk_handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = margo_bulk_transfer(entry->provider->mid, HG_BULK_PULL, source,
+                               bulk, bulk_offset, bulk_handle, 0, bulk_size);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+finish:
+    margo_bulk_free(bulk_handle);
+    return (ret);
+}
+
+static int bake_dax_read_raw(backend_context_t context,
+                             bake_region_id_t  rid,
+                             size_t            offset,
+                             size_t            size,
+                             void**            data,
+                             uint64_t*         data_size,
+                             free_fn*          free_data)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid.data;
+    char*             ptr;
+
+    *free_data = NULL;
+    *data      = NULL;
+    *data_size = 0;
+
+    if (offset > drid->log_entry_size) return BAKE_ERR_OUT_OF_BOUNDS;
+    if (offset + size > drid->log_entry_size)
+        size = drid->log_entry_size - offset;
+
+    ptr = dax_region_ptr(entry, drid, offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* hand out a pointer straight into the mapping */
+    *data      = ptr;
+    *data_size = size;
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_dax_read_bulk(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            region_offset,
+                              size_t            size,
+                              hg_bulk_t         bulk,
+                              hg_addr_t         source,
+                              size_t            bulk_offset,
+                              size_t*           bytes_read)
+{
+    bake_dax_entry_t* entry       = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid        = (dax_region_id_t*)rid.data;
+    hg_bulk_t         bulk_handle = HG_BULK_NULL;
+    hg_size_t         size_to_read;
+    hg_return_t       hret;
+    char*             ptr;
+    int               ret = BAKE_SUCCESS;
+
+    *bytes_read = 0;
+
+    if (region_offset > drid->log_entry_size) return BAKE_ERR_OUT_OF_BOUNDS;
+    size_to_read = size;
+    if (region_offset + size > drid->log_entry_size)
+        size_to_read = drid->log_entry_size - region_offset;
+
+    ptr = dax_region_ptr(entry, drid, region_offset, size_to_read);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    hret = margo_bulk_create(entry->provider->mid, 1, (void**)(&ptr),
+                             &size_to_read, HG_BULK_READ_ONLY, &bulk_handle);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    hret = margo_bulk_transfer(entry->provider->mid, HG_BULK_PUSH, source, bulk,
+                               bulk_offset, bulk_handle, 0, size_to_read);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    *bytes_read = size_to_read;
+
+finish:
+    margo_bulk_free(bulk_handle);
+    return (ret);
+}
+
+static int bake_dax_persist(backend_context_t context,
+                            bake_region_id_t  rid,
+                            size_t            offset,
+                            size_t            size)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid.data;
+    char*             ptr;
+
+    ptr = dax_region_ptr(entry, drid, offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    dax_persist(entry, ptr, size);
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_dax_create_write_persist_raw(backend_context_t context,
+                                             const void*       data,
+                                             size_t            size,
+                                             bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_dax_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = bake_dax_write_raw(context, *rid, 0, size, data);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_dax_persist(context, *rid, 0, size);
+}
+
+static int bake_dax_create_write_persist_bulk(backend_context_t context,
+                                              hg_bulk_t         bulk,
+                                              hg_addr_t         source,
+                                              size_t            bulk_offset,
+                                              size_t            size,
+                                              bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_dax_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = bake_dax_write_bulk(context, *rid, 0, size, bulk, source,
+                              bulk_offset);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_dax_persist(context, *rid, 0, size);
+}
+
+static int bake_dax_get_region_size(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    size_t*           size)
+{
+    dax_region_id_t* drid = (dax_region_id_t*)rid.data;
+    *size                 = drid->log_entry_size;
+    return BAKE_SUCCESS;
+}
+
+static int bake_dax_get_region_data(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    void**            data)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid.data;
+
+    *data = dax_region_ptr(entry, drid, 0, 0);
+    if (!*data) return BAKE_ERR_UNKNOWN_REGION;
+    return BAKE_SUCCESS;
+}
+
+static int bake_dax_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid  = (dax_region_id_t*)rid.data;
+    long              page_size;
+    off_t             start, end;
+
+    if (!dax_region_ptr(entry, drid, 0, 0)) return BAKE_ERR_UNKNOWN_REGION;
+
+    /* As in the file backend, the log is never compacted.  We punch a hole
+     * over the whole pages covered by the region so that the file system
+     * can release them; neighboring regions may share the partial pages at
+     * either end, so those are left alone.  This is best effort (device
+     * dax, for instance, does not support it).
+     */
+    if (entry->fd < 0) return BAKE_SUCCESS;
+    page_size = sysconf(_SC_PAGESIZE);
+    start     = BAKE_ALIGN_UP(drid->log_entry_offset, page_size);
+    end       = BAKE_ALIGN_DOWN(drid->log_entry_offset + drid->log_entry_size,
+                          page_size);
+    if (end > start
+        && fallocate(entry->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                     start, end - start)
+               != 0)
+        BAKE_DEBUG(entry->provider->mid, "fallocate(): %s", strerror(errno));
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_dax_migrate_region(backend_context_t context,
+                                   bake_region_id_t  source_rid,
+                                   size_t            region_size,
+                                   int               remove_source,
+                                   const char*       dest_addr_str,
+                                   uint16_t          dest_provider_id,
+                                   bake_target_id_t  dest_target_id,
+                                   bake_region_id_t* dest_rid)
+{
+    bake_dax_entry_t* entry     = (bake_dax_entry_t*)context;
+    dax_region_id_t*  drid      = (dax_region_id_t*)source_rid.data;
+    hg_addr_t         dest_addr = HG_ADDR_NULL;
+    int               ret       = BAKE_SUCCESS;
+    char*             region_data;
+
+    /* find memory address for the region */
+    region_data = dax_region_ptr(entry, drid, 0, region_size);
+    if (!region_data) {
+        ret = BAKE_ERR_UNKNOWN_REGION;
+        goto finish;
+    }
+
+    if (region_size != drid->log_entry_size) {
+        ret = BAKE_ERR_INVALID_ARG;
+        goto finish;
+    }
+
+    /* lookup the address of the destination provider */
+    hg_return_t hret
+        = margo_addr_lookup(entry->provider->mid, dest_addr_str, &dest_addr);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    { /* the destination pulls the data directly from the mapping */
+        hg_bulk_t region_bulk = HG_BULK_NULL;
+
+        hret = margo_bulk_create(entry->provider->mid, 1,
+                                 (void**)(&region_data), &region_size,
+                                 HG_BULK_READ_ONLY, &region_bulk);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            goto finish;
+        }
+        ret = bake_backend_migrate_region(entry->provider, dest_addr,
+                                          dest_provider_id, dest_target_id,
+                                          region_bulk, region_size, dest_rid);
+        margo_bulk_free(region_bulk);
+    }
+
+    if (ret != BAKE_SUCCESS) goto finish;
+
+    if (remove_source) ret = bake_dax_remove(context, source_rid);
+
+finish:
+    margo_addr_free(entry->provider->mid, dest_addr);
+    return ret;
+}
+
+/* the target file is fully allocated when created, so the holes punched
+ * by removals are the difference between its size and its blocks
+ */
+static int bake_dax_get_stats(backend_context_t   context,
+                              struct json_object* stats)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    struct stat       statbuf;
+    uint64_t          used, holes = 0;
+
+    ABT_mutex_lock(entry->log_offset_mutex);
+    used = entry->dax_root->log_offset - BAKE_SUPERBLOCK_SIZE;
+    ABT_mutex_unlock(entry->log_offset_mutex);
+    if (entry->fd > -1 && fstat(entry->fd, &statbuf) == 0
+        && S_ISREG(statbuf.st_mode)
+        && (uint64_t)statbuf.st_blocks * 512 < entry->mapped_len)
+        holes = entry->mapped_len - (uint64_t)statbuf.st_blocks * 512;
+    used = used > holes ? used - holes : 0;
+    json_object_object_add(stats, "bytes_used", json_object_new_int64(used));
+
+    return BAKE_SUCCESS;
+}
+
+#ifdef USE_REMI
+static int bake_dax_create_fileset(backend_context_t context,
+                                   remi_fileset_t*   fileset)
+{
+    bake_dax_entry_t* entry = (bake_dax_entry_t*)context;
+    int               ret;
+    /* create a fileset */
+    ret = remi_fileset_create("bake", entry->root, fileset);
+    if (ret != REMI_SUCCESS) {
+        ret = BAKE_ERR_REMI;
+        goto error;
+    }
+
+    /* fill the fileset */
+    ret = remi_fileset_register_file(*fileset, entry->filename);
+    if (ret != REMI_SUCCESS) {
+        ret = BAKE_ERR_REMI;
+        goto error;
+    }
+
+finish:
+    return ret;
+error:
+    remi_fileset_free(*fileset);
+    *fileset = NULL;
+    goto finish;
+}
+#endif
+
+bake_backend g_bake_dax_backend = {
+    .name                       = "dax",
+    ._initialize                = bake_dax_backend_initialize,
+    ._finalize                  = bake_dax_backend_finalize,
+    ._create                    = bake_dax_create,
+    ._write_raw                 = bake_dax_write_raw,
+    ._write_bulk                = bake_dax_write_bulk,
+    ._read_raw                  = bake_dax_read_raw,
+    ._read_bulk                 = bake_dax_read_bulk,
+    ._persist                   = bake_dax_persist,
+    ._create_write_persist_raw  = bake_dax_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_dax_create_write_persist_bulk,
+    ._get_region_size           = bake_dax_get_region_size,
+    ._get_region_data           = bake_dax_get_region_data,
+    ._remove                    = bake_dax_remove,
+    ._migrate_region            = bake_dax_migrate_region,
+    ._create_raw_target         = bake_dax_makepool,
+    ._get_stats                 = bake_dax_get_stats,
+#ifdef USE_REMI
+    ._create_fileset = bake_dax_create_fileset,
+#endif
+};
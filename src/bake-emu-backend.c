@@ -0,0 +1,718 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <json-c/json.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+
+/* bake-emu-backend
+ *
+ * This is a stacking back end for the Bake provider.  It does not store
+ * anything itself; every operation is forwarded to another back end (the
+ * "inner" back end), named by the remainder of the target name, e.g.
+ * "emu:file:/tmp/foo.dat" wraps the file back end and "emu:/dev/shm/foo.dat"
+ * wraps the default pmem back end.  Before an operation is forwarded, the
+ * emulator delays it to mimic a slower device:
+ *
+ *  - each class of operation (create, read, write, persist, remove) has its
+ *    own latency distribution (constant, uniform, or exponential), with an
+ *    optional tail latency spike drawn with a given probability
+ *  - reads and writes are charged against a per-direction bandwidth cap;
+ *    transfers that would exceed it queue behind one another
+ *  - at most queue_depth operations are allowed into the inner back end
+ *    at a time; the others wait for a free slot
+ *
+ * This allows realistic local testing of clients and services (timeouts,
+ * backpressure, pipelining) on a laptop or in CI without the real hardware.
+ * The emulation parameters apply to all emu targets of a provider.
+ */
+
+#define EMU_OP_CREATE  0
+#define EMU_OP_READ    1
+#define EMU_OP_WRITE   2
+#define EMU_OP_PERSIST 3
+#define EMU_OP_REMOVE  4
+#define EMU_NUM_OPS    5
+
+#define EMU_DIST_CONSTANT    0
+#define EMU_DIST_UNIFORM     1
+#define EMU_DIST_EXPONENTIAL 2
+
+static const char* const emu_op_names[EMU_NUM_OPS]
+    = {"create_latency", "read_latency", "write_latency", "persist_latency",
+       "remove_latency"};
+
+/* latency distribution of one class of operation, in microseconds */
+typedef struct {
+    int    distribution;
+    double mean_us;
+    double spread_us;   /* half-width of the uniform distribution */
+    double spike_prob;  /* probability of adding a tail latency spike */
+    double spike_us;    /* duration of the spike */
+} emu_latency_t;
+
+typedef struct {
+    emu_latency_t latency[EMU_NUM_OPS];
+    double        read_bandwidth;  /* bytes/s; 0 means unlimited */
+    double        write_bandwidth; /* bytes/s; 0 means unlimited */
+    int64_t       queue_depth;     /* 0 means unlimited */
+} emu_params_t;
+
+typedef struct {
+    bake_provider_t   provider;
+    bake_backend_t    inner;         /* wrapped back end */
+    backend_context_t inner_context; /* context of the wrapped target */
+    free_fn           inner_free;    /* free function of inner read_raw */
+    emu_params_t      params;
+    unsigned int      seed;          /* random state, protected by mutex */
+    double            read_busy_until;  /* end of last reserved read */
+    double            write_busy_until; /* end of last reserved write */
+    int64_t           in_flight;        /* operations in the inner back end */
+    ABT_mutex         mutex;
+    ABT_cond          slot_cond; /* signaled when in_flight decreases */
+} bake_emu_entry_t;
+
+/* finds the back end wrapped by an emu target */
+static int emu_parse_inner(const char*     name,
+                           bake_backend_t* backend,
+                           const char**    path)
+{
+    *backend = bake_backend_parse_target(name, path);
+    if (!*backend) return BAKE_ERR_BACKEND_TYPE;
+    if (strcmp((*backend)->name, "emu") == 0) {
+        fprintf(stderr, "ERROR: emu backend cannot wrap itself\n");
+        return BAKE_ERR_BACKEND_TYPE;
+    }
+    return BAKE_SUCCESS;
+}
+
+/* reads a number (integer or floating point) from the configuration,
+ * adding the default value if it is not present; fails with
+ * BAKE_ERR_INVALID_ARG if it is not a non-negative number
+ */
+static int emu_config_number(struct json_object* config,
+                             const char*         key,
+                             double              default_value,
+                             const char*         fullname,
+                             double*             value)
+{
+    struct json_object* val = json_object_object_get(config, key);
+
+    if (!val) {
+        json_object_object_add(config, key,
+                               json_object_new_double(default_value));
+        *value = default_value;
+        return 0;
+    }
+    if (!json_object_is_type(val, json_type_double)
+        && !json_object_is_type(val, json_type_int)) {
+        fprintf(stderr,
+                "\"%s\" in configuration but has an incorrect type "
+                "(expected number)\n",
+                fullname);
+        return BAKE_ERR_INVALID_ARG;
+    }
+    *value = json_object_get_double(val);
+    if (*value < 0) {
+        fprintf(stderr, "\"%s\" in configuration must not be negative\n",
+                fullname);
+        return BAKE_ERR_INVALID_ARG;
+    }
+    return 0;
+}
+
+static int emu_config_latency(struct json_object* emu_backend_json,
+                              const char*         key,
+                              emu_latency_t*      latency)
+{
+    struct json_object* lat_json;
+    struct json_object* val;
+    const char*         dist;
+    char                fullname[128];
+
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s", key);
+    CONFIG_HAS_OR_CREATE_OBJECT(emu_backend_json, key, fullname, lat_json);
+
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s.distribution", key);
+    CONFIG_HAS_OR_CREATE(lat_json, string, "distribution", "constant",
+                         fullname, val);
+    dist = json_object_get_string(val);
+    if (strcmp(dist, "constant") == 0)
+        latency->distribution = EMU_DIST_CONSTANT;
+    else if (strcmp(dist, "uniform") == 0)
+        latency->distribution = EMU_DIST_UNIFORM;
+    else if (strcmp(dist, "exponential") == 0)
+        latency->distribution = EMU_DIST_EXPONENTIAL;
+    else {
+        fprintf(stderr, "unknown latency distribution \"%s\" for \"%s\"\n",
+                dist, fullname);
+        return BAKE_ERR_INVALID_ARG;
+    }
+
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s.mean_us", key);
+    if (emu_config_number(lat_json, "mean_us", 0, fullname, &latency->mean_us))
+        return BAKE_ERR_INVALID_ARG;
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s.spread_us", key);
+    if (emu_config_number(lat_json, "spread_us", 0, fullname,
+                          &latency->spread_us))
+        return BAKE_ERR_INVALID_ARG;
+    if (latency->spread_us > latency->mean_us)
+        latency->spread_us = latency->mean_us;
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s.spike_probability",
+             key);
+    if (emu_config_number(lat_json, "spike_probability", 0, fullname,
+                          &latency->spike_prob))
+        return BAKE_ERR_INVALID_ARG;
+    snprintf(fullname, sizeof(fullname), "emu_backend.%s.spike_us", key);
+    if (emu_config_number(lat_json, "spike_us", 0, fullname,
+                          &latency->spike_us))
+        return BAKE_ERR_INVALID_ARG;
+
+    return 0;
+}
+
+/* uniform random number in (0,1); caller must hold entry->mutex */
+static double emu_random(bake_emu_entry_t* entry)
+{
+    return ((double)rand_r(&entry->seed) + 0.5) / ((double)RAND_MAX + 1.0);
+}
+
+/* draws a latency (in seconds); caller must hold entry->mutex */
+static double emu_sample_latency(bake_emu_entry_t* entry, int op)
+{
+    emu_latency_t* lat = &entry->params.latency[op];
+    double         us  = 0;
+
+    switch (lat->distribution) {
+    case EMU_DIST_CONSTANT:
+        us = lat->mean_us;
+        break;
+    case EMU_DIST_UNIFORM:
+        us = lat->mean_us + lat->spread_us * (2 * emu_random(entry) - 1);
+        break;
+    case EMU_DIST_EXPONENTIAL:
+        us = -lat->mean_us * log(emu_random(entry));
+        break;
+    }
+    if (lat->spike_prob > 0 && emu_random(entry) < lat->spike_prob)
+        us += lat->spike_us;
+
+    return us / 1e6;
+}
+
+/* waits for a free slot in the emulated device queue, then sleeps for the
+ * latency of the operation plus the time needed to move "size" bytes
+ * through the emulated link
+ */
+static void emu_begin(bake_emu_entry_t* entry, const int* ops, int num_ops,
+                      size_t size, int is_write)
+{
+    double  now, delay = 0, bandwidth, start;
+    double* busy_until;
+    int     i;
+
+    ABT_mutex_lock(entry->mutex);
+    while (entry->params.queue_depth
+           && entry->in_flight >= entry->params.queue_depth)
+        ABT_cond_wait(entry->slot_cond, entry->mutex);
+    entry->in_flight++;
+
+    for (i = 0; i < num_ops; i++) delay += emu_sample_latency(entry, ops[i]);
+
+    now = ABT_get_wtime();
+    if (is_write) {
+        bandwidth  = entry->params.write_bandwidth;
+        busy_until = &entry->write_busy_until;
+    } else {
+        bandwidth  = entry->params.read_bandwidth;
+        busy_until = &entry->read_busy_until;
+    }
+    if (bandwidth > 0 && size > 0) {
+        /* transfers in the same direction are serialized on the link */
+        start       = *busy_until > now ? *busy_until : now;
+        *busy_until = start + (double)size / bandwidth;
+        delay += *busy_until - now;
+    }
+    ABT_mutex_unlock(entry->mutex);
+
+    if (delay > 0) margo_thread_sleep(entry->provider->mid, delay * 1e3);
+}
+
+static void emu_end(bake_emu_entry_t* entry)
+{
+    ABT_mutex_lock(entry->mutex);
+    entry->in_flight--;
+    ABT_cond_signal(entry->slot_cond);
+    ABT_mutex_unlock(entry->mutex);
+}
+
+static int bake_emu_makepool(const char* name, size_t size)
+{
+    bake_backend_t inner;
+    const char*    inner_path;
+    int            ret;
+
+    ret = emu_parse_inner(name, &inner, &inner_path);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return inner->_create_raw_target(inner_path, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_emu_backend_initialize(bake_provider_t    provider,
+                                       const char*        path,
+                                       bake_target_id_t*  target,
+                                       backend_context_t* context)
+{
+    bake_emu_entry_t*   new_entry;
+    bake_backend_t      inner;
+    backend_context_t   inner_context = NULL;
+    const char*         inner_path;
+    emu_params_t        params;
+    struct json_object* emu_backend_json = NULL;
+    struct json_object* target_array     = NULL;
+    struct json_object* val;
+    int                 i;
+    int                 ret;
+
+    memset(&params, 0, sizeof(params));
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "emu_backend",
+                                "emu_backend", emu_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(emu_backend_json, "targets",
+                               "emu_backend.targets", target_array);
+    for (i = 0; i < EMU_NUM_OPS; i++) {
+        if (emu_config_latency(emu_backend_json, emu_op_names[i],
+                               &params.latency[i]))
+            return BAKE_ERR_INVALID_ARG;
+    }
+    if (emu_config_number(emu_backend_json, "read_bandwidth", 0,
+                          "emu_backend.read_bandwidth", &params.read_bandwidth)
+        || emu_config_number(emu_backend_json, "write_bandwidth", 0,
+                             "emu_backend.write_bandwidth",
+                             &params.write_bandwidth))
+        return BAKE_ERR_INVALID_ARG;
+    CONFIG_HAS_OR_CREATE(emu_backend_json, int64, "queue_depth", 0,
+                         "emu_backend.queue_depth", val);
+    params.queue_depth = json_object_get_int64(val);
+    if (params.queue_depth < 0) params.queue_depth = 0;
+
+    ret = emu_parse_inner(path, &inner, &inner_path);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = inner->_initialize(provider, inner_path, target, &inner_context);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    /* the inner back end recorded the target in its own list of targets;
+     * it belongs to this back end, so that a provider created from this
+     * configuration wraps it again rather than opening it directly
+     */
+    bake_backend_unlist_target(provider, inner, inner_path);
+
+    new_entry                = calloc(1, sizeof(*new_entry));
+    new_entry->provider      = provider;
+    new_entry->inner         = inner;
+    new_entry->inner_context = inner_context;
+    new_entry->params        = params;
+    new_entry->seed          = (unsigned int)(ABT_get_wtime() * 1e6);
+    ABT_mutex_create(&new_entry->mutex);
+    ABT_cond_create(&new_entry->slot_cond);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_emu_backend_finalize(backend_context_t context)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    int               ret;
+
+    ret = entry->inner->_finalize(entry->inner_context);
+    ABT_cond_free(&entry->slot_cond);
+    ABT_mutex_free(&entry->mutex);
+    free(entry);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_emu_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_CREATE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = entry->inner->_create(entry->inner_context, size, rid);
+    emu_end(entry);
+
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_emu_write_raw(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size,
+                              const void*       data)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_WRITE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, size, 1);
+    ret = entry->inner->_write_raw(entry->inner_context, rid, offset, size,
+                                   data);
+    emu_end(entry);
+
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_emu_write_bulk(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            region_offset,
+                               size_t            size,
+                               hg_bulk_t         bulk,
+                               hg_addr_t         source,
+                               size_t            bulk_offset)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_WRITE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, size, 1);
+    ret = entry->inner->_write_bulk(entry->inner_context, rid, region_offset,
+                                    size, bulk, source, bulk_offset);
+    emu_end(entry);
+
+    return ret;
+}
+
+static void bake_emu_read_raw_free(backend_context_t context, void* ptr)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    entry->inner_free(entry->inner_context, ptr);
+}
+
+static int bake_emu_read_raw(backend_context_t context,
+                             bake_region_id_t  rid,
+                             size_t            offset,
+                             size_t            size,
+                             void**            data,
+                             uint64_t*         data_size,
+                             free_fn*          free_data)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_READ};
+    free_fn           inner_free = NULL;
+    int               ret;
+
+    emu_begin(entry, ops, 1, size, 0);
+    ret = entry->inner->_read_raw(entry->inner_context, rid, offset, size,
+                                  data, data_size, &inner_free);
+    emu_end(entry);
+
+    /* the free function of a back end does not change from one call to
+     * the next, so it can be remembered in the entry and called with the
+     * inner context when the provider releases the buffer
+     */
+    *free_data = NULL;
+    if (inner_free) {
+        entry->inner_free = inner_free;
+        *free_data        = bake_emu_read_raw_free;
+    }
+
+    return ret;
+}
+
+static int bake_emu_read_bulk(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            region_offset,
+                              size_t            size,
+                              hg_bulk_t         bulk,
+                              hg_addr_t         source,
+                              size_t            bulk_offset,
+                              size_t*           bytes_read)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_READ};
+    int               ret;
+
+    emu_begin(entry, ops, 1, size, 0);
+    ret = entry->inner->_read_bulk(entry->inner_context, rid, region_offset,
+                                   size, bulk, source, bulk_offset,
+                                   bytes_read);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_persist(backend_context_t context,
+                            bake_region_id_t  rid,
+                            size_t            offset,
+                            size_t            size)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_PERSIST};
+    int               ret;
+
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = entry->inner->_persist(entry->inner_context, rid, offset, size);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_create_write_persist_raw(backend_context_t context,
+                                             const void*       data,
+                                             size_t            size,
+                                             bake_region_id_t* rid)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    bake_backend_t    inner = entry->inner;
+    const int ops[]         = {EMU_OP_CREATE, EMU_OP_WRITE, EMU_OP_PERSIST};
+    int       ret;
+
+    /* charged as one operation in the emulated device queue */
+    emu_begin(entry, ops, 3, size, 1);
+    if (inner->_create_write_persist_raw) {
+        ret = inner->_create_write_persist_raw(entry->inner_context, data,
+                                               size, rid);
+    } else {
+        ret = inner->_create(entry->inner_context, size, rid);
+        if (ret == BAKE_SUCCESS)
+            ret = inner->_write_raw(entry->inner_context, *rid, 0, size, data);
+        if (ret == BAKE_SUCCESS)
+            ret = inner->_persist(entry->inner_context, *rid, 0, size);
+    }
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_create_write_persist_bulk(backend_context_t context,
+                                              hg_bulk_t         bulk,
+                                              hg_addr_t         source,
+                                              size_t            bulk_offset,
+                                              size_t            size,
+                                              bake_region_id_t* rid)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    bake_backend_t    inner = entry->inner;
+    const int ops[]         = {EMU_OP_CREATE, EMU_OP_WRITE, EMU_OP_PERSIST};
+    int       ret;
+
+    emu_begin(entry, ops, 3, size, 1);
+    if (inner->_create_write_persist_bulk) {
+        ret = inner->_create_write_persist_bulk(entry->inner_context, bulk,
+                                                source, bulk_offset, size, rid);
+    } else {
+        ret = inner->_create(entry->inner_context, size, rid);
+        if (ret == BAKE_SUCCESS)
+            ret = inner->_write_bulk(entry->inner_context, *rid, 0, size, bulk,
+                                     source, bulk_offset);
+        if (ret == BAKE_SUCCESS)
+            ret = inner->_persist(entry->inner_context, *rid, 0, size);
+    }
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_get_region_size(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    size_t*           size)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    return entry->inner->_get_region_size(entry->inner_context, rid, size);
+}
+
+static int bake_emu_get_region_data(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    void**            data)
+{
+    /* direct access to the data bypasses the emulated device */
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    return entry->inner->_get_region_data(entry->inner_context, rid, data);
+}
+
+static int bake_emu_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_REMOVE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = entry->inner->_remove(entry->inner_context, rid);
+    emu_end(entry);
+
+    return ret;
+}
+
+/* a batch costs the emulated device one operation, like it costs the
+ * inner back end one if it has batch hooks
+ */
+static int bake_emu_create_multi(backend_context_t context,
+                                 size_t            count,
+                                 const uint64_t*   sizes,
+                                 bake_region_id_t* rids)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_CREATE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = bake_backend_create_multi(entry->inner, entry->inner_context, 0,
+                                    count, sizes, rids);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_remove_multi(backend_context_t       context,
+                                 size_t                  count,
+                                 const bake_region_id_t* rids,
+                                 size_t*                 bytes_removed)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_REMOVE};
+    int               ret;
+
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = bake_backend_remove_multi(entry->inner, entry->inner_context, count,
+                                    rids, bytes_removed);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_create_group(backend_context_t context,
+                                 uint64_t          group,
+                                 size_t            count,
+                                 const uint64_t*   sizes,
+                                 bake_region_id_t* rids)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_CREATE};
+    int               ret;
+
+    if (!entry->inner->_create_group) return BAKE_ERR_OP_UNSUPPORTED;
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = entry->inner->_create_group(entry->inner_context, group, count,
+                                      sizes, rids);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_remove_group(backend_context_t context,
+                                 uint64_t          group,
+                                 size_t*           bytes_removed)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_REMOVE};
+    int               ret;
+
+    *bytes_removed = 0;
+    if (!entry->inner->_remove_group) return BAKE_ERR_OP_UNSUPPORTED;
+    emu_begin(entry, ops, 1, 0, 1);
+    ret = entry->inner->_remove_group(entry->inner_context, group,
+                                      bytes_removed);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_migrate_region(backend_context_t context,
+                                   bake_region_id_t  source_rid,
+                                   size_t            region_size,
+                                   int               remove_source,
+                                   const char*       dest_addr_str,
+                                   uint16_t          dest_provider_id,
+                                   bake_target_id_t  dest_target_id,
+                                   bake_region_id_t* dest_rid)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    const int         ops[] = {EMU_OP_READ};
+    int               ret;
+
+    /* the source region is read out of the emulated device */
+    emu_begin(entry, ops, 1, region_size, 0);
+    ret = entry->inner->_migrate_region(
+        entry->inner_context, source_rid, region_size, remove_source,
+        dest_addr_str, dest_provider_id, dest_target_id, dest_rid);
+    emu_end(entry);
+
+    return ret;
+}
+
+static int bake_emu_get_stats(backend_context_t   context,
+                              struct json_object* stats)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    if (!entry->inner->_get_stats) return BAKE_ERR_OP_UNSUPPORTED;
+    return entry->inner->_get_stats(entry->inner_context, stats);
+}
+
+static int bake_emu_reconfigure(backend_context_t context)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    if (!entry->inner->_reconfigure) return BAKE_SUCCESS;
+    return entry->inner->_reconfigure(entry->inner_context);
+}
+
+#ifdef USE_REMI
+static int bake_emu_create_fileset(backend_context_t context,
+                                   remi_fileset_t*   fileset)
+{
+    bake_emu_entry_t* entry = (bake_emu_entry_t*)context;
+    return entry->inner->_create_fileset(entry->inner_context, fileset);
+}
+#endif
+
+bake_backend g_bake_emu_backend = {
+    .name                       = "emu",
+    ._initialize                = bake_emu_backend_initialize,
+    ._finalize                  = bake_emu_backend_finalize,
+    ._create                    = bake_emu_create,
+    ._write_raw                 = bake_emu_write_raw,
+    ._write_bulk                = bake_emu_write_bulk,
+    ._read_raw                  = bake_emu_read_raw,
+    ._read_bulk                 = bake_emu_read_bulk,
+    ._persist                   = bake_emu_persist,
+    ._create_write_persist_raw  = bake_emu_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_emu_create_write_persist_bulk,
+    ._get_region_size           = bake_emu_get_region_size,
+    ._get_region_data           = bake_emu_get_region_data,
+    ._remove                    = bake_emu_remove,
+    ._migrate_region            = bake_emu_migrate_region,
+    ._create_raw_target         = bake_emu_makepool,
+    ._get_stats                 = bake_emu_get_stats,
+    ._reconfigure               = bake_emu_reconfigure,
+    ._create_multi              = bake_emu_create_multi,
+    ._remove_multi              = bake_emu_remove_multi,
+    ._create_group              = bake_emu_create_group,
+    ._remove_group              = bake_emu_remove_group,
+#ifdef USE_REMI
+    ._create_fileset = bake_emu_create_fileset,
+#endif
+};
@@ -20,6 +20,8 @@
 #include "bake-provider.h"
 #include "bake-backend.h"
 #include "bake-macros.h"
+#include "bake-io-engine.h"
+#include "bake-file-backend.h"
 
 /* bake-file-backend
  *
@@ -48,16 +50,23 @@ typedef struct {
     bake_target_id_t pool_id;
 } bake_root_t;
 
-/* definition of internal BAKE region_id_t identifier for file back end */
-typedef struct {
-    off_t  log_entry_offset;
-    size_t log_entry_size;
-} file_region_id_t;
-
 typedef struct {
     char data[1];
 } region_content_t;
 
+/* record of the group index of a target, which lists the log extents of
+ * the regions created with a group, one extent per batch since a batch is
+ * contiguous in the log; removing a group punches its extents and clears
+ * its records
+ */
+typedef struct {
+    uint64_t group; /* 0 once removed */
+    off_t    offset;
+    size_t   size;
+} file_group_extent_t;
+
+#define BAKE_GROUPS_SUFFIX ".groups"
+
 typedef struct {
     bake_provider_t provider;
     int             log_fd;        /* file descriptor for log */
@@ -67,38 +76,19 @@ typedef struct {
     ABT_mutex log_offset_mutex; /* protects the above during concurrent region
                                    creation */
     abt_io_instance_id abtioi;  /* abt-io instance used by this provider */
+    bake_io_queue_t    ioq;     /* on the shared I/O engine, or NULL */
+    int                groups_fd;     /* group index, next to the log */
+    off_t              groups_offset; /* end of the group index */
+    ABT_mutex          groups_mutex;  /* protects the above two */
     bake_root_t*       file_root;
     char*              root;
     char*              filename;
 } bake_file_entry_t;
 
+/* where in the log a pipelined transfer relays its chunks */
 typedef struct xfer_args {
-    /* information about underlying target */
     bake_file_entry_t* entry;
-
-    /* information about remote host */
-    hg_addr_t remote_addr;   /* remote address */
-    hg_bulk_t remote_bulk;   /* remote bulk handle for transfers */
-    size_t    remote_offset; /* remote offset at which to take the data */
-
-    /* state of region to be accessed in local log */
-    off_t  log_entry_offset; /* log extent to access */
-    size_t log_entry_size;   /* log extent to access */
-    size_t log_issued;       /* log accesses issued (bytes) */
-    size_t log_retired;      /* log accesses retired (bytes) */
-
-    /* state of network transmission */
-    size_t transmit_size;          /* total amount of data to xmit */
-    off_t  transmit_offset_in_log; /* what position in log to xmit first */
-    size_t transmit_issued;        /* number of xmit bytes issued */
-    size_t poolset_max_size;       /* max xmit size supported by poolset */
-
-    /* state of transfer as a whole */
-    int32_t      ret;         /* return code (0 on success) */
-    int          ults_active; /* number of ULTs working on this xfer */
-    ABT_mutex    mutex;       /* protect shared fields in this struct */
-    ABT_eventual eventual;    /* signal when complete */
-    int          op_flag;     /* read or write */
+    off_t              log_offset; /* aligned start of the log extent */
 } xfer_args;
 
 static int transfer_data(bake_file_entry_t* entry,
@@ -111,7 +101,98 @@ static int transfer_data(bake_file_entry_t* entry,
                          hg_addr_t          src_addr,
                          int                op_flag);
 
-static void xfer_ult(void* _args);
+/* abt-io operations on the log of a target, which take their turn on the
+ * shared I/O engine if the target uses it
+ */
+static ssize_t
+file_pread(bake_file_entry_t* entry, void* buf, size_t count, off_t offset)
+{
+    ssize_t ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_pread(entry->abtioi, entry->log_fd, buf, count, offset);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static ssize_t file_pwrite(bake_file_entry_t* entry,
+                           const void*        buf,
+                           size_t             count,
+                           off_t              offset)
+{
+    ssize_t ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_pwrite(entry->abtioi, entry->log_fd, buf, count, offset);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static int file_fdatasync(bake_file_entry_t* entry)
+{
+    int ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_fdatasync(entry->abtioi, entry->log_fd);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+/* same, on the group index of the target */
+static ssize_t
+groups_pread(bake_file_entry_t* entry, void* buf, size_t count, off_t offset)
+{
+    ssize_t ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_pread(entry->abtioi, entry->groups_fd, buf, count, offset);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static ssize_t groups_pwrite(bake_file_entry_t* entry,
+                             const void*        buf,
+                             size_t             count,
+                             off_t              offset)
+{
+    ssize_t ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_pwrite(entry->abtioi, entry->groups_fd, buf, count, offset);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static int groups_fdatasync(bake_file_entry_t* entry)
+{
+    int ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_fdatasync(entry->abtioi, entry->groups_fd);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static int groups_ftruncate(bake_file_entry_t* entry, off_t length)
+{
+    int ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_ftruncate(entry->abtioi, entry->groups_fd, length);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
+
+static int
+file_fallocate(bake_file_entry_t* entry, int mode, off_t offset, off_t len)
+{
+    int ret;
+
+    bake_io_enter(entry->ioq);
+    ret = abt_io_fallocate(entry->abtioi, entry->log_fd, mode, offset, len);
+    bake_io_leave(entry->ioq);
+    return ret;
+}
 
 static int bake_file_makepool(const char* file_name, size_t file_size)
 {
@@ -165,9 +246,11 @@ static int bake_file_backend_initialize(bake_provider_t    provider,
     bake_file_entry_t* new_entry = calloc(1, sizeof(*new_entry));
     new_entry->provider          = provider;
     new_entry->log_fd            = -1;
+    new_entry->groups_fd         = -1;
     const char*         tmp;
     ptrdiff_t           d;
     struct stat         statbuf;
+    char*               groups_path = NULL;
     struct json_object* file_backend_json = NULL;
     struct json_object* target_array      = NULL;
     struct json_object* val;
@@ -211,17 +294,27 @@ static int bake_file_backend_initialize(bake_provider_t    provider,
         goto error_cleanup;
     } else if (provider->aid) {
         new_entry->abtioi = provider->aid;
-    } else {
-        CONFIG_HAS_OR_CREATE(file_backend_json, int64, "abtio_nthreads", 16,
-                             "file_backend.abtio_nthreads", val);
-
+    } else if (CONFIG_HAS(file_backend_json, "abtio_nthreads", val)) {
         /* initialize an abt-io instance just for this target */
-        new_entry->abtioi = abt_io_init(json_object_get_int(
-            json_object_object_get(file_backend_json, "abtio_nthreads")));
+        new_entry->abtioi = abt_io_init(json_object_get_int(val));
         if (!new_entry->abtioi) {
             ret = BAKE_ERR_IO;
             goto error_cleanup;
         }
+    } else {
+        /* go through the I/O engine shared by the targets of the process,
+         * which runs up to io_max_threads execution streams
+         */
+        CONFIG_HAS_OR_CREATE(file_backend_json, int64, "io_max_threads", 16,
+                             "file_backend.io_max_threads", val);
+        if (json_object_get_int(val) <= 0) {
+            BAKE_ERROR(provider->mid, "io_max_threads must be positive");
+            ret = BAKE_ERR_INVALID_ARG;
+            goto error_cleanup;
+        }
+        ret = bake_io_queue_open(json_object_get_int(val), &new_entry->ioq);
+        if (ret != BAKE_SUCCESS) goto error_cleanup;
+        new_entry->abtioi = bake_io_queue_abtio(new_entry->ioq);
     }
 
     tmp = strrchr(path, '/');
@@ -276,6 +369,34 @@ static int bake_file_backend_initialize(bake_provider_t    provider,
     ABT_mutex_create(&new_entry->log_offset_mutex);
     new_entry->log_offset = statbuf.st_size;
 
+    /* the group index sits next to the log; targets made before groups
+     * existed get an empty one
+     */
+    groups_path = malloc(strlen(path) + sizeof(BAKE_GROUPS_SUFFIX));
+    if (!groups_path) {
+        ret = BAKE_ERR_ALLOCATION;
+        goto error_cleanup;
+    }
+    sprintf(groups_path, "%s%s", path, BAKE_GROUPS_SUFFIX);
+    new_entry->groups_fd
+        = abt_io_open(new_entry->abtioi, groups_path, O_RDWR | O_CREAT, 0644);
+    free(groups_path);
+    if (new_entry->groups_fd < 0) {
+        BAKE_ERROR(provider->mid, "open(): %s on group index of %s",
+                   strerror(-new_entry->groups_fd), path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+    ret = fstat(new_entry->groups_fd, &statbuf);
+    if (ret < 0) {
+        perror("fstat");
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+    ABT_mutex_create(&new_entry->groups_mutex);
+    new_entry->groups_offset = statbuf.st_size
+                             - statbuf.st_size % sizeof(file_group_extent_t);
+
     /* check to make sure the root is properly set */
     ret = posix_memalign((void**)(&new_entry->file_root), BAKE_SUPERBLOCK_SIZE,
                          BAKE_SUPERBLOCK_SIZE);
@@ -283,8 +404,7 @@ static int bake_file_backend_initialize(bake_provider_t    provider,
         ret = BAKE_ERR_IO;
         goto error_cleanup;
     }
-    ret = abt_io_pread(new_entry->abtioi, new_entry->log_fd,
-                       new_entry->file_root, BAKE_SUPERBLOCK_SIZE, 0);
+    ret = file_pread(new_entry, new_entry->file_root, BAKE_SUPERBLOCK_SIZE, 0);
     if (ret < 0) {
         ret = BAKE_ERR_IO;
         goto error_cleanup;
@@ -337,7 +457,11 @@ error_cleanup:
     if (new_entry) {
         if (new_entry->file_root) free(new_entry->file_root);
         if (new_entry->log_fd > -1) close(new_entry->log_fd);
-        if (new_entry->abtioi && new_entry->abtioi != provider->aid)
+        if (new_entry->groups_fd > -1) close(new_entry->groups_fd);
+        if (new_entry->groups_mutex) ABT_mutex_free(&new_entry->groups_mutex);
+        if (new_entry->ioq)
+            bake_io_queue_close(new_entry->ioq);
+        else if (new_entry->abtioi && new_entry->abtioi != provider->aid)
             abt_io_finalize(new_entry->abtioi);
         if (new_entry->filename) free(new_entry->filename);
         if (new_entry->root) free(new_entry->root);
@@ -352,9 +476,13 @@ static int bake_file_backend_finalize(backend_context_t context)
     bake_file_entry_t* entry = (bake_file_entry_t*)context;
     free(entry->file_root);
     close(entry->log_fd);
-    if (entry->abtioi && entry->abtioi != entry->provider->aid)
+    close(entry->groups_fd);
+    if (entry->ioq)
+        bake_io_queue_close(entry->ioq);
+    else if (entry->abtioi && entry->abtioi != entry->provider->aid)
         abt_io_finalize(entry->abtioi);
     ABT_mutex_free(&entry->log_offset_mutex);
+    ABT_mutex_free(&entry->groups_mutex);
     free(entry->filename);
     free(entry->root);
     free(entry);
@@ -362,6 +490,42 @@ static int bake_file_backend_finalize(backend_context_t context)
     return BAKE_SUCCESS;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_file_reconfigure(backend_context_t context)
+{
+    bake_file_entry_t*  entry = (bake_file_entry_t*)context;
+    struct json_object* file_backend_json
+        = json_object_object_get(entry->provider->json_cfg, "file_backend");
+    struct json_object* val;
+    int                 ret;
+
+    /* transfers go through the pipeline, which must stay on */
+    if (!json_object_get_boolean(json_object_object_get(
+            entry->provider->json_cfg, "pipeline_enable"))) {
+        BAKE_ERROR(entry->provider->mid,
+                   "the bake file backend requires pipelining");
+        return BAKE_ERR_INVALID_ARG;
+    }
+
+    /* the thread count of an abt-io instance of our own, or of the one
+     * given to the provider, cannot change once it runs; that of the
+     * queue of the target on the shared engine only bounds this target
+     */
+    val = json_object_object_get(file_backend_json, "io_max_threads");
+    if (val && json_object_get_int(val) <= 0) return BAKE_ERR_INVALID_ARG;
+    if (entry->ioq && val) {
+        ret = bake_io_queue_set_max_threads(entry->ioq,
+                                            json_object_get_int(val));
+        if (ret != BAKE_SUCCESS) return ret;
+    }
+
+    /* only read by operations that start after this point */
+    entry->sync = json_object_get_boolean(
+        json_object_object_get(file_backend_json, "sync"));
+
+    return BAKE_SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 static int
 bake_file_create(backend_context_t context, size_t size, bake_region_id_t* rid)
@@ -399,16 +563,15 @@ bake_file_create(backend_context_t context, size_t size, bake_region_id_t* rid)
                          entry->log_alignment);
     if (ret != 0) return (BAKE_ERR_IO);
 
-    ret = abt_io_pwrite(entry->abtioi, entry->log_fd, zero_block,
-                        entry->log_alignment,
-                        entry->log_offset - entry->log_alignment);
+    ret = file_pwrite(entry, zero_block, entry->log_alignment,
+                      entry->log_offset - entry->log_alignment);
     if (ret != entry->log_alignment) {
         free(zero_block);
         return (BAKE_ERR_IO);
     }
 
     if (entry->sync) {
-        ret = abt_io_fdatasync(entry->abtioi, entry->log_fd);
+        ret = file_fdatasync(entry);
         if (ret != 0) {
             free(zero_block);
             return (BAKE_ERR_IO);
@@ -464,10 +627,10 @@ static int bake_file_write_raw(backend_context_t context,
 
     memcpy(bounce_buffer, data, size);
 
-    ret = abt_io_pwrite(entry->abtioi, entry->log_fd, bounce_buffer,
-                        BAKE_ALIGN_UP(size, entry->log_alignment),
-                        frid->log_entry_offset);
-    if (ret != entry->log_alignment) {
+    ret = file_pwrite(entry, bounce_buffer,
+                      BAKE_ALIGN_UP(size, entry->log_alignment),
+                      frid->log_entry_offset);
+    if (ret != BAKE_ALIGN_UP(size, entry->log_alignment)) {
         free(bounce_buffer);
         return (BAKE_ERR_IO);
     }
@@ -565,9 +728,9 @@ static int bake_file_read_raw(backend_context_t context,
     if (ret != 0) return (BAKE_ERR_IO);
 
     /* read extent from log */
-    ret = abt_io_pread(entry->abtioi, entry->log_fd, bounce_buffer,
-                       log_offset_end - log_offset_start, log_offset_start);
-    if (ret != entry->log_alignment) {
+    ret = file_pread(entry, bounce_buffer, log_offset_end - log_offset_start,
+                     log_offset_start);
+    if (ret != log_offset_end - log_offset_start) {
         free(bounce_buffer);
         return (BAKE_ERR_IO);
     }
@@ -624,7 +787,7 @@ static int bake_file_persist(backend_context_t context,
          * portable function that can be used to sync portion of a log; we have
          * to sync the whole thing.
          */
-        ret = abt_io_fdatasync(entry->abtioi, entry->log_fd);
+        ret = file_fdatasync(entry);
         if (ret != 0) return (BAKE_ERR_IO);
     }
 
@@ -635,7 +798,9 @@ static int bake_file_get_region_size(backend_context_t context,
                                      bake_region_id_t  rid,
                                      size_t*           size)
 {
-    return BAKE_ERR_OP_UNSUPPORTED;
+    file_region_id_t* frid = (file_region_id_t*)rid.data;
+    *size                  = frid->log_entry_size;
+    return BAKE_SUCCESS;
 }
 
 static int bake_file_get_region_data(backend_context_t context,
@@ -666,10 +831,238 @@ static int bake_file_remove(backend_context_t context, bake_region_id_t rid)
      * The log could be defragmented, but that would be a higher level
      * opertion.
      */
-    ret = abt_io_fallocate(entry->abtioi, entry->log_fd,
-                           FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
-                           frid->log_entry_offset, frid->log_entry_size);
+    ret = file_fallocate(entry, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                         frid->log_entry_offset, frid->log_entry_size);
+
+    return (ret);
+}
+
+/* lays all the regions out back to back in a single extent of the log,
+ * extending the log with one block write and sync for all of them, see
+ * bake_file_create()
+ */
+static int bake_file_create_multi(backend_context_t context,
+                                  size_t            count,
+                                  const uint64_t*   sizes,
+                                  bake_region_id_t* rids)
+{
+    bake_file_entry_t* entry = (bake_file_entry_t*)context;
+    file_region_id_t*  frid;
+    off_t              offset;
+    size_t             i, size = 0;
+    void*              zero_block;
+    int                ret;
+
+    assert(sizeof(file_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    for (i = 0; i < count; i++)
+        size += BAKE_ALIGN_UP(sizes[i], entry->log_alignment);
+
+    ABT_mutex_lock(entry->log_offset_mutex);
+    offset = entry->log_offset;
+    entry->log_offset += size;
+    ABT_mutex_unlock(entry->log_offset_mutex);
+
+    for (i = 0; i < count; i++) {
+        frid                   = (file_region_id_t*)rids[i].data;
+        frid->log_entry_offset = offset;
+        frid->log_entry_size = BAKE_ALIGN_UP(sizes[i], entry->log_alignment);
+        offset += frid->log_entry_size;
+    }
+    if (size == 0) return (BAKE_SUCCESS);
+
+    ret = posix_memalign(&zero_block, entry->log_alignment,
+                         entry->log_alignment);
+    if (ret != 0) return (BAKE_ERR_IO);
+
+    ret = file_pwrite(entry, zero_block, entry->log_alignment,
+                      offset - entry->log_alignment);
+    if (ret != entry->log_alignment) {
+        free(zero_block);
+        return (BAKE_ERR_IO);
+    }
+
+    if (entry->sync) {
+        ret = file_fdatasync(entry);
+        if (ret != 0) {
+            free(zero_block);
+            return (BAKE_ERR_IO);
+        }
+    }
+
+    free(zero_block);
+    return (BAKE_SUCCESS);
+}
+
+static int compare_log_entries(const void* a, const void* b)
+{
+    const file_region_id_t* fa = a;
+    const file_region_id_t* fb = b;
+
+    return (fa->log_entry_offset > fb->log_entry_offset)
+         - (fa->log_entry_offset < fb->log_entry_offset);
+}
+
+/* punches one hole per run of adjacent log extents, and reports the size
+ * of the extents of the runs punched
+ */
+static int punch_extents(bake_file_entry_t* entry,
+                         file_region_id_t*  extents,
+                         size_t             count,
+                         size_t*            bytes_punched)
+{
+    off_t  start, end;
+    size_t i, j, k, size;
+    int    ret = 0, r;
+
+    qsort(extents, count, sizeof(*extents), compare_log_entries);
+
+    *bytes_punched = 0;
+    for (i = 0; i < count; i = j) {
+        start = extents[i].log_entry_offset;
+        end   = start + extents[i].log_entry_size;
+        for (j = i + 1; j < count && extents[j].log_entry_offset <= end; j++) {
+            if (extents[j].log_entry_offset + extents[j].log_entry_size > end)
+                end = extents[j].log_entry_offset + extents[j].log_entry_size;
+        }
+        r = end == start
+              ? 0
+              : file_fallocate(entry,
+                               FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                               start, end - start);
+        if (r == 0) {
+            for (k = i, size = 0; k < j; k++)
+                size += extents[k].log_entry_size;
+            *bytes_punched += size;
+        }
+        if (ret == 0) ret = r;
+    }
+    return (ret);
+}
+
+/* punches one hole for each run of adjacent regions, which regions created
+ * together usually are, rather than one per region; see bake_file_remove()
+ */
+static int bake_file_remove_multi(backend_context_t       context,
+                                  size_t                  count,
+                                  const bake_region_id_t* rids,
+                                  size_t*                 bytes_removed)
+{
+    bake_file_entry_t* entry = (bake_file_entry_t*)context;
+    file_region_id_t*  extents;
+    size_t             i;
+    int                ret;
+
+    *bytes_removed = 0;
+    if (count == 0) return BAKE_SUCCESS;
+    extents = malloc(count * sizeof(*extents));
+    if (!extents) return BAKE_ERR_ALLOCATION;
+    for (i = 0; i < count; i++)
+        extents[i] = *(const file_region_id_t*)rids[i].data;
+    ret = punch_extents(entry, extents, count, bytes_removed);
+
+    free(extents);
+    return (ret);
+}
+
+static int bake_file_create_group(backend_context_t context,
+                                  uint64_t          group,
+                                  size_t            count,
+                                  const uint64_t*   sizes,
+                                  bake_region_id_t* rids)
+{
+    bake_file_entry_t*  entry = (bake_file_entry_t*)context;
+    file_group_extent_t extent;
+    file_region_id_t*   first;
+    file_region_id_t*   last;
+    ssize_t             written;
+    size_t              removed;
+    int                 ret;
+
+    ret = bake_file_create_multi(context, count, sizes, rids);
+    if (ret != BAKE_SUCCESS || count == 0) return (ret);
+
+    /* the regions of the batch follow each other in the log */
+    first         = (file_region_id_t*)rids[0].data;
+    last          = (file_region_id_t*)rids[count - 1].data;
+    extent.group  = group;
+    extent.offset = first->log_entry_offset;
+    extent.size
+        = last->log_entry_offset + last->log_entry_size - extent.offset;
+
+    ABT_mutex_lock(entry->groups_mutex);
+    written = groups_pwrite(entry, &extent, sizeof(extent),
+                            entry->groups_offset);
+    if (written == sizeof(extent)) entry->groups_offset += sizeof(extent);
+    ABT_mutex_unlock(entry->groups_mutex);
+
+    if (written != sizeof(extent)
+        || (entry->sync && groups_fdatasync(entry) != 0)) {
+        bake_file_remove_multi(context, count, rids, &removed);
+        return (BAKE_ERR_IO);
+    }
+    return (BAKE_SUCCESS);
+}
+
+static int bake_file_remove_group(backend_context_t context,
+                                  uint64_t          group,
+                                  size_t*           bytes_removed)
+{
+    bake_file_entry_t*   entry   = (bake_file_entry_t*)context;
+    file_group_extent_t* records = NULL;
+    file_region_id_t*    extents = NULL;
+    size_t               i, count, n = 0, live = 0;
+    int                  ret = BAKE_SUCCESS;
+
+    *bytes_removed = 0;
+    ABT_mutex_lock(entry->groups_mutex);
+    count = entry->groups_offset / sizeof(*records);
+    if (count == 0) goto finish;
+
+    records = malloc(count * sizeof(*records));
+    extents = malloc(count * sizeof(*extents));
+    if (!records || !extents) {
+        ret = BAKE_ERR_ALLOCATION;
+        goto finish;
+    }
+    if (groups_pread(entry, records, count * sizeof(*records), 0)
+        != (ssize_t)(count * sizeof(*records))) {
+        ret = BAKE_ERR_IO;
+        goto finish;
+    }
+    for (i = 0; i < count; i++) {
+        if (records[i].group != group) {
+            if (records[i].group) live = i + 1;
+            continue;
+        }
+        extents[n].log_entry_offset = records[i].offset;
+        extents[n].log_entry_size   = records[i].size;
+        records[i].group            = 0;
+        n++;
+    }
+    if (n == 0) goto finish;
+
+    ret = punch_extents(entry, extents, n, bytes_removed);
+    if (ret != 0) goto finish;
+
+    /* clear the records of the group, dropping the cleared records at the
+     * end of the index; punching an extent again is harmless, should we
+     * stop in between
+     */
+    if ((live
+         && groups_pwrite(entry, records, live * sizeof(*records), 0)
+                != (ssize_t)(live * sizeof(*records)))
+        || groups_ftruncate(entry, live * sizeof(*records)) != 0
+        || (entry->sync && groups_fdatasync(entry) != 0)) {
+        ret = BAKE_ERR_IO;
+        goto finish;
+    }
+    entry->groups_offset = live * sizeof(*records);
 
+finish:
+    ABT_mutex_unlock(entry->groups_mutex);
+    free(records);
+    free(extents);
     return (ret);
 }
 
@@ -685,11 +1078,35 @@ static int bake_file_migrate_region(backend_context_t context,
     return BAKE_ERR_OP_UNSUPPORTED;
 }
 
+/* the log is never compacted, but removed regions are punched out of it,
+ * so the blocks allocated to the file past the superblock are those of
+ * live regions
+ */
+static int bake_file_get_stats(backend_context_t   context,
+                               struct json_object* stats)
+{
+    bake_file_entry_t* entry = (bake_file_entry_t*)context;
+    struct stat        statbuf;
+    uint64_t           used = 0;
+
+    if (fstat(entry->log_fd, &statbuf) != 0) return BAKE_ERR_IO;
+    if ((uint64_t)statbuf.st_blocks * 512 > BAKE_SUPERBLOCK_SIZE)
+        used = (uint64_t)statbuf.st_blocks * 512 - BAKE_SUPERBLOCK_SIZE;
+    json_object_object_add(stats, "bytes_used", json_object_new_int64(used));
+    if (entry->ioq)
+        json_object_object_add(
+            stats, "io_max_threads",
+            json_object_new_int64(bake_io_queue_max_threads(entry->ioq)));
+
+    return BAKE_SUCCESS;
+}
+
 #ifdef USE_REMI
 static int bake_file_create_fileset(backend_context_t context,
                                     remi_fileset_t*   fileset)
 {
     bake_file_entry_t* entry = (bake_file_entry_t*)context;
+    char*              groups_file;
     int                ret;
     /* create a fileset */
     ret = remi_fileset_create("bake", entry->root, fileset);
@@ -704,6 +1121,18 @@ static int bake_file_create_fileset(backend_context_t context,
         ret = BAKE_ERR_REMI;
         goto error;
     }
+    groups_file = malloc(strlen(entry->filename) + sizeof(BAKE_GROUPS_SUFFIX));
+    if (!groups_file) {
+        ret = BAKE_ERR_ALLOCATION;
+        goto error;
+    }
+    sprintf(groups_file, "%s%s", entry->filename, BAKE_GROUPS_SUFFIX);
+    ret = remi_fileset_register_file(*fileset, groups_file);
+    free(groups_file);
+    if (ret != REMI_SUCCESS) {
+        ret = BAKE_ERR_REMI;
+        goto error;
+    }
 
 finish:
     return ret;
@@ -731,12 +1160,49 @@ bake_backend g_bake_file_backend = {
     ._remove                    = bake_file_remove,
     ._migrate_region            = bake_file_migrate_region,
     ._create_raw_target         = bake_file_makepool,
+    ._get_stats                 = bake_file_get_stats,
+    ._reconfigure               = bake_file_reconfigure,
+    ._create_multi              = bake_file_create_multi,
+    ._remove_multi              = bake_file_remove_multi,
+    ._create_group              = bake_file_create_group,
+    ._remove_group              = bake_file_remove_group,
 #ifdef USE_REMI
     ._create_fileset = bake_file_create_fileset,
 #endif
 };
 
-/* common utility function for relaying data in read_bulk/write_bulk */
+/* relays of pipeline chunks to and from the log */
+static int xfer_write(void* arg, void* buffer, size_t offset, size_t size)
+{
+    struct xfer_args* args = arg;
+
+    /* pool buffers are supposed to be page aligned already.  Just
+     * safety checking here.
+     */
+    assert((long unsigned)buffer % 4096 == 0);
+
+    if (file_pwrite(args->entry, buffer, size, args->log_offset + offset)
+        != size)
+        return BAKE_ERR_IO;
+    return BAKE_SUCCESS;
+}
+
+static int xfer_read(void* arg, void* buffer, size_t offset, size_t size)
+{
+    struct xfer_args* args = arg;
+
+    assert((long unsigned)buffer % 4096 == 0);
+
+    if (file_pread(args->entry, buffer, size, args->log_offset + offset)
+        != size)
+        return BAKE_ERR_IO;
+    return BAKE_SUCCESS;
+}
+
+/* common utility function for relaying data in read_bulk/write_bulk.
+ * File alignment is stricter (because we are using directio), so the log
+ * extent that is accessed is a superset of the data to be transmitted.
+ */
 static int transfer_data(bake_file_entry_t* entry,
                          off_t              log_entry_offset,
                          size_t             log_entry_size,
@@ -749,7 +1215,6 @@ static int transfer_data(bake_file_entry_t* entry,
 {
     off_t            log_end_offset;
     struct xfer_args xargs = {0};
-    int              i;
 
     if (bulk_size + region_offset > log_entry_size) {
         /* caller is attempting to access more data in this region than
@@ -763,208 +1228,15 @@ static int transfer_data(bake_file_entry_t* entry,
         = log_entry_offset + region_offset + bulk_size - remote_bulk_offset;
     log_end_offset = BAKE_ALIGN_UP(log_end_offset, entry->log_alignment);
 
-    xargs.entry            = entry;
-    xargs.remote_addr      = src_addr;
-    xargs.remote_bulk      = remote_bulk;
-    xargs.remote_offset    = remote_bulk_offset;
-    xargs.log_entry_offset = BAKE_ALIGN_DOWN(log_entry_offset + region_offset,
-                                             entry->log_alignment);
-    xargs.log_entry_size   = log_end_offset - xargs.log_entry_offset;
-    xargs.log_issued       = 0;
-    xargs.log_retired      = 0;
-    xargs.transmit_size    = bulk_size - remote_bulk_offset;
-    xargs.transmit_offset_in_log
-        = log_entry_offset + region_offset - xargs.log_entry_offset;
-    xargs.transmit_issued = 0;
-    margo_bulk_poolset_get_max(entry->provider->poolset,
-                               &xargs.poolset_max_size);
-    xargs.ret         = 0;
-    xargs.ults_active = 0;
-    xargs.op_flag     = op_flag;
-    ABT_mutex_create(&xargs.mutex);
-    ABT_eventual_create(0, &xargs.eventual);
-
-    /* divide amount to be accessed in log by max poolset size and create
-     * one ULT per chunk
-     */
-    for (i = 0; i < xargs.log_entry_size; i += xargs.poolset_max_size)
-        xargs.ults_active++;
-    for (i = 0; i < xargs.log_entry_size; i += xargs.poolset_max_size) {
-        /* NOTE: deliberately set output tid to NULL to ignore.  The last
-         * thread out of this set to complete will signal eventual below,
-         * rather than joining
-         */
-        ABT_thread_create(entry->provider->handler_pool, xfer_ult, &xargs,
-                          ABT_THREAD_ATTR_NULL, NULL);
-    }
-
-    ABT_eventual_wait(xargs.eventual, NULL);
-    ABT_eventual_free(&xargs.eventual);
-
-    /* consolidated error code (0 if all successful, otherwise first
-     * non-zero error code)
-     */
-    return (xargs.ret);
-}
-
-/* worker function for each ULT involved in a transfer */
-static void xfer_ult(void* _args)
-{
-    struct xfer_args* args = _args;
-
-    /* Variables with a this_ prefix are used to describe the
-     * specific extent that this ULT is working on at a given time (as
-     * opposed to the mutex-locked shared state tracked in the xfer_args).
-     */
-    size_t this_log_size;
-    size_t this_transmit_size;
-    off_t  this_log_offset;
-    off_t  this_transmit_offset_in_log = 0;
-    size_t this_remote_offset;
-
-    /* references to local RDMA region */
-    hg_bulk_t local_bulk = HG_BULK_NULL;
-    void*     local_bulk_ptr;
-
-    /* flag to indicate if this ULT is the one responsible for cleaning up
-     * the transfer state on completion
-     */
-    int turn_out_the_lights = 0;
-
-    /* misc */
-    size_t      tmp_buf_size;
-    hg_uint32_t tmp_count;
-    int         ret;
-
-    /* Each ULT runs a loop here to find work to do.  We don't care which
-     * ULTs get there first.  The general strategy of the loop is to loop
-     * over the entire log extent that needs to be accessed and then filter
-     * out the parts that need to be trasmitted to client.  File alignment
-     * is stricter (because we are using directio) and is a superset of the
-     * data to be transmitted.
-     */
-    /* Hold lock going into loop so that this ULT can pull of it's unit of
-     * work to operate on
-     */
-    ABT_mutex_lock(args->mutex);
-    /* have we issued all of the necessary file operations or hit an error
-     * already?
-     */
-    while (args->log_issued < args->log_entry_size && !args->ret) {
-        /* calculate what extent to work on in this cycle, both in file and
-         * in terms of remote transmission
-         */
-        if ((args->log_entry_size - args->log_issued) > args->poolset_max_size)
-            this_log_size = args->poolset_max_size;
-        else
-            this_log_size = args->log_entry_size - args->log_issued;
-        this_log_offset    = args->log_entry_offset + args->log_issued;
-        this_remote_offset = args->remote_offset + args->transmit_issued;
-        this_transmit_size = this_log_size;
-        if (args->transmit_issued == 0) {
-            /* first network transmission */
-            /* skip unused part of first block, if present */
-            this_transmit_size -= args->transmit_offset_in_log;
-            this_transmit_offset_in_log = args->transmit_offset_in_log;
-        } else {
-            this_transmit_offset_in_log = 0;
-        }
-        /* truncate transmission at the end if needed */
-        if ((this_transmit_size + args->transmit_issued) > args->transmit_size)
-            this_transmit_size = args->transmit_size - args->transmit_issued;
-
-        /* update shared state for the transfer */
-        args->log_issued += this_log_size;
-        args->transmit_issued += this_transmit_size;
-
-        /* drop mutex while we work on our local piece */
-        ABT_mutex_unlock(args->mutex);
-
-        /* get buffer */
-        /* this will block until a buffer is available if pool is exhausted */
-        ret = margo_bulk_poolset_get(args->entry->provider->poolset,
-                                     this_log_size, &local_bulk);
-        if (ret != 0 && args->ret == 0) {
-            args->ret = ret;
-            goto finished;
-        }
-        /* find pointer of memory in buffer */
-        ret = margo_bulk_access(local_bulk, 0, this_log_size, HG_BULK_READWRITE,
-                                1, &local_bulk_ptr, &tmp_buf_size, &tmp_count);
-        /* shouldn't ever fail in this scenario */
-        assert(ret == 0);
-
-        /* margo pool buffers are supposed to be page aligned already.  Just
-         * safety checking here.
-         */
-        assert((long unsigned)local_bulk_ptr % 4096 == 0);
-
-        if (args->op_flag == TRANSFER_DATA_WRITE) {
-            /* rdma transfer */
-            ret = margo_bulk_transfer(args->entry->provider->mid, HG_BULK_PULL,
-                                      args->remote_addr, args->remote_bulk,
-                                      this_remote_offset, local_bulk, 0,
-                                      this_transmit_size);
-            if (ret != 0 && args->ret == 0) {
-                args->ret = ret;
-                goto finished;
-            }
-
-            /* relay to log */
-            ret = abt_io_pwrite(args->entry->abtioi, args->entry->log_fd,
-                                local_bulk_ptr, this_log_size, this_log_offset);
-            if (ret != this_log_size && args->ret == 0) {
-                args->ret = ret;
-                goto finished;
-            }
-        } else if (args->op_flag == TRANSFER_DATA_READ) {
-            /* read from log */
-            ret = abt_io_pread(args->entry->abtioi, args->entry->log_fd,
-                               local_bulk_ptr, this_log_size, this_log_offset);
-            if (ret != this_log_size && args->ret == 0) {
-                args->ret = ret;
-                goto finished;
-            }
-
-            /* rdma transfer */
-            ret = margo_bulk_transfer(
-                args->entry->provider->mid, HG_BULK_PUSH, args->remote_addr,
-                args->remote_bulk, this_remote_offset, local_bulk,
-                this_transmit_offset_in_log, this_transmit_size);
-            if (ret != 0 && args->ret == 0) {
-                args->ret = ret;
-                goto finished;
-            }
-        } else
-            assert(0);
-
-        /* let go of bulk handle (we'll re-acquire one on next loop
-         * iteration if we have more work to do) */
-        margo_bulk_poolset_release(args->entry->provider->poolset, local_bulk);
-        local_bulk = HG_BULK_NULL;
-
-        ABT_mutex_lock(args->mutex);
-        args->log_retired += this_log_size;
-    }
-
-    ABT_mutex_unlock(args->mutex);
-
-finished:
-    if (local_bulk != HG_BULK_NULL)
-        margo_bulk_poolset_release(args->entry->provider->poolset, local_bulk);
-    ABT_mutex_lock(args->mutex);
-    args->ults_active--;
-    /* The ULT that sets active to zero is the last one that can possibly
-     * hold this mutex
-     */
-    if (!args->ults_active) turn_out_the_lights = 1;
-    ABT_mutex_unlock(args->mutex);
-
-    /* last ULT to exit cleans up remaining resources and signals caller */
-    if (turn_out_the_lights) {
-        ABT_mutex_free(&args->mutex);
-        ABT_eventual_set(args->eventual, NULL, 0);
-    }
-
-    return;
+    xargs.entry      = entry;
+    xargs.log_offset = BAKE_ALIGN_DOWN(log_entry_offset + region_offset,
+                                       entry->log_alignment);
+
+    return bake_backend_pipeline_transfer(
+        entry->provider,
+        op_flag == TRANSFER_DATA_WRITE ? HG_BULK_PULL : HG_BULK_PUSH,
+        log_end_offset - xargs.log_offset,
+        log_entry_offset + region_offset - xargs.log_offset, remote_bulk,
+        src_addr, remote_bulk_offset, bulk_size - remote_bulk_offset,
+        op_flag == TRANSFER_DATA_WRITE ? xfer_write : xfer_read, &xargs);
 }
@@ -0,0 +1,21 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __BAKE_FILE_BACKEND_H
+#define __BAKE_FILE_BACKEND_H
+
+#include <sys/types.h>
+
+/* definition of internal BAKE region_id_t identifier for file back end,
+ * also used by the back ends that store their regions in a file target.
+ * A region starts on a block of the log and owns all the blocks it spans;
+ * log_entry_size may end within the last one.
+ */
+typedef struct {
+    off_t  log_entry_offset;
+    size_t log_entry_size;
+} file_region_id_t;
+
+#endif
@@ -0,0 +1,1136 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <json-c/json.h>
+#include <libpmem.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+#include "bake-file-backend.h"
+#include "uthash.h"
+
+/* bake-hybrid-backend
+ *
+ * This is a composite back end for the Bake provider that pairs a write
+ * ahead log (WAL) in persistent memory, or in any file that can be mapped,
+ * with a conventional file target.  A target named "hybrid:/ssd/foo.dat"
+ * uses the file target /ssd/foo.dat and the log /ssd/foo.dat.wal (or a log
+ * of the same name in hybrid_backend.log_dir, e.g. on a DAX file system).
+ *
+ * Regions of at most small_region_size bytes are "small".  They are
+ * carved out of large extents ("chunks") that are allocated, and synced,
+ * once in the file log, so that creating one costs no I/O.  Writes to small
+ * regions are appended to the WAL, flushed, and acknowledged right away;
+ * persist() on them has nothing left to do.  A background ULT (the
+ * destager) periodically, or when the WAL runs low on space, replays the
+ * logged writes into the file target, coalescing all pending writes to a
+ * region into one aligned write and syncing the file once per pass, and
+ * then releases the WAL space.  Until then, reads of small regions are
+ * patched with the logged data.  Larger regions bypass the WAL and go
+ * straight to the file target.
+ *
+ * Region ids are file back end region ids, so the file target can always
+ * be read on its own once the WAL has been destaged.
+ */
+
+#define BAKE_ALIGN_UP(x, _alignment) \
+    ((((unsigned long)(x)) + (_alignment - 1)) & (~(_alignment - 1)))
+
+#define HYBRID_SUPERBLOCK_SIZE 4096
+#define HYBRID_WAL_MAGIC       0x62616b6577616c32ULL /* "bakewal2" */
+#define HYBRID_RECORD_MAGIC    0x7265636f72640a01ULL
+#define HYBRID_WRAP_MAGIC      0x77726170706564ffULL
+#define HYBRID_RECORD_ALIGN    64
+
+/* persistent header of the WAL; head and tail are logical byte positions
+ * that only ever increase, mapped into the circular data area that
+ * follows the superblock
+ */
+typedef struct {
+    uint64_t         magic;
+    bake_target_id_t target_id; /* file target this log belongs to */
+    uint64_t         head;      /* oldest record not yet destaged */
+    uint64_t         tail;      /* end of the last complete record */
+    uint64_t         chunk_offset; /* file log extent of the current chunk */
+    uint64_t         chunk_size;
+    uint64_t         chunk_used;
+} hybrid_wal_root_t;
+
+/* header of a record; a record takes ALIGN_UP(header + payload) bytes of
+ * the log, so that every record, and thus any gap left at the end of the
+ * data area, starts on HYBRID_RECORD_ALIGN and can hold a header
+ */
+typedef struct {
+    uint64_t magic;
+    uint64_t size;          /* payload bytes following the header */
+    uint64_t region_offset; /* where the payload goes in the region */
+    char     rid[BAKE_REGION_ID_DATA_SIZE];
+    uint64_t pad[3];
+} hybrid_record_t;
+_Static_assert(sizeof(hybrid_record_t) == HYBRID_RECORD_ALIGN,
+               "hybrid_record_t must take exactly HYBRID_RECORD_ALIGN bytes");
+
+#define HYBRID_RECORD_LEN(_size) \
+    BAKE_ALIGN_UP(sizeof(hybrid_record_t) + (_size), HYBRID_RECORD_ALIGN)
+
+/* a logged write not yet destaged to the file target */
+typedef struct hybrid_extent {
+    uint64_t              pos; /* logical WAL position of the record */
+    size_t                region_offset;
+    size_t                size;
+    const char*           data; /* payload, in the WAL mapping */
+    struct hybrid_extent* next;
+} hybrid_extent_t;
+
+/* pending writes of one small region, oldest first */
+typedef struct {
+    char             key[BAKE_REGION_ID_DATA_SIZE];
+    hybrid_extent_t* first;
+    hybrid_extent_t* last;
+    UT_hash_handle   hh;
+} hybrid_overlay_t;
+
+typedef struct {
+    bake_provider_t    provider;
+    bake_backend_t     file;         /* the file back end */
+    backend_context_t  file_context; /* context of the file target */
+    free_fn            file_free;    /* free function of file read_raw */
+    char*              wal_path;
+    char*              wal_base;
+    size_t             wal_mapped_len;
+    int                wal_is_pmem;
+    hybrid_wal_root_t* wal_root;
+    uint64_t           wal_capacity; /* bytes in the circular data area */
+    size_t             small_region_size;
+    size_t             alignment; /* of the file target */
+    double             destage_interval; /* seconds */
+    hybrid_overlay_t*  overlays;         /* protected by wal_mutex */
+    uint64_t           destage_gen;      /* bumped when extents are retired */
+    ABT_mutex          wal_mutex;
+    ABT_cond           space_cond;   /* signaled when the head moves */
+    ABT_cond           destage_cond; /* wakes the destager up */
+    ABT_mutex          destage_mutex; /* one destage pass at a time */
+    ABT_mutex          chunk_mutex;   /* protects chunk_* in the root */
+    ABT_thread         destager;
+    int                shutdown;
+    uint64_t           appends;
+    uint64_t           stalls;   /* appends that waited for space */
+    uint64_t           destages; /* passes that retired records */
+} bake_hybrid_entry_t;
+
+static int  hybrid_destage(bake_hybrid_entry_t* entry);
+static void hybrid_destage_ult(void* _arg);
+
+static void hybrid_persist(bake_hybrid_entry_t* entry, void* addr, size_t len)
+{
+    if (entry->wal_is_pmem)
+        pmem_persist(addr, len);
+    else
+        pmem_msync(addr, len);
+}
+
+static char* hybrid_wal_addr(bake_hybrid_entry_t* entry, uint64_t pos)
+{
+    return entry->wal_base + HYBRID_SUPERBLOCK_SIZE
+         + (pos % entry->wal_capacity);
+}
+
+static int hybrid_is_small(bake_hybrid_entry_t* entry, bake_region_id_t rid)
+{
+    file_region_id_t* frid = (file_region_id_t*)rid.data;
+    return frid->log_entry_size <= entry->small_region_size;
+}
+
+/* must be called with wal_mutex held */
+static void hybrid_overlay_add(bake_hybrid_entry_t* entry,
+                               const char*          key,
+                               uint64_t             pos,
+                               size_t               region_offset,
+                               size_t               size,
+                               const char*          data)
+{
+    hybrid_overlay_t* ov  = NULL;
+    hybrid_extent_t*  ext = calloc(1, sizeof(*ext));
+
+    ext->pos           = pos;
+    ext->region_offset = region_offset;
+    ext->size          = size;
+    ext->data          = data;
+
+    HASH_FIND(hh, entry->overlays, key, BAKE_REGION_ID_DATA_SIZE, ov);
+    if (!ov) {
+        ov = calloc(1, sizeof(*ov));
+        memcpy(ov->key, key, BAKE_REGION_ID_DATA_SIZE);
+        HASH_ADD(hh, entry->overlays, key, BAKE_REGION_ID_DATA_SIZE, ov);
+    }
+    if (ov->last)
+        ov->last->next = ext;
+    else
+        ov->first = ext;
+    ov->last = ext;
+}
+
+/* must be called with wal_mutex held */
+static void hybrid_overlay_free(bake_hybrid_entry_t* entry,
+                                hybrid_overlay_t*    ov)
+{
+    hybrid_extent_t* ext = ov->first;
+    hybrid_extent_t* next;
+
+    while (ext) {
+        next = ext->next;
+        free(ext);
+        ext = next;
+    }
+    HASH_DEL(entry->overlays, ov);
+    free(ov);
+}
+
+/* appends a write to the WAL and makes it durable */
+static int hybrid_wal_append(bake_hybrid_entry_t* entry,
+                             bake_region_id_t     rid,
+                             size_t               region_offset,
+                             size_t               size,
+                             const void*          data)
+{
+    hybrid_wal_root_t* root = entry->wal_root;
+    hybrid_record_t*   rec;
+    uint64_t           wrap    = 0;
+    int                stalled = 0;
+    uint64_t           len;
+
+    len = HYBRID_RECORD_LEN(size);
+
+    if (len > entry->wal_capacity / 2) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    ABT_mutex_lock(entry->wal_mutex);
+    for (;;) {
+        /* records never wrap around the end of the data area; the rest
+         * of it, a multiple of HYBRID_RECORD_ALIGN, is skipped
+         */
+        wrap = 0;
+        if ((root->tail % entry->wal_capacity) + len > entry->wal_capacity)
+            wrap = entry->wal_capacity - (root->tail % entry->wal_capacity);
+        if (root->tail + wrap + len - root->head <= entry->wal_capacity)
+            break;
+        stalled = 1;
+        ABT_cond_signal(entry->destage_cond);
+        ABT_cond_wait(entry->space_cond, entry->wal_mutex);
+    }
+    if (stalled) entry->stalls++;
+
+    if (wrap) {
+        rec        = (hybrid_record_t*)hybrid_wal_addr(entry, root->tail);
+        rec->magic = HYBRID_WRAP_MAGIC;
+        rec->size  = wrap - sizeof(*rec);
+        hybrid_persist(entry, rec, sizeof(*rec));
+        root->tail += wrap;
+    }
+
+    rec                = (hybrid_record_t*)hybrid_wal_addr(entry, root->tail);
+    rec->magic         = HYBRID_RECORD_MAGIC;
+    rec->size          = size;
+    rec->region_offset = region_offset;
+    memcpy(rec->rid, rid.data, BAKE_REGION_ID_DATA_SIZE);
+    memcpy(rec + 1, data, size);
+    hybrid_persist(entry, rec, sizeof(*rec) + size);
+
+    hybrid_overlay_add(entry, rid.data, root->tail, region_offset, size,
+                       (const char*)(rec + 1));
+
+    /* the record only becomes part of the log once the tail covers it */
+    root->tail += len;
+    hybrid_persist(entry, &root->tail, sizeof(root->tail));
+    entry->appends++;
+    ABT_mutex_unlock(entry->wal_mutex);
+
+    return BAKE_SUCCESS;
+}
+
+/* fills buffer with bytes [offset, offset+size) of a region, as the client
+ * should see them.  Returns 0 if the region has no pending writes, in which
+ * case the buffer is untouched.
+ */
+static int hybrid_read_patched(bake_hybrid_entry_t* entry,
+                               bake_region_id_t     rid,
+                               size_t               offset,
+                               size_t               size,
+                               char*                buffer,
+                               int*                 ret)
+{
+    hybrid_overlay_t* ov;
+    hybrid_extent_t*  ext;
+    uint64_t          gen;
+    void*             base;
+    uint64_t          base_size;
+    free_fn           base_free;
+    size_t            start, end;
+
+    *ret = BAKE_SUCCESS;
+    for (;;) {
+        ABT_mutex_lock(entry->wal_mutex);
+        HASH_FIND(hh, entry->overlays, rid.data, BAKE_REGION_ID_DATA_SIZE,
+                  ov);
+        gen = entry->destage_gen;
+        ABT_mutex_unlock(entry->wal_mutex);
+        if (!ov) return 0;
+
+        /* start from what is already in the file */
+        base      = NULL;
+        base_free = NULL;
+        *ret      = entry->file->_read_raw(entry->file_context, rid, offset,
+                                      size, &base, &base_size, &base_free);
+        if (*ret != BAKE_SUCCESS) return 1;
+        memcpy(buffer, base, size);
+        if (base_free) base_free(entry->file_context, base);
+
+        ABT_mutex_lock(entry->wal_mutex);
+        if (gen != entry->destage_gen) {
+            /* the destager retired extents while we were reading the
+             * file; what we read may predate them
+             */
+            ABT_mutex_unlock(entry->wal_mutex);
+            continue;
+        }
+        /* may have been dropped by a concurrent remove */
+        HASH_FIND(hh, entry->overlays, rid.data, BAKE_REGION_ID_DATA_SIZE,
+                  ov);
+        for (ext = ov ? ov->first : NULL; ext; ext = ext->next) {
+            start = ext->region_offset > offset ? ext->region_offset : offset;
+            end   = ext->region_offset + ext->size < offset + size
+                      ? ext->region_offset + ext->size
+                      : offset + size;
+            if (start < end)
+                memcpy(buffer + (start - offset),
+                       ext->data + (start - ext->region_offset), end - start);
+        }
+        ABT_mutex_unlock(entry->wal_mutex);
+        return 1;
+    }
+}
+
+static int bake_hybrid_makepool(const char* name, size_t size)
+{
+    /* the WAL is created when the target is first attached */
+    return bake_backend_lookup("file")->_create_raw_target(name, size);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_hybrid_backend_initialize(bake_provider_t    provider,
+                                          const char*        path,
+                                          bake_target_id_t*  target,
+                                          backend_context_t* context)
+{
+    bake_hybrid_entry_t* new_entry;
+    bake_backend_t       file = bake_backend_lookup("file");
+    backend_context_t    file_context = NULL;
+    struct json_object*  hybrid_backend_json = NULL;
+    struct json_object*  target_array        = NULL;
+    struct json_object*  val;
+    const char*          log_dir;
+    const char*          tmp;
+    hybrid_record_t*     rec;
+    uint64_t             pos;
+    int64_t              log_size;
+    int64_t              chunk_size;
+    size_t               len, slot;
+    int                  ret;
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "hybrid_backend",
+                                "hybrid_backend", hybrid_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(hybrid_backend_json, "targets",
+                               "hybrid_backend.targets", target_array);
+    /* size of a newly created WAL */
+    CONFIG_HAS_OR_CREATE(hybrid_backend_json, int64, "log_size", 67108864,
+                         "hybrid_backend.log_size", val);
+    log_size = json_object_get_int64(val);
+    /* directory of the WAL; empty means next to the file target */
+    CONFIG_HAS_OR_CREATE(hybrid_backend_json, string, "log_dir", "",
+                         "hybrid_backend.log_dir", val);
+    log_dir = json_object_get_string(val);
+    CONFIG_HAS_OR_CREATE(hybrid_backend_json, int64, "small_region_size",
+                         65536, "hybrid_backend.small_region_size", val);
+
+    new_entry                    = calloc(1, sizeof(*new_entry));
+    new_entry->provider          = provider;
+    new_entry->file              = file;
+    new_entry->small_region_size = json_object_get_int64(val);
+    /* file log extent from which small regions are allocated */
+    CONFIG_HAS_OR_CREATE(hybrid_backend_json, int64, "chunk_size", 16777216,
+                         "hybrid_backend.chunk_size", val);
+    chunk_size = json_object_get_int64(val);
+    CONFIG_HAS_OR_CREATE(hybrid_backend_json, int64, "destage_interval_ms",
+                         100, "hybrid_backend.destage_interval_ms", val);
+    new_entry->destage_interval = json_object_get_int64(val) / 1e3;
+
+    if (new_entry->destage_interval <= 0) {
+        BAKE_ERROR(provider->mid,
+                   "hybrid_backend.destage_interval_ms must be positive");
+        free(new_entry);
+        return BAKE_ERR_INVALID_ARG;
+    }
+    /* a new log must hold its superblock and, in half of its data area,
+     * a record of a small region
+     */
+    if (log_size < HYBRID_SUPERBLOCK_SIZE
+        || (uint64_t)log_size - HYBRID_SUPERBLOCK_SIZE
+               < 2 * HYBRID_RECORD_LEN(new_entry->small_region_size)) {
+        BAKE_ERROR(provider->mid,
+                   "hybrid_backend.log_size is too small for "
+                   "hybrid_backend.small_region_size");
+        free(new_entry);
+        return BAKE_ERR_INVALID_ARG;
+    }
+
+    ret = file->_initialize(provider, path, target, &file_context);
+    if (ret != BAKE_SUCCESS) {
+        free(new_entry);
+        return ret;
+    }
+    /* the file target is recorded under this back end only */
+    bake_backend_unlist_target(provider, file, path);
+    new_entry->file_context = file_context;
+    new_entry->alignment    = json_object_get_int64(json_object_object_get(
+        json_object_object_get(provider->json_cfg, "file_backend"),
+        "alignment"));
+    /* a chunk must hold at least the slot of the largest small region */
+    slot = BAKE_ALIGN_UP(new_entry->small_region_size, new_entry->alignment);
+    if (chunk_size <= 0 || (uint64_t)chunk_size < slot) {
+        BAKE_ERROR(provider->mid,
+                   "hybrid_backend.chunk_size cannot hold a region of "
+                   "hybrid_backend.small_region_size");
+        ret = BAKE_ERR_INVALID_ARG;
+        goto error_cleanup;
+    }
+
+    if (log_dir[0]) {
+        tmp = strrchr(path, '/');
+        tmp = tmp ? tmp + 1 : path;
+        len = strlen(log_dir) + strlen(tmp) + 6;
+        new_entry->wal_path = malloc(len);
+        snprintf(new_entry->wal_path, len, "%s/%s.wal", log_dir, tmp);
+    } else {
+        len                 = strlen(path) + 5;
+        new_entry->wal_path = malloc(len);
+        snprintf(new_entry->wal_path, len, "%s.wal", path);
+    }
+
+    new_entry->wal_base
+        = pmem_map_file(new_entry->wal_path, 0, 0, 0,
+                        &new_entry->wal_mapped_len, &new_entry->wal_is_pmem);
+    if (!new_entry->wal_base && errno == ENOENT) {
+        new_entry->wal_base = pmem_map_file(
+            new_entry->wal_path, log_size, PMEM_FILE_CREATE | PMEM_FILE_EXCL,
+            0644, &new_entry->wal_mapped_len, &new_entry->wal_is_pmem);
+        if (new_entry->wal_base) {
+            new_entry->wal_root = (hybrid_wal_root_t*)new_entry->wal_base;
+            memset(new_entry->wal_root, 0, HYBRID_SUPERBLOCK_SIZE);
+            new_entry->wal_root->magic     = HYBRID_WAL_MAGIC;
+            new_entry->wal_root->target_id = *target;
+            hybrid_persist(new_entry, new_entry->wal_root,
+                           HYBRID_SUPERBLOCK_SIZE);
+        }
+    }
+    if (!new_entry->wal_base) {
+        BAKE_ERROR(provider->mid, "pmem_map_file(): %s on %s", strerror(errno),
+                   new_entry->wal_path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+
+    new_entry->wal_root = (hybrid_wal_root_t*)new_entry->wal_base;
+    new_entry->wal_capacity
+        = (new_entry->wal_mapped_len - HYBRID_SUPERBLOCK_SIZE)
+        & ~((uint64_t)HYBRID_RECORD_ALIGN - 1);
+    if (new_entry->wal_mapped_len <= HYBRID_SUPERBLOCK_SIZE
+        || new_entry->wal_root->magic != HYBRID_WAL_MAGIC
+        || uuid_compare(new_entry->wal_root->target_id.id, target->id) != 0) {
+        BAKE_ERROR(provider->mid, "%s is not the WAL of target %s",
+                   new_entry->wal_path, path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+    if (HYBRID_RECORD_LEN(new_entry->small_region_size)
+        > new_entry->wal_capacity / 2) {
+        BAKE_ERROR(provider->mid,
+                   "hybrid_backend.small_region_size is too large for the "
+                   "WAL of target %s",
+                   path);
+        ret = BAKE_ERR_INVALID_ARG;
+        goto error_cleanup;
+    }
+    if (new_entry->wal_root->chunk_offset == 0)
+        new_entry->wal_root->chunk_size = chunk_size;
+
+    ABT_mutex_create(&new_entry->wal_mutex);
+    ABT_mutex_create(&new_entry->destage_mutex);
+    ABT_mutex_create(&new_entry->chunk_mutex);
+    ABT_cond_create(&new_entry->space_cond);
+    ABT_cond_create(&new_entry->destage_cond);
+
+    /* recover writes that were logged but not destaged before the last
+     * shutdown; the destager will replay them
+     */
+    for (pos = new_entry->wal_root->head; pos < new_entry->wal_root->tail;
+         pos += HYBRID_RECORD_LEN(rec->size)) {
+        rec = (hybrid_record_t*)hybrid_wal_addr(new_entry, pos);
+        if (rec->magic == HYBRID_RECORD_MAGIC)
+            hybrid_overlay_add(new_entry, rec->rid, pos, rec->region_offset,
+                               rec->size, (const char*)(rec + 1));
+    }
+
+    ABT_thread_create(provider->handler_pool, hybrid_destage_ult, new_entry,
+                      ABT_THREAD_ATTR_NULL, &new_entry->destager);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+
+error_cleanup:
+    if (new_entry->wal_base)
+        pmem_unmap(new_entry->wal_base, new_entry->wal_mapped_len);
+    free(new_entry->wal_path);
+    file->_finalize(file_context);
+    free(new_entry);
+    return (ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_hybrid_backend_finalize(backend_context_t context)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    hybrid_overlay_t *   ov, *tmp;
+    int                  ret;
+
+    ABT_mutex_lock(entry->wal_mutex);
+    entry->shutdown = 1;
+    ABT_cond_signal(entry->destage_cond);
+    ABT_mutex_unlock(entry->wal_mutex);
+    ABT_thread_join(entry->destager);
+    ABT_thread_free(&entry->destager);
+
+    /* leave as little as possible to recover */
+    hybrid_destage(entry);
+
+    HASH_ITER(hh, entry->overlays, ov, tmp) { hybrid_overlay_free(entry, ov); }
+    ABT_cond_free(&entry->destage_cond);
+    ABT_cond_free(&entry->space_cond);
+    ABT_mutex_free(&entry->chunk_mutex);
+    ABT_mutex_free(&entry->destage_mutex);
+    ABT_mutex_free(&entry->wal_mutex);
+    pmem_unmap(entry->wal_base, entry->wal_mapped_len);
+    free(entry->wal_path);
+
+    ret = entry->file->_finalize(entry->file_context);
+    free(entry);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_hybrid_create(backend_context_t context,
+                              size_t            size,
+                              bake_region_id_t* rid)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    hybrid_wal_root_t*   root  = entry->wal_root;
+    file_region_id_t*    frid  = (file_region_id_t*)rid->data;
+    bake_region_id_t     chunk_rid;
+    file_region_id_t*    chunk_frid = (file_region_id_t*)chunk_rid.data;
+    size_t               slot;
+    int                  ret;
+
+    assert(sizeof(file_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    if (size > entry->small_region_size)
+        return entry->file->_create(entry->file_context, size, rid);
+
+    /* the region takes whole blocks of the chunk, but reports its size */
+    slot = BAKE_ALIGN_UP(size ? size : 1, entry->alignment);
+
+    ABT_mutex_lock(entry->chunk_mutex);
+    if (root->chunk_offset == 0
+        || root->chunk_used + slot > root->chunk_size) {
+        /* the file target makes the new chunk durable; the rest of the
+         * previous one is abandoned
+         */
+        memset(&chunk_rid, 0, sizeof(chunk_rid));
+        ret = entry->file->_create(entry->file_context, root->chunk_size,
+                                   &chunk_rid);
+        if (ret != BAKE_SUCCESS) {
+            ABT_mutex_unlock(entry->chunk_mutex);
+            return ret;
+        }
+        root->chunk_offset = chunk_frid->log_entry_offset;
+        root->chunk_size   = chunk_frid->log_entry_size;
+        root->chunk_used   = 0;
+        if (slot > root->chunk_size) {
+            ABT_mutex_unlock(entry->chunk_mutex);
+            return BAKE_ERR_INVALID_ARG;
+        }
+    }
+    frid->log_entry_offset = root->chunk_offset + root->chunk_used;
+    frid->log_entry_size   = size;
+    root->chunk_used += slot;
+    hybrid_persist(entry, &root->chunk_offset, 3 * sizeof(uint64_t));
+    ABT_mutex_unlock(entry->chunk_mutex);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_hybrid_write_raw(backend_context_t context,
+                                 bake_region_id_t  rid,
+                                 size_t            offset,
+                                 size_t            size,
+                                 const void*       data)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    file_region_id_t*    frid  = (file_region_id_t*)rid.data;
+
+    if (!hybrid_is_small(entry, rid))
+        return entry->file->_write_raw(entry->file_context, rid, offset, size,
+                                       data);
+
+    if (size + offset > frid->log_entry_size) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    return hybrid_wal_append(entry, rid, offset, size, data);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_hybrid_write_bulk(backend_context_t context,
+                                  bake_region_id_t  rid,
+                                  size_t            region_offset,
+                                  size_t            size,
+                                  hg_bulk_t         bulk,
+                                  hg_addr_t         source,
+                                  size_t            bulk_offset)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    file_region_id_t*    frid  = (file_region_id_t*)rid.data;
+    hg_bulk_t            local_bulk;
+    void*                buffer;
+    hg_size_t            buffer_size = size;
+    hg_return_t          hret;
+    int                  ret;
+
+    if (!hybrid_is_small(entry, rid))
+        return entry->file->_write_bulk(entry->file_context, rid,
+                                        region_offset, size, bulk, source,
+                                        bulk_offset);
+
+    if (size + region_offset > frid->log_entry_size)
+        return BAKE_ERR_OUT_OF_BOUNDS;
+    if (size == 0) return BAKE_SUCCESS;
+
+    /* small by definition; pull into a staging buffer rather than hold the
+     * WAL lock during the transfer
+     */
+    buffer = malloc(size);
+    if (!buffer) return BAKE_ERR_NOMEM;
+    hret = margo_bulk_create(entry->provider->mid, 1, &buffer, &buffer_size,
+                             HG_BULK_WRITE_ONLY, &local_bulk);
+    if (hret != HG_SUCCESS) {
+        free(buffer);
+        return BAKE_ERR_MERCURY;
+    }
+    hret = margo_bulk_transfer(entry->provider->mid, HG_BULK_PULL, source,
+                               bulk, bulk_offset, local_bulk, 0, size);
+    margo_bulk_free(local_bulk);
+    if (hret != HG_SUCCESS) {
+        free(buffer);
+        return BAKE_ERR_MERCURY;
+    }
+
+    ret = hybrid_wal_append(entry, rid, region_offset, size, buffer);
+    free(buffer);
+    return ret;
+}
+
+static void bake_hybrid_read_raw_free(backend_context_t context, void* ptr)
+{
+    free(ptr);
+}
+
+static void bake_hybrid_file_read_raw_free(backend_context_t context,
+                                           void*             ptr)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    entry->file_free(entry->file_context, ptr);
+}
+
+static int bake_hybrid_read_raw(backend_context_t context,
+                                bake_region_id_t  rid,
+                                size_t            offset,
+                                size_t            size,
+                                void**            data,
+                                uint64_t*         data_size,
+                                free_fn*          free_data)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    file_region_id_t*    frid  = (file_region_id_t*)rid.data;
+    free_fn              file_free = NULL;
+    char*                buffer;
+    int                  ret;
+
+    *free_data = NULL;
+    *data      = NULL;
+    *data_size = 0;
+
+    if (hybrid_is_small(entry, rid)) {
+        if (size + offset > frid->log_entry_size)
+            return BAKE_ERR_OUT_OF_BOUNDS;
+        buffer = malloc(size ? size : 1);
+        if (!buffer) return BAKE_ERR_NOMEM;
+        if (hybrid_read_patched(entry, rid, offset, size, buffer, &ret)) {
+            if (ret != BAKE_SUCCESS) {
+                free(buffer);
+                return ret;
+            }
+            *data      = buffer;
+            *data_size = size;
+            *free_data = bake_hybrid_read_raw_free;
+            return BAKE_SUCCESS;
+        }
+        free(buffer);
+    }
+
+    ret = entry->file->_read_raw(entry->file_context, rid, offset, size, data,
+                                 data_size, &file_free);
+    if (file_free) {
+        /* the free function of a back end is the same for every call */
+        entry->file_free = file_free;
+        *free_data       = bake_hybrid_file_read_raw_free;
+    }
+    return ret;
+}
+
+static int bake_hybrid_read_bulk(backend_context_t context,
+                                 bake_region_id_t  rid,
+                                 size_t            region_offset,
+                                 size_t            size,
+                                 hg_bulk_t         bulk,
+                                 hg_addr_t         source,
+                                 size_t            bulk_offset,
+                                 size_t*           bytes_read)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    file_region_id_t*    frid  = (file_region_id_t*)rid.data;
+    hg_bulk_t            local_bulk;
+    void*                buffer;
+    hg_size_t            buffer_size;
+    hg_return_t          hret;
+    int                  ret;
+
+    *bytes_read = 0;
+
+    if (!hybrid_is_small(entry, rid))
+        return entry->file->_read_bulk(entry->file_context, rid, region_offset,
+                                       size, bulk, source, bulk_offset,
+                                       bytes_read);
+
+    if (region_offset > frid->log_entry_size) return BAKE_ERR_OUT_OF_BOUNDS;
+    if (region_offset + size > frid->log_entry_size)
+        size = frid->log_entry_size - region_offset;
+    if (size == 0) return BAKE_SUCCESS;
+
+    buffer = malloc(size);
+    if (!buffer) return BAKE_ERR_NOMEM;
+    if (!hybrid_read_patched(entry, rid, region_offset, size, buffer, &ret)) {
+        free(buffer);
+        return entry->file->_read_bulk(entry->file_context, rid, region_offset,
+                                       size, bulk, source, bulk_offset,
+                                       bytes_read);
+    }
+    if (ret != BAKE_SUCCESS) {
+        free(buffer);
+        return ret;
+    }
+
+    buffer_size = size;
+    hret = margo_bulk_create(entry->provider->mid, 1, &buffer, &buffer_size,
+                             HG_BULK_READ_ONLY, &local_bulk);
+    if (hret != HG_SUCCESS) {
+        free(buffer);
+        return BAKE_ERR_MERCURY;
+    }
+    hret = margo_bulk_transfer(entry->provider->mid, HG_BULK_PUSH, source,
+                               bulk, bulk_offset, local_bulk, 0, size);
+    margo_bulk_free(local_bulk);
+    free(buffer);
+    if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+
+    *bytes_read = size;
+    return BAKE_SUCCESS;
+}
+
+static int bake_hybrid_persist(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            offset,
+                               size_t            size)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+
+    /* writes to small regions were durable before they were acknowledged */
+    if (hybrid_is_small(entry, rid)) return BAKE_SUCCESS;
+
+    return entry->file->_persist(entry->file_context, rid, offset, size);
+}
+
+static int bake_hybrid_create_write_persist_raw(backend_context_t context,
+                                                const void*       data,
+                                                size_t            size,
+                                                bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_hybrid_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = bake_hybrid_write_raw(context, *rid, 0, size, data);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_hybrid_persist(context, *rid, 0, size);
+}
+
+static int bake_hybrid_create_write_persist_bulk(backend_context_t context,
+                                                 hg_bulk_t         bulk,
+                                                 hg_addr_t         source,
+                                                 size_t            bulk_offset,
+                                                 size_t            size,
+                                                 bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_hybrid_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = bake_hybrid_write_bulk(context, *rid, 0, size, bulk, source,
+                                 bulk_offset);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_hybrid_persist(context, *rid, 0, size);
+}
+
+static int bake_hybrid_get_region_size(backend_context_t context,
+                                       bake_region_id_t  rid,
+                                       size_t*           size)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    return entry->file->_get_region_size(entry->file_context, rid, size);
+}
+
+static int bake_hybrid_get_region_data(backend_context_t context,
+                                       bake_region_id_t  rid,
+                                       void**            data)
+{
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+
+/* drops the pending writes of a region; their records stay in the WAL
+ * until the next destage pass, which will no longer find them
+ */
+static void hybrid_overlay_drop(bake_hybrid_entry_t* entry,
+                                bake_region_id_t     rid)
+{
+    hybrid_overlay_t* ov;
+
+    ABT_mutex_lock(entry->wal_mutex);
+    HASH_FIND(hh, entry->overlays, rid.data, BAKE_REGION_ID_DATA_SIZE, ov);
+    if (ov) hybrid_overlay_free(entry, ov);
+    ABT_mutex_unlock(entry->wal_mutex);
+}
+
+static int bake_hybrid_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+
+    hybrid_overlay_drop(entry, rid);
+    return entry->file->_remove(entry->file_context, rid);
+}
+
+static int bake_hybrid_migrate_region(backend_context_t context,
+                                      bake_region_id_t  source_rid,
+                                      size_t            region_size,
+                                      int               remove_source,
+                                      const char*       dest_addr_str,
+                                      uint16_t          dest_provider_id,
+                                      bake_target_id_t  dest_target_id,
+                                      bake_region_id_t* dest_rid)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    int                  ret;
+
+    /* the file back end reads the region from the file */
+    ret = hybrid_destage(entry);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    ret = entry->file->_migrate_region(
+        entry->file_context, source_rid, region_size, remove_source,
+        dest_addr_str, dest_provider_id, dest_target_id, dest_rid);
+    if (ret == BAKE_SUCCESS && remove_source)
+        hybrid_overlay_drop(entry, source_rid);
+    return ret;
+}
+
+static int bake_hybrid_get_stats(backend_context_t   context,
+                                 struct json_object* stats)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    struct json_object*  wal_stats = json_object_new_object();
+
+    ABT_mutex_lock(entry->wal_mutex);
+    json_object_object_add(wal_stats, "capacity",
+                           json_object_new_int64(entry->wal_capacity));
+    json_object_object_add(
+        wal_stats, "used",
+        json_object_new_int64(entry->wal_root->tail - entry->wal_root->head));
+    json_object_object_add(wal_stats, "appends",
+                           json_object_new_int64(entry->appends));
+    json_object_object_add(wal_stats, "stalls",
+                           json_object_new_int64(entry->stalls));
+    json_object_object_add(wal_stats, "destages",
+                           json_object_new_int64(entry->destages));
+    ABT_mutex_unlock(entry->wal_mutex);
+    json_object_object_add(stats, "wal", wal_stats);
+    if (entry->file->_get_stats)
+        entry->file->_get_stats(entry->file_context, stats);
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_hybrid_reconfigure(backend_context_t context)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    if (!entry->file->_reconfigure) return BAKE_SUCCESS;
+    return entry->file->_reconfigure(entry->file_context);
+}
+
+#ifdef USE_REMI
+static int bake_hybrid_create_fileset(backend_context_t context,
+                                      remi_fileset_t*   fileset)
+{
+    bake_hybrid_entry_t* entry = (bake_hybrid_entry_t*)context;
+    int                  ret;
+
+    /* the file target is complete once the WAL has been destaged */
+    ret = hybrid_destage(entry);
+    if (ret != BAKE_SUCCESS) return ret;
+    return entry->file->_create_fileset(entry->file_context, fileset);
+}
+#endif
+
+bake_backend g_bake_hybrid_backend = {
+    .name                       = "hybrid",
+    ._initialize                = bake_hybrid_backend_initialize,
+    ._finalize                  = bake_hybrid_backend_finalize,
+    ._create                    = bake_hybrid_create,
+    ._write_raw                 = bake_hybrid_write_raw,
+    ._write_bulk                = bake_hybrid_write_bulk,
+    ._read_raw                  = bake_hybrid_read_raw,
+    ._read_bulk                 = bake_hybrid_read_bulk,
+    ._persist                   = bake_hybrid_persist,
+    ._create_write_persist_raw  = bake_hybrid_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_hybrid_create_write_persist_bulk,
+    ._get_region_size           = bake_hybrid_get_region_size,
+    ._get_region_data           = bake_hybrid_get_region_data,
+    ._remove                    = bake_hybrid_remove,
+    ._migrate_region            = bake_hybrid_migrate_region,
+    ._create_raw_target         = bake_hybrid_makepool,
+    ._get_stats                 = bake_hybrid_get_stats,
+    ._reconfigure               = bake_hybrid_reconfigure,
+#ifdef USE_REMI
+    ._create_fileset = bake_hybrid_create_fileset,
+#endif
+};
+
+/* replays every record currently in the WAL into the file target, syncs
+ * it, and releases the WAL space
+ */
+static int hybrid_destage(bake_hybrid_entry_t* entry)
+{
+    hybrid_overlay_t *ov, *tmp;
+    hybrid_extent_t * ext, *next;
+    bake_region_id_t  rid;
+    uint64_t          snap_tail;
+    char*             keys = NULL;
+    size_t            num_keys, i;
+    size_t            end, image_size, region_size;
+    char*             image;
+    void*             base;
+    uint64_t          base_size;
+    free_fn           base_free;
+    int               covered;
+    int               written = 0;
+    int               ret     = BAKE_SUCCESS;
+
+    ABT_mutex_lock(entry->destage_mutex);
+
+    /* records before snap_tail will not be overwritten until we move the
+     * head, so their payloads stay valid while the lock is dropped
+     */
+    ABT_mutex_lock(entry->wal_mutex);
+    snap_tail = entry->wal_root->tail;
+    if (snap_tail == entry->wal_root->head) {
+        ABT_mutex_unlock(entry->wal_mutex);
+        ABT_mutex_unlock(entry->destage_mutex);
+        return BAKE_SUCCESS;
+    }
+    num_keys = HASH_COUNT(entry->overlays);
+    if (num_keys) keys = malloc(num_keys * BAKE_REGION_ID_DATA_SIZE);
+    i = 0;
+    HASH_ITER(hh, entry->overlays, ov, tmp)
+    {
+        memcpy(keys + i * BAKE_REGION_ID_DATA_SIZE, ov->key,
+               BAKE_REGION_ID_DATA_SIZE);
+        i++;
+    }
+    ABT_mutex_unlock(entry->wal_mutex);
+    if (num_keys && !keys) {
+        ABT_mutex_unlock(entry->destage_mutex);
+        return BAKE_ERR_NOMEM;
+    }
+
+    memset(&rid, 0, sizeof(rid));
+    for (i = 0; i < num_keys && ret == BAKE_SUCCESS; i++) {
+        memcpy(rid.data, keys + i * BAKE_REGION_ID_DATA_SIZE,
+               BAKE_REGION_ID_DATA_SIZE);
+
+        /* how much of the region the records up to snap_tail touch, and
+         * whether they cover all of it from the start
+         */
+        ABT_mutex_lock(entry->wal_mutex);
+        HASH_FIND(hh, entry->overlays, rid.data, BAKE_REGION_ID_DATA_SIZE, ov);
+        end     = 0;
+        covered = 1;
+        for (ext = ov ? ov->first : NULL; ext && ext->pos < snap_tail;
+             ext = ext->next) {
+            if (ext->region_offset > end) covered = 0;
+            if (ext->region_offset + ext->size > end)
+                end = ext->region_offset + ext->size;
+        }
+        ABT_mutex_unlock(entry->wal_mutex);
+        if (end == 0) continue;
+
+        /* the file back end writes whole blocks, so the image extends to
+         * the end of the block, or of the region, and whatever the log
+         * does not cover comes from the file
+         */
+        region_size = ((file_region_id_t*)rid.data)->log_entry_size;
+        image_size  = BAKE_ALIGN_UP(end, entry->alignment);
+        if (image_size > region_size) image_size = region_size;
+        image = malloc(image_size);
+        if (!image) {
+            ret = BAKE_ERR_NOMEM;
+            break;
+        }
+        if (!covered || end < image_size) {
+            /* read-modify-write */
+            base      = NULL;
+            base_free = NULL;
+            ret       = entry->file->_read_raw(entry->file_context, rid, 0,
+                                         image_size, &base, &base_size,
+                                         &base_free);
+            if (ret == BAKE_SUCCESS) memcpy(image, base, image_size);
+            if (base_free) base_free(entry->file_context, base);
+            if (ret != BAKE_SUCCESS) {
+                free(image);
+                break;
+            }
+        }
+
+        /* the region may have been removed in the meantime */
+        ABT_mutex_lock(entry->wal_mutex);
+        HASH_FIND(hh, entry->overlays, rid.data, BAKE_REGION_ID_DATA_SIZE, ov);
+        for (ext = ov ? ov->first : NULL; ext && ext->pos < snap_tail;
+             ext = ext->next)
+            memcpy(image + ext->region_offset, ext->data, ext->size);
+        ABT_mutex_unlock(entry->wal_mutex);
+
+        if (ov) {
+            ret = entry->file->_write_raw(entry->file_context, rid, 0,
+                                          image_size, image);
+            written++;
+        }
+        free(image);
+    }
+    free(keys);
+
+    /* one sync for the whole pass */
+    if (ret == BAKE_SUCCESS && written)
+        ret = entry->file->_persist(entry->file_context, rid, 0, 0);
+    if (ret != BAKE_SUCCESS) {
+        BAKE_ERROR(entry->provider->mid, "destaging WAL %s failed (%d)",
+                   entry->wal_path, ret);
+        ABT_mutex_unlock(entry->destage_mutex);
+        return ret;
+    }
+
+    /* everything before snap_tail is now in the file */
+    ABT_mutex_lock(entry->wal_mutex);
+    HASH_ITER(hh, entry->overlays, ov, tmp)
+    {
+        for (ext = ov->first; ext && ext->pos < snap_tail; ext = next) {
+            next = ext->next;
+            free(ext);
+        }
+        ov->first = ext;
+        if (!ext) {
+            ov->last = NULL;
+            hybrid_overlay_free(entry, ov);
+        }
+    }
+    entry->wal_root->head = snap_tail;
+    hybrid_persist(entry, &entry->wal_root->head,
+                   sizeof(entry->wal_root->head));
+    entry->destage_gen++;
+    entry->destages++;
+    ABT_cond_broadcast(entry->space_cond);
+    ABT_mutex_unlock(entry->wal_mutex);
+
+    ABT_mutex_unlock(entry->destage_mutex);
+    return BAKE_SUCCESS;
+}
+
+/* background ULT: destages periodically, or as soon as the WAL is half
+ * full or an append is waiting for space
+ */
+static void hybrid_destage_ult(void* _arg)
+{
+    bake_hybrid_entry_t* entry = _arg;
+    struct timespec      deadline;
+    double               t;
+
+    ABT_mutex_lock(entry->wal_mutex);
+    while (!entry->shutdown) {
+        if (entry->wal_root->tail - entry->wal_root->head
+            < entry->wal_capacity / 2) {
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            t = deadline.tv_sec + deadline.tv_nsec / 1e9
+              + entry->destage_interval;
+            deadline.tv_sec  = (time_t)t;
+            deadline.tv_nsec = (long)((t - (double)deadline.tv_sec) * 1e9);
+            ABT_cond_timedwait(entry->destage_cond, entry->wal_mutex,
+                               &deadline);
+            if (entry->shutdown) break;
+        }
+        ABT_mutex_unlock(entry->wal_mutex);
+        hybrid_destage(entry);
+        ABT_mutex_lock(entry->wal_mutex);
+    }
+    ABT_mutex_unlock(entry->wal_mutex);
+}
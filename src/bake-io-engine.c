@@ -0,0 +1,307 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "bake-config.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <bake.h>
+#include "bake-io-engine.h"
+
+#define BAKE_IO_MAX_THREADS 256
+
+typedef struct bake_io_waiter {
+    int                    granted;
+    struct bake_io_waiter* next;
+} bake_io_waiter_t;
+
+typedef struct bake_io_engine {
+    abt_io_instance_id aid;
+    ABT_pool           pool;
+    ABT_xstream        xstreams[BAKE_IO_MAX_THREADS];
+    unsigned           num_xstreams;
+    unsigned           num_queues;   /* protected by engine_mutex */
+    ABT_mutex          mutex;        /* protects everything below */
+    ABT_cond           granted;      /* signaled when a waiter gets in */
+    unsigned           max_threads;  /* largest limit of the queues */
+    unsigned           in_flight;    /* operations holding a stream */
+    bake_io_queue_t    queues;       /* all the open queues */
+    bake_io_queue_t    ready_head;   /* queues with waiting operations */
+    bake_io_queue_t    ready_tail;
+} bake_io_engine_t;
+
+struct bake_io_queue {
+    bake_io_engine_t*     engine;
+    unsigned              max_threads; /* operations of the queue at once */
+    unsigned              in_flight;
+    bake_io_waiter_t*     head; /* waiting operations, in arrival order */
+    bake_io_waiter_t*     tail;
+    struct bake_io_queue* next_ready;
+    struct bake_io_queue* next_queue;
+};
+
+static bake_io_engine_t* engine;
+static pthread_mutex_t   engine_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void engine_stop(bake_io_engine_t* e)
+{
+    unsigned i;
+
+    if (e->aid) abt_io_finalize(e->aid);
+    for (i = 0; i < e->num_xstreams; i++) {
+        ABT_xstream_join(e->xstreams[i]);
+        ABT_xstream_free(&e->xstreams[i]);
+    }
+    if (e->pool != ABT_POOL_NULL) ABT_pool_free(&e->pool);
+    if (e->granted) ABT_cond_free(&e->granted);
+    if (e->mutex) ABT_mutex_free(&e->mutex);
+    free(e);
+}
+
+static int add_xstream(bake_io_engine_t* e)
+{
+    int ret;
+
+    ret = ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &e->pool,
+                                   ABT_SCHED_CONFIG_NULL,
+                                   &e->xstreams[e->num_xstreams]);
+    if (ret != ABT_SUCCESS) return BAKE_ERR_ARGOBOTS;
+    e->num_xstreams++;
+    return BAKE_SUCCESS;
+}
+
+static int engine_start(bake_io_engine_t** engine)
+{
+    bake_io_engine_t* e;
+
+    e = calloc(1, sizeof(*e));
+    if (!e) return BAKE_ERR_ALLOCATION;
+
+    if (ABT_mutex_create(&e->mutex) != ABT_SUCCESS
+        || ABT_cond_create(&e->granted) != ABT_SUCCESS
+        || ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC,
+                                 ABT_FALSE, &e->pool)
+               != ABT_SUCCESS
+        || add_xstream(e) != BAKE_SUCCESS) {
+        engine_stop(e);
+        return BAKE_ERR_ARGOBOTS;
+    }
+    e->aid = abt_io_init_pool(e->pool);
+    if (!e->aid) {
+        engine_stop(e);
+        return BAKE_ERR_IO;
+    }
+
+    *engine = e;
+    return BAKE_SUCCESS;
+}
+
+/* whether an operation can start now, starting a stream if needed */
+static int has_stream(bake_io_engine_t* e)
+{
+    if (e->in_flight >= e->max_threads) return 0;
+    return e->in_flight < e->num_xstreams || add_xstream(e) == BAKE_SUCCESS;
+}
+
+/* the engine runs as many streams as the most demanding queue may use */
+static void update_max_threads(bake_io_engine_t* e)
+{
+    bake_io_queue_t q;
+
+    e->max_threads = 0;
+    for (q = e->queues; q; q = q->next_queue)
+        if (q->max_threads > e->max_threads) e->max_threads = q->max_threads;
+}
+
+/* gives a stream to the first operation of the first waiting queue that
+ * is below its own limit, which then goes to the back of the line if it
+ * has more; returns 0 if there is no such operation or no stream for it
+ */
+static int grant_next(bake_io_engine_t* e)
+{
+    bake_io_queue_t   next, prev = NULL;
+    bake_io_waiter_t* waiter;
+
+    for (next = e->ready_head; next; prev = next, next = next->next_ready)
+        if (next->in_flight < next->max_threads) break;
+    if (!next || !has_stream(e)) return 0;
+
+    if (prev)
+        prev->next_ready = next->next_ready;
+    else
+        e->ready_head = next->next_ready;
+    if (e->ready_tail == next) e->ready_tail = prev;
+    next->next_ready = NULL;
+
+    waiter     = next->head;
+    next->head = waiter->next;
+    if (next->head) {
+        if (e->ready_tail)
+            e->ready_tail->next_ready = next;
+        else
+            e->ready_head = next;
+        e->ready_tail = next;
+    } else
+        next->tail = NULL;
+    next->in_flight++;
+    e->in_flight++;
+    waiter->granted = 1;
+    return 1;
+}
+
+/* lets in as many waiting operations as the limits allow */
+static void grant_waiting(bake_io_engine_t* e)
+{
+    int granted = 0;
+
+    while (grant_next(e)) granted = 1;
+    if (granted) ABT_cond_broadcast(e->granted);
+}
+
+int bake_io_queue_open(unsigned max_threads, bake_io_queue_t* queue)
+{
+    bake_io_queue_t q;
+    int             ret;
+
+    if (max_threads == 0) return BAKE_ERR_INVALID_ARG;
+    if (max_threads > BAKE_IO_MAX_THREADS) max_threads = BAKE_IO_MAX_THREADS;
+
+    q = calloc(1, sizeof(*q));
+    if (!q) return BAKE_ERR_ALLOCATION;
+    q->max_threads = max_threads;
+
+    pthread_mutex_lock(&engine_mutex);
+    if (!engine) {
+        ret = engine_start(&engine);
+        if (ret != BAKE_SUCCESS) {
+            pthread_mutex_unlock(&engine_mutex);
+            free(q);
+            return ret;
+        }
+    }
+    engine->num_queues++;
+    q->engine = engine;
+    pthread_mutex_unlock(&engine_mutex);
+
+    ABT_mutex_lock(q->engine->mutex);
+    q->next_queue     = q->engine->queues;
+    q->engine->queues = q;
+    update_max_threads(q->engine);
+    ABT_mutex_unlock(q->engine->mutex);
+
+    *queue = q;
+    return BAKE_SUCCESS;
+}
+
+void bake_io_queue_close(bake_io_queue_t queue)
+{
+    bake_io_engine_t* e = queue->engine;
+    bake_io_queue_t*  q;
+
+    ABT_mutex_lock(e->mutex);
+    for (q = &e->queues; *q != queue; q = &(*q)->next_queue)
+        ;
+    *q = queue->next_queue;
+    update_max_threads(e);
+    ABT_mutex_unlock(e->mutex);
+
+    e = NULL;
+    pthread_mutex_lock(&engine_mutex);
+    if (--queue->engine->num_queues == 0) {
+        e      = engine;
+        engine = NULL;
+    }
+    pthread_mutex_unlock(&engine_mutex);
+
+    if (e) engine_stop(e);
+    free(queue);
+}
+
+unsigned bake_io_queue_max_threads(bake_io_queue_t queue)
+{
+    unsigned max_threads;
+
+    ABT_mutex_lock(queue->engine->mutex);
+    max_threads = queue->max_threads;
+    ABT_mutex_unlock(queue->engine->mutex);
+    return max_threads;
+}
+
+abt_io_instance_id bake_io_queue_abtio(bake_io_queue_t queue)
+{
+    return queue->engine->aid;
+}
+
+void bake_io_enter(bake_io_queue_t queue)
+{
+    bake_io_engine_t* e;
+    bake_io_waiter_t  waiter = {0, NULL};
+
+    if (!queue) return;
+    e = queue->engine;
+
+    ABT_mutex_lock(e->mutex);
+    /* go straight in when no queue is waiting and there is a stream for
+     * the operation, starting one if needed
+     */
+    if (!e->ready_head && queue->in_flight < queue->max_threads
+        && has_stream(e)) {
+        queue->in_flight++;
+        e->in_flight++;
+        ABT_mutex_unlock(e->mutex);
+        return;
+    }
+
+    if (queue->tail)
+        queue->tail->next = &waiter;
+    else {
+        queue->head = &waiter;
+        /* the queue starts waiting */
+        if (e->ready_tail)
+            e->ready_tail->next_ready = queue;
+        else
+            e->ready_head = queue;
+        e->ready_tail = queue;
+    }
+    queue->tail = &waiter;
+    /* queues ahead of this one may all be at their limit */
+    grant_waiting(e);
+    while (!waiter.granted) ABT_cond_wait(e->granted, e->mutex);
+    ABT_mutex_unlock(e->mutex);
+}
+
+void bake_io_leave(bake_io_queue_t queue)
+{
+    bake_io_engine_t* e;
+
+    if (!queue) return;
+    e = queue->engine;
+
+    ABT_mutex_lock(e->mutex);
+    /* the stream goes to the next waiting operation, unless the limits
+     * were lowered below what is in flight
+     */
+    queue->in_flight--;
+    e->in_flight--;
+    grant_waiting(e);
+    ABT_mutex_unlock(e->mutex);
+}
+
+int bake_io_queue_set_max_threads(bake_io_queue_t queue, unsigned max_threads)
+{
+    bake_io_engine_t* e = queue->engine;
+
+    if (max_threads == 0) return BAKE_ERR_INVALID_ARG;
+    if (max_threads > BAKE_IO_MAX_THREADS) max_threads = BAKE_IO_MAX_THREADS;
+
+    ABT_mutex_lock(e->mutex);
+    queue->max_threads = max_threads;
+    update_max_threads(e);
+    /* waiting operations may use the streams a higher limit allows */
+    grant_waiting(e);
+    ABT_mutex_unlock(e->mutex);
+    return BAKE_SUCCESS;
+}
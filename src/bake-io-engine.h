@@ -0,0 +1,46 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __BAKE_IO_ENGINE_H
+#define __BAKE_IO_ENGINE_H
+
+#include <abt-io.h>
+
+/* The I/O engine of the process, shared by the file targets of all the
+ * providers that are not given an abt-io instance.  It runs abt-io
+ * operations on a single pool of execution streams, adding streams as
+ * outstanding I/O grows.  Each target submits through its own queue,
+ * which has at most max_threads operations in flight; the engine runs up
+ * to the largest max_threads of the open queues.  Once all the streams
+ * are busy, waiting operations are let through one queue at a time,
+ * round-robin, so that a busy target cannot starve the others.
+ */
+typedef struct bake_io_queue* bake_io_queue_t;
+
+/* opens a queue on the engine, starting the engine on first use */
+int bake_io_queue_open(unsigned max_threads, bake_io_queue_t* queue);
+
+/* closes the queue, stopping the engine with the last one */
+void bake_io_queue_close(bake_io_queue_t queue);
+
+/* sets the number of operations of the queue that may run at once,
+ * leaving the other queues alone; lowering it does not stop streams, but
+ * lets fewer operations of the queue in at once
+ */
+int bake_io_queue_set_max_threads(bake_io_queue_t queue, unsigned max_threads);
+
+/* number of operations of the queue that may run at once */
+unsigned bake_io_queue_max_threads(bake_io_queue_t queue);
+
+/* abt-io instance on which to issue the operations of the queue */
+abt_io_instance_id bake_io_queue_abtio(bake_io_queue_t queue);
+
+/* an operation takes a stream of the engine between these two calls;
+ * both do nothing on a NULL queue
+ */
+void bake_io_enter(bake_io_queue_t queue);
+void bake_io_leave(bake_io_queue_t queue);
+
+#endif
@@ -0,0 +1,560 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <json-c/json.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+
+/* bake-mem-backend
+ *
+ * This is an implementation of a back end for the Bake provider that keeps
+ * all data in volatile memory.  It is meant for scratch and burst-buffer
+ * use cases that do not need durability: persist is a no-op and the
+ * contents of a target are lost when it is detached.
+ *
+ * Each target owns a single arena of "capacity" bytes of address space,
+ * whose pages are only populated as regions are written.  Bulk reads and
+ * writes register just the part of the arena they move, so that nothing
+ * else gets pinned by transports that pin registered memory.  Regions are
+ * carved from the arena in power-of-two size classes.  Each class has its
+ * own free list (so that concurrent creates of different sizes do not
+ * contend); when a free list is empty a new chunk is taken from the
+ * untouched tail of the arena.  A bitmap records which chunks are
+ * allocated, so that a region removed twice, or used after its removal,
+ * is reported as unknown rather than corrupting the free lists.
+ */
+
+#define MEM_MIN_CLASS_SHIFT 6 /* smallest chunk is 64 bytes */
+#define MEM_NUM_CLASSES     (64 - MEM_MIN_CLASS_SHIFT)
+#define MEM_NULL_OFFSET     UINT64_MAX
+
+/* definition of internal BAKE region_id_t identifier for mem back end */
+typedef struct {
+    uint64_t offset; /* offset of the chunk within the arena */
+    uint64_t size;   /* size requested at creation time */
+} mem_region_id_t;
+
+typedef struct {
+    ABT_mutex mutex;
+    uint64_t  free_head; /* offset of first free chunk, or MEM_NULL_OFFSET */
+} mem_size_class_t;
+
+typedef struct {
+    bake_provider_t  provider;
+    char*            arena;      /* base address of the arena */
+    size_t           capacity;   /* size of the arena */
+    uint64_t*        allocated;  /* one bit per smallest chunk of the arena */
+    ABT_mutex        tail_mutex; /* protects tail */
+    uint64_t         tail;       /* offset of the untouched part of arena */
+    mem_size_class_t classes[MEM_NUM_CLASSES];
+} bake_mem_entry_t;
+
+/* allocation bit of the chunk at the given offset */
+#define MEM_BIT_WORD(_offset) ((_offset) >> MEM_MIN_CLASS_SHIFT >> 6)
+#define MEM_BIT_MASK(_offset) \
+    ((uint64_t)1 << (((_offset) >> MEM_MIN_CLASS_SHIFT) & 63))
+
+static int mem_is_allocated(bake_mem_entry_t* entry, uint64_t offset)
+{
+    return (__atomic_load_n(&entry->allocated[MEM_BIT_WORD(offset)],
+                            __ATOMIC_ACQUIRE)
+            & MEM_BIT_MASK(offset))
+        != 0;
+}
+
+static int mem_size_class(uint64_t size)
+{
+    int c = 0;
+    while (((uint64_t)1 << (c + MEM_MIN_CLASS_SHIFT)) < size) c++;
+    return c;
+}
+
+static int mem_alloc(bake_mem_entry_t* entry, uint64_t size, uint64_t* offset)
+{
+    int               c;
+    uint64_t          chunk_size;
+    mem_size_class_t* sc;
+
+    if (size > entry->capacity) return BAKE_ERR_ALLOCATION;
+    c          = mem_size_class(size);
+    chunk_size = (uint64_t)1 << (c + MEM_MIN_CLASS_SHIFT);
+    sc         = &entry->classes[c];
+
+    /* free chunks keep the offset of the next free chunk in their first
+     * bytes
+     */
+    ABT_mutex_lock(sc->mutex);
+    if (sc->free_head != MEM_NULL_OFFSET) {
+        *offset       = sc->free_head;
+        sc->free_head = *(uint64_t*)(entry->arena + *offset);
+        ABT_mutex_unlock(sc->mutex);
+    } else {
+        ABT_mutex_unlock(sc->mutex);
+
+        /* nothing recycled in this class; take a new chunk from the tail */
+        ABT_mutex_lock(entry->tail_mutex);
+        if (entry->tail + chunk_size > entry->capacity) {
+            ABT_mutex_unlock(entry->tail_mutex);
+            return BAKE_ERR_ALLOCATION;
+        }
+        *offset = entry->tail;
+        entry->tail += chunk_size;
+        ABT_mutex_unlock(entry->tail_mutex);
+    }
+
+    __atomic_or_fetch(&entry->allocated[MEM_BIT_WORD(*offset)],
+                      MEM_BIT_MASK(*offset), __ATOMIC_RELEASE);
+    return BAKE_SUCCESS;
+}
+
+/* gives the chunk of a region back to its free list, unless it is not
+ * allocated (anymore)
+ */
+static int mem_free(bake_mem_entry_t* entry, uint64_t offset, uint64_t size)
+{
+    mem_size_class_t* sc = &entry->classes[mem_size_class(size)];
+    uint64_t          old;
+
+    old = __atomic_fetch_and(&entry->allocated[MEM_BIT_WORD(offset)],
+                             ~MEM_BIT_MASK(offset), __ATOMIC_ACQ_REL);
+    if (!(old & MEM_BIT_MASK(offset))) return BAKE_ERR_UNKNOWN_REGION;
+
+    ABT_mutex_lock(sc->mutex);
+    *(uint64_t*)(entry->arena + offset) = sc->free_head;
+    sc->free_head                       = offset;
+    ABT_mutex_unlock(sc->mutex);
+    return BAKE_SUCCESS;
+}
+
+/* find the memory backing (part of) a region, checking bounds and that
+ * the region is allocated
+ */
+static char* mem_region_ptr(bake_mem_entry_t* entry,
+                            mem_region_id_t*  mrid,
+                            size_t            offset,
+                            size_t            size)
+{
+    if (offset > mrid->size || size > mrid->size - offset) return NULL;
+    if (mrid->offset % ((uint64_t)1 << MEM_MIN_CLASS_SHIFT)
+        || mrid->offset >= entry->capacity
+        || mrid->size > entry->capacity - mrid->offset
+        || !mem_is_allocated(entry, mrid->offset))
+        return NULL;
+    return entry->arena + mrid->offset + offset;
+}
+
+/* moves part of a region to or from a client, registering only that part
+ * of the arena for the transfer
+ */
+static int mem_transfer(bake_mem_entry_t* entry,
+                        hg_bulk_op_t      op,
+                        char*             ptr,
+                        size_t            size,
+                        hg_bulk_t         bulk,
+                        hg_addr_t         source,
+                        size_t            bulk_offset)
+{
+    hg_bulk_t   local = HG_BULK_NULL;
+    hg_size_t   local_size = size;
+    hg_return_t hret;
+
+    if (size == 0) return BAKE_SUCCESS;
+    hret = margo_bulk_create(entry->provider->mid, 1, (void**)&ptr,
+                             &local_size,
+                             op == HG_BULK_PULL ? HG_BULK_WRITE_ONLY
+                                                : HG_BULK_READ_ONLY,
+                             &local);
+    if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+    hret = margo_bulk_transfer(entry->provider->mid, op, source, bulk,
+                               bulk_offset, local, 0, size);
+    margo_bulk_free(local);
+    return hret == HG_SUCCESS ? BAKE_SUCCESS : BAKE_ERR_MERCURY;
+}
+
+static int bake_mem_makepool(const char* name, size_t size)
+{
+    /* nothing to do; mem targets only exist once they are attached */
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_mem_backend_initialize(bake_provider_t    provider,
+                                       const char*        path,
+                                       bake_target_id_t*  target,
+                                       backend_context_t* context)
+{
+    int                 ret              = BAKE_SUCCESS;
+    bake_mem_entry_t*   new_entry        = NULL;
+    struct json_object* mem_backend_json = NULL;
+    struct json_object* target_array     = NULL;
+    struct json_object* val;
+    int                 i;
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "mem_backend",
+                                "mem_backend", mem_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(mem_backend_json, "targets",
+                               "mem_backend.targets", target_array);
+    /* amount of memory reserved for each target */
+    CONFIG_HAS_OR_CREATE(mem_backend_json, int64, "capacity", 1073741824,
+                         "mem_backend.capacity", val);
+
+    new_entry           = calloc(1, sizeof(*new_entry));
+    new_entry->provider = provider;
+    new_entry->arena    = MAP_FAILED;
+    new_entry->capacity = json_object_get_int64(val);
+    if (json_object_get_int64(val) <= 0) {
+        BAKE_ERROR(provider->mid, "invalid mem_backend.capacity %ld",
+                   (long)json_object_get_int64(val));
+        ret = BAKE_ERR_INVALID_ARG;
+        goto error_cleanup;
+    }
+
+    /* reserve address space for the arena; pages are only populated as
+     * regions are written
+     */
+    new_entry->arena
+        = mmap(NULL, new_entry->capacity, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (new_entry->arena == MAP_FAILED) {
+        BAKE_ERROR(provider->mid, "mmap(): %s", strerror(errno));
+        ret = BAKE_ERR_NOMEM;
+        goto error_cleanup;
+    }
+
+    /* one allocation bit per smallest chunk, rounded up to whole words */
+    new_entry->allocated
+        = calloc(((new_entry->capacity >> MEM_MIN_CLASS_SHIFT) + 63) / 64,
+                 sizeof(*new_entry->allocated));
+    if (!new_entry->allocated) {
+        ret = BAKE_ERR_NOMEM;
+        goto error_cleanup;
+    }
+
+    ABT_mutex_create(&new_entry->tail_mutex);
+    for (i = 0; i < MEM_NUM_CLASSES; i++) {
+        ABT_mutex_create(&new_entry->classes[i].mutex);
+        new_entry->classes[i].free_head = MEM_NULL_OFFSET;
+    }
+
+    /* a mem target is always new */
+    uuid_generate(target->id);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+
+error_cleanup:
+    free(new_entry->allocated);
+    if (new_entry->arena != MAP_FAILED)
+        munmap(new_entry->arena, new_entry->capacity);
+    free(new_entry);
+    return (ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_mem_backend_finalize(backend_context_t context)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    int               i;
+
+    free(entry->allocated);
+    munmap(entry->arena, entry->capacity);
+    ABT_mutex_free(&entry->tail_mutex);
+    for (i = 0; i < MEM_NUM_CLASSES; i++)
+        ABT_mutex_free(&entry->classes[i].mutex);
+    free(entry);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_mem_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid->data;
+
+    assert(sizeof(mem_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    mrid->size = size;
+    return mem_alloc(entry, size, &mrid->offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_mem_write_raw(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size,
+                              const void*       data)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+    char*             ptr;
+
+    ptr = mem_region_ptr(entry, mrid, offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    memcpy(ptr, data, size);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_mem_write_bulk(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            region_offset,
+                               size_t            size,
+                               hg_bulk_t         bulk,
+                               hg_addr_t         source,
+                               size_t            bulk_offset)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+    char*             ptr;
+
+    ptr = mem_region_ptr(entry, mrid, region_offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* pull straight into the arena */
+    return mem_transfer(entry, HG_BULK_PULL, ptr, size, bulk, source,
+                        bulk_offset);
+}
+
+static int bake_mem_read_raw(backend_context_t context,
+                             bake_region_id_t  rid,
+                             size_t            offset,
+                             size_t            size,
+                             void**            data,
+                             uint64_t*         data_size,
+                             free_fn*          free_data)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+    char*             ptr;
+
+    *free_data = NULL;
+    *data      = NULL;
+    *data_size = 0;
+
+    if (offset > mrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+    if (offset + size > mrid->size) size = mrid->size - offset;
+
+    ptr = mem_region_ptr(entry, mrid, offset, size);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    *data      = ptr;
+    *data_size = size;
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_mem_read_bulk(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            region_offset,
+                              size_t            size,
+                              hg_bulk_t         bulk,
+                              hg_addr_t         source,
+                              size_t            bulk_offset,
+                              size_t*           bytes_read)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+    size_t            size_to_read;
+    char*             ptr;
+    int               ret;
+
+    *bytes_read = 0;
+
+    if (region_offset > mrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+    size_to_read = size;
+    if (region_offset + size > mrid->size)
+        size_to_read = mrid->size - region_offset;
+
+    ptr = mem_region_ptr(entry, mrid, region_offset, size_to_read);
+    if (!ptr) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* push straight from the arena */
+    ret = mem_transfer(entry, HG_BULK_PUSH, ptr, size_to_read, bulk, source,
+                       bulk_offset);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    *bytes_read = size_to_read;
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_mem_persist(backend_context_t context,
+                            bake_region_id_t  rid,
+                            size_t            offset,
+                            size_t            size)
+{
+    /* nothing is durable in this backend */
+    return BAKE_SUCCESS;
+}
+
+static int bake_mem_create_write_persist_raw(backend_context_t context,
+                                             const void*       data,
+                                             size_t            size,
+                                             bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_mem_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_mem_write_raw(context, *rid, 0, size, data);
+}
+
+static int bake_mem_create_write_persist_bulk(backend_context_t context,
+                                              hg_bulk_t         bulk,
+                                              hg_addr_t         source,
+                                              size_t            bulk_offset,
+                                              size_t            size,
+                                              bake_region_id_t* rid)
+{
+    int ret;
+
+    ret = bake_mem_create(context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    return bake_mem_write_bulk(context, *rid, 0, size, bulk, source,
+                               bulk_offset);
+}
+
+static int bake_mem_get_region_size(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    size_t*           size)
+{
+    mem_region_id_t* mrid = (mem_region_id_t*)rid.data;
+    *size                 = mrid->size;
+    return BAKE_SUCCESS;
+}
+
+static int bake_mem_get_region_data(backend_context_t context,
+                                    bake_region_id_t  rid,
+                                    void**            data)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+
+    *data = mem_region_ptr(entry, mrid, 0, 0);
+    if (!*data) return BAKE_ERR_UNKNOWN_REGION;
+    return BAKE_SUCCESS;
+}
+
+static int bake_mem_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_mem_entry_t* entry = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid  = (mem_region_id_t*)rid.data;
+
+    if (!mem_region_ptr(entry, mrid, 0, 0)) return BAKE_ERR_UNKNOWN_REGION;
+
+    return mem_free(entry, mrid->offset, mrid->size);
+}
+
+static int bake_mem_migrate_region(backend_context_t context,
+                                   bake_region_id_t  source_rid,
+                                   size_t            region_size,
+                                   int               remove_source,
+                                   const char*       dest_addr_str,
+                                   uint16_t          dest_provider_id,
+                                   bake_target_id_t  dest_target_id,
+                                   bake_region_id_t* dest_rid)
+{
+    bake_mem_entry_t* entry     = (bake_mem_entry_t*)context;
+    mem_region_id_t*  mrid      = (mem_region_id_t*)source_rid.data;
+    hg_addr_t         dest_addr   = HG_ADDR_NULL;
+    hg_bulk_t         region_bulk = HG_BULK_NULL;
+    hg_size_t         bulk_size   = region_size;
+    char*             ptr;
+    int               ret = BAKE_SUCCESS;
+
+    ptr = mem_region_ptr(entry, mrid, 0, region_size);
+    if (!ptr) {
+        ret = BAKE_ERR_UNKNOWN_REGION;
+        goto finish;
+    }
+
+    if (region_size != mrid->size) {
+        ret = BAKE_ERR_INVALID_ARG;
+        goto finish;
+    }
+
+    /* lookup the address of the destination provider */
+    hg_return_t hret
+        = margo_addr_lookup(entry->provider->mid, dest_addr_str, &dest_addr);
+    if (hret != HG_SUCCESS) {
+        ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    /* the destination pulls directly from the region */
+    if (region_size) {
+        hret = margo_bulk_create(entry->provider->mid, 1, (void**)&ptr,
+                                 &bulk_size, HG_BULK_READ_ONLY, &region_bulk);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            goto finish;
+        }
+    }
+
+    ret = bake_backend_migrate_region(entry->provider, dest_addr,
+                                      dest_provider_id, dest_target_id,
+                                      region_bulk, region_size, dest_rid);
+
+    if (ret != BAKE_SUCCESS) goto finish;
+
+    if (remove_source) ret = mem_free(entry, mrid->offset, mrid->size);
+
+finish:
+    margo_bulk_free(region_bulk);
+    margo_addr_free(entry->provider->mid, dest_addr);
+    return ret;
+}
+
+#ifdef USE_REMI
+static int bake_mem_create_fileset(backend_context_t context,
+                                   remi_fileset_t*   fileset)
+{
+    /* there are no files backing a mem target */
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+#endif
+
+bake_backend g_bake_mem_backend = {
+    .name                       = "mem",
+    ._initialize                = bake_mem_backend_initialize,
+    ._finalize                  = bake_mem_backend_finalize,
+    ._create                    = bake_mem_create,
+    ._write_raw                 = bake_mem_write_raw,
+    ._write_bulk                = bake_mem_write_bulk,
+    ._read_raw                  = bake_mem_read_raw,
+    ._read_bulk                 = bake_mem_read_bulk,
+    ._persist                   = bake_mem_persist,
+    ._create_write_persist_raw  = bake_mem_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_mem_create_write_persist_bulk,
+    ._get_region_size           = bake_mem_get_region_size,
+    ._get_region_data           = bake_mem_get_region_data,
+    ._remove                    = bake_mem_remove,
+    ._migrate_region            = bake_mem_migrate_region,
+    ._create_raw_target         = bake_mem_makepool,
+#ifdef USE_REMI
+    ._create_fileset = bake_mem_create_fileset,
+#endif
+};
@@ -26,7 +26,12 @@ void usage(int argc, char* argv[])
             "       path may be a file, directory, or device depending on the "
             "backend.\n");
     fprintf(stderr,
-            "           (prepend pmem: or file: to specify backend format)\n");
+            "           (prepend pmem:, file:, dax:, mem:, null:, or hybrid: "
+            "to specify backend format, or\n"
+            "            emu:<backend>: to emulate a slower device, or\n"
+            "            cache:<backend>: to cache hot regions in memory, or\n"
+            "            tier:<fast>,<slow> to move regions between two "
+            "targets)\n");
     fprintf(stderr,
             "       [-s size] create pool file named <pmem_pool> with "
             "specified size (K, M, G, etc. suffixes allowed)\n");
@@ -0,0 +1,307 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <json-c/json.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+
+/* bake-null-backend
+ *
+ * This is an implementation of a back end for the Bake provider that does
+ * not store anything.  It exists to measure the cost of the network and
+ * RPC layers in isolation: region ids are handed out without allocating
+ * any storage, bulk writes are pulled into the provider's pipeline buffers
+ * and then discarded, and reads are served from a fixed byte pattern.
+ * Every other operation succeeds without doing any work.
+ */
+
+/* definition of internal BAKE region_id_t identifier for null back end */
+typedef struct {
+    uint64_t seq;  /* unique (per target) sequence number */
+    uint64_t size; /* size requested at creation time */
+} null_region_id_t;
+
+typedef struct {
+    bake_provider_t provider;
+    int             pattern;   /* byte value returned by reads */
+    uint64_t        next_seq;  /* next region sequence number */
+    ABT_mutex       seq_mutex; /* protects next_seq */
+} bake_null_entry_t;
+
+static int bake_null_makepool(const char* name, size_t size)
+{
+    /* nothing to do; null targets have no backing storage */
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_null_backend_initialize(bake_provider_t    provider,
+                                        const char*        path,
+                                        bake_target_id_t*  target,
+                                        backend_context_t* context)
+{
+    bake_null_entry_t*  new_entry;
+    struct json_object* null_backend_json = NULL;
+    struct json_object* target_array      = NULL;
+    struct json_object* val;
+
+    if (!json_object_get_boolean(
+            json_object_object_get(provider->json_cfg, "pipeline_enable"))) {
+        BAKE_ERROR(provider->mid, "the bake null backend requires pipelining");
+        BAKE_ERROR(provider->mid,
+                   "please enable pipelining in the provider's json "
+                   "configuration or with bake-server-daemon -p");
+        return (BAKE_ERR_INVALID_ARG);
+    }
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "null_backend",
+                                "null_backend", null_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(null_backend_json, "targets",
+                               "null_backend.targets", target_array);
+    /* byte value that reads will return */
+    CONFIG_HAS_OR_CREATE(null_backend_json, int64, "pattern", 0,
+                         "null_backend.pattern", val);
+
+    new_entry           = calloc(1, sizeof(*new_entry));
+    new_entry->provider = provider;
+    new_entry->pattern  = json_object_get_int(val) & 0xff;
+    ABT_mutex_create(&new_entry->seq_mutex);
+
+    /* a null target is always new */
+    uuid_generate(target->id);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_null_backend_finalize(backend_context_t context)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+    ABT_mutex_free(&entry->seq_mutex);
+    free(entry);
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_null_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+    null_region_id_t*  nrid  = (null_region_id_t*)rid->data;
+
+    assert(sizeof(null_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    nrid->size = size;
+    ABT_mutex_lock(entry->seq_mutex);
+    nrid->seq = entry->next_seq++;
+    ABT_mutex_unlock(entry->seq_mutex);
+
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_null_write_raw(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            offset,
+                               size_t            size,
+                               const void*       data)
+{
+    null_region_id_t* nrid = (null_region_id_t*)rid.data;
+
+    if (offset + size > nrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* discard */
+    return BAKE_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_null_write_bulk(backend_context_t context,
+                                bake_region_id_t  rid,
+                                size_t            region_offset,
+                                size_t            size,
+                                hg_bulk_t         bulk,
+                                hg_addr_t         source,
+                                size_t            bulk_offset)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+    null_region_id_t*  nrid  = (null_region_id_t*)rid.data;
+
+    if (region_offset + size > nrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+
+    /* pull the data through the pipeline, then simply drop it */
+    return bake_backend_pipeline_transfer(entry->provider, HG_BULK_PULL, size,
+                                          0, bulk, source, bulk_offset, size,
+                                          NULL, NULL);
+}
+
+/* fills a pipeline buffer with the pattern before it is pushed */
+static int bake_null_fill(void* arg, void* buffer, size_t offset, size_t size)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)arg;
+
+    memset(buffer, entry->pattern, size);
+    return BAKE_SUCCESS;
+}
+
+static void bake_null_read_raw_free(backend_context_t context, void* ptr)
+{
+    free(ptr);
+}
+
+static int bake_null_read_raw(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size,
+                              void**            data,
+                              uint64_t*         data_size,
+                              free_fn*          free_data)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+    null_region_id_t*  nrid  = (null_region_id_t*)rid.data;
+    void*              buffer;
+
+    *free_data = NULL;
+    *data      = NULL;
+    *data_size = 0;
+
+    if (offset > nrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+    if (offset + size > nrid->size) size = nrid->size - offset;
+
+    buffer = malloc(size ? size : 1);
+    if (!buffer) return BAKE_ERR_NOMEM;
+    memset(buffer, entry->pattern, size);
+
+    *data      = buffer;
+    *data_size = size;
+    *free_data = bake_null_read_raw_free;
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_null_read_bulk(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            region_offset,
+                               size_t            size,
+                               hg_bulk_t         bulk,
+                               hg_addr_t         source,
+                               size_t            bulk_offset,
+                               size_t*           bytes_read)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+    null_region_id_t*  nrid  = (null_region_id_t*)rid.data;
+    int                ret;
+
+    *bytes_read = 0;
+
+    if (region_offset > nrid->size) return BAKE_ERR_OUT_OF_BOUNDS;
+    if (region_offset + size > nrid->size) size = nrid->size - region_offset;
+
+    ret = bake_backend_pipeline_transfer(entry->provider, HG_BULK_PUSH, size,
+                                         0, bulk, source, bulk_offset, size,
+                                         bake_null_fill, entry);
+    if (ret == BAKE_SUCCESS) *bytes_read = size;
+
+    return (ret);
+}
+
+static int bake_null_persist(backend_context_t context,
+                             bake_region_id_t  rid,
+                             size_t            offset,
+                             size_t            size)
+{
+    return BAKE_SUCCESS;
+}
+
+static int bake_null_get_region_size(backend_context_t context,
+                                     bake_region_id_t  rid,
+                                     size_t*           size)
+{
+    null_region_id_t* nrid = (null_region_id_t*)rid.data;
+    *size                  = nrid->size;
+    return BAKE_SUCCESS;
+}
+
+static int bake_null_get_region_data(backend_context_t context,
+                                     bake_region_id_t  rid,
+                                     void**            data)
+{
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+
+static int bake_null_remove(backend_context_t context, bake_region_id_t rid)
+{
+    return BAKE_SUCCESS;
+}
+
+static int bake_null_migrate_region(backend_context_t context,
+                                    bake_region_id_t  source_rid,
+                                    size_t            region_size,
+                                    int               remove_source,
+                                    const char*       dest_addr_str,
+                                    uint16_t          dest_provider_id,
+                                    bake_target_id_t  dest_target_id,
+                                    bake_region_id_t* dest_rid)
+{
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+
+/* transfers go through the pipeline, which must stay on */
+static int bake_null_reconfigure(backend_context_t context)
+{
+    bake_null_entry_t* entry = (bake_null_entry_t*)context;
+
+    if (!json_object_get_boolean(json_object_object_get(
+            entry->provider->json_cfg, "pipeline_enable"))) {
+        BAKE_ERROR(entry->provider->mid,
+                   "the bake null backend requires pipelining");
+        return BAKE_ERR_INVALID_ARG;
+    }
+    return BAKE_SUCCESS;
+}
+
+#ifdef USE_REMI
+static int bake_null_create_fileset(backend_context_t context,
+                                    remi_fileset_t*   fileset)
+{
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+#endif
+
+bake_backend g_bake_null_backend = {
+    .name                       = "null",
+    ._initialize                = bake_null_backend_initialize,
+    ._finalize                  = bake_null_backend_finalize,
+    ._create                    = bake_null_create,
+    ._write_raw                 = bake_null_write_raw,
+    ._write_bulk                = bake_null_write_bulk,
+    ._read_raw                  = bake_null_read_raw,
+    ._read_bulk                 = bake_null_read_bulk,
+    ._persist                   = bake_null_persist,
+    ._create_write_persist_raw  = NULL, /* use default implementation */
+    ._create_write_persist_bulk = NULL, /* use default implementation */
+    ._get_region_size           = bake_null_get_region_size,
+    ._get_region_data           = bake_null_get_region_data,
+    ._remove                    = bake_null_remove,
+    ._migrate_region            = bake_null_migrate_region,
+    ._create_raw_target         = bake_null_makepool,
+    ._reconfigure               = bake_null_reconfigure,
+#ifdef USE_REMI
+    ._create_fileset = bake_null_create_fileset,
+#endif
+};
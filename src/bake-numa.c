@@ -0,0 +1,140 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+/* for sched_getcpu */
+#define _GNU_SOURCE
+#include "bake-config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
+#include "bake-numa.h"
+
+#define BAKE_NUMA_MAX_NODES 64
+#define BAKE_NUMA_MAX_CPUS  4096
+#define BAKE_MPOL_PREFERRED 1
+
+static int            cpu_node[BAKE_NUMA_MAX_CPUS];
+static pthread_once_t cpu_node_once = PTHREAD_ONCE_INIT;
+
+/* calls fn on each cpu of a sysfs cpu list such as "0-3,8-11"; returns -1
+ * if the list of the node could not be read
+ */
+static int
+foreach_node_cpu(int node, void (*fn)(int cpu, void* arg), void* arg)
+{
+    char  path[64];
+    FILE* f;
+    int   first, last, cpu;
+    int   sep;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+             node);
+    f = fopen(path, "r");
+    if (!f) return -1;
+    while (fscanf(f, "%d", &first) == 1) {
+        last = first;
+        sep  = fgetc(f);
+        if (sep == '-') {
+            if (fscanf(f, "%d", &last) != 1) break;
+            sep = fgetc(f);
+        }
+        for (cpu = first; cpu <= last; cpu++) fn(cpu, arg);
+        if (sep != ',') break;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void set_cpu_node(int cpu, void* arg)
+{
+    if (cpu >= 0 && cpu < BAKE_NUMA_MAX_CPUS) cpu_node[cpu] = *(int*)arg;
+}
+
+static void read_cpu_nodes(void)
+{
+    int cpu, node;
+
+    for (cpu = 0; cpu < BAKE_NUMA_MAX_CPUS; cpu++) cpu_node[cpu] = -1;
+    for (node = 0; node < BAKE_NUMA_MAX_NODES; node++)
+        foreach_node_cpu(node, set_cpu_node, &node);
+}
+
+int bake_numa_current_node(void)
+{
+    int cpu;
+
+    pthread_once(&cpu_node_once, read_cpu_nodes);
+    cpu = sched_getcpu();
+    if (cpu < 0 || cpu >= BAKE_NUMA_MAX_CPUS) return -1;
+    return cpu_node[cpu];
+}
+
+int bake_numa_path_node(const char* path)
+{
+    /* where the node of the device is found, relative to its sysfs entry,
+     * for disks, partitions and controllers such as nvme
+     */
+    static const char* links[] = {"device/numa_node", "device/device/numa_node",
+                                  "../device/numa_node",
+                                  "../device/device/numa_node"};
+    struct stat        st;
+    char               sys_path[256];
+    FILE*              f;
+    dev_t              dev;
+    unsigned           i;
+    int                node = -1;
+
+    if (stat(path, &st) != 0) return -1;
+    /* device files such as /dev/dax0.0 stand for themselves */
+    dev = S_ISCHR(st.st_mode) || S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+
+    for (i = 0; i < sizeof(links) / sizeof(links[0]) && node < 0; i++) {
+        snprintf(sys_path, sizeof(sys_path), "/sys/dev/%s/%u:%u/%s",
+                 S_ISCHR(st.st_mode) ? "char" : "block", major(dev),
+                 minor(dev), links[i]);
+        f = fopen(sys_path, "r");
+        if (!f) continue;
+        if (fscanf(f, "%d", &node) != 1) node = -1;
+        fclose(f);
+    }
+    return node;
+}
+
+static void add_cpu(int cpu, void* arg)
+{
+    json_object_array_add(arg, json_object_new_int(cpu));
+}
+
+struct json_object* bake_numa_node_cpus(int node)
+{
+    struct json_object* cpus = json_object_new_array();
+
+    if (node >= 0) foreach_node_cpu(node, add_cpu, cpus);
+    return cpus;
+}
+
+int bake_numa_bind(void* ptr, size_t size, int node)
+{
+#ifdef SYS_mbind
+    unsigned long mask;
+
+    if (node < 0 || node >= BAKE_NUMA_MAX_NODES) return -1;
+    mask = 1UL << node;
+    /* preferred rather than bound, so that a full node does not fail the
+     * allocation
+     */
+    return syscall(SYS_mbind, ptr, size, BAKE_MPOL_PREFERRED, &mask,
+                   8 * sizeof(mask) + 1, 0);
+#else
+    return -1;
+#endif
+}
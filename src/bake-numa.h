@@ -0,0 +1,31 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __BAKE_NUMA_H
+#define __BAKE_NUMA_H
+
+#include <stddef.h>
+#include <json-c/json.h>
+
+/* NUMA topology helpers, reading it from sysfs; they all return -1 (or an
+ * empty array) when the topology cannot be found, e.g. on a single-node
+ * system or outside of Linux
+ */
+
+/* node of the cpu running the caller */
+int bake_numa_current_node(void);
+
+/* node of the device on which the given file or device lives */
+int bake_numa_path_node(const char* path);
+
+/* new json array of the cpus of the given node */
+struct json_object* bake_numa_node_cpus(int node);
+
+/* asks for the pages of the given memory, not touched yet, to be placed
+ * on the given node
+ */
+int bake_numa_bind(void* ptr, size_t size, int node);
+
+#endif
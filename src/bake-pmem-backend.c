@@ -42,8 +42,9 @@ typedef struct xfer_args {
     char*             local_ptr;
     size_t            bytes_issued;
     size_t            bytes_retired;
-    margo_bulk_poolset_t poolset;
-    size_t               poolset_max_size;
+    bake_buffer_pool_t   buffer_pool;
+    size_t               chunk_size;
+    uint64_t             deadline_us; // of the request, 0 for none
     int32_t              ret; // return value of the xfer_ult function
     int                  done;
     int                  ults_active;
@@ -203,6 +204,7 @@ static int write_transfer_data(margo_instance_id mid,
     hg_bulk_t         bulk_handle = HG_BULK_NULL;
     int               ret         = 0;
     struct xfer_args  x_args      = {0};
+    unsigned          pool_slot;
     size_t            i;
 
     /* find memory address for target object */
@@ -217,10 +219,11 @@ static int write_transfer_data(margo_instance_id mid,
     memory = region->data + region_offset;
 
     /* resolve addr, could be addr of rpc sender (normal case) or a third
-     * party (proxy write)
+     * party (proxy write); the provider keeps the buffers we may use until
+     * the transfer completes, even if pipelining is reconfigured meanwhile
      */
-    if (!json_object_get_boolean(
-            json_object_object_get(provider->json_cfg, "pipeline_enable"))) {
+    x_args.buffer_pool = bake_provider_get_buffers(provider, &pool_slot);
+    if (!x_args.buffer_pool) {
         /* normal path; no pipeline or intermediate buffers */
 
         /* create bulk handle for local side of transfer */
@@ -250,17 +253,18 @@ static int write_transfer_data(margo_instance_id mid,
         x_args.local_ptr     = memory;
         x_args.bytes_issued  = 0;
         x_args.bytes_retired = 0;
-        x_args.poolset       = provider->poolset;
-        margo_bulk_poolset_get_max(provider->poolset, &x_args.poolset_max_size);
-        x_args.ret = 0;
+        x_args.chunk_size
+            = bake_buffer_pool_chunk_size(x_args.buffer_pool, bulk_size);
+        x_args.deadline_us = bake_provider_deadline(provider);
+        x_args.ret         = 0;
         ABT_mutex_create(&x_args.mutex);
         ABT_eventual_create(0, &x_args.eventual);
 
-        for (i = 0; i < bulk_size; i += x_args.poolset_max_size)
+        for (i = 0; i < bulk_size; i += x_args.chunk_size)
             x_args.ults_active++;
 
         /* issue one ult per pipeline chunk */
-        for (i = 0; i < bulk_size; i += x_args.poolset_max_size) {
+        for (i = 0; i < bulk_size; i += x_args.chunk_size) {
             /* note: setting output tid to NULL to ignore; we will let
              * threads clean up themselves, with the last one setting an
              * eventual to signal completion.
@@ -279,6 +283,7 @@ static int write_transfer_data(margo_instance_id mid,
     }
 
 finish:
+    bake_provider_put_buffers(provider, pool_slot);
     margo_bulk_free(bulk_handle);
 
     return (ret);
@@ -321,7 +326,7 @@ static int bake_pmem_write_bulk(backend_context_t context,
 
     prid = (pmemobj_region_id_t*)rid.data;
 
-    ABT_pool handler_pool = entry->provider->handler_pool;
+    ABT_pool handler_pool = bake_provider_xfer_pool(entry->provider);
 
     int ret = write_transfer_data(entry->provider->mid, entry->provider,
                                   prid->oid, region_offset, bulk, bulk_offset,
@@ -497,7 +502,8 @@ static int bake_pmem_create_write_persist_bulk(backend_context_t context,
 {
     bake_pmem_entry_t*   entry = (bake_pmem_entry_t*)context;
     pmemobj_region_id_t* prid;
-    ABT_pool             handler_pool = entry->provider->handler_pool;
+    ABT_pool             handler_pool
+        = bake_provider_xfer_pool(entry->provider);
 
     /* TODO: this check needs to be somewhere else */
     assert(sizeof(pmemobj_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
@@ -566,6 +572,181 @@ static int bake_pmem_remove(backend_context_t context, bake_region_id_t rid)
     return BAKE_SUCCESS;
 }
 
+/* reserves all the regions and publishes them in one atomic action, rather
+ * than going through the allocator's redo log once per region; the type
+ * number of the objects is the group of the regions, 0 for none
+ */
+static int reserve_regions(bake_pmem_entry_t* entry,
+                           uint64_t           group,
+                           size_t             count,
+                           const uint64_t*    sizes,
+                           bake_region_id_t*  rids)
+{
+    struct pobj_action*  actions;
+    pmemobj_region_id_t* prid;
+    size_t               i;
+    int                  ret = BAKE_SUCCESS;
+
+    if (count == 0) return BAKE_SUCCESS;
+    actions = malloc(count * sizeof(*actions));
+    if (!actions) return BAKE_ERR_ALLOCATION;
+
+    for (i = 0; i < count; i++) {
+        prid = (pmemobj_region_id_t*)rids[i].data;
+#ifdef USE_SIZECHECK_HEADERS
+        prid->oid = pmemobj_reserve(entry->pmem_pool, &actions[i],
+                                    sizes[i] + sizeof(uint64_t), group);
+        if (OID_IS_NULL(prid->oid)) {
+            ret = BAKE_ERR_PMEM;
+            break;
+        }
+        region_content_t* region = pmemobj_direct(prid->oid);
+        region->size             = sizes[i];
+        pmemobj_persist(entry->pmem_pool, region, sizeof(region->size));
+#else
+        prid->oid
+            = pmemobj_reserve(entry->pmem_pool, &actions[i], sizes[i], group);
+        if (OID_IS_NULL(prid->oid)) {
+            ret = BAKE_ERR_PMEM;
+            break;
+        }
+#endif
+    }
+    if (ret != BAKE_SUCCESS)
+        pmemobj_cancel(entry->pmem_pool, actions, i);
+    else if (pmemobj_publish(entry->pmem_pool, actions, count) != 0) {
+        pmemobj_cancel(entry->pmem_pool, actions, count);
+        ret = BAKE_ERR_PMEM;
+    }
+
+    free(actions);
+    return ret;
+}
+
+static int bake_pmem_create_multi(backend_context_t context,
+                                  size_t            count,
+                                  const uint64_t*   sizes,
+                                  bake_region_id_t* rids)
+{
+    return reserve_regions(context, 0, count, sizes, rids);
+}
+
+static int bake_pmem_create_group(backend_context_t context,
+                                  uint64_t          group,
+                                  size_t            count,
+                                  const uint64_t*   sizes,
+                                  bake_region_id_t* rids)
+{
+    return reserve_regions(context, group, count, sizes, rids);
+}
+
+/* size a region was created with, which the provider accounts for as
+ * placed; without size headers the object does not record it, and its
+ * usable size is the closest there is
+ */
+static size_t placed_size(PMEMoid oid)
+{
+#ifdef USE_SIZECHECK_HEADERS
+    region_content_t* region = pmemobj_direct(oid);
+    if (region) return region->size;
+#endif
+    return pmemobj_alloc_usable_size(oid);
+}
+
+/* frees all the regions in one atomic action */
+static int bake_pmem_remove_multi(backend_context_t       context,
+                                  size_t                  count,
+                                  const bake_region_id_t* rids,
+                                  size_t*                 bytes_removed)
+{
+    bake_pmem_entry_t*   entry = (bake_pmem_entry_t*)context;
+    struct pobj_action*  actions;
+    pmemobj_region_id_t* prid;
+    size_t               i, size = 0;
+    int                  ret = BAKE_SUCCESS;
+
+    *bytes_removed = 0;
+    if (count == 0) return BAKE_SUCCESS;
+    actions = malloc(count * sizeof(*actions));
+    if (!actions) return BAKE_ERR_ALLOCATION;
+
+    for (i = 0; i < count; i++) {
+        prid = (pmemobj_region_id_t*)rids[i].data;
+        size += placed_size(prid->oid);
+        pmemobj_defer_free(entry->pmem_pool, prid->oid, &actions[i]);
+    }
+    if (pmemobj_publish(entry->pmem_pool, actions, count) != 0)
+        ret = BAKE_ERR_PMEM;
+    else
+        *bytes_removed = size;
+
+    free(actions);
+    return ret;
+}
+
+/* walks the objects of the pool for those whose type number is the group,
+ * freeing them a batch of actions at a time
+ */
+#define BAKE_PMEM_GROUP_BATCH 1024
+static int bake_pmem_remove_group(backend_context_t context,
+                                  uint64_t          group,
+                                  size_t*           bytes_removed)
+{
+    bake_pmem_entry_t*  entry = (bake_pmem_entry_t*)context;
+    struct pobj_action* actions;
+    PMEMoid             oid, next;
+    size_t              n = 0, size = 0;
+    int                 ret = BAKE_SUCCESS;
+
+    *bytes_removed = 0;
+    actions        = malloc(BAKE_PMEM_GROUP_BATCH * sizeof(*actions));
+    if (!actions) return BAKE_ERR_ALLOCATION;
+
+    for (oid = pmemobj_first(entry->pmem_pool); !OID_IS_NULL(oid);
+         oid = next) {
+        /* the object stays allocated until its batch is published */
+        next = pmemobj_next(oid);
+        if (pmemobj_type_num(oid) != group) continue;
+        size += placed_size(oid);
+        pmemobj_defer_free(entry->pmem_pool, oid, &actions[n++]);
+        if (n == BAKE_PMEM_GROUP_BATCH) {
+            if (pmemobj_publish(entry->pmem_pool, actions, n) != 0)
+                ret = BAKE_ERR_PMEM;
+            else
+                *bytes_removed += size;
+            n    = 0;
+            size = 0;
+        }
+    }
+    if (n) {
+        if (pmemobj_publish(entry->pmem_pool, actions, n) != 0)
+            ret = BAKE_ERR_PMEM;
+        else
+            *bytes_removed += size;
+    }
+
+    free(actions);
+    return ret;
+}
+
+/* pmemobj keeps no count of the allocated bytes unless its statistics
+ * were enabled for the whole life of the pool, so this walks the objects
+ */
+static int bake_pmem_get_stats(backend_context_t   context,
+                               struct json_object* stats)
+{
+    bake_pmem_entry_t* entry = (bake_pmem_entry_t*)context;
+    PMEMoid            oid;
+    uint64_t           used = 0;
+
+    for (oid = pmemobj_first(entry->pmem_pool); !OID_IS_NULL(oid);
+         oid = pmemobj_next(oid))
+        used += pmemobj_alloc_usable_size(oid);
+    json_object_object_add(stats, "bytes_used", json_object_new_int64(used));
+
+    return BAKE_SUCCESS;
+}
+
 static int bake_pmem_migrate_region(backend_context_t context,
                                     bake_region_id_t  source_rid,
                                     size_t            region_size,
@@ -608,57 +789,21 @@ static int bake_pmem_migrate_region(backend_context_t context,
         goto finish;
     }
 
-    { /* in this block we issue a create_write_persist to the destination */
-        hg_handle_t                     cwp_handle = HG_HANDLE_NULL;
-        bake_create_write_persist_in_t  cwp_in;
-        bake_create_write_persist_out_t cwp_out;
-
-        cwp_in.bti             = dest_target_id;
-        cwp_in.bulk_offset     = 0;
-        cwp_in.bulk_size       = region_size;
-        cwp_in.remote_addr_str = NULL;
+    { /* the destination pulls the data directly from the region */
+        hg_bulk_t region_bulk = HG_BULK_NULL;
 
         hret = margo_bulk_create(entry->provider->mid, 1,
                                  (void**)(&region_data), &region_size,
-                                 HG_BULK_READ_ONLY, &cwp_in.bulk_handle);
-        if (hret != HG_SUCCESS) {
-            ret = BAKE_ERR_MERCURY;
-            goto finish_scope;
-        }
-
-        hret = margo_create(entry->provider->mid, dest_addr,
-                            entry->provider->bake_create_write_persist_id,
-                            &cwp_handle);
-        if (hret != HG_SUCCESS) {
-            ret = BAKE_ERR_MERCURY;
-            goto finish_scope;
-        }
-
-        hret = margo_provider_forward(dest_provider_id, cwp_handle, &cwp_in);
-        if (hret != HG_SUCCESS) {
-            ret = BAKE_ERR_MERCURY;
-            goto finish_scope;
-        }
-
-        hret = margo_get_output(cwp_handle, &cwp_out);
+                                 HG_BULK_READ_ONLY, &region_bulk);
         if (hret != HG_SUCCESS) {
             ret = BAKE_ERR_MERCURY;
-            goto finish_scope;
-        }
-
-        if (cwp_out.ret != BAKE_SUCCESS) {
-            ret = cwp_out.ret;
-            goto finish_scope;
+            goto finish;
         }
-
-        *dest_rid = cwp_out.rid;
-        ret       = BAKE_SUCCESS;
-
-finish_scope:
-        margo_free_output(cwp_handle, &cwp_out);
-        margo_bulk_free(cwp_in.bulk_handle);
-        margo_destroy(cwp_handle);
-    } /* end of create-write-persist block */
+        ret = bake_backend_migrate_region(entry->provider, dest_addr,
+                                          dest_provider_id, dest_target_id,
+                                          region_bulk, region_size, dest_rid);
+        margo_bulk_free(region_bulk);
+    }
 
     if (ret != BAKE_SUCCESS) goto finish;
 
@@ -715,6 +860,11 @@ bake_backend g_bake_pmem_backend = {
     ._remove                    = bake_pmem_remove,
     ._migrate_region            = bake_pmem_migrate_region,
     ._create_raw_target         = bake_pmem_makepool,
+    ._get_stats                 = bake_pmem_get_stats,
+    ._create_multi              = bake_pmem_create_multi,
+    ._remove_multi              = bake_pmem_remove_multi,
+    ._create_group              = bake_pmem_create_group,
+    ._remove_group              = bake_pmem_remove_group,
 #ifdef USE_REMI
     ._create_fileset = bake_pmem_create_fileset,
 #endif
@@ -723,13 +873,10 @@ bake_backend g_bake_pmem_backend = {
 static void xfer_ult(void* _args)
 {
     struct xfer_args* args       = _args;
-    hg_bulk_t         local_bulk = HG_BULK_NULL;
+    bake_buffer_t*    buffer     = NULL;
     size_t            this_size;
     char*             this_local_ptr;
-    void*             local_bulk_ptr;
     size_t            this_remote_offset;
-    size_t            tmp_buf_size;
-    hg_uint32_t       tmp_count;
     int               turn_out_the_lights = 0;
     int               ret;
 
@@ -739,9 +886,14 @@ static void xfer_ult(void* _args)
      */
     ABT_mutex_lock(args->mutex);
     while (args->bytes_issued < args->bulk_size && !args->ret) {
+        if (bake_deadline_passed(args->deadline_us)) {
+            /* the client has given up on the transfer */
+            args->ret = BAKE_ERR_TIMEOUT;
+            break;
+        }
         /* calculate what work we will do in this cycle */
-        if ((args->bulk_size - args->bytes_issued) > args->poolset_max_size)
-            this_size = args->poolset_max_size;
+        if ((args->bulk_size - args->bytes_issued) > args->chunk_size)
+            this_size = args->chunk_size;
         else
             this_size = args->bulk_size - args->bytes_issued;
         this_local_ptr     = args->local_ptr + args->bytes_issued;
@@ -754,33 +906,27 @@ static void xfer_ult(void* _args)
         ABT_mutex_unlock(args->mutex);
 
         /* get buffer */
-        ret = margo_bulk_poolset_get(args->poolset, this_size, &local_bulk);
+        ret = bake_buffer_get(args->buffer_pool, this_size, &buffer);
         if (ret != 0 && args->ret == 0) {
             args->ret = ret;
             goto finished;
         }
 
-        /* find pointer of memory in buffer */
-        ret = margo_bulk_access(local_bulk, 0, this_size, HG_BULK_READWRITE, 1,
-                                &local_bulk_ptr, &tmp_buf_size, &tmp_count);
-        /* shouldn't ever fail in this use case */
-        assert(ret == 0);
-
         /* do the rdma transfer */
         ret = margo_bulk_transfer(args->mid, HG_BULK_PULL, args->remote_addr,
                                   args->remote_bulk, this_remote_offset,
-                                  local_bulk, 0, this_size);
+                                  buffer->bulk, 0, this_size);
         if (ret != 0 && args->ret == 0) {
             args->ret = ret;
             goto finished;
         }
 
         /* copy to real destination */
-        memcpy(this_local_ptr, local_bulk_ptr, this_size);
+        memcpy(this_local_ptr, buffer->ptr, this_size);
 
-        /* let go of bulk handle */
-        margo_bulk_poolset_release(args->poolset, local_bulk);
-        local_bulk = HG_BULK_NULL;
+        /* let go of the buffer */
+        bake_buffer_release(args->buffer_pool, buffer);
+        buffer = NULL;
 
         ABT_mutex_lock(args->mutex);
         args->bytes_retired += this_size;
@@ -802,8 +948,7 @@ static void xfer_ult(void* _args)
     ABT_mutex_unlock(args->mutex);
 
 finished:
-    if (local_bulk != HG_BULK_NULL)
-        margo_bulk_poolset_release(args->poolset, local_bulk);
+    if (buffer) bake_buffer_release(args->buffer_pool, buffer);
     ABT_mutex_lock(args->mutex);
     args->ults_active--;
     if (!args->ults_active) turn_out_the_lights = 1;
@@ -12,30 +12,142 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <margo.h>
-#include <margo-bulk-pool.h>
 #ifdef USE_REMI
     #include <remi/remi-client.h>
     #include <remi/remi-server.h>
 #endif
 #include "bake-server.h"
 #include "bake-backend.h"
+#include "bake-rpc.h"
+#include "bake-buffer-pool.h"
 #include "uthash.h"
 
-typedef struct {
+/* an operation waiting to be admitted on its target, see "admission" */
+typedef struct bake_admit_waiter {
+    uint64_t                  bytes;
+    ABT_eventual              admitted;
+    struct bake_admit_waiter* next;
+} bake_admit_waiter_t;
+
+typedef struct bake_target {
     bake_target_id_t  target_id;
     backend_context_t context;
     bake_backend_t    backend;
-    UT_hash_handle    hh;
+    uint64_t bytes_placed; /* bytes held by the regions of this target */
+    uint64_t in_flight;    /* RPCs currently using this target */
+    int      migrating;    /* set while the target is migrated with REMI */
+    int      small_class;  /* preferred for small regions by size_class */
+    ABT_pool pool;         /* runs the target's RPCs, if not ABT_POOL_NULL */
+
+    /* admission control, protected by the provider's admit_mutex */
+    uint64_t             max_ops;   /* in-flight limits, 0 for none */
+    uint64_t             max_bytes;
+    uint64_t             admitted_ops;
+    uint64_t             admitted_bytes;
+    uint64_t             deficit; /* deficit round-robin credit, in bytes */
+    bake_admit_waiter_t* waiters; /* in arrival order */
+    bake_admit_waiter_t* waiters_tail;
+    struct bake_target*  drr_next; /* in the provider's round if waiting */
 } bake_target_t;
 
+/* pool and execution streams created by the provider, for a target that
+ * has an object in the "target_pools" configuration or for transfers
+ */
+typedef struct bake_target_pool {
+    char*                    target_name;
+    ABT_pool                 pool;
+    int                      num_xstreams;
+    ABT_xstream*             xstreams;
+    struct bake_target_pool* next;
+} bake_target_pool_t;
+
+/* Snapshot of the targets of a provider.  RPC handlers read it without
+ * locking; attaching or detaching a target publishes a new table, and the
+ * old one is freed once no handler can still be reading it.
+ */
+typedef struct {
+    uint64_t        num_targets;
+    uint64_t        index_mask; /* index has index_mask + 1 slots */
+    bake_target_t** index;      /* open addressing on the target id */
+    bake_target_t*  targets[];  /* in attach order */
+} bake_target_table_t;
+
+/* Number of handlers looking up the target table, counted separately for
+ * each execution stream (modulo BAKE_READER_SLOTS) so that lookups from
+ * different execution streams do not write to the same cache line.
+ */
+#define BAKE_READER_SLOTS 64
+typedef struct {
+    uint64_t active;
+    char     pad[64 - sizeof(uint64_t)];
+} bake_reader_slot_t;
+
+/* token buckets of a client, identified by its address, see "qos" */
+typedef struct {
+    char           addr[256];
+    double         byte_tokens;
+    double         op_tokens;
+    double         last_refill; /* ABT_get_wtime() of the last update */
+    UT_hash_handle hh;
+} bake_qos_client_t;
+
+/* lanes in which RPC handlers wait, when "priority_lanes" are enabled */
+typedef enum {
+    BAKE_LANE_EAGER,    /* eager operations and noop */
+    BAKE_LANE_METADATA, /* everything else, including small bulk ops */
+    BAKE_LANE_BULK,     /* bulk ops above small_bulk_size, migrations */
+    BAKE_NUM_LANES
+} bake_lane_t;
+
+/* placement policies for regions created without naming a target */
+typedef enum {
+    BAKE_PLACEMENT_ROUND_ROBIN,
+    BAKE_PLACEMENT_LEAST_USED,
+    BAKE_PLACEMENT_LEAST_INFLIGHT,
+    BAKE_PLACEMENT_SIZE_CLASS,
+    BAKE_PLACEMENT_HASH
+} bake_placement_policy_t;
+
 typedef struct bake_provider {
     margo_instance_id mid;
-    ABT_pool   handler_pool; // pool used to run RPC handlers for this provider
-    ABT_rwlock lock; // write-locked during migration, read-locked by all other
-    // operations. There should be something better to avoid locking everything
-    // but we are going with that for simplicity for now.
-    uint64_t       num_targets;
-    bake_target_t* targets;
+    ABT_pool handler_pool; // pool used to run RPC handlers for this provider
+    bake_target_table_t* targets;       /* current table, see above */
+    ABT_mutex            targets_mutex; /* serializes table updates */
+    bake_reader_slot_t   readers[BAKE_READER_SLOTS];
+    ABT_pool*            target_pools;  /* provided in the init info */
+    unsigned             num_target_pools;
+    bake_target_pool_t*  own_pools;     /* created for targets, transfers */
+    ABT_pool             transfer_pool; /* pipelined transfers, or NULL */
+    ABT_pool     lanes[BAKE_NUM_LANES]; /* handler pools, by class of RPC */
+    int          lane_weights[BAKE_NUM_LANES];
+    uint64_t     lane_small_bulk_size;
+    int          num_lane_xstreams; /* 0 unless lanes are enabled */
+    ABT_xstream* lane_xstreams;
+    ABT_sched*   lane_scheds;
+
+    int                qos_enabled; /* a limit below is not 0 */
+    ABT_mutex          qos_mutex;   /* protects the fields below */
+    double             qos_bytes_per_sec;
+    double             qos_ops_per_sec;
+    double             qos_burst_sec; /* bucket depth, in seconds of rate */
+    uint64_t           qos_admissions;
+    bake_qos_client_t* qos_clients;
+
+    int            admit_enabled; /* an "admission" limit is not 0 */
+    ABT_mutex      admit_mutex;   /* protects the fields below */
+    uint64_t       admit_max_bytes; /* over all targets, 0 for none */
+    uint64_t       admit_bytes;     /* admitted over all targets */
+    uint64_t       admit_quantum;
+    bake_target_t* drr_head; /* targets with waiting operations */
+    bake_target_t* drr_tail;
+
+    uint64_t busy_max_pending;      /* data operations, 0 for no limit */
+    uint64_t busy_max_buffer_bytes; /* staged in buffers, 0 for no limit */
+    uint32_t busy_retry_after_ms;   /* hint sent with BAKE_ERR_BUSY */
+    uint64_t busy_pending;          /* data operations in progress */
+    uint64_t busy_buffer_bytes;     /* bytes they stage in buffers */
+    ABT_key  deadline_key; /* deadline of the request a handler serves */
+    uint64_t expired;      /* requests dropped past their deadline */
     abt_io_instance_id
         aid; /* externally provided abt-io instance, if present */
     hg_id_t
@@ -46,7 +158,14 @@ typedef struct bake_provider {
     remi_provider_t remi_provider;
 #endif
 
-    margo_bulk_poolset_t poolset; /* intermediate buffers, if used */
+    bake_buffer_pool_t buffer_pool; /* intermediate buffers, if used */
+    bake_reader_slot_t buffer_pool_users[BAKE_READER_SLOTS]; /* see below */
+    uint64_t           buffer_pool_frozen; /* set while it is rebuilt */
+    ABT_mutex          buffer_pool_mutex;  /* serializes rebuilds */
+
+    bake_placement_policy_t placement_policy;
+    uint64_t placement_small_size; /* size_class threshold */
+    uint64_t placement_next;       /* round-robin cursor */
 
     // list of RPC ids
     hg_id_t rpc_create_id;
@@ -55,13 +174,22 @@ typedef struct bake_provider {
     hg_id_t rpc_persist_id;
     hg_id_t rpc_create_write_persist_id;
     hg_id_t rpc_eager_create_write_persist_id;
+    hg_id_t rpc_eager_create_write_persist_multi_id;
     hg_id_t rpc_get_size_id;
     hg_id_t rpc_get_data_id;
     hg_id_t rpc_read_id;
     hg_id_t rpc_eager_read_id;
+    hg_id_t rpc_eager_read_multi_id;
+    hg_id_t rpc_writev_id;
+    hg_id_t rpc_readv_id;
+    hg_id_t rpc_compound_id;
     hg_id_t rpc_probe_id;
     hg_id_t rpc_noop_id;
     hg_id_t rpc_remove_id;
+    hg_id_t rpc_create_multi_id;
+    hg_id_t rpc_remove_multi_id;
+    hg_id_t rpc_remove_group_id;
+    hg_id_t rpc_set_param_id;
     hg_id_t rpc_migrate_region_id;
     hg_id_t rpc_migrate_target_id;
 
@@ -69,4 +197,61 @@ typedef struct bake_provider {
 
 } bake_provider;
 
+/* pool on which backends run the ULTs of pipelined transfers: the
+ * provider's transfer pool if it has one, otherwise the one the calling
+ * handler runs on, i.e. the pool of its target if it has one
+ */
+static inline ABT_pool bake_provider_xfer_pool(bake_provider_t provider)
+{
+    ABT_pool pool;
+
+    if (provider->transfer_pool != ABT_POOL_NULL)
+        return provider->transfer_pool;
+    if (ABT_self_get_last_pool(&pool) != ABT_SUCCESS || pool == ABT_POOL_NULL)
+        pool = provider->handler_pool;
+    return pool;
+}
+
+static inline void bake_provider_put_buffers(bake_provider_t provider,
+                                             unsigned        slot)
+{
+    __atomic_sub_fetch(&provider->buffer_pool_users[slot].active, 1,
+                       __ATOMIC_RELEASE);
+}
+
+/* pipeline buffers for a transfer, or NULL without pipelining; the pool
+ * cannot be rebuilt until the transfer calls bake_provider_put_buffers()
+ * with the slot returned here.  Transfers pin the pool in the slot of
+ * their execution stream, so that they do not contend with each other;
+ * they only wait while the pool is being rebuilt.
+ */
+static inline bake_buffer_pool_t
+bake_provider_get_buffers(bake_provider_t provider, unsigned* slot)
+{
+    int rank = 0;
+
+    if (ABT_xstream_self_rank(&rank) != ABT_SUCCESS) rank = 0;
+    *slot = rank % BAKE_READER_SLOTS;
+    for (;;) {
+        __atomic_add_fetch(&provider->buffer_pool_users[*slot].active, 1,
+                           __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&provider->buffer_pool_frozen, __ATOMIC_SEQ_CST))
+            return __atomic_load_n(&provider->buffer_pool, __ATOMIC_ACQUIRE);
+        bake_provider_put_buffers(provider, *slot);
+        while (__atomic_load_n(&provider->buffer_pool_frozen, __ATOMIC_SEQ_CST))
+            ABT_thread_yield();
+    }
+}
+
+/* deadline of the request the calling handler is serving, see
+ * bake_deadline_passed(); backends check it between pipeline chunks
+ */
+static inline uint64_t bake_provider_deadline(bake_provider_t provider)
+{
+    void* deadline_us = NULL;
+
+    ABT_self_get_specific(provider->deadline_key, &deadline_us);
+    return (uint64_t)(uintptr_t)deadline_us;
+}
+
 #endif
@@ -7,6 +7,8 @@
 #ifndef __BAKE_RPC
 #define __BAKE_RPC
 
+#include <time.h>
+#include <stdlib.h>
 #include <uuid.h>
 #include <margo.h>
 #include <mercury_proc_string.h>
@@ -18,19 +20,62 @@ static inline hg_return_t hg_proc_bake_target_id_t(hg_proc_t         proc,
 static inline hg_return_t hg_proc_bake_region_id_t(hg_proc_t         proc,
                                                    bake_region_id_t* rid);
 static inline hg_return_t hg_proc_bake_probe_out_t(hg_proc_t proc, void* out);
+static inline hg_return_t hg_proc_bake_readv_in_t(hg_proc_t proc, void* in);
+static inline hg_return_t hg_proc_bake_readv_out_t(hg_proc_t proc, void* out);
+static inline hg_return_t
+hg_proc_bake_eager_create_write_persist_multi_in_t(hg_proc_t proc, void* in);
+static inline hg_return_t
+hg_proc_bake_eager_create_write_persist_multi_out_t(hg_proc_t proc, void* out);
+static inline hg_return_t hg_proc_bake_eager_read_multi_in_t(hg_proc_t proc,
+                                                             void*     in);
+static inline hg_return_t hg_proc_bake_eager_read_multi_out_t(hg_proc_t proc,
+                                                              void*     out);
+static inline hg_return_t hg_proc_bake_create_multi_in_t(hg_proc_t proc,
+                                                         void*     in);
+static inline hg_return_t hg_proc_bake_create_multi_out_t(hg_proc_t proc,
+                                                          void*     out);
+static inline hg_return_t hg_proc_bake_remove_multi_in_t(hg_proc_t proc,
+                                                         void*     in);
+static inline hg_return_t hg_proc_bake_compound_in_t(hg_proc_t proc, void* in);
+static inline hg_return_t hg_proc_bake_compound_out_t(hg_proc_t proc,
+                                                      void*     out);
+
+/* Deadlines travel in the RPCs as microseconds since the epoch, 0 meaning
+ * none; they assume clients and providers have synchronized clocks.
+ */
+static inline uint64_t bake_deadline_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static inline int bake_deadline_passed(uint64_t deadline_us)
+{
+    return deadline_us && bake_deadline_now() > deadline_us;
+}
 
-/* BAKE create */
+/* BAKE create
+ *
+ * The create, create_write_persist and eager create_write_persist
+ * responses return the target that was used, since the provider chooses
+ * it when the request carries a null target id; this field broke the
+ * wire compatibility with older clients and providers.
+ */
 MERCURY_GEN_PROC(bake_create_in_t,
                  ((bake_target_id_t)(bti))((uint64_t)(region_size)))
-MERCURY_GEN_PROC(bake_create_out_t, ((int32_t)(ret))((bake_region_id_t)(rid)))
+MERCURY_GEN_PROC(bake_create_out_t,
+                 ((int32_t)(ret))((bake_target_id_t)(bti))(
+                     (bake_region_id_t)(rid)))
 
 /* BAKE write */
 MERCURY_GEN_PROC(bake_write_in_t,
                  ((bake_target_id_t)(bti))((bake_region_id_t)(rid))(
                      (uint64_t)(region_offset))((hg_bulk_t)(bulk_handle))(
                      (uint64_t)(bulk_offset))((uint64_t)(bulk_size))(
-                     (hg_string_t)(remote_addr_str)))
-MERCURY_GEN_PROC(bake_write_out_t, ((int32_t)(ret)))
+                     (hg_string_t)(remote_addr_str))((uint64_t)(deadline_us)))
+MERCURY_GEN_PROC(bake_write_out_t, ((int32_t)(ret))((uint32_t)(retry_after_ms)))
 
 /* BAKE eager write */
 typedef struct {
@@ -38,11 +83,13 @@ typedef struct {
     bake_region_id_t rid;
     uint64_t         region_offset;
     uint64_t         size;
+    uint64_t         deadline_us;
     char*            buffer;
 } bake_eager_write_in_t;
 static inline hg_return_t hg_proc_bake_eager_write_in_t(hg_proc_t proc,
                                                         void*     v_out_p);
-MERCURY_GEN_PROC(bake_eager_write_out_t, ((int32_t)(ret)))
+MERCURY_GEN_PROC(bake_eager_write_out_t,
+                 ((int32_t)(ret))((uint32_t)(retry_after_ms)))
 
 /* BAKE persist */
 MERCURY_GEN_PROC(bake_persist_in_t,
@@ -54,20 +101,24 @@ MERCURY_GEN_PROC(bake_persist_out_t, ((int32_t)(ret)))
 MERCURY_GEN_PROC(bake_create_write_persist_in_t,
                  ((bake_target_id_t)(bti))((uint64_t)(region_size))(
                      (hg_bulk_t)(bulk_handle))((uint64_t)(bulk_offset))(
-                     (uint64_t)(bulk_size))((hg_string_t)(remote_addr_str)))
+                     (uint64_t)(bulk_size))((hg_string_t)(remote_addr_str))(
+                     (uint64_t)(deadline_us)))
 MERCURY_GEN_PROC(bake_create_write_persist_out_t,
-                 ((int32_t)(ret))((bake_region_id_t)(rid)))
+                 ((int32_t)(ret))((bake_target_id_t)(bti))(
+                     (bake_region_id_t)(rid))((uint32_t)(retry_after_ms)))
 
 /* BAKE eager create/write/persist */
 typedef struct {
     bake_target_id_t bti;
     uint64_t         size;
+    uint64_t         deadline_us;
     char*            buffer;
 } bake_eager_create_write_persist_in_t;
 static inline hg_return_t
 hg_proc_bake_eager_create_write_persist_in_t(hg_proc_t proc, void* v_out_p);
 MERCURY_GEN_PROC(bake_eager_create_write_persist_out_t,
-                 ((int32_t)(ret))((bake_region_id_t)(rid)))
+                 ((int32_t)(ret))((bake_target_id_t)(bti))(
+                     (bake_region_id_t)(rid))((uint32_t)(retry_after_ms)))
 
 /* BAKE get size */
 MERCURY_GEN_PROC(bake_get_size_in_t,
@@ -84,21 +135,83 @@ MERCURY_GEN_PROC(bake_read_in_t,
                  ((bake_target_id_t)(bti))((bake_region_id_t)(rid))(
                      (uint64_t)(region_offset))((hg_bulk_t)(bulk_handle))(
                      (uint64_t)(bulk_offset))((uint64_t)(bulk_size))(
-                     (hg_string_t)(remote_addr_str)))
-MERCURY_GEN_PROC(bake_read_out_t, ((hg_size_t)(size))((int32_t)(ret)))
+                     (hg_string_t)(remote_addr_str))((uint64_t)(deadline_us)))
+MERCURY_GEN_PROC(bake_read_out_t,
+                 ((hg_size_t)(size))((int32_t)(ret))(
+                     (uint32_t)(retry_after_ms)))
 
 /* BAKE eager read */
 MERCURY_GEN_PROC(bake_eager_read_in_t,
                  ((bake_target_id_t)(bti))((bake_region_id_t)(rid))(
-                     (uint64_t)(region_offset))((uint64_t)(size)))
+                     (uint64_t)(region_offset))((uint64_t)(size))(
+                     (uint64_t)(deadline_us)))
 typedef struct {
     int32_t  ret;
+    uint32_t retry_after_ms;
     uint64_t size;
     char*    buffer;
 } bake_eager_read_out_t;
 static inline hg_return_t hg_proc_bake_eager_read_out_t(hg_proc_t proc,
                                                         void*     v_out_p);
 
+/* BAKE eager create/write/persist of several regions, whose contents
+ * follow each other in the message
+ */
+typedef struct {
+    bake_target_id_t bti;
+    uint64_t         count;
+    uint64_t*        sizes;
+    uint64_t         deadline_us;
+    char*            buffer;
+} bake_eager_create_write_persist_multi_in_t;
+typedef struct {
+    int32_t           ret;
+    uint32_t          retry_after_ms;
+    bake_target_id_t  bti;
+    uint64_t          count;
+    bake_region_id_t* rids;
+} bake_eager_create_write_persist_multi_out_t;
+
+/* BAKE eager read of several regions of a target, whose contents follow
+ * each other in the response
+ */
+typedef struct {
+    bake_target_id_t  bti;
+    uint64_t          count;
+    bake_region_id_t* rids;
+    uint64_t*         sizes;
+    uint64_t          deadline_us;
+} bake_eager_read_multi_in_t;
+typedef struct {
+    int32_t   ret;
+    uint32_t  retry_after_ms;
+    uint64_t  count;
+    uint64_t* sizes; /* bytes read from each region */
+    char*     buffer;
+} bake_eager_read_multi_out_t;
+
+/* BAKE compound request, running a list of operations on one target; the
+ * data of the writes follow each other in the request, and the data read
+ * in the response
+ */
+typedef struct {
+    bake_target_id_t bti;
+    uint64_t         count;
+    bake_op_t*       ops;
+    uint64_t         deadline_us;
+    uint64_t         data_size;
+    char*            data;
+} bake_compound_in_t;
+typedef struct {
+    int32_t           ret;
+    uint32_t          retry_after_ms;
+    bake_target_id_t  bti;
+    uint64_t          count; /* operations run */
+    bake_op_result_t* results;
+    uint64_t          data_size;
+    char*             data;
+} bake_compound_out_t;
+
 /* BAKE probe */
 MERCURY_GEN_PROC(bake_probe_in_t, ((uint64_t)(max_targets)))
 typedef struct {
@@ -107,11 +220,66 @@ typedef struct {
     bake_target_id_t* targets;
 } bake_probe_out_t;
 
+/* BAKE vectored read and write; the data of the segments follow each
+ * other in the bulk handle, in the order of the segments
+ */
+typedef struct {
+    uint64_t        num_segments;
+    bake_segment_t* segments;
+    hg_bulk_t       bulk_handle;
+    uint64_t        deadline_us;
+} bake_readv_in_t;
+typedef struct {
+    int32_t   ret;
+    uint32_t  retry_after_ms;
+    uint64_t  num_segments;
+    uint64_t* sizes; /* bytes read from each segment */
+} bake_readv_out_t;
+typedef bake_readv_in_t bake_writev_in_t;
+#define hg_proc_bake_writev_in_t hg_proc_bake_readv_in_t
+MERCURY_GEN_PROC(bake_writev_out_t,
+                 ((int32_t)(ret))((uint32_t)(retry_after_ms)))
+
 /* BAKE remove */
 MERCURY_GEN_PROC(bake_remove_in_t,
                  ((bake_target_id_t)(bti))((bake_region_id_t)(rid)))
 MERCURY_GEN_PROC(bake_remove_out_t, ((int32_t)(ret)))
 
+/* BAKE create and remove of several regions; the sizes and region ids
+ * travel in the messages, or through bulk_handle for large batches, in
+ * which case the sizes are followed by room for the new region ids
+ */
+typedef struct {
+    bake_target_id_t bti;
+    uint64_t         group; /* 0 for none */
+    uint64_t         count;
+    hg_bulk_t        bulk_handle;
+    uint64_t*        sizes;
+} bake_create_multi_in_t;
+typedef struct {
+    int32_t           ret;
+    bake_target_id_t  bti;
+    uint64_t          count; /* 0 if the ids went through the bulk handle */
+    bake_region_id_t* rids;
+} bake_create_multi_out_t;
+typedef struct {
+    bake_target_id_t  bti;
+    uint64_t          count;
+    hg_bulk_t         bulk_handle;
+    bake_region_id_t* rids;
+} bake_remove_multi_in_t;
+MERCURY_GEN_PROC(bake_remove_multi_out_t, ((int32_t)(ret)))
+
+/* BAKE remove of all the regions of a group */
+MERCURY_GEN_PROC(bake_remove_group_in_t,
+                 ((bake_target_id_t)(bti))((uint64_t)(group)))
+MERCURY_GEN_PROC(bake_remove_group_out_t, ((int32_t)(ret)))
+
+/* BAKE set param */
+MERCURY_GEN_PROC(bake_set_param_in_t,
+                 ((hg_const_string_t)(key))((hg_const_string_t)(value)))
+MERCURY_GEN_PROC(bake_set_param_out_t, ((int32_t)(ret)))
+
 /* BAKE migrate region */
 MERCURY_GEN_PROC(
     bake_migrate_region_in_t,
@@ -164,6 +332,7 @@ static inline hg_return_t hg_proc_bake_eager_write_in_t(hg_proc_t proc,
     hg_proc_bake_region_id_t(proc, &in->rid);
     hg_proc_uint64_t(proc, &in->region_offset);
     hg_proc_uint64_t(proc, &in->size);
+    hg_proc_uint64_t(proc, &in->deadline_us);
     if (in->size
         && (hg_proc_get_op(proc) == HG_ENCODE
             || hg_proc_get_op(proc) == HG_DECODE)) {
@@ -186,6 +355,7 @@ hg_proc_bake_eager_create_write_persist_in_t(hg_proc_t proc, void* v_out_p)
 
     hg_proc_bake_target_id_t(proc, &in->bti);
     hg_proc_uint64_t(proc, &in->size);
+    hg_proc_uint64_t(proc, &in->deadline_us);
     if (in->size
         && (hg_proc_get_op(proc) == HG_ENCODE
             || hg_proc_get_op(proc) == HG_DECODE)) {
@@ -207,6 +377,7 @@ static inline hg_return_t hg_proc_bake_eager_read_out_t(hg_proc_t proc,
     void*                  buf = NULL;
 
     hg_proc_int32_t(proc, &out->ret);
+    hg_proc_uint32_t(proc, &out->retry_after_ms);
     hg_proc_uint32_t(proc, &out->size);
     if (out->size
         && (hg_proc_get_op(proc) == HG_ENCODE
@@ -221,6 +392,290 @@ static inline hg_return_t hg_proc_bake_eager_read_out_t(hg_proc_t proc,
     return (HG_SUCCESS);
 }
 
+/* encodes or decodes an array of count integers, allocating it when
+ * decoding, or frees it
+ */
+static inline hg_return_t
+hg_proc_bake_uint64_array(hg_proc_t proc, uint64_t** array, uint64_t count)
+{
+    uint64_t i;
+
+    switch (hg_proc_get_op(proc)) {
+    case HG_DECODE:
+        *array = calloc(count ? count : 1, sizeof(**array));
+        if (!*array) return HG_NOMEM;
+        /* fall through */
+    case HG_ENCODE:
+        for (i = 0; i < count; i++) hg_proc_uint64_t(proc, &(*array)[i]);
+        break;
+    case HG_FREE:
+        free(*array);
+        *array = NULL;
+        break;
+    }
+    return HG_SUCCESS;
+}
+
+/* same as hg_proc_bake_uint64_array, for region ids */
+static inline hg_return_t hg_proc_bake_region_id_array(hg_proc_t          proc,
+                                                       bake_region_id_t** array,
+                                                       uint64_t           count)
+{
+    uint64_t i;
+
+    switch (hg_proc_get_op(proc)) {
+    case HG_DECODE:
+        *array = calloc(count ? count : 1, sizeof(**array));
+        if (!*array) return HG_NOMEM;
+        /* fall through */
+    case HG_ENCODE:
+        for (i = 0; i < count; i++)
+            hg_proc_bake_region_id_t(proc, &(*array)[i]);
+        break;
+    case HG_FREE:
+        free(*array);
+        *array = NULL;
+        break;
+    }
+    return HG_SUCCESS;
+}
+
+/* encodes the contents of count regions of the given sizes, which follow
+ * each other in buffer; decoding points buffer into the message rather
+ * than copying them
+ */
+static inline void hg_proc_bake_packed_data(hg_proc_t       proc,
+                                            char**          buffer,
+                                            const uint64_t* sizes,
+                                            uint64_t        count)
+{
+    uint64_t i, size = 0;
+    void*    buf;
+
+    if (hg_proc_get_op(proc) != HG_ENCODE && hg_proc_get_op(proc) != HG_DECODE)
+        return;
+    for (i = 0; i < count; i++) size += sizes[i];
+    if (!size) return;
+    buf = hg_proc_save_ptr(proc, size);
+    if (hg_proc_get_op(proc) == HG_ENCODE) memcpy(buf, *buffer, size);
+    if (hg_proc_get_op(proc) == HG_DECODE) *buffer = buf;
+    hg_proc_restore_ptr(proc, buf, size);
+}
+
+static inline hg_return_t
+hg_proc_bake_eager_create_write_persist_multi_in_t(hg_proc_t proc, void* data)
+{
+    bake_eager_create_write_persist_multi_in_t* in = data;
+    hg_return_t                                 ret;
+
+    hg_proc_bake_target_id_t(proc, &in->bti);
+    hg_proc_uint64_t(proc, &in->count);
+    ret = hg_proc_bake_uint64_array(proc, &in->sizes, in->count);
+    if (ret != HG_SUCCESS) return ret;
+    hg_proc_uint64_t(proc, &in->deadline_us);
+    hg_proc_bake_packed_data(proc, &in->buffer, in->sizes, in->count);
+    return HG_SUCCESS;
+}
+
+static inline hg_return_t
+hg_proc_bake_eager_create_write_persist_multi_out_t(hg_proc_t proc, void* data)
+{
+    bake_eager_create_write_persist_multi_out_t* out = data;
+
+    hg_proc_int32_t(proc, &out->ret);
+    hg_proc_uint32_t(proc, &out->retry_after_ms);
+    hg_proc_bake_target_id_t(proc, &out->bti);
+    hg_proc_uint64_t(proc, &out->count);
+    return hg_proc_bake_region_id_array(proc, &out->rids, out->count);
+}
+
+static inline hg_return_t hg_proc_bake_eager_read_multi_in_t(hg_proc_t proc,
+                                                             void*     data)
+{
+    bake_eager_read_multi_in_t* in = data;
+    hg_return_t                 ret;
+
+    hg_proc_bake_target_id_t(proc, &in->bti);
+    hg_proc_uint64_t(proc, &in->count);
+    ret = hg_proc_bake_region_id_array(proc, &in->rids, in->count);
+    if (ret != HG_SUCCESS) return ret;
+    ret = hg_proc_bake_uint64_array(proc, &in->sizes, in->count);
+    if (ret != HG_SUCCESS) return ret;
+    return hg_proc_uint64_t(proc, &in->deadline_us);
+}
+
+static inline hg_return_t hg_proc_bake_eager_read_multi_out_t(hg_proc_t proc,
+                                                              void*     data)
+{
+    bake_eager_read_multi_out_t* out = data;
+    hg_return_t                  ret;
+
+    hg_proc_int32_t(proc, &out->ret);
+    hg_proc_uint32_t(proc, &out->retry_after_ms);
+    hg_proc_uint64_t(proc, &out->count);
+    ret = hg_proc_bake_uint64_array(proc, &out->sizes, out->count);
+    if (ret != HG_SUCCESS) return ret;
+    hg_proc_bake_packed_data(proc, &out->buffer, out->sizes, out->count);
+    return HG_SUCCESS;
+}
+
+static inline hg_return_t hg_proc_bake_create_multi_in_t(hg_proc_t proc,
+                                                         void*     data)
+{
+    bake_create_multi_in_t* in = data;
+
+    hg_proc_bake_target_id_t(proc, &in->bti);
+    hg_proc_uint64_t(proc, &in->group);
+    hg_proc_uint64_t(proc, &in->count);
+    hg_proc_hg_bulk_t(proc, &in->bulk_handle);
+    /* the sizes are in the message unless they are in the bulk handle */
+    return hg_proc_bake_uint64_array(
+        proc, &in->sizes, in->bulk_handle == HG_BULK_NULL ? in->count : 0);
+}
+
+static inline hg_return_t hg_proc_bake_create_multi_out_t(hg_proc_t proc,
+                                                          void*     data)
+{
+    bake_create_multi_out_t* out = data;
+
+    hg_proc_int32_t(proc, &out->ret);
+    hg_proc_bake_target_id_t(proc, &out->bti);
+    hg_proc_uint64_t(proc, &out->count);
+    return hg_proc_bake_region_id_array(proc, &out->rids, out->count);
+}
+
+static inline hg_return_t hg_proc_bake_remove_multi_in_t(hg_proc_t proc,
+                                                         void*     data)
+{
+    bake_remove_multi_in_t* in = data;
+
+    hg_proc_bake_target_id_t(proc, &in->bti);
+    hg_proc_uint64_t(proc, &in->count);
+    hg_proc_hg_bulk_t(proc, &in->bulk_handle);
+    return hg_proc_bake_region_id_array(
+        proc, &in->rids, in->bulk_handle == HG_BULK_NULL ? in->count : 0);
+}
+
+static inline hg_return_t hg_proc_bake_segment_t(hg_proc_t       proc,
+                                                 bake_segment_t* seg)
+{
+    hg_proc_bake_target_id_t(proc, &seg->bti);
+    hg_proc_bake_region_id_t(proc, &seg->rid);
+    hg_proc_uint64_t(proc, &seg->region_offset);
+    return hg_proc_uint64_t(proc, &seg->size);
+}
+
+static inline hg_return_t hg_proc_bake_readv_in_t(hg_proc_t proc, void* data)
+{
+    bake_readv_in_t* in = (bake_readv_in_t*)data;
+    uint64_t         i;
+
+    hg_proc_uint64_t(proc, &in->num_segments);
+    switch (hg_proc_get_op(proc)) {
+    case HG_DECODE:
+        in->segments = calloc(in->num_segments ? in->num_segments : 1,
+                              sizeof(*in->segments));
+        if (!in->segments) return HG_NOMEM;
+        /* fall through */
+    case HG_ENCODE:
+        for (i = 0; i < in->num_segments; i++)
+            hg_proc_bake_segment_t(proc, &in->segments[i]);
+        break;
+    case HG_FREE:
+        free(in->segments);
+        in->segments = NULL;
+        break;
+    }
+    hg_proc_hg_bulk_t(proc, &in->bulk_handle);
+    hg_proc_uint64_t(proc, &in->deadline_us);
+    return HG_SUCCESS;
+}
+
+static inline hg_return_t hg_proc_bake_readv_out_t(hg_proc_t proc, void* data)
+{
+    bake_readv_out_t* out = (bake_readv_out_t*)data;
+
+    hg_proc_int32_t(proc, &out->ret);
+    hg_proc_uint32_t(proc, &out->retry_after_ms);
+    hg_proc_uint64_t(proc, &out->num_segments);
+    return hg_proc_bake_uint64_array(proc, &out->sizes, out->num_segments);
+}
+
+static inline hg_return_t hg_proc_bake_op_t(hg_proc_t proc, bake_op_t* op)
+{
+    /* buf stays on the client, its data travel packed */
+    hg_proc_int32_t(proc, &op->type);
+    hg_proc_int32_t(proc, &op->rid_step);
+    hg_proc_bake_region_id_t(proc, &op->rid);
+    hg_proc_uint64_t(proc, &op->offset);
+    return hg_proc_uint64_t(proc, &op->size);
+}
+
+static inline hg_return_t hg_proc_bake_op_result_t(hg_proc_t         proc,
+                                                   bake_op_result_t* result)
+{
+    hg_proc_int32_t(proc, &result->ret);
+    hg_proc_bake_region_id_t(proc, &result->rid);
+    return hg_proc_uint64_t(proc, &result->size);
+}
+
+static inline hg_return_t hg_proc_bake_compound_in_t(hg_proc_t proc,
+                                                     void*     data)
+{
+    bake_compound_in_t* in = data;
+    uint64_t            i;
+
+    hg_proc_bake_target_id_t(proc, &in->bti);
+    hg_proc_uint64_t(proc, &in->count);
+    switch (hg_proc_get_op(proc)) {
+    case HG_DECODE:
+        in->ops = calloc(in->count ? in->count : 1, sizeof(*in->ops));
+        if (!in->ops) return HG_NOMEM;
+        /* fall through */
+    case HG_ENCODE:
+        for (i = 0; i < in->count; i++) hg_proc_bake_op_t(proc, &in->ops[i]);
+        break;
+    case HG_FREE:
+        free(in->ops);
+        in->ops = NULL;
+        break;
+    }
+    hg_proc_uint64_t(proc, &in->deadline_us);
+    hg_proc_uint64_t(proc, &in->data_size);
+    hg_proc_bake_packed_data(proc, &in->data, &in->data_size, 1);
+    return HG_SUCCESS;
+}
+
+static inline hg_return_t hg_proc_bake_compound_out_t(hg_proc_t proc,
+                                                      void*     data)
+{
+    bake_compound_out_t* out = data;
+    uint64_t             i;
+
+    hg_proc_int32_t(proc, &out->ret);
+    hg_proc_uint32_t(proc, &out->retry_after_ms);
+    hg_proc_bake_target_id_t(proc, &out->bti);
+    hg_proc_uint64_t(proc, &out->count);
+    switch (hg_proc_get_op(proc)) {
+    case HG_DECODE:
+        out->results
+            = calloc(out->count ? out->count : 1, sizeof(*out->results));
+        if (!out->results) return HG_NOMEM;
+        /* fall through */
+    case HG_ENCODE:
+        for (i = 0; i < out->count; i++)
+            hg_proc_bake_op_result_t(proc, &out->results[i]);
+        break;
+    case HG_FREE:
+        free(out->results);
+        out->results = NULL;
+        break;
+    }
+    hg_proc_uint64_t(proc, &out->data_size);
+    hg_proc_bake_packed_data(proc, &out->data, &out->data_size, 1);
+    return HG_SUCCESS;
+}
+
 static inline hg_return_t hg_proc_bake_probe_out_t(hg_proc_t proc, void* data)
 {
     bake_probe_out_t* out = (bake_probe_out_t*)data;
@@ -36,7 +36,12 @@ static void usage(int argc, char** argv)
     fprintf(stderr, "       listen_addr is the Mercury address to listen on\n");
     fprintf(stderr, "       bake_pool is the path to the BAKE pool\n");
     fprintf(stderr,
-            "           (prepend pmem: or file: to specify backend format)\n");
+            "           (prepend pmem:, file:, dax:, mem:, null:, or hybrid: "
+            "to specify backend format, or\n"
+            "            emu:<backend>: to emulate a slower device, or\n"
+            "            cache:<backend>: to cache hot regions in memory, or\n"
+            "            tier:<fast>,<slow> to move regions between two "
+            "targets)\n");
     fprintf(stderr,
             "           (pools may be omitted if they are specified in json "
             "file)\n");
@@ -11,21 +11,27 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <margo.h>
-#include <margo-bulk-pool.h>
 #include <json-c/json.h>
 #ifdef USE_REMI
     #include <remi/remi-client.h>
     #include <remi/remi-server.h>
 #endif
 #include "bake-server.h"
-#include "uthash.h"
 #include "bake-rpc.h"
+#include "bake-numa.h"
 #include "bake-timing.h"
 #include "bake-provider.h"
 #include "bake-macros.h"
 
 extern bake_backend g_bake_pmem_backend;
 extern bake_backend g_bake_file_backend;
+extern bake_backend g_bake_dax_backend;
+extern bake_backend g_bake_mem_backend;
+extern bake_backend g_bake_null_backend;
+extern bake_backend g_bake_emu_backend;
+extern bake_backend g_bake_cache_backend;
+extern bake_backend g_bake_hybrid_backend;
+extern bake_backend g_bake_tier_backend;
 
 DECLARE_MARGO_RPC_HANDLER(bake_shutdown_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_create_ult)
@@ -34,13 +40,22 @@ DECLARE_MARGO_RPC_HANDLER(bake_eager_write_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_persist_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_create_write_persist_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_eager_create_write_persist_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_eager_create_write_persist_multi_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_get_size_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_get_data_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_read_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_eager_read_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_eager_read_multi_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_writev_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_readv_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_compound_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_probe_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_noop_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_remove_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_create_multi_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_remove_multi_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_remove_group_ult)
+DECLARE_MARGO_RPC_HANDLER(bake_set_param_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_migrate_region_ult)
 DECLARE_MARGO_RPC_HANDLER(bake_migrate_target_ult)
 
@@ -52,15 +67,1186 @@ static int validate_and_complete_config(struct json_object* _config,
                                         ABT_pool            _progress_pool);
 static int configure_targets(bake_provider_t     provider,
                              struct json_object* _config);
-static int setup_poolset(bake_provider_t provider);
+static int setup_buffer_pool(bake_provider_t provider);
+static int setup_placement(bake_provider_t provider);
+static bake_target_t* place_region(bake_provider_t provider,
+                                   uint64_t        region_size,
+                                   hg_addr_t       client);
+static int placement_small_class(bake_provider_t provider,
+                                 bake_backend_t  backend);
+
+bake_backend_t bake_backend_lookup(const char* backend_type)
+{
+    if (strcmp(backend_type, "pmem") == 0) return &g_bake_pmem_backend;
+    if (strcmp(backend_type, "file") == 0) return &g_bake_file_backend;
+    if (strcmp(backend_type, "dax") == 0) return &g_bake_dax_backend;
+    if (strcmp(backend_type, "mem") == 0) return &g_bake_mem_backend;
+    if (strcmp(backend_type, "null") == 0) return &g_bake_null_backend;
+    if (strcmp(backend_type, "emu") == 0) return &g_bake_emu_backend;
+    if (strcmp(backend_type, "cache") == 0) return &g_bake_cache_backend;
+    if (strcmp(backend_type, "hybrid") == 0) return &g_bake_hybrid_backend;
+    if (strcmp(backend_type, "tier") == 0) return &g_bake_tier_backend;
+    return NULL;
+}
+
+bake_backend_t bake_backend_parse_target(const char* name, const char** path)
+{
+    char*          backend_type;
+    bake_backend_t backend;
+    char*          tmp = strchr(name, ':');
+
+    if (tmp != NULL) {
+        backend_type                              = strdup(name);
+        backend_type[(unsigned long)(tmp - name)] = '\0';
+        *path                                     = tmp + 1;
+    } else {
+        backend_type = strdup("pmem");
+        *path        = name;
+    }
+
+    backend = bake_backend_lookup(backend_type);
+    if (!backend)
+        fprintf(stderr, "ERROR: unknown backend type \"%s\"\n", backend_type);
+    free(backend_type);
+    return backend;
+}
+
+uint64_t bake_backend_bytes_used(bake_backend_t    backend,
+                                 backend_context_t context)
+{
+    struct json_object* stats;
+    struct json_object* val;
+    uint64_t            bytes = 0;
+
+    if (!backend->_get_stats) return 0;
+    stats = json_object_new_object();
+    if (backend->_get_stats(context, stats) == BAKE_SUCCESS) {
+        val = json_object_object_get(stats, "bytes_used");
+        if (val && json_object_is_type(val, json_type_int))
+            bytes = json_object_get_int64(val);
+    }
+    json_object_put(stats);
+    return bytes;
+}
+
+/* creates the regions with the backend's batch create if it has one;
+ * only backends that keep track of groups can tag the regions with one
+ */
+int bake_backend_create_multi(bake_backend_t    backend,
+                              backend_context_t context,
+                              uint64_t          group,
+                              size_t            count,
+                              const uint64_t*   sizes,
+                              bake_region_id_t* rids)
+{
+    size_t i;
+    int    ret;
+
+    if (group) {
+        if (!backend->_create_group) return BAKE_ERR_OP_UNSUPPORTED;
+        return backend->_create_group(context, group, count, sizes, rids);
+    }
+    if (backend->_create_multi)
+        return backend->_create_multi(context, count, sizes, rids);
+    for (i = 0; i < count; i++) {
+        ret = backend->_create(context, sizes[i], &rids[i]);
+        if (ret != BAKE_SUCCESS) {
+            /* a failed batch leaves no region behind */
+            while (i-- > 0) backend->_remove(context, rids[i]);
+            return ret;
+        }
+    }
+    return BAKE_SUCCESS;
+}
+
+/* removes the regions with the backend's batch remove if it has one,
+ * returning the first error; the size of the regions removed, even when
+ * some could not be, goes to bytes_removed if not NULL
+ */
+int bake_backend_remove_multi(bake_backend_t          backend,
+                              backend_context_t       context,
+                              size_t                  count,
+                              const bake_region_id_t* rids,
+                              size_t*                 bytes_removed)
+{
+    size_t i, removed = 0, size;
+    int    ret = BAKE_SUCCESS, r;
+
+    if (backend->_remove_multi) {
+        ret = backend->_remove_multi(context, count, rids, &removed);
+    } else {
+        for (i = 0; i < count; i++) {
+            if (!bytes_removed
+                || backend->_get_region_size(context, rids[i], &size)
+                       != BAKE_SUCCESS)
+                size = 0;
+            r = backend->_remove(context, rids[i]);
+            if (r == BAKE_SUCCESS) removed += size;
+            if (ret == BAKE_SUCCESS) ret = r;
+        }
+    }
+    if (bytes_removed) *bytes_removed = removed;
+    return ret;
+}
+
+/* the destination of a migration may shed load like for any client, but
+ * the region has to get there, so the sender insists longer than clients
+ * do by default
+ */
+#define BAKE_MIGRATE_BUSY_RETRIES    16
+#define BAKE_MIGRATE_MAX_BACKOFF_MS 1000
+
+int bake_backend_migrate_region(bake_provider_t   provider,
+                                hg_addr_t         dest_addr,
+                                uint16_t          dest_provider_id,
+                                bake_target_id_t  dest_target_id,
+                                hg_bulk_t         bulk,
+                                size_t            region_size,
+                                bake_region_id_t* dest_rid)
+{
+    hg_handle_t                     handle = HG_HANDLE_NULL;
+    bake_create_write_persist_in_t  in     = {0};
+    bake_create_write_persist_out_t out;
+    hg_return_t                     hret;
+    double                          delay_ms;
+    int                             attempt, ret;
+
+    in.bti         = dest_target_id;
+    in.region_size = region_size;
+    in.bulk_handle = bulk;
+    in.bulk_offset = 0;
+    in.bulk_size   = region_size;
+
+    hret = margo_create(provider->mid, dest_addr,
+                        provider->bake_create_write_persist_id, &handle);
+    if (hret != HG_SUCCESS) return BAKE_ERR_MERCURY;
+
+    for (attempt = 0;; attempt++) {
+        hret = margo_provider_forward(dest_provider_id, handle, &in);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            break;
+        }
+        hret = margo_get_output(handle, &out);
+        if (hret != HG_SUCCESS) {
+            ret = BAKE_ERR_MERCURY;
+            break;
+        }
+        ret = out.ret;
+        if (ret == BAKE_SUCCESS) *dest_rid = out.rid;
+        if (ret != BAKE_ERR_BUSY || attempt >= BAKE_MIGRATE_BUSY_RETRIES) {
+            margo_free_output(handle, &out);
+            break;
+        }
+        delay_ms = out.retry_after_ms ? out.retry_after_ms : 1;
+        delay_ms *= 1 << (attempt < 10 ? attempt : 10);
+        if (delay_ms > BAKE_MIGRATE_MAX_BACKOFF_MS)
+            delay_ms = BAKE_MIGRATE_MAX_BACKOFF_MS;
+        margo_free_output(handle, &out);
+        margo_thread_sleep(provider->mid, delay_ms);
+    }
+
+    margo_destroy(handle);
+    return ret;
+}
+
+void bake_backend_unlist_target(bake_provider_t provider,
+                                bake_backend_t  backend,
+                                const char*     path)
+{
+    struct json_object* backend_json;
+    struct json_object* targets;
+    struct json_object* val;
+    char                key[64];
+    int                 i;
+
+    snprintf(key, sizeof(key), "%s_backend", backend->name);
+    backend_json = json_object_object_get(provider->json_cfg, key);
+    if (!backend_json) return;
+    targets = json_object_object_get(backend_json, "targets");
+    if (!targets || !json_object_is_type(targets, json_type_array)) return;
+
+    for (i = (int)json_object_array_length(targets) - 1; i >= 0; i--) {
+        val = json_object_array_get_idx(targets, i);
+        if (strcmp(json_object_get_string(val), path) == 0) {
+            json_object_array_del_idx(targets, i, 1);
+            break;
+        }
+    }
+}
+
+typedef struct pipeline_args {
+    bake_provider_t        provider;
+    hg_bulk_op_t           op;
+    size_t                 extent_size;
+    size_t                 skip;
+    hg_bulk_t              remote_bulk;
+    hg_addr_t              remote_addr;
+    size_t                 remote_offset;
+    size_t                 bulk_size;
+    bake_pipeline_relay_fn relay;
+    void*                  relay_arg;
+    bake_buffer_pool_t     buffer_pool; /* held for the whole transfer */
+    size_t                 chunk_size;
+    uint64_t               deadline_us; /* of the request, 0 for none */
+    /* shared state, protected by mutex */
+    size_t       issued; /* bytes of the extent handed out to ULTs */
+    int32_t      ret;    /* first error, 0 if none */
+    int          ults_active;
+    ABT_mutex    mutex;
+    ABT_eventual eventual; /* set by the last ULT to finish */
+} pipeline_args_t;
+
+/* moves one chunk between the client and a pipeline buffer, and between
+ * the buffer and the backend, in the order the direction requires
+ */
+static int pipeline_chunk(pipeline_args_t* args,
+                          bake_buffer_t*   buffer,
+                          size_t           chunk_offset,
+                          size_t           chunk_size)
+{
+    size_t start = chunk_offset > args->skip ? chunk_offset : args->skip;
+    size_t end   = chunk_offset + chunk_size;
+    int    ret;
+
+    /* part of the chunk that is exchanged with the client, if any */
+    if (end > args->skip + args->bulk_size) end = args->skip + args->bulk_size;
+    if (end < start) end = start;
+
+    if (args->op == HG_BULK_PUSH && args->relay) {
+        ret = args->relay(args->relay_arg, buffer->ptr, chunk_offset,
+                          chunk_size);
+        if (ret != BAKE_SUCCESS) return ret;
+    }
+    if (end > start
+        && margo_bulk_transfer(args->provider->mid, args->op,
+                               args->remote_addr, args->remote_bulk,
+                               args->remote_offset + start - args->skip,
+                               buffer->bulk, start - chunk_offset,
+                               end - start)
+               != HG_SUCCESS)
+        return BAKE_ERR_MERCURY;
+    if (args->op == HG_BULK_PULL && args->relay)
+        return args->relay(args->relay_arg, buffer->ptr, chunk_offset,
+                           chunk_size);
+    return BAKE_SUCCESS;
+}
+
+/* worker for bake_backend_pipeline_transfer(); takes chunks until the
+ * whole extent has been handed out or the transfer failed
+ */
+static void pipeline_ult(void* _args)
+{
+    pipeline_args_t* args   = _args;
+    bake_buffer_t*   buffer = NULL;
+    size_t           this_offset;
+    size_t           this_size;
+    int              turn_out_the_lights = 0;
+    int              ret;
+
+    ABT_mutex_lock(args->mutex);
+    while (args->issued < args->extent_size && !args->ret) {
+        if (bake_deadline_passed(args->deadline_us)) {
+            /* the client has given up on the transfer */
+            args->ret = BAKE_ERR_TIMEOUT;
+            break;
+        }
+        this_offset = args->issued;
+        this_size   = args->extent_size - this_offset;
+        if (this_size > args->chunk_size) this_size = args->chunk_size;
+        args->issued += this_size;
+
+        /* drop mutex while we work on our local piece */
+        ABT_mutex_unlock(args->mutex);
+
+        /* this will block until a buffer is available if pool is exhausted */
+        ret = bake_buffer_get(args->buffer_pool, this_size, &buffer);
+        if (ret == BAKE_SUCCESS) {
+            ret = pipeline_chunk(args, buffer, this_offset, this_size);
+            bake_buffer_release(args->buffer_pool, buffer);
+        }
+
+        ABT_mutex_lock(args->mutex);
+        if (ret != BAKE_SUCCESS && args->ret == 0) args->ret = ret;
+    }
+    args->ults_active--;
+    /* The ULT that sets active to zero is the last one that can possibly
+     * hold this mutex
+     */
+    if (!args->ults_active) turn_out_the_lights = 1;
+    ABT_mutex_unlock(args->mutex);
+
+    /* last ULT to exit cleans up remaining resources and signals caller */
+    if (turn_out_the_lights) {
+        ABT_mutex_free(&args->mutex);
+        ABT_eventual_set(args->eventual, NULL, 0);
+    }
+}
+
+int bake_backend_pipeline_transfer(bake_provider_t        provider,
+                                   hg_bulk_op_t           op,
+                                   size_t                 extent_size,
+                                   size_t                 skip,
+                                   hg_bulk_t              remote_bulk,
+                                   hg_addr_t              remote_addr,
+                                   size_t                 remote_offset,
+                                   size_t                 bulk_size,
+                                   bake_pipeline_relay_fn relay,
+                                   void*                  arg)
+{
+    pipeline_args_t args = {0};
+    unsigned        pool_slot;
+    size_t          i;
+
+    if (extent_size == 0) return BAKE_SUCCESS;
+
+    args.provider      = provider;
+    args.op            = op;
+    args.extent_size   = extent_size;
+    args.skip          = skip;
+    args.remote_bulk   = remote_bulk;
+    args.remote_addr   = remote_addr;
+    args.remote_offset = remote_offset;
+    args.bulk_size     = bulk_size;
+    args.relay         = relay;
+    args.relay_arg     = arg;
+    args.buffer_pool   = bake_provider_get_buffers(provider, &pool_slot);
+    if (!args.buffer_pool) {
+        /* pipelining was disabled at runtime */
+        bake_provider_put_buffers(provider, pool_slot);
+        return BAKE_ERR_INVALID_ARG;
+    }
+    args.chunk_size  = bake_buffer_pool_chunk_size(args.buffer_pool,
+                                                  extent_size);
+    args.deadline_us = bake_provider_deadline(provider);
+    ABT_mutex_create(&args.mutex);
+    ABT_eventual_create(0, &args.eventual);
+
+    /* one ULT per chunk; count them all before any can finish */
+    for (i = 0; i < extent_size; i += args.chunk_size) args.ults_active++;
+    for (i = 0; i < extent_size; i += args.chunk_size) {
+        /* NOTE: deliberately set output tid to NULL to ignore.  The last
+         * thread out of this set to complete will signal eventual below,
+         * rather than joining
+         */
+        ABT_thread_create(bake_provider_xfer_pool(provider), pipeline_ult,
+                          &args, ABT_THREAD_ATTR_NULL, NULL);
+    }
+
+    ABT_eventual_wait(args.eventual, NULL);
+    ABT_eventual_free(&args.eventual);
+    bake_provider_put_buffers(provider, pool_slot);
+
+    /* consolidated error code (0 if all successful, otherwise first
+     * non-zero error code)
+     */
+    return (args.ret);
+}
+
+static uint64_t target_id_hash(const bake_target_id_t* target_id)
+{
+    uint64_t h;
+
+    /* target ids are random uuids, any 8 bytes of them will do */
+    memcpy(&h, target_id->id, sizeof(h));
+    return h ^ (h >> 29);
+}
+
+/* builds a table holding the given targets */
+static bake_target_table_t* target_table_create(bake_target_t** targets,
+                                                uint64_t        num_targets)
+{
+    bake_target_table_t* table;
+    uint64_t             slots = 4;
+    uint64_t             i, h;
+
+    while (slots < 2 * num_targets) slots *= 2;
+    table = calloc(1, sizeof(*table) + num_targets * sizeof(bake_target_t*)
+                          + slots * sizeof(bake_target_t*));
+    if (!table) return NULL;
+    table->num_targets = num_targets;
+    table->index_mask  = slots - 1;
+    table->index       = table->targets + num_targets;
+    for (i = 0; i < num_targets; i++) {
+        table->targets[i] = targets[i];
+        h = target_id_hash(&targets[i]->target_id) & table->index_mask;
+        while (table->index[h]) h = (h + 1) & table->index_mask;
+        table->index[h] = targets[i];
+    }
+    return table;
+}
+
+static bake_target_t* target_table_find(bake_target_table_t* table,
+                                        bake_target_id_t     target_id)
+{
+    bake_target_t* target;
+    uint64_t       h = target_id_hash(&target_id) & table->index_mask;
+
+    while ((target = table->index[h]) != NULL) {
+        if (memcmp(&target->target_id, &target_id, sizeof(target_id)) == 0)
+            return target;
+        h = (h + 1) & table->index_mask;
+    }
+    return NULL;
+}
+
+/* Readers of the target table announce themselves in the slot of their
+ * execution stream for the duration of the lookup only, which must not
+ * yield.  A writer that has published a new table waits until every slot
+ * has been seen empty; after that, no reader can still hold a pointer into
+ * the old table.
+ */
+static unsigned reader_enter(bake_provider_t provider)
+{
+    int rank = 0;
+
+    if (ABT_xstream_self_rank(&rank) != ABT_SUCCESS) rank = 0;
+    rank %= BAKE_READER_SLOTS;
+    __atomic_add_fetch(&provider->readers[rank].active, 1, __ATOMIC_SEQ_CST);
+    return rank;
+}
+
+static void reader_exit(bake_provider_t provider, unsigned slot)
+{
+    __atomic_sub_fetch(&provider->readers[slot].active, 1, __ATOMIC_RELEASE);
+}
+
+static void wait_for_readers(bake_provider_t provider)
+{
+    unsigned i;
+
+    for (i = 0; i < BAKE_READER_SLOTS; i++)
+        while (__atomic_load_n(&provider->readers[i].active, __ATOMIC_SEQ_CST))
+            ABT_thread_yield();
+}
+
+/* replaces the target table; the caller holds targets_mutex */
+static void publish_targets(bake_provider_t      provider,
+                            bake_target_table_t* table)
+{
+    bake_target_table_t* old = provider->targets;
+
+    __atomic_store_n(&provider->targets, table, __ATOMIC_SEQ_CST);
+    wait_for_readers(provider);
+    free(old);
+}
+
+static void release_target(bake_target_t* target)
+{
+    __atomic_sub_fetch(&target->in_flight, 1, __ATOMIC_SEQ_CST);
+}
+
+/* looks up a target and pins it until release_target(); returns NULL if
+ * there is no such target.  Waits if the target is being migrated.
+ */
+static bake_target_t* acquire_target(bake_provider_t  provider,
+                                     bake_target_id_t target_id)
+{
+    bake_target_t* target;
+    unsigned       slot;
+
+    for (;;) {
+        slot   = reader_enter(provider);
+        target = target_table_find(provider->targets, target_id);
+        if (target) __atomic_add_fetch(&target->in_flight, 1, __ATOMIC_SEQ_CST);
+        reader_exit(provider, slot);
+
+        if (!target || !__atomic_load_n(&target->migrating, __ATOMIC_SEQ_CST))
+            return target;
+
+        /* let the migration drain the target, then look it up again since
+         * the migration may have removed it
+         */
+        release_target(target);
+        margo_thread_sleep(provider->mid, 1);
+    }
+}
+
+/* waits for the RPCs that pinned a target before it was unpublished */
+static void drain_target(bake_target_t* target)
+{
+    while (__atomic_load_n(&target->in_flight, __ATOMIC_SEQ_CST))
+        ABT_thread_yield();
+}
+
+/* pins all the targets of the provider; returns a malloc'ed array of them
+ * that must be handed back to release_all_targets()
+ */
+static bake_target_t** acquire_all_targets(bake_provider_t provider,
+                                           uint64_t*       num_targets)
+{
+    bake_target_table_t* table;
+    bake_target_t**      targets;
+    unsigned             slot;
+    uint64_t             i;
+
+    slot    = reader_enter(provider);
+    table   = provider->targets;
+    targets = malloc((table->num_targets + 1) * sizeof(*targets));
+    for (i = 0; targets && i < table->num_targets; i++) {
+        targets[i] = table->targets[i];
+        __atomic_add_fetch(&targets[i]->in_flight, 1, __ATOMIC_SEQ_CST);
+    }
+    *num_targets = targets ? table->num_targets : 0;
+    reader_exit(provider, slot);
+    return targets;
+}
+
+static void release_all_targets(bake_target_t** targets, uint64_t num_targets)
+{
+    uint64_t i;
+
+    for (i = 0; i < num_targets; i++) release_target(targets[i]);
+    free(targets);
+}
+
+/* moves the calling handler to the pool of its target, if it has one */
+static void move_to_target_pool(bake_target_t* target)
+{
+    ABT_pool pool;
+
+    if (target->pool == ABT_POOL_NULL) return;
+    if (ABT_self_get_last_pool(&pool) == ABT_SUCCESS && pool == target->pool)
+        return;
+    if (ABT_self_set_associated_pool(target->pool) == ABT_SUCCESS)
+        ABT_thread_yield();
+}
+
+static void free_target_pool(bake_target_pool_t* tp)
+{
+    int i;
+
+    for (i = 0; i < tp->num_xstreams; i++) {
+        if (tp->xstreams[i] == ABT_XSTREAM_NULL) continue;
+        ABT_xstream_join(tp->xstreams[i]);
+        ABT_xstream_free(&tp->xstreams[i]);
+    }
+    if (tp->pool != ABT_POOL_NULL) ABT_pool_free(&tp->pool);
+    free(tp->target_name);
+    free(tp->xstreams);
+    free(tp);
+}
+
+/* creates a pool with the given number of execution streams, bound
+ * round-robin to the cpus of the given json array if not NULL or empty
+ */
+static int create_own_pool(bake_provider_t     provider,
+                           const char*         target_name,
+                           int                 num_xstreams,
+                           struct json_object* cpus,
+                           ABT_pool*           pool)
+{
+    bake_target_pool_t* tp;
+    struct json_object* cpu;
+    int                 i, ret;
+
+    tp = calloc(1, sizeof(*tp));
+    if (!tp) return BAKE_ERR_NOMEM;
+    tp->num_xstreams = num_xstreams;
+    tp->xstreams     = calloc(tp->num_xstreams, sizeof(*tp->xstreams));
+    tp->target_name = strdup(target_name);
+    if (!tp->xstreams || !tp->target_name) {
+        free_target_pool(tp);
+        return BAKE_ERR_NOMEM;
+    }
+
+    ret = ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC,
+                                ABT_FALSE, &tp->pool);
+    if (ret != ABT_SUCCESS) {
+        tp->pool = ABT_POOL_NULL;
+        free_target_pool(tp);
+        return BAKE_ERR_ARGOBOTS;
+    }
+
+    for (i = 0; i < tp->num_xstreams; i++) {
+        ret = ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &tp->pool,
+                                       ABT_SCHED_CONFIG_NULL, &tp->xstreams[i]);
+        if (ret != ABT_SUCCESS) {
+            tp->xstreams[i] = ABT_XSTREAM_NULL;
+            free_target_pool(tp);
+            return BAKE_ERR_ARGOBOTS;
+        }
+        if (!cpus || json_object_array_length(cpus) == 0) continue;
+        cpu = json_object_array_get_idx(cpus,
+                                        i % json_object_array_length(cpus));
+        if (ABT_xstream_set_cpubind(tp->xstreams[i], json_object_get_int(cpu))
+            != ABT_SUCCESS)
+            BAKE_WARNING(provider->mid, "could not bind %s to cpu %d",
+                         target_name, json_object_get_int(cpu));
+    }
+
+    tp->next            = provider->own_pools;
+    provider->own_pools = tp;
+    *pool               = tp->pool;
+    return BAKE_SUCCESS;
+}
+
+/* finds the pool that runs the RPCs of a target according to the
+ * "target_pools" configuration, creating it if needed
+ */
+static int find_target_pool(bake_provider_t provider,
+                            const char*     target_name,
+                            ABT_pool*       pool)
+{
+    struct json_object* spec;
+    struct json_object* cpus;
+    bake_target_pool_t* tp;
+    const char*         path;
+    int                 index, node, ret;
+
+    *pool = ABT_POOL_NULL;
+    spec  = json_object_object_get(
+        json_object_object_get(provider->json_cfg, "target_pools"),
+        target_name);
+    if (!spec) return BAKE_SUCCESS;
+
+    if (json_object_is_type(spec, json_type_int)) {
+        index = json_object_get_int(spec);
+        if (index < 0 || (unsigned)index >= provider->num_target_pools) {
+            BAKE_ERROR(provider->mid, "no pool %d for target %s", index,
+                       target_name);
+            return BAKE_ERR_INVALID_ARG;
+        }
+        *pool = provider->target_pools[index];
+        return BAKE_SUCCESS;
+    }
+
+    /* a target attached again gets the pool it had before */
+    for (tp = provider->own_pools; tp; tp = tp->next) {
+        if (strcmp(tp->target_name, target_name) == 0) {
+            *pool = tp->pool;
+            return BAKE_SUCCESS;
+        }
+    }
+    cpus = json_object_object_get(spec, "cpus");
+    if (!json_object_is_type(cpus, json_type_string))
+        return create_own_pool(
+            provider, target_name,
+            json_object_get_int(json_object_object_get(spec, "num_xstreams")),
+            cpus, pool);
+
+    /* "numa": the cpus of the node of the device, past the backend prefix
+     * of the target name
+     */
+    path = strchr(target_name, ':');
+    node = bake_numa_path_node(path ? path + 1 : target_name);
+    if (node < 0)
+        BAKE_WARNING(provider->mid, "could not find the NUMA node of %s",
+                     target_name);
+    cpus = bake_numa_node_cpus(node);
+    ret  = create_own_pool(
+        provider, target_name,
+        json_object_get_int(json_object_object_get(spec, "num_xstreams")),
+        cpus, pool);
+    json_object_put(cpus);
+    return ret;
+}
+
+/* sets up the pool of pipelined transfers: the one passed in the init
+ * info, or one with pipeline_transfer_xstreams execution streams
+ */
+static int setup_transfer_pool(bake_provider_t provider, ABT_pool pool)
+{
+    int num_xstreams = json_object_get_int(json_object_object_get(
+        provider->json_cfg, "pipeline_transfer_xstreams"));
+
+    provider->transfer_pool = pool;
+    if (pool != ABT_POOL_NULL || num_xstreams == 0) return BAKE_SUCCESS;
+    return create_own_pool(provider, "pipeline transfers", num_xstreams, NULL,
+                           &provider->transfer_pool);
+}
+
+static void free_target_pools(bake_provider_t provider)
+{
+    bake_target_pool_t* tp;
+
+    while ((tp = provider->own_pools) != NULL) {
+        provider->own_pools = tp->next;
+        free_target_pool(tp);
+    }
+    free(provider->target_pools);
+    provider->target_pools = NULL;
+}
+
+/* Scheduler of the priority lanes.  Each round runs up to lane_weights[i]
+ * ULTs from lane i, in lane order, so that eager and metadata operations
+ * get ahead of bulk ones while no lane starves.
+ */
+static int lanes_sched_init(ABT_sched sched, ABT_sched_config config)
+{
+    return ABT_SUCCESS;
+}
+
+static void lanes_sched_run(ABT_sched sched)
+{
+    bake_provider_t provider;
+    ABT_pool        pools[BAKE_NUM_LANES];
+    ABT_unit        unit;
+    ABT_bool        stop;
+    unsigned        rounds = 0, idle = 0;
+    int             i, n, ran, rank = 0;
+
+    ABT_sched_get_data(sched, (void**)&provider);
+    ABT_sched_get_pools(sched, BAKE_NUM_LANES, 0, pools);
+    ABT_xstream_self_rank(&rank);
+    for (;;) {
+        ran = 0;
+        for (i = 0; i < BAKE_NUM_LANES; i++) {
+            for (n = 0; n < provider->lane_weights[i]; n++) {
+                if (ABT_pool_pop(pools[i], &unit) != ABT_SUCCESS
+                    || unit == ABT_UNIT_NULL)
+                    break;
+                ABT_xstream_run_unit(unit, pools[i]);
+                ran++;
+            }
+        }
+        if (!ran) {
+            /* idle; Argobots cannot block on several pools at once, so
+             * wait a little on each lane in turn before scanning all lanes
+             * again, starting from a different lane on each execution
+             * stream so that together they wait on all of them
+             */
+            i    = (rank + idle++) % BAKE_NUM_LANES;
+            unit = ABT_UNIT_NULL;
+            ABT_pool_pop_timedwait(pools[i], &unit,
+                                   ABT_get_wtime()
+                                       + 0.0001 / BAKE_NUM_LANES);
+            if (unit != ABT_UNIT_NULL) {
+                ABT_xstream_run_unit(unit, pools[i]);
+                idle = 0;
+            }
+        }
+        if (!ran || ++rounds % 64 == 0) {
+            ABT_xstream_check_events(sched);
+            ABT_sched_has_to_stop(sched, &stop);
+            if (stop == ABT_TRUE) break;
+        }
+    }
+}
+
+static int lanes_sched_free(ABT_sched sched) { return ABT_SUCCESS; }
+
+/* reads the weights of the "priority_lanes" configuration, which the
+ * scheduler picks up on its next round
+ */
+static void load_lane_weights(bake_provider_t provider)
+{
+    static const char* weight_keys[BAKE_NUM_LANES]
+        = {"eager_weight", "metadata_weight", "bulk_weight"};
+    struct json_object* lanes;
+    int                 i;
+
+    lanes = json_object_object_get(provider->json_cfg, "priority_lanes");
+    for (i = 0; i < BAKE_NUM_LANES; i++)
+        provider->lane_weights[i] = json_object_get_int(
+            json_object_object_get(lanes, weight_keys[i]));
+}
+
+/* creates the pools of the priority lanes and the execution streams that
+ * schedule them; without lanes, all the RPCs use the handler pool
+ */
+static int setup_lanes(bake_provider_t provider)
+{
+    ABT_sched_def def = {.type          = ABT_SCHED_TYPE_ULT,
+                         .init          = lanes_sched_init,
+                         .run           = lanes_sched_run,
+                         .free          = lanes_sched_free,
+                         .get_migr_pool = NULL};
+    struct json_object* lanes;
+    int                 i, n, ret;
+
+    for (i = 0; i < BAKE_NUM_LANES; i++)
+        provider->lanes[i] = provider->handler_pool;
+
+    /* NOTE: this is called after validate, so we don't need extensive error
+     * checking on the json here
+     */
+    lanes = json_object_object_get(provider->json_cfg, "priority_lanes");
+    if (!json_object_get_boolean(json_object_object_get(lanes, "enable")))
+        return BAKE_SUCCESS;
+
+    load_lane_weights(provider);
+    for (i = 0; i < BAKE_NUM_LANES; i++) {
+        ret = ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC,
+                                    ABT_FALSE, &provider->lanes[i]);
+        if (ret != ABT_SUCCESS) {
+            provider->lanes[i] = ABT_POOL_NULL;
+            return BAKE_ERR_ARGOBOTS;
+        }
+    }
+    provider->lane_small_bulk_size = json_object_get_int64(
+        json_object_object_get(lanes, "small_bulk_size"));
+
+    n = json_object_get_int(json_object_object_get(lanes, "num_xstreams"));
+    provider->lane_xstreams = calloc(n, sizeof(*provider->lane_xstreams));
+    provider->lane_scheds   = calloc(n, sizeof(*provider->lane_scheds));
+    if (!provider->lane_xstreams || !provider->lane_scheds)
+        return BAKE_ERR_NOMEM;
+    for (i = 0; i < n; i++) {
+        ret = ABT_sched_create(&def, BAKE_NUM_LANES, provider->lanes,
+                               ABT_SCHED_CONFIG_NULL,
+                               &provider->lane_scheds[i]);
+        if (ret != ABT_SUCCESS) return BAKE_ERR_ARGOBOTS;
+        provider->num_lane_xstreams = i + 1;
+        ABT_sched_set_data(provider->lane_scheds[i], provider);
+        ret = ABT_xstream_create(provider->lane_scheds[i],
+                                 &provider->lane_xstreams[i]);
+        if (ret != ABT_SUCCESS) {
+            provider->lane_xstreams[i] = ABT_XSTREAM_NULL;
+            return BAKE_ERR_ARGOBOTS;
+        }
+    }
+    return BAKE_SUCCESS;
+}
+
+static void free_lanes(bake_provider_t provider)
+{
+    int i;
+
+    for (i = 0; i < provider->num_lane_xstreams; i++) {
+        if (provider->lane_xstreams[i] != ABT_XSTREAM_NULL) {
+            ABT_xstream_join(provider->lane_xstreams[i]);
+            ABT_xstream_free(&provider->lane_xstreams[i]);
+        }
+        ABT_sched_free(&provider->lane_scheds[i]);
+    }
+    for (i = 0; i < BAKE_NUM_LANES; i++) {
+        if (provider->lanes[i] != ABT_POOL_NULL
+            && provider->lanes[i] != provider->handler_pool)
+            ABT_pool_free(&provider->lanes[i]);
+    }
+    free(provider->lane_xstreams);
+    free(provider->lane_scheds);
+    provider->num_lane_xstreams = 0;
+    provider->lane_xstreams     = NULL;
+    provider->lane_scheds       = NULL;
+}
+
+/* bulk RPCs arrive in the metadata lane; once their size is known, the
+ * large ones move to the bulk lane.  Targets with a pool of their own keep
+ * their handlers there.
+ */
+static void move_to_bulk_lane(bake_provider_t provider,
+                              bake_target_t*  target,
+                              uint64_t        size)
+{
+    if (!provider->num_lane_xstreams || target->pool != ABT_POOL_NULL
+        || size <= provider->lane_small_bulk_size)
+        return;
+    if (ABT_self_set_associated_pool(provider->lanes[BAKE_LANE_BULK])
+        == ABT_SUCCESS)
+        ABT_thread_yield();
+}
+
+/* reads the "qos" configuration into the provider */
+static void load_qos(bake_provider_t provider)
+{
+    struct json_object* qos;
+
+    qos = json_object_object_get(provider->json_cfg, "qos");
+    ABT_mutex_lock(provider->qos_mutex);
+    provider->qos_bytes_per_sec = (double)json_object_get_int64(
+        json_object_object_get(qos, "bytes_per_sec"));
+    provider->qos_ops_per_sec = (double)json_object_get_int64(
+        json_object_object_get(qos, "ops_per_sec"));
+    provider->qos_burst_sec
+        = json_object_get_int64(json_object_object_get(qos, "burst_ms"))
+        / 1000.0;
+    __atomic_store_n(&provider->qos_enabled,
+                     provider->qos_bytes_per_sec > 0
+                         || provider->qos_ops_per_sec > 0,
+                     __ATOMIC_RELAXED);
+    ABT_mutex_unlock(provider->qos_mutex);
+}
+
+/* reads the "backpressure" configuration into the provider */
+static void load_backpressure(bake_provider_t provider)
+{
+    struct json_object* backpressure;
+
+    backpressure = json_object_object_get(provider->json_cfg, "backpressure");
+    provider->busy_max_pending = json_object_get_int64(
+        json_object_object_get(backpressure, "max_pending"));
+    provider->busy_max_buffer_bytes = json_object_get_int64(
+        json_object_object_get(backpressure, "max_buffer_bytes"));
+    provider->busy_retry_after_ms = json_object_get_int64(
+        json_object_object_get(backpressure, "retry_after_ms"));
+}
+
+static void free_qos(bake_provider_t provider)
+{
+    bake_qos_client_t *client, *tmp;
+
+    HASH_ITER(hh, provider->qos_clients, client, tmp)
+    {
+        HASH_DEL(provider->qos_clients, client);
+        free(client);
+    }
+    if (provider->qos_mutex) ABT_mutex_free(&provider->qos_mutex);
+}
+
+/* Charges an operation of the given size to the token buckets of the
+ * client that sent it, then waits until the client is back within its
+ * limits.  Buckets go into debt rather than refusing the operation, so
+ * that the waiting operations of a client are admitted in order.
+ */
+static void qos_admit(bake_provider_t provider, hg_addr_t addr, uint64_t bytes)
+{
+    char               addr_str[256];
+    hg_size_t          addr_str_size = sizeof(addr_str);
+    bake_qos_client_t *client, *tmp;
+    double             now, bps, ops, burst, wait = 0;
+
+    if (!__atomic_load_n(&provider->qos_enabled, __ATOMIC_RELAXED)) return;
+    if (margo_addr_to_string(provider->mid, addr_str, &addr_str_size, addr)
+        != HG_SUCCESS)
+        return;
+    now = ABT_get_wtime();
+
+    ABT_mutex_lock(provider->qos_mutex);
+    bps   = provider->qos_bytes_per_sec;
+    ops   = provider->qos_ops_per_sec;
+    burst = provider->qos_burst_sec;
+    HASH_FIND_STR(provider->qos_clients, addr_str, client);
+    if (!client) {
+        client = calloc(1, sizeof(*client));
+        if (!client) goto unlock;
+        strcpy(client->addr, addr_str);
+        client->byte_tokens = bps * burst;
+        client->op_tokens   = ops * burst;
+        client->last_refill = now;
+        HASH_ADD_STR(provider->qos_clients, addr, client);
+    }
+
+    /* refill for the time elapsed, up to the depth of the buckets */
+    client->byte_tokens += (now - client->last_refill) * bps;
+    if (client->byte_tokens > bps * burst) client->byte_tokens = bps * burst;
+    client->op_tokens += (now - client->last_refill) * ops;
+    if (client->op_tokens > ops * burst) client->op_tokens = ops * burst;
+    client->last_refill = now;
+
+    if (bps > 0) {
+        client->byte_tokens -= bytes;
+        if (client->byte_tokens < 0) wait = -client->byte_tokens / bps;
+    }
+    if (ops > 0) {
+        client->op_tokens -= 1;
+        if (client->op_tokens < 0 && -client->op_tokens / ops > wait)
+            wait = -client->op_tokens / ops;
+    }
+
+    /* now and then, forget the clients that have been idle for a minute */
+    if (++provider->qos_admissions % 1024 == 0) {
+        HASH_ITER(hh, provider->qos_clients, client, tmp)
+        {
+            if (now - client->last_refill < 60.0) continue;
+            HASH_DEL(provider->qos_clients, client);
+            free(client);
+        }
+    }
+
+unlock:
+    ABT_mutex_unlock(provider->qos_mutex);
+    if (wait > 0) margo_thread_sleep(provider->mid, wait * 1000.0);
+}
+
+/* tells whether an operation of the given size can start on the target;
+ * an operation larger than a byte limit is let through when there is
+ * nothing else in flight
+ */
+static int admit_fits(bake_provider_t provider,
+                      bake_target_t*  target,
+                      uint64_t        bytes)
+{
+    if (target->max_ops && target->admitted_ops >= target->max_ops) return 0;
+    if (target->max_bytes && target->admitted_bytes
+        && target->admitted_bytes + bytes > target->max_bytes)
+        return 0;
+    if (provider->admit_max_bytes && provider->admit_bytes
+        && provider->admit_bytes + bytes > provider->admit_max_bytes)
+        return 0;
+    return 1;
+}
 
-static bake_target_t* find_target_entry(bake_provider_t  provider,
-                                        bake_target_id_t target_id)
+static void admit_charge(bake_provider_t provider,
+                         bake_target_t*  target,
+                         uint64_t        bytes)
 {
-    bake_target_t* entry = NULL;
-    HASH_FIND(hh, provider->targets, &target_id, sizeof(bake_target_id_t),
-              entry);
-    return entry;
+    target->admitted_ops++;
+    target->admitted_bytes += bytes;
+    provider->admit_bytes += bytes;
+}
+
+/* Admits waiting operations by deficit round-robin over the targets that
+ * have some: on its turn, a target whose next operation could start gets
+ * admit_quantum bytes of credit, and starts operations as long as its
+ * credit covers them.  Targets therefore share the provider-wide byte
+ * limit evenly, whatever the size of their operations.  The caller holds
+ * admit_mutex.
+ */
+static void admit_waiters(bake_provider_t provider)
+{
+    bake_target_t*       target;
+    bake_target_t*       last;
+    bake_admit_waiter_t* w;
+    int                  progress = 1;
+
+    while (progress && provider->drr_head) {
+        progress = 0;
+        /* one turn for each target in the round, in order */
+        last = provider->drr_tail;
+        do {
+            target             = provider->drr_head;
+            provider->drr_head = target->drr_next;
+            target->drr_next   = NULL;
+            if (!provider->drr_head) provider->drr_tail = NULL;
+
+            if (admit_fits(provider, target, target->waiters->bytes)) {
+                target->deficit += provider->admit_quantum;
+                progress = 1;
+            }
+            while ((w = target->waiters) != NULL && w->bytes <= target->deficit
+                   && admit_fits(provider, target, w->bytes)) {
+                target->waiters = w->next;
+                target->deficit -= w->bytes;
+                admit_charge(provider, target, w->bytes);
+                ABT_eventual_set(w->admitted, NULL, 0);
+            }
+
+            if (target->waiters) {
+                /* back at the end of the round */
+                if (provider->drr_tail)
+                    provider->drr_tail->drr_next = target;
+                else
+                    provider->drr_head = target;
+                provider->drr_tail = target;
+            } else {
+                target->waiters_tail = NULL;
+                target->deficit      = 0;
+            }
+        } while (target != last);
+    }
+}
+
+/* waits until an operation of the given size may start on the target;
+ * returns 1 if the operation was charged and must be handed back to
+ * admit_release()
+ */
+static int admit_acquire(bake_provider_t provider,
+                         bake_target_t*  target,
+                         uint64_t        bytes)
+{
+    bake_admit_waiter_t w = {bytes, ABT_EVENTUAL_NULL, NULL};
+
+    if (!__atomic_load_n(&provider->admit_enabled, __ATOMIC_RELAXED))
+        return 0;
+
+    ABT_mutex_lock(provider->admit_mutex);
+    /* go straight through unless someone is already waiting */
+    if (!provider->drr_head && admit_fits(provider, target, bytes)) {
+        admit_charge(provider, target, bytes);
+        ABT_mutex_unlock(provider->admit_mutex);
+        return 1;
+    }
+    if (ABT_eventual_create(0, &w.admitted) != ABT_SUCCESS) {
+        /* do not hold the operation up for lack of memory */
+        admit_charge(provider, target, bytes);
+        ABT_mutex_unlock(provider->admit_mutex);
+        return 1;
+    }
+    if (target->waiters)
+        target->waiters_tail->next = &w;
+    else {
+        target->waiters = &w;
+        if (provider->drr_tail)
+            provider->drr_tail->drr_next = target;
+        else
+            provider->drr_head = target;
+        provider->drr_tail = target;
+    }
+    target->waiters_tail = &w;
+    admit_waiters(provider);
+    ABT_mutex_unlock(provider->admit_mutex);
+
+    ABT_eventual_wait(w.admitted, NULL);
+    ABT_eventual_free(&w.admitted);
+    return 1;
+}
+
+static void admit_release(bake_provider_t provider,
+                          bake_target_t*  target,
+                          uint64_t        bytes)
+{
+    ABT_mutex_lock(provider->admit_mutex);
+    target->admitted_ops--;
+    target->admitted_bytes -= bytes;
+    provider->admit_bytes -= bytes;
+    admit_waiters(provider);
+    ABT_mutex_unlock(provider->admit_mutex);
+}
+
+/* sets the admission limits of a target, from the "admission" config */
+static void setup_admission_limits(bake_provider_t provider,
+                                   bake_target_t*  target,
+                                   const char*     target_name)
+{
+    struct json_object* admission;
+    struct json_object* limits;
+
+    admission = json_object_object_get(provider->json_cfg, "admission");
+    limits    = json_object_object_get(
+        json_object_object_get(admission, "targets"), target_name);
+    target->max_ops = json_object_get_int64(json_object_object_get(
+        limits ? limits : admission, limits ? "max_ops" : "target_max_ops"));
+    target->max_bytes = json_object_get_int64(
+        json_object_object_get(limits ? limits : admission,
+                               limits ? "max_bytes" : "target_max_bytes"));
+    if (target->max_ops || target->max_bytes)
+        __atomic_store_n(&provider->admit_enabled, 1, __ATOMIC_RELAXED);
+}
+
+/* Counts in a data operation, along with the bytes it stages through the
+ * pipeline buffers, unless the provider already has too many operations
+ * in progress or too many bytes staged.  In that case the operation is
+ * turned away with BAKE_ERR_BUSY and a retry-after hint that grows with
+ * the overload, rather than left to queue up holding its handle.  An
+ * operation staging more than the byte limit is let through when nothing
+ * else is staged.
+ */
+static int busy_enter(bake_provider_t provider,
+                      uint64_t        bytes,
+                      uint32_t*       retry_after_ms)
+{
+    uint64_t max_pending = provider->busy_max_pending;
+    uint64_t max_bytes   = provider->busy_max_buffer_bytes;
+    uint64_t pending, staged = 0;
+    double   overload = 0;
+
+    pending = __atomic_add_fetch(&provider->busy_pending, 1, __ATOMIC_RELAXED);
+    if (bytes)
+        staged = __atomic_add_fetch(&provider->busy_buffer_bytes, bytes,
+                                    __ATOMIC_RELAXED);
+    if (max_pending && pending > max_pending)
+        overload = (double)pending / max_pending;
+    if (max_bytes && staged > max_bytes && staged > bytes
+        && (double)staged / max_bytes > overload)
+        overload = (double)staged / max_bytes;
+    if (overload == 0) return BAKE_SUCCESS;
+
+    __atomic_sub_fetch(&provider->busy_pending, 1, __ATOMIC_RELAXED);
+    if (bytes)
+        __atomic_sub_fetch(&provider->busy_buffer_bytes, bytes,
+                           __ATOMIC_RELAXED);
+    *retry_after_ms = provider->busy_retry_after_ms * overload;
+    return BAKE_ERR_BUSY;
+}
+
+static void busy_exit(bake_provider_t provider, uint64_t bytes)
+{
+    __atomic_sub_fetch(&provider->busy_pending, 1, __ATOMIC_RELAXED);
+    if (bytes)
+        __atomic_sub_fetch(&provider->busy_buffer_bytes, bytes,
+                           __ATOMIC_RELAXED);
 }
 
 static void bake_server_finalize_cb(void* data);
@@ -137,6 +1323,24 @@ int bake_provider_register(margo_instance_id                     mid,
     tmp_provider->json_cfg = config;
     tmp_provider->aid      = args.aid;
 
+    if (args.num_target_pools) {
+        tmp_provider->target_pools
+            = malloc(args.num_target_pools * sizeof(ABT_pool));
+        if (!tmp_provider->target_pools) {
+            ret = BAKE_ERR_NOMEM;
+            goto error;
+        }
+        memcpy(tmp_provider->target_pools, args.target_pools,
+               args.num_target_pools * sizeof(ABT_pool));
+        tmp_provider->num_target_pools = args.num_target_pools;
+    }
+
+    ret = setup_transfer_pool(tmp_provider, args.transfer_pool);
+    if (ret != BAKE_SUCCESS) {
+        BAKE_ERROR(mid, "could not create pool for pipeline transfers");
+        goto error;
+    }
+
     tmp_provider->mid = mid;
     if (args.rpc_pool != NULL)
         tmp_provider->handler_pool = args.rpc_pool;
@@ -145,115 +1349,224 @@ int bake_provider_register(margo_instance_id                     mid,
     }
     BAKE_DEBUG(mid, "using handler pool %p", tmp_provider->handler_pool);
 
-    /* create buffer poolset if needed for config */
-    ret = setup_poolset(tmp_provider);
-    if (ret != 0) {
-        BAKE_ERROR(mid, "could not create poolset for pipelining");
+    ret = setup_lanes(tmp_provider);
+    if (ret != BAKE_SUCCESS) {
+        BAKE_ERROR(mid, "could not create priority lanes");
         goto error;
     }
 
-    /* Create rwlock */
-    ret = ABT_rwlock_create(&(tmp_provider->lock));
+    ret = ABT_mutex_create(&(tmp_provider->qos_mutex));
     if (ret != ABT_SUCCESS) {
         ret = BAKE_ERR_ARGOBOTS;
         goto error;
     }
+    load_qos(tmp_provider);
+
+    ret = ABT_mutex_create(&(tmp_provider->admit_mutex));
+    if (ret != ABT_SUCCESS) {
+        ret = BAKE_ERR_ARGOBOTS;
+        goto error;
+    }
+    {
+        struct json_object* admission
+            = json_object_object_get(config, "admission");
+        tmp_provider->admit_max_bytes = json_object_get_int64(
+            json_object_object_get(admission, "provider_max_bytes"));
+        tmp_provider->admit_quantum = json_object_get_int64(
+            json_object_object_get(admission, "quantum"));
+        tmp_provider->admit_enabled = tmp_provider->admit_max_bytes != 0;
+    }
+    load_backpressure(tmp_provider);
+
+    ret = ABT_key_create(NULL, &(tmp_provider->deadline_key));
+    if (ret != ABT_SUCCESS) {
+        ret = BAKE_ERR_ARGOBOTS;
+        goto error;
+    }
+
+    ret = ABT_mutex_create(&(tmp_provider->buffer_pool_mutex));
+    if (ret != ABT_SUCCESS) {
+        ret = BAKE_ERR_ARGOBOTS;
+        goto error;
+    }
+
+    /* create buffer pool if needed for config */
+    ret = setup_buffer_pool(tmp_provider);
+    if (ret != 0) {
+        BAKE_ERROR(mid, "could not create buffer pool for pipelining");
+        goto error;
+    }
+
+    /* start with no targets */
+    tmp_provider->targets = target_table_create(NULL, 0);
+    ret                   = ABT_mutex_create(&(tmp_provider->targets_mutex));
+    if (!tmp_provider->targets || ret != ABT_SUCCESS) {
+        ret = BAKE_ERR_ARGOBOTS;
+        goto error;
+    }
+
+    setup_placement(tmp_provider);
 
     /* register RPCs */
     hg_id_t rpc_id;
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_create_rpc", bake_create_in_t,
-                                     bake_create_out_t, bake_create_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_create_rpc", bake_create_in_t, bake_create_out_t,
+        bake_create_ult, provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_create_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_write_rpc", bake_write_in_t,
-                                     bake_write_out_t, bake_write_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_write_rpc", bake_write_in_t, bake_write_out_t,
+        bake_write_ult, provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_write_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_eager_write_rpc", bake_eager_write_in_t,
         bake_eager_write_out_t, bake_eager_write_ult, provider_id,
-        tmp_provider->handler_pool);
+        tmp_provider->lanes[BAKE_LANE_EAGER]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_eager_write_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_eager_read_rpc", bake_eager_read_in_t, bake_eager_read_out_t,
-        bake_eager_read_ult, provider_id, tmp_provider->handler_pool);
+        bake_eager_read_ult, provider_id, tmp_provider->lanes[BAKE_LANE_EAGER]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_eager_read_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_persist_rpc", bake_persist_in_t,
-                                     bake_persist_out_t, bake_persist_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_eager_read_multi_rpc", bake_eager_read_multi_in_t,
+        bake_eager_read_multi_out_t, bake_eager_read_multi_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_EAGER]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_eager_read_multi_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_writev_rpc", bake_writev_in_t, bake_writev_out_t,
+        bake_writev_ult, provider_id, tmp_provider->lanes[BAKE_LANE_BULK]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_writev_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_readv_rpc", bake_readv_in_t, bake_readv_out_t,
+        bake_readv_ult, provider_id, tmp_provider->lanes[BAKE_LANE_BULK]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_readv_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_compound_rpc", bake_compound_in_t, bake_compound_out_t,
+        bake_compound_ult, provider_id, tmp_provider->lanes[BAKE_LANE_EAGER]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_compound_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_persist_rpc", bake_persist_in_t, bake_persist_out_t,
+        bake_persist_ult, provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_persist_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_create_write_persist_rpc", bake_create_write_persist_in_t,
         bake_create_write_persist_out_t, bake_create_write_persist_ult,
-        provider_id, tmp_provider->handler_pool);
+        provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_create_write_persist_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_eager_create_write_persist_rpc",
-                                     bake_eager_create_write_persist_in_t,
-                                     bake_eager_create_write_persist_out_t,
-                                     bake_eager_create_write_persist_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_eager_create_write_persist_rpc",
+        bake_eager_create_write_persist_in_t,
+        bake_eager_create_write_persist_out_t,
+        bake_eager_create_write_persist_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_EAGER]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_eager_create_write_persist_id = rpc_id;
 
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_eager_create_write_persist_multi_rpc",
+        bake_eager_create_write_persist_multi_in_t,
+        bake_eager_create_write_persist_multi_out_t,
+        bake_eager_create_write_persist_multi_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_EAGER]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_eager_create_write_persist_multi_id = rpc_id;
+
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_get_size_rpc", bake_get_size_in_t, bake_get_size_out_t,
-        bake_get_size_ult, provider_id, tmp_provider->handler_pool);
+        bake_get_size_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_get_size_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_get_data_rpc", bake_get_data_in_t, bake_get_data_out_t,
-        bake_get_data_ult, provider_id, tmp_provider->handler_pool);
+        bake_get_data_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_get_data_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_read_rpc", bake_read_in_t,
-                                     bake_read_out_t, bake_read_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_read_rpc", bake_read_in_t, bake_read_out_t, bake_read_ult,
+        provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_read_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_probe_rpc", bake_probe_in_t,
-                                     bake_probe_out_t, bake_probe_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_probe_rpc", bake_probe_in_t, bake_probe_out_t,
+        bake_probe_ult, provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_probe_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_noop_rpc", void, void,
                                      bake_noop_ult, provider_id,
-                                     tmp_provider->handler_pool);
+                                     tmp_provider->lanes[BAKE_LANE_EAGER]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_noop_id = rpc_id;
 
-    rpc_id = MARGO_REGISTER_PROVIDER(mid, "bake_remove_rpc", bake_remove_in_t,
-                                     bake_remove_out_t, bake_remove_ult,
-                                     provider_id, tmp_provider->handler_pool);
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_remove_rpc", bake_remove_in_t, bake_remove_out_t,
+        bake_remove_ult, provider_id, tmp_provider->lanes[BAKE_LANE_METADATA]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_remove_id = rpc_id;
 
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_create_multi_rpc", bake_create_multi_in_t,
+        bake_create_multi_out_t, bake_create_multi_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_create_multi_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_remove_multi_rpc", bake_remove_multi_in_t,
+        bake_remove_multi_out_t, bake_remove_multi_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_remove_multi_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_remove_group_rpc", bake_remove_group_in_t,
+        bake_remove_group_out_t, bake_remove_group_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_remove_group_id = rpc_id;
+
+    rpc_id = MARGO_REGISTER_PROVIDER(
+        mid, "bake_set_param_rpc", bake_set_param_in_t, bake_set_param_out_t,
+        bake_set_param_ult, provider_id,
+        tmp_provider->lanes[BAKE_LANE_METADATA]);
+    margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
+    tmp_provider->rpc_set_param_id = rpc_id;
+
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_migrate_region_rpc", bake_migrate_region_in_t,
         bake_migrate_region_out_t, bake_migrate_region_ult, provider_id,
-        tmp_provider->handler_pool);
+        tmp_provider->lanes[BAKE_LANE_BULK]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_migrate_region_id = rpc_id;
 
     rpc_id = MARGO_REGISTER_PROVIDER(
         mid, "bake_migrate_target_rpc", bake_migrate_target_in_t,
         bake_migrate_target_out_t, bake_migrate_target_ult, provider_id,
-        tmp_provider->handler_pool);
+        tmp_provider->lanes[BAKE_LANE_BULK]);
     margo_register_data(mid, rpc_id, (void*)tmp_provider, NULL);
     tmp_provider->rpc_migrate_target_id = rpc_id;
 
@@ -316,13 +1629,23 @@ error:
         margo_deregister(mid, tmp_provider->rpc_persist_id);
         margo_deregister(mid, tmp_provider->rpc_create_write_persist_id);
         margo_deregister(mid, tmp_provider->rpc_eager_create_write_persist_id);
+        margo_deregister(mid,
+                         tmp_provider->rpc_eager_create_write_persist_multi_id);
         margo_deregister(mid, tmp_provider->rpc_get_size_id);
         margo_deregister(mid, tmp_provider->rpc_get_data_id);
         margo_deregister(mid, tmp_provider->rpc_read_id);
         margo_deregister(mid, tmp_provider->rpc_eager_read_id);
+        margo_deregister(mid, tmp_provider->rpc_eager_read_multi_id);
+        margo_deregister(mid, tmp_provider->rpc_writev_id);
+        margo_deregister(mid, tmp_provider->rpc_readv_id);
+        margo_deregister(mid, tmp_provider->rpc_compound_id);
         margo_deregister(mid, tmp_provider->rpc_probe_id);
         margo_deregister(mid, tmp_provider->rpc_noop_id);
         margo_deregister(mid, tmp_provider->rpc_remove_id);
+        margo_deregister(mid, tmp_provider->rpc_create_multi_id);
+        margo_deregister(mid, tmp_provider->rpc_remove_multi_id);
+        margo_deregister(mid, tmp_provider->rpc_remove_group_id);
+        margo_deregister(mid, tmp_provider->rpc_set_param_id);
         margo_deregister(mid, tmp_provider->rpc_migrate_region_id);
         margo_deregister(mid, tmp_provider->rpc_migrate_target_id);
     }
@@ -330,9 +1653,20 @@ error:
     if (config) json_object_put(config);
 
     if (tmp_provider) {
-        if (tmp_provider->poolset)
-            margo_bulk_poolset_destroy(tmp_provider->poolset);
-        if (tmp_provider->lock) ABT_rwlock_free(&(tmp_provider->lock));
+        if (tmp_provider->buffer_pool)
+            bake_buffer_pool_destroy(tmp_provider->buffer_pool);
+        if (tmp_provider->buffer_pool_mutex)
+            ABT_mutex_free(&(tmp_provider->buffer_pool_mutex));
+        if (tmp_provider->targets_mutex)
+            ABT_mutex_free(&(tmp_provider->targets_mutex));
+        free(tmp_provider->targets);
+        free_target_pools(tmp_provider);
+        free_lanes(tmp_provider);
+        free_qos(tmp_provider);
+        if (tmp_provider->admit_mutex)
+            ABT_mutex_free(&(tmp_provider->admit_mutex));
+        if (tmp_provider->deadline_key)
+            ABT_key_free(&(tmp_provider->deadline_key));
         free(tmp_provider);
     }
 
@@ -367,9 +1701,14 @@ int bake_provider_attach_target(bake_provider_t   provider,
                                 const char*       target_name,
                                 bake_target_id_t* target_id)
 {
-    int               ret = BAKE_SUCCESS;
-    bake_target_id_t  tid;
-    backend_context_t ctx = NULL;
+    int                  ret = BAKE_SUCCESS;
+    bake_target_id_t     tid;
+    backend_context_t    ctx = NULL;
+    bake_target_table_t* old_table;
+    bake_target_table_t* new_table = NULL;
+    bake_target_t**      targets;
+    const char*          full_name = target_name;
+    ABT_pool             pool;
 
     char* backend_type = NULL;
     // figure out the backend by searching until the ":" in the target name
@@ -384,13 +1723,11 @@ int bake_provider_attach_target(bake_provider_t   provider,
 
     bake_target_t* new_entry = calloc(1, sizeof(*new_entry));
 
-    if (strcmp(backend_type, "pmem") == 0) {
-        new_entry->backend = &g_bake_pmem_backend;
-    } else if (strcmp(backend_type, "file") == 0) {
-        new_entry->backend = &g_bake_file_backend;
-    } else {
+    new_entry->backend = bake_backend_lookup(backend_type);
+    if (!new_entry->backend) {
         BAKE_ERROR(provider->mid, "unknown backend type \"%s\"", backend_type);
         free(backend_type);
+        free(new_entry);
         return BAKE_ERR_BACKEND_TYPE;
     }
 
@@ -400,31 +1737,56 @@ int bake_provider_attach_target(bake_provider_t   provider,
         free(new_entry);
         return ret;
     }
+
+    ABT_mutex_lock(provider->targets_mutex);
+    ret = find_target_pool(provider, full_name, &pool);
+    ABT_mutex_unlock(provider->targets_mutex);
+    if (ret != BAKE_SUCCESS) {
+        new_entry->backend->_finalize(ctx);
+        free(backend_type);
+        free(new_entry);
+        return ret;
+    }
     new_entry->context   = ctx;
     new_entry->target_id = tid;
-
-    /* write-lock the provider */
-    ABT_rwlock_wrlock(provider->lock);
-    /* insert in the provider's hash */
-    HASH_ADD(hh, provider->targets, target_id, sizeof(bake_target_id_t),
-             new_entry);
-    /* check that it was inserted */
-    bake_target_t* check_entry = NULL;
-    HASH_FIND(hh, provider->targets, &tid, sizeof(bake_target_id_t),
-              check_entry);
-    if (check_entry != new_entry) {
-        BAKE_ERROR(provider->mid,
-                   "could not insert new pmem pool into the hash");
+    new_entry->pool      = pool;
+    /* regions created before the target was attached count for placement */
+    new_entry->bytes_placed
+        = bake_backend_bytes_used(new_entry->backend, ctx);
+    setup_admission_limits(provider, new_entry, full_name);
+    new_entry->small_class
+        = placement_small_class(provider, new_entry->backend);
+
+    /* publish a table with the new target added */
+    ABT_mutex_lock(provider->targets_mutex);
+    old_table = provider->targets;
+    if (target_table_find(old_table, tid)) {
+        BAKE_ERROR(provider->mid, "target is already attached to the provider");
+        new_entry->backend->_finalize(ctx);
+        free(new_entry);
+        ret = BAKE_ERR_ALLOCATION;
+        goto unlock;
+    }
+    targets = malloc((old_table->num_targets + 1) * sizeof(*targets));
+    if (targets) {
+        memcpy(targets, old_table->targets,
+               old_table->num_targets * sizeof(*targets));
+        targets[old_table->num_targets] = new_entry;
+        new_table = target_table_create(targets, old_table->num_targets + 1);
+        free(targets);
+    }
+    if (!new_table) {
         new_entry->backend->_finalize(ctx);
         free(new_entry);
         ret = BAKE_ERR_ALLOCATION;
-    } else {
-        provider->num_targets += 1;
-        *target_id = new_entry->target_id;
-        ret        = BAKE_SUCCESS;
+        goto unlock;
     }
-    /* unlock provider */
-    ABT_rwlock_unlock(provider->lock);
+    publish_targets(provider, new_table);
+    *target_id = new_entry->target_id;
+    ret        = BAKE_SUCCESS;
+
+unlock:
+    ABT_mutex_unlock(provider->targets_mutex);
     free(backend_type);
     return ret;
 }
@@ -432,70 +1794,99 @@ int bake_provider_attach_target(bake_provider_t   provider,
 int bake_provider_detach_target(bake_provider_t  provider,
                                 bake_target_id_t target_id)
 {
-    int ret;
-    ABT_rwlock_wrlock(provider->lock);
-    bake_target_t* entry = NULL;
-    HASH_FIND(hh, provider->targets, &target_id, sizeof(bake_target_id_t),
-              entry);
+    bake_target_table_t* old_table;
+    bake_target_table_t* new_table;
+    bake_target_t**      targets;
+    bake_target_t*       entry;
+    uint64_t             i, n = 0;
+
+    ABT_mutex_lock(provider->targets_mutex);
+    old_table = provider->targets;
+    entry     = target_table_find(old_table, target_id);
     if (!entry) {
-        ret = BAKE_ERR_UNKNOWN_TARGET;
-    } else {
-        HASH_DEL(provider->targets, entry);
-        entry->backend->_finalize(entry->context);
-        free(entry);
-        ret = BAKE_SUCCESS;
+        ABT_mutex_unlock(provider->targets_mutex);
+        return BAKE_ERR_UNKNOWN_TARGET;
     }
-    ABT_rwlock_unlock(provider->lock);
-    return ret;
+    /* publish a table without the target */
+    targets = malloc((old_table->num_targets + 1) * sizeof(*targets));
+    if (!targets) {
+        ABT_mutex_unlock(provider->targets_mutex);
+        return BAKE_ERR_ALLOCATION;
+    }
+    for (i = 0; i < old_table->num_targets; i++)
+        if (old_table->targets[i] != entry)
+            targets[n++] = old_table->targets[i];
+    new_table = target_table_create(targets, n);
+    free(targets);
+    if (!new_table) {
+        ABT_mutex_unlock(provider->targets_mutex);
+        return BAKE_ERR_ALLOCATION;
+    }
+    publish_targets(provider, new_table);
+    ABT_mutex_unlock(provider->targets_mutex);
+
+    /* no new RPC can find the target; let the ones using it finish */
+    drain_target(entry);
+    entry->backend->_finalize(entry->context);
+    free(entry);
+    return BAKE_SUCCESS;
 }
 
 int bake_provider_detach_all_targets(bake_provider_t provider)
 {
-    ABT_rwlock_wrlock(provider->lock);
-    bake_target_t *p, *tmp;
-    HASH_ITER(hh, provider->targets, p, tmp)
-    {
-        HASH_DEL(provider->targets, p);
-        p->backend->_finalize(p->context);
-        free(p);
+    bake_target_table_t* old_table;
+    uint64_t             i;
+
+    ABT_mutex_lock(provider->targets_mutex);
+    old_table = provider->targets;
+    __atomic_store_n(&provider->targets, target_table_create(NULL, 0),
+                     __ATOMIC_SEQ_CST);
+    wait_for_readers(provider);
+    ABT_mutex_unlock(provider->targets_mutex);
+
+    for (i = 0; i < old_table->num_targets; i++) {
+        drain_target(old_table->targets[i]);
+        old_table->targets[i]->backend->_finalize(
+            old_table->targets[i]->context);
+        free(old_table->targets[i]);
     }
-    provider->num_targets = 0;
-    ABT_rwlock_unlock(provider->lock);
+    free(old_table);
     return BAKE_SUCCESS;
 }
 
 int bake_provider_count_targets(bake_provider_t provider, uint64_t* num_targets)
 {
-    ABT_rwlock_rdlock(provider->lock);
-    *num_targets = provider->num_targets;
-    ABT_rwlock_unlock(provider->lock);
+    unsigned slot = reader_enter(provider);
+    *num_targets  = provider->targets->num_targets;
+    reader_exit(provider, slot);
     return BAKE_SUCCESS;
 }
 
 int bake_provider_list_targets(bake_provider_t   provider,
                                bake_target_id_t* targets)
 {
-    ABT_rwlock_rdlock(provider->lock);
-    bake_target_t *p, *tmp;
-    uint64_t       i = 0;
-    HASH_ITER(hh, provider->targets, p, tmp)
-    {
-        targets[i] = p->target_id;
-        i += 1;
-    }
-    ABT_rwlock_unlock(provider->lock);
+    unsigned             slot  = reader_enter(provider);
+    bake_target_table_t* table = provider->targets;
+    uint64_t             i;
+
+    for (i = 0; i < table->num_targets; i++)
+        targets[i] = table->targets[i]->target_id;
+    reader_exit(provider, slot);
     return BAKE_SUCCESS;
 }
 
-#define DECLARE_LOCAL_VARS(rpc_name)                    \
-    margo_instance_id       mid = MARGO_INSTANCE_NULL;  \
-    bake_##rpc_name##_out_t out = {0};                  \
-    bake_##rpc_name##_in_t  in;                         \
-    hg_return_t             hret;                       \
-    ABT_rwlock              lock     = ABT_RWLOCK_NULL; \
-    const struct hg_info*   info     = NULL;            \
-    bake_provider_t         provider = NULL;            \
-    bake_target_t*          target   = NULL
+#define DECLARE_LOCAL_VARS(rpc_name)                   \
+    margo_instance_id       mid = MARGO_INSTANCE_NULL; \
+    bake_##rpc_name##_out_t out = {0};                 \
+    bake_##rpc_name##_in_t  in;                        \
+    hg_return_t             hret;                      \
+    const struct hg_info*   info           = NULL;     \
+    bake_provider_t         provider       = NULL;     \
+    bake_target_t*          target         = NULL;     \
+    int                     admitted       = 0;        \
+    uint64_t                admitted_bytes = 0;        \
+    int                     busy           = 0;        \
+    uint64_t                busy_bytes     = 0
 
 #define FIND_PROVIDER                                    \
     do {                                                 \
@@ -518,24 +1909,90 @@ int bake_provider_list_targets(bake_provider_t   provider,
         }                                    \
     } while (0)
 
-#define LOCK_PROVIDER            \
-    do {                         \
-        lock = provider->lock;   \
-        ABT_rwlock_rdlock(lock); \
+#define FIND_TARGET                                \
+    do {                                           \
+        target = acquire_target(provider, in.bti); \
+        if (target == NULL) {                      \
+            out.ret = BAKE_ERR_UNKNOWN_TARGET;     \
+            goto finish;                           \
+        }                                          \
+        move_to_target_pool(target);               \
     } while (0)
 
-#define FIND_TARGET                                   \
-    do {                                              \
-        target = find_target_entry(provider, in.bti); \
-        if (target == NULL) {                         \
-            out.ret = BAKE_ERR_UNKNOWN_TARGET;        \
-            goto finish;                              \
-        }                                             \
+/* like FIND_TARGET, but lets the provider choose the target if the
+ * request does not name one, and reports the target in the response
+ */
+#define FIND_OR_PLACE_TARGET(__size)                             \
+    do {                                                         \
+        if (uuid_is_null(in.bti.id))                             \
+            target = place_region(provider, __size, info->addr); \
+        else                                                     \
+            target = acquire_target(provider, in.bti);           \
+        if (target == NULL) {                                    \
+            out.ret = BAKE_ERR_UNKNOWN_TARGET;                   \
+            goto finish;                                         \
+        }                                                        \
+        out.bti = target->target_id;                             \
+        move_to_target_pool(target);                             \
     } while (0)
 
-#define UNLOCK_PROVIDER                                       \
+/* accounts for a region created on the target, for least_used placement */
+#define ACCOUNT_PLACED(__size)                                \
     do {                                                      \
-        if (lock != ABT_RWLOCK_NULL) ABT_rwlock_unlock(lock); \
+        if (out.ret == BAKE_SUCCESS)                          \
+            __atomic_add_fetch(&target->bytes_placed, __size, \
+                               __ATOMIC_RELAXED);             \
+    } while (0)
+
+/* waits for the target to admit an operation of the given size, see
+ * admit_acquire(); RELEASE_TARGET hands the admission back
+ */
+#define ADMIT(__size)                                               \
+    do {                                                            \
+        admitted_bytes = __size;                                    \
+        admitted = admit_acquire(provider, target, admitted_bytes); \
+    } while (0)
+
+/* turns the operation away if the provider is overloaded, see
+ * busy_enter(); bulk operations stage their data through the buffer
+ * pool when pipelining is enabled.  RELEASE_TARGET counts the operation out.
+ */
+#define SHED_IF_BUSY(__size, __bulk)                                     \
+    do {                                                                 \
+        busy_bytes = (__bulk) && __atomic_load_n(&provider->buffer_pool, \
+                                                 __ATOMIC_RELAXED)       \
+                       ? (__size)                                        \
+                       : 0;                                              \
+        out.ret = busy_enter(provider, busy_bytes, &out.retry_after_ms); \
+        if (out.ret != BAKE_SUCCESS) goto finish;                        \
+        busy = 1;                                                        \
+    } while (0)
+
+/* fails the operation with BAKE_ERR_TIMEOUT if its client has given up on
+ * it already, which may happen while it waits in a queue; the backend
+ * finds the deadline with bake_provider_deadline()
+ */
+#define CHECK_DEADLINE                                           \
+    do {                                                         \
+        if (bake_deadline_passed(in.deadline_us)) {              \
+            __atomic_add_fetch(&provider->expired, 1,            \
+                               __ATOMIC_RELAXED);                \
+            out.ret = BAKE_ERR_TIMEOUT;                          \
+            goto finish;                                         \
+        }                                                        \
+        ABT_self_set_specific(provider->deadline_key,            \
+                              (void*)(uintptr_t)in.deadline_us); \
+    } while (0)
+
+#define RELEASE_TARGET                                       \
+    do {                                                     \
+        if (target && admitted)                              \
+            admit_release(provider, target, admitted_bytes); \
+        if (target) release_target(target);                  \
+        if (busy) busy_exit(provider, busy_bytes);           \
+        target   = NULL;                                     \
+        admitted = 0;                                        \
+        busy     = 0;                                        \
     } while (0)
 
 #define RESPOND_AND_CLEANUP            \
@@ -551,15 +2008,16 @@ static void bake_create_ult(hg_handle_t handle)
     DECLARE_LOCAL_VARS(create);
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
-    FIND_TARGET;
+    qos_admit(provider, info->addr, 0);
+    FIND_OR_PLACE_TARGET(in.region_size);
+    ADMIT(0);
 
-    memset(&out, 0, sizeof(out));
     out.ret
         = target->backend->_create(target->context, in.region_size, &out.rid);
+    ACCOUNT_PLACED(in.region_size);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_create_ult)
@@ -568,13 +2026,18 @@ DEFINE_MARGO_RPC_HANDLER(bake_create_ult)
 static void bake_write_ult(hg_handle_t handle)
 {
     DECLARE_LOCAL_VARS(write);
+    hg_addr_t src_addr = HG_ADDR_NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.bulk_size, 1);
+    qos_admit(provider, info->addr, in.bulk_size);
     FIND_TARGET;
+    move_to_bulk_lane(provider, target, in.bulk_size);
+    ADMIT(in.bulk_size);
+    CHECK_DEADLINE;
 
     memset(&out, 0, sizeof(out));
-    hg_addr_t src_addr = HG_ADDR_NULL;
     if (in.remote_addr_str && strlen(in.remote_addr_str)) {
         hret = margo_addr_lookup(mid, in.remote_addr_str, &src_addr);
     } else {
@@ -590,7 +2053,7 @@ static void bake_write_ult(hg_handle_t handle)
         src_addr, in.bulk_offset);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     margo_addr_free(mid, src_addr);
     RESPOND_AND_CLEANUP;
 }
@@ -604,14 +2067,18 @@ static void bake_eager_write_ult(hg_handle_t handle)
     in.size   = 0;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.size, 0);
+    qos_admit(provider, info->addr, in.size);
     FIND_TARGET;
+    ADMIT(in.size);
+    CHECK_DEADLINE;
 
     out.ret = target->backend->_write_raw(target->context, in.rid,
                                           in.region_offset, in.size, in.buffer);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_eager_write_ult)
@@ -622,14 +2089,15 @@ static void bake_persist_ult(hg_handle_t handle)
     DECLARE_LOCAL_VARS(persist);
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    qos_admit(provider, info->addr, 0);
     FIND_TARGET;
+    ADMIT(0);
 
     out.ret = target->backend->_persist(target->context, in.rid, in.offset,
                                         in.size);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_persist_ult)
@@ -637,13 +2105,17 @@ DEFINE_MARGO_RPC_HANDLER(bake_persist_ult)
 static void bake_create_write_persist_ult(hg_handle_t handle)
 {
     DECLARE_LOCAL_VARS(create_write_persist);
+    hg_addr_t src_addr = HG_ADDR_NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
-    FIND_TARGET;
-    memset(&out, 0, sizeof(out));
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.bulk_size, 1);
+    qos_admit(provider, info->addr, in.bulk_size);
+    FIND_OR_PLACE_TARGET(in.region_size);
+    move_to_bulk_lane(provider, target, in.bulk_size);
+    ADMIT(in.bulk_size);
+    CHECK_DEADLINE;
 
-    hg_addr_t src_addr = HG_ADDR_NULL;
     if (in.remote_addr_str && strlen(in.remote_addr_str)) {
         hret = margo_addr_lookup(mid, in.remote_addr_str, &src_addr);
     } else {
@@ -673,15 +2145,38 @@ static void bake_create_write_persist_ult(hg_handle_t handle)
             target->context, in.bulk_handle, src_addr, in.bulk_offset,
             in.bulk_size, &out.rid);
     }
+    ACCOUNT_PLACED(in.region_size);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     margo_addr_free(mid, src_addr);
     RESPOND_AND_CLEANUP;
     return;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_create_write_persist_ult)
 
+/* creates a region holding the given data on the target */
+static int create_write_persist_raw(bake_target_t*    target,
+                                    void*             buffer,
+                                    uint64_t          size,
+                                    bake_region_id_t* rid)
+{
+    int ret;
+
+    if (target->backend->_create_write_persist_raw)
+        return target->backend->_create_write_persist_raw(
+            target->context, buffer, size, rid);
+
+    /* If the backend does not provide a combination create_write_persist
+     * function, then issue constituent backend calls instead.
+     */
+    ret = target->backend->_create(target->context, size, rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = target->backend->_write_raw(target->context, *rid, 0, size, buffer);
+    if (ret != BAKE_SUCCESS) return ret;
+    return target->backend->_persist(target->context, *rid, 0, size);
+}
+
 static void bake_eager_create_write_persist_ult(hg_handle_t handle)
 {
     DECLARE_LOCAL_VARS(eager_create_write_persist);
@@ -689,33 +2184,67 @@ static void bake_eager_create_write_persist_ult(hg_handle_t handle)
     in.size   = 0;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
-    FIND_TARGET;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.size, 0);
+    qos_admit(provider, info->addr, in.size);
+    FIND_OR_PLACE_TARGET(in.size);
+    ADMIT(in.size);
+    CHECK_DEADLINE;
 
-    memset(&out, 0, sizeof(out));
+    out.ret = create_write_persist_raw(target, in.buffer, in.size, &out.rid);
+    ACCOUNT_PLACED(in.size);
 
-    if (!target->backend->_create_write_persist_raw) {
-        /* If the backend does not provide a combination
-         * create_write_persist function, then issue constituent backend
-         * calls instead.
-         */
-        out.ret = target->backend->_create(target->context, in.size, &out.rid);
-        if (out.ret != BAKE_SUCCESS) goto finish;
-        out.ret = target->backend->_write_raw(target->context, out.rid, 0,
-                                              in.size, in.buffer);
-        if (out.ret != BAKE_SUCCESS) goto finish;
-        out.ret
-            = target->backend->_persist(target->context, out.rid, 0, in.size);
-    } else {
-        out.ret = target->backend->_create_write_persist_raw(
-            target->context, in.buffer, in.size, &out.rid);
+finish:
+    RELEASE_TARGET;
+    RESPOND_AND_CLEANUP;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_eager_create_write_persist_ult)
+
+/* service a remote RPC that creates several small regions on one target
+ * from the data packed in its message; either all the regions are
+ * created, or none
+ */
+static void bake_eager_create_write_persist_multi_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(eager_create_write_persist_multi);
+    uint64_t i, size = 0, offset = 0;
+    in.count  = 0;
+    in.sizes  = NULL;
+    in.buffer = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    for (i = 0; i < in.count; i++) size += in.sizes[i];
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(size, 0);
+    qos_admit(provider, info->addr, size);
+    FIND_OR_PLACE_TARGET(size);
+    ADMIT(size);
+    CHECK_DEADLINE;
+
+    out.rids = calloc(in.count ? in.count : 1, sizeof(*out.rids));
+    if (!out.rids) {
+        out.ret = BAKE_ERR_ALLOCATION;
+        goto finish;
+    }
+    for (i = 0; i < in.count; i++) {
+        out.ret = create_write_persist_raw(target, in.buffer + offset,
+                                           in.sizes[i], &out.rids[i]);
+        if (out.ret != BAKE_SUCCESS) break;
+        offset += in.sizes[i];
+    }
+    if (out.ret != BAKE_SUCCESS) {
+        while (i-- > 0) target->backend->_remove(target->context, out.rids[i]);
+        goto finish;
     }
+    out.count = in.count;
+    ACCOUNT_PLACED(size);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
+    free(out.rids);
 }
-DEFINE_MARGO_RPC_HANDLER(bake_eager_create_write_persist_ult)
+DEFINE_MARGO_RPC_HANDLER(bake_eager_create_write_persist_multi_ult)
 
 /* service a remote RPC that retrieves the size of a BAKE region */
 static void bake_get_size_ult(hg_handle_t handle)
@@ -723,15 +2252,16 @@ static void bake_get_size_ult(hg_handle_t handle)
     DECLARE_LOCAL_VARS(get_size);
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    qos_admit(provider, info->addr, 0);
     FIND_TARGET;
+    ADMIT(0);
 
     memset(&out, 0, sizeof(out));
     out.ret
         = target->backend->_get_region_size(target->context, in.rid, &out.size);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_get_size_ult)
@@ -742,93 +2272,707 @@ static void bake_get_data_ult(hg_handle_t handle)
     DECLARE_LOCAL_VARS(get_data);
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    qos_admit(provider, info->addr, 0);
     FIND_TARGET;
+    ADMIT(0);
     out.ptr = 0;
 
     out.ret = target->backend->_get_region_data(target->context, in.rid,
                                                 (void**)&out.ptr);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
+    RESPOND_AND_CLEANUP;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_get_data_ult)
+
+/* service a remote RPC for a BAKE no-op */
+static void bake_noop_ult(hg_handle_t handle)
+{
+    margo_instance_id mid = margo_hg_handle_get_instance(handle);
+    assert(mid);
+
+    margo_respond(handle, NULL);
+    margo_destroy(handle);
+    return;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_noop_ult)
+
+/* TODO consolidate with write handler; read and write are nearly identical */
+/* service a remote RPC that reads from a BAKE region */
+static void bake_read_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(read);
+    hg_addr_t src_addr = HG_ADDR_NULL;
+    in.remote_addr_str = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.bulk_size, 1);
+    qos_admit(provider, info->addr, in.bulk_size);
+    FIND_TARGET;
+    move_to_bulk_lane(provider, target, in.bulk_size);
+    ADMIT(in.bulk_size);
+    CHECK_DEADLINE;
+
+    memset(&out, 0, sizeof(out));
+    if (in.remote_addr_str && strlen(in.remote_addr_str)) {
+        hret = margo_addr_lookup(mid, in.remote_addr_str, &src_addr);
+    } else {
+        hret = margo_addr_dup(mid, info->addr, &src_addr);
+    }
+    if (hret != HG_SUCCESS) {
+        out.ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+
+    out.ret = target->backend->_read_bulk(
+        target->context, in.rid, in.region_offset, in.bulk_size, in.bulk_handle,
+        src_addr, in.bulk_offset, &out.size);
+
+finish:
+    RELEASE_TARGET;
+    margo_addr_free(mid, src_addr);
+    RESPOND_AND_CLEANUP;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_read_ult)
+
+/* service a remote RPC that reads from a BAKE region and eagerly sends
+ * response */
+static void bake_eager_read_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(eager_read);
+    free_fn free_data = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(in.size, 0);
+    qos_admit(provider, info->addr, in.size);
+    FIND_TARGET;
+    ADMIT(in.size);
+    CHECK_DEADLINE;
+
+    out.ret = target->backend->_read_raw(target->context, in.rid,
+                                         in.region_offset, in.size,
+                                         (void**)&out.buffer, &out.size,
+                                         &free_data);
+
+finish:
+    RESPOND_AND_CLEANUP;
+    /* the target must not go away before its data is freed */
+    if (free_data) free_data(target->context, out.buffer);
+    RELEASE_TARGET;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_eager_read_ult)
+
+/* service a remote RPC that reads several small regions of one target and
+ * packs their contents in its response
+ */
+static void bake_eager_read_multi_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(eager_read_multi);
+    uint64_t i, size = 0, offset = 0;
+    void*    data;
+    uint64_t data_size;
+    free_fn  free_data;
+    in.count = 0;
+    in.rids  = NULL;
+    in.sizes = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    for (i = 0; i < in.count; i++) size += in.sizes[i];
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(size, 0);
+    qos_admit(provider, info->addr, size);
+    FIND_TARGET;
+    ADMIT(size);
+    CHECK_DEADLINE;
+
+    out.sizes  = calloc(in.count ? in.count : 1, sizeof(*out.sizes));
+    out.buffer = malloc(size ? size : 1);
+    if (!out.sizes || !out.buffer) {
+        out.ret = BAKE_ERR_ALLOCATION;
+        goto finish;
+    }
+    for (i = 0; i < in.count; i++) {
+        free_data = NULL;
+        out.ret   = target->backend->_read_raw(target->context, in.rids[i], 0,
+                                               in.sizes[i], &data, &data_size,
+                                               &free_data);
+        if (out.ret != BAKE_SUCCESS) break;
+        if (data_size > in.sizes[i]) data_size = in.sizes[i];
+        memcpy(out.buffer + offset, data, data_size);
+        if (free_data) free_data(target->context, data);
+        out.sizes[i] = data_size;
+        offset += data_size;
+    }
+    /* nothing is sent back on failure */
+    if (out.ret == BAKE_SUCCESS) out.count = in.count;
+
+finish:
+    RELEASE_TARGET;
+    RESPOND_AND_CLEANUP;
+    free(out.sizes);
+    free(out.buffer);
+}
+DEFINE_MARGO_RPC_HANDLER(bake_eager_read_multi_ult)
+
+/* runs operation i of a compound request on the target, taking the data it
+ * writes from in_data and appending the data it reads to out_data
+ */
+static int run_op(bake_provider_t   provider,
+                  bake_target_t*    target,
+                  const bake_op_t*  ops,
+                  uint64_t          i,
+                  bake_op_result_t* results,
+                  const char*       in_data,
+                  uint64_t*         in_offset,
+                  char*             out_data,
+                  uint64_t*         out_offset)
+{
+    const bake_op_t*  op        = &ops[i];
+    bake_op_result_t* result    = &results[i];
+    void*             data      = NULL;
+    uint64_t          data_size = 0;
+    size_t            size      = 0;
+    free_fn           free_data = NULL;
+
+    if (op->type == BAKE_OP_CREATE) {
+        result->ret = target->backend->_create(target->context, op->size,
+                                               &result->rid);
+        if (result->ret == BAKE_SUCCESS)
+            __atomic_add_fetch(&target->bytes_placed, op->size,
+                               __ATOMIC_RELAXED);
+        return result->ret;
+    }
+
+    /* the region is named, or was created by an earlier operation */
+    if (op->rid_step == BAKE_OP_RID)
+        result->rid = op->rid;
+    else if (op->rid_step >= 0 && (uint64_t)op->rid_step < i
+             && ops[op->rid_step].type == BAKE_OP_CREATE)
+        result->rid = results[op->rid_step].rid;
+    else
+        return result->ret = BAKE_ERR_INVALID_ARG;
+
+    switch (op->type) {
+    case BAKE_OP_WRITE:
+        result->ret
+            = target->backend->_write_raw(target->context, result->rid,
+                                          op->offset, op->size,
+                                          in_data + *in_offset);
+        *in_offset += op->size;
+        break;
+    case BAKE_OP_PERSIST:
+        result->ret = target->backend->_persist(target->context, result->rid,
+                                                op->offset, op->size);
+        break;
+    case BAKE_OP_GET_SIZE:
+        result->ret = target->backend->_get_region_size(target->context,
+                                                        result->rid, &size);
+        result->size = size;
+        break;
+    case BAKE_OP_READ:
+        result->ret = target->backend->_read_raw(
+            target->context, result->rid, op->offset, op->size, &data,
+            &data_size, &free_data);
+        if (result->ret != BAKE_SUCCESS) break;
+        if (data_size > op->size) data_size = op->size;
+        memcpy(out_data + *out_offset, data, data_size);
+        if (free_data) free_data(target->context, data);
+        *out_offset += data_size;
+        result->size = data_size;
+        break;
+    case BAKE_OP_REMOVE:
+        /* same accounting as bake_remove_ult() */
+        if (provider->placement_policy == BAKE_PLACEMENT_LEAST_USED
+            && target->backend->_get_region_size(target->context, result->rid,
+                                                 &size)
+                   != BAKE_SUCCESS)
+            size = 0;
+        result->ret = target->backend->_remove(target->context, result->rid);
+        if (result->ret == BAKE_SUCCESS && size
+            && size <= __atomic_load_n(&target->bytes_placed, __ATOMIC_RELAXED))
+            __atomic_sub_fetch(&target->bytes_placed, size, __ATOMIC_RELAXED);
+        break;
+    default:
+        result->ret = BAKE_ERR_INVALID_ARG;
+    }
+    return result->ret;
+}
+
+/* service a remote RPC that runs a list of operations on one target, in
+ * order, stopping at the first one that fails
+ */
+static void bake_compound_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(compound);
+    uint64_t i, created = 0, written = 0, read = 0, in_offset = 0;
+    in.count     = 0;
+    in.ops       = NULL;
+    in.data_size = 0;
+    in.data      = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    for (i = 0; i < in.count; i++) {
+        if (in.ops[i].type == BAKE_OP_CREATE) created += in.ops[i].size;
+        if (in.ops[i].type == BAKE_OP_WRITE) written += in.ops[i].size;
+        if (in.ops[i].type == BAKE_OP_READ) read += in.ops[i].size;
+    }
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(written + read, 0);
+    qos_admit(provider, info->addr, written + read);
+    FIND_OR_PLACE_TARGET(created);
+    ADMIT(written + read);
+    CHECK_DEADLINE;
+
+    if (written != in.data_size) {
+        out.ret = BAKE_ERR_INVALID_ARG;
+        goto finish;
+    }
+    out.results = calloc(in.count ? in.count : 1, sizeof(*out.results));
+    out.data    = malloc(read ? read : 1);
+    if (!out.results || !out.data) {
+        out.ret = BAKE_ERR_ALLOCATION;
+        goto finish;
+    }
+    for (i = 0; i < in.count; i++) {
+        out.count = i + 1;
+        out.ret   = run_op(provider, target, in.ops, i, out.results, in.data,
+                           &in_offset, out.data, &out.data_size);
+        if (out.ret != BAKE_SUCCESS) break;
+    }
+
+finish:
+    RELEASE_TARGET;
+    RESPOND_AND_CLEANUP;
+    free(out.results);
+    free(out.data);
+}
+DEFINE_MARGO_RPC_HANDLER(bake_compound_ult)
+
+/* one segment of a vectored read or write */
+typedef struct {
+    bake_provider_t provider;
+    bake_target_t*  target; /* pinned by transfer_segments() */
+    bake_segment_t* segment;
+    hg_bulk_t       bulk;
+    hg_addr_t       src_addr;
+    uint64_t        bulk_offset;
+    uint64_t        deadline_us;
+    int             write;
+    size_t          size; /* bytes read */
+    int32_t         ret;
+} bake_segment_xfer_t;
+
+static void segment_xfer_ult(void* _args)
+{
+    bake_segment_xfer_t* x       = _args;
+    bake_segment_t*      segment = x->segment;
+    bake_target_t*       target  = x->target;
+    int                  admitted;
+
+    admitted = admit_acquire(x->provider, target, segment->size);
+    ABT_self_set_specific(x->provider->deadline_key,
+                          (void*)(uintptr_t)x->deadline_us);
+    if (bake_deadline_passed(x->deadline_us))
+        x->ret = BAKE_ERR_TIMEOUT;
+    else if (x->write)
+        x->ret = target->backend->_write_bulk(
+            target->context, segment->rid, segment->region_offset,
+            segment->size, x->bulk, x->src_addr, x->bulk_offset);
+    else
+        x->ret = target->backend->_read_bulk(
+            target->context, segment->rid, segment->region_offset,
+            segment->size, x->bulk, x->src_addr, x->bulk_offset, &x->size);
+    if (admitted) admit_release(x->provider, target, segment->size);
+}
+
+/* total size of the segments of a vectored read or write */
+static uint64_t segments_size(const bake_readv_in_t* in)
+{
+    uint64_t i, size = 0;
+
+    for (i = 0; i < in->num_segments; i++) size += in->segments[i].size;
+    return size;
+}
+
+/* segments of a vectored request in flight at once */
+#define BAKE_SEGMENT_WAVE 64
+
+/* moves the segments of a vectored read or write concurrently, each in a
+ * ULT on the pool of its target, so that a single request keeps all the
+ * targets and the pipeline busy; a request with many segments is moved
+ * BAKE_SEGMENT_WAVE segments at a time, so that it does not create ULTs
+ * and pin targets for all of them at once.  Returns the first error, and
+ * the bytes read from each segment in sizes if not NULL.
+ */
+static int transfer_segments(bake_provider_t  provider,
+                             bake_readv_in_t* in,
+                             hg_addr_t        src_addr,
+                             int              write,
+                             uint64_t*        sizes)
+{
+    bake_segment_xfer_t* xfers;
+    ABT_thread*          ults;
+    ABT_pool             pool;
+    uint64_t             i, n, first, wave, offset = 0;
+    int                  ret = BAKE_SUCCESS;
+
+    if (in->num_segments == 0) return BAKE_SUCCESS;
+    if (segments_size(in) > 0
+        && (in->bulk_handle == HG_BULK_NULL
+            || segments_size(in) > HG_Bulk_get_size(in->bulk_handle)))
+        return BAKE_ERR_OUT_OF_BOUNDS;
+
+    wave  = in->num_segments < BAKE_SEGMENT_WAVE ? in->num_segments
+                                                 : BAKE_SEGMENT_WAVE;
+    xfers = malloc(wave * sizeof(*xfers));
+    ults  = malloc(wave * sizeof(*ults));
+    if (!xfers || !ults) {
+        free(xfers);
+        free(ults);
+        return BAKE_ERR_ALLOCATION;
+    }
+
+    for (first = 0; first < in->num_segments; first += n) {
+        n = in->num_segments - first < wave ? in->num_segments - first : wave;
+        memset(xfers, 0, n * sizeof(*xfers));
+        for (i = 0; i < n; i++) {
+            xfers[i].provider    = provider;
+            xfers[i].segment     = &in->segments[first + i];
+            xfers[i].bulk        = in->bulk_handle;
+            xfers[i].src_addr    = src_addr;
+            xfers[i].bulk_offset = offset;
+            xfers[i].deadline_us = in->deadline_us;
+            xfers[i].write       = write;
+            ults[i]              = ABT_THREAD_NULL;
+            offset += xfers[i].segment->size;
+            if (xfers[i].segment->size == 0) continue;
+
+            xfers[i].target = acquire_target(provider, xfers[i].segment->bti);
+            if (!xfers[i].target) {
+                xfers[i].ret = BAKE_ERR_UNKNOWN_TARGET;
+                continue;
+            }
+            pool = xfers[i].target->pool != ABT_POOL_NULL
+                     ? xfers[i].target->pool
+                     : bake_provider_xfer_pool(provider);
+            if (ABT_thread_create(pool, segment_xfer_ult, &xfers[i],
+                                  ABT_THREAD_ATTR_NULL, &ults[i])
+                != ABT_SUCCESS)
+                xfers[i].ret = BAKE_ERR_ARGOBOTS;
+        }
+
+        for (i = 0; i < n; i++) {
+            /* frees the ULT once it has completed */
+            if (ults[i] != ABT_THREAD_NULL) ABT_thread_free(&ults[i]);
+            if (xfers[i].target) release_target(xfers[i].target);
+            if (sizes) sizes[first + i] = xfers[i].size;
+            if (ret == BAKE_SUCCESS) ret = xfers[i].ret;
+        }
+    }
+
+    free(xfers);
+    free(ults);
+    return ret;
+}
+
+/* service a remote RPC that writes to several regions, possibly on
+ * several targets, with one bulk handle holding the data of all of them
+ */
+static void bake_writev_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(writev);
+    hg_addr_t src_addr = HG_ADDR_NULL;
+    in.num_segments    = 0;
+    in.segments        = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(segments_size(&in), 1);
+    qos_admit(provider, info->addr, segments_size(&in));
+
+    hret = margo_addr_dup(mid, info->addr, &src_addr);
+    if (hret != HG_SUCCESS) {
+        out.ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+    out.ret = transfer_segments(provider, &in, src_addr, 1, NULL);
+
+finish:
+    RELEASE_TARGET;
+    margo_addr_free(mid, src_addr);
+    RESPOND_AND_CLEANUP;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_writev_ult)
+
+/* service a remote RPC that reads from several regions into one bulk
+ * handle, see bake_writev_ult()
+ */
+static void bake_readv_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(readv);
+    hg_addr_t src_addr = HG_ADDR_NULL;
+    in.num_segments    = 0;
+    in.segments        = NULL;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    CHECK_DEADLINE;
+    SHED_IF_BUSY(segments_size(&in), 1);
+    qos_admit(provider, info->addr, segments_size(&in));
+
+    out.sizes = calloc(in.num_segments ? in.num_segments : 1,
+                       sizeof(*out.sizes));
+    if (!out.sizes) {
+        out.ret = BAKE_ERR_ALLOCATION;
+        goto finish;
+    }
+    out.num_segments = in.num_segments;
+
+    hret = margo_addr_dup(mid, info->addr, &src_addr);
+    if (hret != HG_SUCCESS) {
+        out.ret = BAKE_ERR_MERCURY;
+        goto finish;
+    }
+    out.ret = transfer_segments(provider, &in, src_addr, 0, out.sizes);
+
+finish:
+    RELEASE_TARGET;
+    margo_addr_free(mid, src_addr);
+    RESPOND_AND_CLEANUP;
+    free(out.sizes);
+}
+DEFINE_MARGO_RPC_HANDLER(bake_readv_ult)
+
+/* service a remote RPC that probes for a BAKE target id */
+static void bake_probe_ult(hg_handle_t handle)
+{
+    bake_probe_out_t out;
+
+    memset(&out, 0, sizeof(out));
+
+    margo_instance_id mid = margo_hg_handle_get_instance(handle);
+    assert(mid);
+    const struct hg_info* hgi      = margo_get_info(handle);
+    bake_provider_t       provider = margo_registered_data(mid, hgi->id);
+    if (!provider) {
+        out.ret = BAKE_ERR_UNKNOWN_PROVIDER;
+        margo_respond(handle, &out);
+        margo_destroy(handle);
+        return;
+    }
+
+    /* count and list from the same snapshot of the target table */
+    uint64_t         targets_count, i;
+    bake_target_t**  pinned  = acquire_all_targets(provider, &targets_count);
+    bake_target_id_t targets[targets_count ? targets_count : 1];
+    for (i = 0; i < targets_count; i++) targets[i] = pinned[i]->target_id;
+    release_all_targets(pinned, targets_count);
+
+    out.ret         = pinned ? BAKE_SUCCESS : BAKE_ERR_ALLOCATION;
+    out.targets     = targets;
+    out.num_targets = targets_count;
+
+    margo_respond(handle, &out);
+
+    margo_destroy(handle);
+}
+DEFINE_MARGO_RPC_HANDLER(bake_probe_ult)
+
+static void bake_remove_ult(hg_handle_t handle)
+{
+    DECLARE_LOCAL_VARS(remove);
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    qos_admit(provider, info->addr, 0);
+    FIND_TARGET;
+    ADMIT(0);
+
+    if (provider->placement_policy == BAKE_PLACEMENT_LEAST_USED) {
+        size_t size = 0;
+        if (target->backend->_get_region_size(target->context, in.rid, &size)
+            != BAKE_SUCCESS)
+            size = 0;
+        out.ret = target->backend->_remove(target->context, in.rid);
+        if (out.ret == BAKE_SUCCESS && size
+            && size <= __atomic_load_n(&target->bytes_placed, __ATOMIC_RELAXED))
+            __atomic_sub_fetch(&target->bytes_placed, size, __ATOMIC_RELAXED);
+    } else {
+        out.ret = target->backend->_remove(target->context, in.rid);
+    }
+finish:
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
-DEFINE_MARGO_RPC_HANDLER(bake_get_data_ult)
+DEFINE_MARGO_RPC_HANDLER(bake_remove_ult)
 
-/* service a remote RPC for a BAKE no-op */
-static void bake_noop_ult(hg_handle_t handle)
+/* pulls an array of a batch operation from the bulk handle of the client,
+ * or pushes it there
+ */
+static int transfer_array(margo_instance_id mid,
+                          hg_addr_t         addr,
+                          hg_bulk_t         remote_bulk,
+                          size_t            remote_offset,
+                          void*             array,
+                          hg_size_t         size,
+                          int               pull)
 {
-    margo_instance_id mid = margo_hg_handle_get_instance(handle);
-    assert(mid);
+    hg_bulk_t   bulk = HG_BULK_NULL;
+    hg_return_t hret;
 
-    margo_respond(handle, NULL);
-    margo_destroy(handle);
-    return;
+    if (size == 0) return BAKE_SUCCESS;
+    if (remote_offset + size > HG_Bulk_get_size(remote_bulk))
+        return BAKE_ERR_OUT_OF_BOUNDS;
+    hret = margo_bulk_create(mid, 1, &array, &size,
+                             pull ? HG_BULK_WRITE_ONLY : HG_BULK_READ_ONLY,
+                             &bulk);
+    if (hret == HG_SUCCESS)
+        hret = margo_bulk_transfer(mid, pull ? HG_BULK_PULL : HG_BULK_PUSH,
+                                   addr, remote_bulk, remote_offset, bulk, 0,
+                                   size);
+    margo_bulk_free(bulk);
+    return hret == HG_SUCCESS ? BAKE_SUCCESS : BAKE_ERR_MERCURY;
 }
-DEFINE_MARGO_RPC_HANDLER(bake_noop_ult)
 
-/* TODO consolidate with write handler; read and write are nearly identical */
-/* service a remote RPC that reads from a BAKE region */
-static void bake_read_ult(hg_handle_t handle)
+/* service a remote RPC that creates several regions on a target */
+static void bake_create_multi_ult(hg_handle_t handle)
 {
-    DECLARE_LOCAL_VARS(read);
-    in.remote_addr_str = NULL;
+    DECLARE_LOCAL_VARS(create_multi);
+    uint64_t*         sizes;
+    uint64_t*         pulled_sizes = NULL;
+    bake_region_id_t* rids         = NULL;
+    uint64_t          i, size = 0;
+    in.sizes       = NULL;
+    in.bulk_handle = HG_BULK_NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
-    FIND_TARGET;
-
-    memset(&out, 0, sizeof(out));
-    hg_addr_t src_addr = HG_ADDR_NULL;
-    if (in.remote_addr_str && strlen(in.remote_addr_str)) {
-        hret = margo_addr_lookup(mid, in.remote_addr_str, &src_addr);
-    } else {
-        hret = margo_addr_dup(mid, info->addr, &src_addr);
+    qos_admit(provider, info->addr, 0);
+
+    sizes = in.sizes;
+    if (in.bulk_handle != HG_BULK_NULL) {
+        pulled_sizes = malloc((in.count ? in.count : 1) * sizeof(*sizes));
+        if (!pulled_sizes) {
+            out.ret = BAKE_ERR_ALLOCATION;
+            goto finish;
+        }
+        out.ret = transfer_array(mid, info->addr, in.bulk_handle, 0,
+                                 pulled_sizes, in.count * sizeof(*sizes), 1);
+        if (out.ret != BAKE_SUCCESS) goto finish;
+        sizes = pulled_sizes;
     }
-    if (hret != HG_SUCCESS) {
-        out.ret = BAKE_ERR_MERCURY;
+    rids = calloc(in.count ? in.count : 1, sizeof(*rids));
+    if (!rids) {
+        out.ret = BAKE_ERR_ALLOCATION;
         goto finish;
     }
-
-    out.ret = target->backend->_read_bulk(
-        target->context, in.rid, in.region_offset, in.bulk_size, in.bulk_handle,
-        src_addr, in.bulk_offset, &out.size);
+    for (i = 0; i < in.count; i++) size += sizes[i];
+    FIND_OR_PLACE_TARGET(size);
+    ADMIT(0);
+
+    out.ret = bake_backend_create_multi(target->backend, target->context,
+                                        in.group, in.count, sizes, rids);
+    if (out.ret != BAKE_SUCCESS) goto finish;
+    if (in.bulk_handle != HG_BULK_NULL) {
+        out.ret = transfer_array(mid, info->addr, in.bulk_handle,
+                                 in.count * sizeof(*sizes), rids,
+                                 in.count * sizeof(*rids), 0);
+        if (out.ret != BAKE_SUCCESS)
+            bake_backend_remove_multi(target->backend, target->context,
+                                      in.count, rids, NULL);
+    } else {
+        out.count = in.count;
+        out.rids  = rids;
+    }
+    ACCOUNT_PLACED(size);
 
 finish:
-    UNLOCK_PROVIDER;
-    margo_addr_free(mid, src_addr);
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
+    free(pulled_sizes);
+    free(rids);
 }
-DEFINE_MARGO_RPC_HANDLER(bake_read_ult)
+DEFINE_MARGO_RPC_HANDLER(bake_create_multi_ult)
 
-/* service a remote RPC that reads from a BAKE region and eagerly sends
- * response */
-static void bake_eager_read_ult(hg_handle_t handle)
+/* service a remote RPC that removes several regions of a target */
+static void bake_remove_multi_ult(hg_handle_t handle)
 {
-    DECLARE_LOCAL_VARS(eager_read);
+    DECLARE_LOCAL_VARS(remove_multi);
+    bake_region_id_t* rids;
+    bake_region_id_t* pulled_rids = NULL;
+    size_t            size = 0;
+    in.rids        = NULL;
+    in.bulk_handle = HG_BULK_NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
+    qos_admit(provider, info->addr, 0);
+
+    rids = in.rids;
+    if (in.bulk_handle != HG_BULK_NULL) {
+        pulled_rids = malloc((in.count ? in.count : 1) * sizeof(*rids));
+        if (!pulled_rids) {
+            out.ret = BAKE_ERR_ALLOCATION;
+            goto finish;
+        }
+        out.ret = transfer_array(mid, info->addr, in.bulk_handle, 0,
+                                 pulled_rids, in.count * sizeof(*rids), 1);
+        if (out.ret != BAKE_SUCCESS) goto finish;
+        rids = pulled_rids;
+    }
     FIND_TARGET;
+    ADMIT(0);
 
-    free_fn free_data = NULL;
-    out.ret           = target->backend->_read_raw(
-        target->context, in.rid, in.region_offset, in.size, (void**)&out.buffer,
-        &out.size, &free_data);
+    /* the regions removed no longer count, even if others could not be */
+    out.ret = bake_backend_remove_multi(
+        target->backend, target->context, in.count, rids,
+        provider->placement_policy == BAKE_PLACEMENT_LEAST_USED ? &size
+                                                                : NULL);
+    if (size
+        && size <= __atomic_load_n(&target->bytes_placed, __ATOMIC_RELAXED))
+        __atomic_sub_fetch(&target->bytes_placed, size, __ATOMIC_RELAXED);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
-    if (free_data) free_data(target->context, out.buffer);
+    free(pulled_rids);
 }
-DEFINE_MARGO_RPC_HANDLER(bake_eager_read_ult)
+DEFINE_MARGO_RPC_HANDLER(bake_remove_multi_ult)
 
-/* service a remote RPC that probes for a BAKE target id */
-static void bake_probe_ult(hg_handle_t handle)
+static void bake_remove_group_ult(hg_handle_t handle)
 {
-    bake_probe_out_t out;
+    DECLARE_LOCAL_VARS(remove_group);
+    size_t size = 0;
+    FIND_PROVIDER;
+    GET_RPC_INPUT;
+    qos_admit(provider, info->addr, 0);
+    FIND_TARGET;
+    ADMIT(0);
 
-    memset(&out, 0, sizeof(out));
+    if (in.group == 0) {
+        out.ret = BAKE_ERR_INVALID_ARG;
+        goto finish;
+    }
+    if (!target->backend->_remove_group) {
+        out.ret = BAKE_ERR_OP_UNSUPPORTED;
+        goto finish;
+    }
+    out.ret = target->backend->_remove_group(target->context, in.group, &size);
+    if (provider->placement_policy == BAKE_PLACEMENT_LEAST_USED && size
+        && size <= __atomic_load_n(&target->bytes_placed, __ATOMIC_RELAXED))
+        __atomic_sub_fetch(&target->bytes_placed, size, __ATOMIC_RELAXED);
+
+finish:
+    RELEASE_TARGET;
+    RESPOND_AND_CLEANUP;
+}
+DEFINE_MARGO_RPC_HANDLER(bake_remove_group_ult)
+
+/* service a remote RPC that changes a runtime parameter of the provider */
+static void bake_set_param_ult(hg_handle_t handle)
+{
+    bake_set_param_in_t  in;
+    bake_set_param_out_t out = {0};
+    hg_return_t          hret;
 
     margo_instance_id mid = margo_hg_handle_get_instance(handle);
     assert(mid);
@@ -841,35 +2985,21 @@ static void bake_probe_ult(hg_handle_t handle)
         return;
     }
 
-    uint64_t targets_count;
-    bake_provider_count_targets(provider, &targets_count);
-    bake_target_id_t targets[targets_count];
-    bake_provider_list_targets(provider, targets);
+    hret = margo_get_input(handle, &in);
+    if (hret != HG_SUCCESS) {
+        out.ret = BAKE_ERR_MERCURY;
+        margo_respond(handle, &out);
+        margo_destroy(handle);
+        return;
+    }
 
-    out.ret         = BAKE_SUCCESS;
-    out.targets     = targets;
-    out.num_targets = targets_count;
+    out.ret = bake_provider_set_param(provider, in.key, in.value);
 
     margo_respond(handle, &out);
-
+    margo_free_input(handle, &in);
     margo_destroy(handle);
 }
-DEFINE_MARGO_RPC_HANDLER(bake_probe_ult)
-
-static void bake_remove_ult(hg_handle_t handle)
-{
-    DECLARE_LOCAL_VARS(remove);
-    FIND_PROVIDER;
-    GET_RPC_INPUT;
-    LOCK_PROVIDER;
-    FIND_TARGET;
-
-    out.ret = target->backend->_remove(target->context, in.rid);
-finish:
-    UNLOCK_PROVIDER;
-    RESPOND_AND_CLEANUP;
-}
-DEFINE_MARGO_RPC_HANDLER(bake_remove_ult)
+DEFINE_MARGO_RPC_HANDLER(bake_set_param_ult)
 
 static void bake_migrate_region_ult(hg_handle_t handle)
 {
@@ -877,7 +3007,6 @@ static void bake_migrate_region_ult(hg_handle_t handle)
     in.dest_addr = NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
-    LOCK_PROVIDER;
     FIND_TARGET;
 
     memset(&out, 0, sizeof(out));
@@ -887,7 +3016,7 @@ static void bake_migrate_region_ult(hg_handle_t handle)
         in.dest_addr, in.dest_provider_id, in.dest_target_id, &out.dest_rid);
 
 finish:
-    UNLOCK_PROVIDER;
+    RELEASE_TARGET;
     RESPOND_AND_CLEANUP;
 }
 DEFINE_MARGO_RPC_HANDLER(bake_migrate_region_ult)
@@ -896,8 +3025,9 @@ static void bake_migrate_target_ult(hg_handle_t handle)
 {
 #ifdef USE_REMI
     DECLARE_LOCAL_VARS(migrate_target);
-    int ret;
-    in.dest_remi_addr = NULL;
+    int            ret;
+    bake_target_t* migrating = NULL;
+    in.dest_remi_addr        = NULL;
     in.dest_root      = NULL;
     FIND_PROVIDER;
     GET_RPC_INPUT;
@@ -907,9 +3037,6 @@ static void bake_migrate_target_ult(hg_handle_t handle)
 
     remi_provider_handle_t remi_ph       = REMI_PROVIDER_HANDLE_NULL;
     remi_fileset_t         local_fileset = REMI_FILESET_NULL;
-    /* lock provider */
-    lock = provider->lock;
-    ABT_rwlock_wrlock(lock);
 
     if (!provider->remi_client) {
         out.ret = BAKE_ERR_OP_UNSUPPORTED;
@@ -918,6 +3045,17 @@ static void bake_migrate_target_ult(hg_handle_t handle)
 
     FIND_TARGET;
 
+    /* hold off new RPCs on this target and wait for the ones in progress;
+     * the other targets of the provider are not affected
+     */
+    if (__atomic_exchange_n(&target->migrating, 1, __ATOMIC_SEQ_CST)) {
+        out.ret = BAKE_ERR_FORBIDDEN;
+        goto finish;
+    }
+    migrating = target;
+    while (__atomic_load_n(&target->in_flight, __ATOMIC_SEQ_CST) > 1)
+        ABT_thread_yield();
+
     /* lookup the address of the destination REMI provider */
     hret = margo_addr_lookup(mid, in.dest_remi_addr, &dest_addr);
     if (hret != HG_SUCCESS) {
@@ -953,14 +3091,19 @@ static void bake_migrate_target_ult(hg_handle_t handle)
         goto finish;
     }
 
-    UNLOCK_PROVIDER;
-    /* remove the target from the list of managed targets */
-    if (in.remove_src) { bake_provider_detach_target(provider, in.bti); }
-    LOCK_PROVIDER;
+    /* remove the target from the list of managed targets; RPCs waiting
+     * for the migration to end will then find it gone
+     */
+    if (in.remove_src) {
+        RELEASE_TARGET;
+        migrating = NULL;
+        bake_provider_detach_target(provider, in.bti);
+    }
 
     out.ret = BAKE_SUCCESS;
 finish:
-    UNLOCK_PROVIDER;
+    if (migrating) __atomic_store_n(&migrating->migrating, 0, __ATOMIC_SEQ_CST);
+    RELEASE_TARGET;
     remi_fileset_free(local_fileset);
     remi_provider_handle_release(remi_ph);
     margo_addr_free(mid, dest_addr);
@@ -989,13 +3132,22 @@ static void bake_server_finalize_cb(void* data)
     margo_deregister(mid, provider->rpc_persist_id);
     margo_deregister(mid, provider->rpc_create_write_persist_id);
     margo_deregister(mid, provider->rpc_eager_create_write_persist_id);
+    margo_deregister(mid, provider->rpc_eager_create_write_persist_multi_id);
     margo_deregister(mid, provider->rpc_get_size_id);
     margo_deregister(mid, provider->rpc_get_data_id);
     margo_deregister(mid, provider->rpc_read_id);
     margo_deregister(mid, provider->rpc_eager_read_id);
+    margo_deregister(mid, provider->rpc_eager_read_multi_id);
+    margo_deregister(mid, provider->rpc_writev_id);
+    margo_deregister(mid, provider->rpc_readv_id);
+    margo_deregister(mid, provider->rpc_compound_id);
     margo_deregister(mid, provider->rpc_probe_id);
     margo_deregister(mid, provider->rpc_noop_id);
     margo_deregister(mid, provider->rpc_remove_id);
+    margo_deregister(mid, provider->rpc_create_multi_id);
+    margo_deregister(mid, provider->rpc_remove_multi_id);
+    margo_deregister(mid, provider->rpc_remove_group_id);
+    margo_deregister(mid, provider->rpc_set_param_id);
     margo_deregister(mid, provider->rpc_migrate_region_id);
     margo_deregister(mid, provider->rpc_migrate_target_id);
 
@@ -1003,9 +3155,19 @@ static void bake_server_finalize_cb(void* data)
 
     json_object_put(provider->json_cfg);
 
-    if (provider->poolset) margo_bulk_poolset_destroy(provider->poolset);
+    if (provider->buffer_pool)
+        bake_buffer_pool_destroy(provider->buffer_pool);
+    ABT_mutex_free(&(provider->buffer_pool_mutex));
+
+    ABT_mutex_free(&(provider->targets_mutex));
+    free(provider->targets);
 
-    ABT_rwlock_free(&(provider->lock));
+    /* all the targets are detached, no RPC runs on their pools anymore */
+    free_target_pools(provider);
+    free_lanes(provider);
+    free_qos(provider);
+    ABT_mutex_free(&(provider->admit_mutex));
+    ABT_key_free(&(provider->deadline_key));
 
     free(provider);
 
@@ -1055,44 +3217,212 @@ static int bake_target_post_migration_callback(remi_fileset_t fileset,
 
 #endif
 
-static int setup_poolset(bake_provider_t provider)
+static int setup_buffer_pool(bake_provider_t provider)
 {
-    hg_return_t hret;
+    bake_buffer_pool_config_t config;
+    bake_buffer_pool_t        pool;
+    int                       npools, i;
+    int                       ret;
 
     /* NOTE: this is called after validate, so we don't need extensive error
      * checking on the json here
      */
 
-    /* create poolset if we don't have one yet but pipelining is enabled */
-    if (provider->poolset == NULL
+    /* create the pool if we don't have one yet but pipelining is enabled;
+     * it starts empty and only allocates the buffers transfers ask for
+     */
+    if (provider->buffer_pool == NULL
         && json_object_get_boolean(
             json_object_object_get(provider->json_cfg, "pipeline_enable"))) {
-        hret = margo_bulk_poolset_create(
-            provider->mid,
-            json_object_get_int(
-                json_object_object_get(provider->json_cfg, "pipeline_npools")),
-            json_object_get_int(json_object_object_get(
-                provider->json_cfg, "pipeline_nbuffers_per_pool")),
-            json_object_get_int(json_object_object_get(
-                provider->json_cfg, "pipeline_first_buffer_size")),
-            json_object_get_int(json_object_object_get(provider->json_cfg,
-                                                       "pipeline_multiplier")),
-            HG_BULK_READWRITE, &(provider->poolset));
-        if (hret != 0) return BAKE_ERR_MERCURY;
-    }
-
-    /* destroy poolset if we have one but pipelining has been disabled */
-    if (provider->poolset
+        npools = json_object_get_int(
+            json_object_object_get(provider->json_cfg, "pipeline_npools"));
+        config.multiplier = json_object_get_int(
+            json_object_object_get(provider->json_cfg, "pipeline_multiplier"));
+        config.min_size = json_object_get_int64(json_object_object_get(
+            provider->json_cfg, "pipeline_first_buffer_size"));
+        config.max_size = config.min_size;
+        for (i = 1; i < npools; i++) config.max_size *= config.multiplier;
+        config.num_kept = json_object_get_int(json_object_object_get(
+            provider->json_cfg, "pipeline_nbuffers_per_pool"));
+        config.max_memory = json_object_get_int64(
+            json_object_object_get(provider->json_cfg, "pipeline_max_memory"));
+        config.idle_sec = json_object_get_int64(json_object_object_get(
+                              provider->json_cfg, "pipeline_idle_ms"))
+                        / 1000.0;
+        config.numa      = json_object_get_boolean(
+            json_object_object_get(provider->json_cfg, "pipeline_numa"));
+        config.hugepages = json_object_get_boolean(
+            json_object_object_get(provider->json_cfg, "pipeline_hugepages"));
+        ret = bake_buffer_pool_create(provider->mid, &config, &pool);
+        if (ret != BAKE_SUCCESS) return ret;
+        __atomic_store_n(&provider->buffer_pool, pool, __ATOMIC_RELEASE);
+    }
+
+    /* destroy the pool if we have one but pipelining has been disabled */
+    if (provider->buffer_pool
         && !json_object_get_boolean(
             json_object_object_get(provider->json_cfg, "pipeline_enable"))) {
-        hret = margo_bulk_poolset_destroy(provider->poolset);
-        if (hret != 0) return BAKE_ERR_MERCURY;
+        bake_buffer_pool_destroy(provider->buffer_pool);
+        __atomic_store_n(&provider->buffer_pool, NULL, __ATOMIC_RELEASE);
     }
 
     /* otherwise nothing to do here */
     return BAKE_SUCCESS;
 }
 
+static int parse_placement_policy(const char*              name,
+                                  bake_placement_policy_t* policy)
+{
+    bake_placement_policy_t p;
+
+    if (strcmp(name, "round_robin") == 0)
+        p = BAKE_PLACEMENT_ROUND_ROBIN;
+    else if (strcmp(name, "least_used") == 0)
+        p = BAKE_PLACEMENT_LEAST_USED;
+    else if (strcmp(name, "least_inflight") == 0)
+        p = BAKE_PLACEMENT_LEAST_INFLIGHT;
+    else if (strcmp(name, "size_class") == 0)
+        p = BAKE_PLACEMENT_SIZE_CLASS;
+    else if (strcmp(name, "hash") == 0)
+        p = BAKE_PLACEMENT_HASH;
+    else
+        return -1;
+    if (policy) *policy = p;
+    return 0;
+}
+
+/* tells whether targets of this back end take small regions under the
+ * size_class placement policy
+ */
+static int placement_small_class(bake_provider_t provider,
+                                 bake_backend_t  backend)
+{
+    struct json_object* placement;
+    struct json_object* backends;
+    struct json_object* val;
+    unsigned            i;
+
+    placement = json_object_object_get(provider->json_cfg, "placement");
+    backends  = json_object_object_get(placement, "small_backends");
+    json_array_foreach(backends, i, val)
+    {
+        if (strcmp(json_object_get_string(val), backend->name) == 0) return 1;
+    }
+    return 0;
+}
+
+static int setup_placement(bake_provider_t provider)
+{
+    struct json_object*  placement;
+    bake_target_table_t* table;
+    uint64_t             i;
+
+    /* NOTE: this is called after validate, so we don't need extensive error
+     * checking on the json here
+     */
+    placement = json_object_object_get(provider->json_cfg, "placement");
+    parse_placement_policy(
+        json_object_get_string(json_object_object_get(placement, "policy")),
+        &provider->placement_policy);
+    provider->placement_small_size = json_object_get_int64(
+        json_object_object_get(placement, "small_region_size"));
+    ABT_mutex_lock(provider->targets_mutex);
+    table = provider->targets;
+    for (i = 0; table && i < table->num_targets; i++)
+        table->targets[i]->small_class
+            = placement_small_class(provider, table->targets[i]->backend);
+    ABT_mutex_unlock(provider->targets_mutex);
+    return BAKE_SUCCESS;
+}
+
+/* FNV-1a hash of the client's address, so that the hash placement policy
+ * keeps each client on the same target
+ */
+static uint64_t placement_hash(margo_instance_id mid, hg_addr_t addr)
+{
+    char      addr_str[256];
+    hg_size_t addr_str_size = sizeof(addr_str);
+    uint64_t  hash          = 14695981039346656037ULL;
+    char*     c;
+
+    if (margo_addr_to_string(mid, addr_str, &addr_str_size, addr)
+        != HG_SUCCESS)
+        return 0;
+    for (c = addr_str; *c; c++) {
+        hash ^= (unsigned char)*c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* chooses a target for a new region of the given size and pins it until
+ * release_target(); targets being migrated are skipped
+ */
+static bake_target_t* place_region(bake_provider_t provider,
+                                   uint64_t        region_size,
+                                   hg_addr_t       client)
+{
+    bake_target_table_t* table;
+    bake_target_t *      p, *best = NULL;
+    uint64_t             n, start = 0, i, rank, best_rank = 0;
+    uint64_t             score, best_score = 0;
+    int                  small = region_size <= provider->placement_small_size;
+    int                  have_class = 0;
+    unsigned             slot;
+
+    slot  = reader_enter(provider);
+    table = provider->targets;
+    n     = table->num_targets;
+    if (n == 0) goto done;
+
+    if (provider->placement_policy == BAKE_PLACEMENT_HASH)
+        start = placement_hash(provider->mid, client) % n;
+    else
+        start = __atomic_fetch_add(&provider->placement_next, 1,
+                                   __ATOMIC_RELAXED)
+              % n;
+
+    if (provider->placement_policy == BAKE_PLACEMENT_SIZE_CLASS) {
+        /* fall back to all targets if none is of the right class */
+        for (i = 0; i < n; i++)
+            if (table->targets[i]->small_class == small) have_class = 1;
+    }
+
+    /* scan targets starting from the round-robin (or hash) position, so
+     * that ties are broken differently from one call to the next
+     */
+    for (i = 0; i < n; i++) {
+        p = table->targets[i];
+        if (__atomic_load_n(&p->migrating, __ATOMIC_SEQ_CST)) continue;
+        rank = (i + n - start) % n;
+        switch (provider->placement_policy) {
+        case BAKE_PLACEMENT_LEAST_USED:
+            score = __atomic_load_n(&p->bytes_placed, __ATOMIC_RELAXED);
+            break;
+        case BAKE_PLACEMENT_LEAST_INFLIGHT:
+            score = __atomic_load_n(&p->in_flight, __ATOMIC_RELAXED);
+            break;
+        case BAKE_PLACEMENT_SIZE_CLASS:
+            if (have_class && p->small_class != small) continue;
+            score = 0;
+            break;
+        default:
+            score = 0;
+            break;
+        }
+        if (!best || score < best_score
+            || (score == best_score && rank < best_rank)) {
+            best       = p;
+            best_score = score;
+            best_rank  = rank;
+        }
+    }
+    if (best) __atomic_add_fetch(&best->in_flight, 1, __ATOMIC_SEQ_CST);
+done:
+    reader_exit(provider, slot);
+    return best;
+}
+
 /* attach each target listed in the backend json block.  This fn assumes
  * that backend has an array of strings called "targets"
  */
@@ -1199,6 +3529,54 @@ static int configure_targets(bake_provider_t     provider,
         if (ret != BAKE_SUCCESS) return (ret);
     }
 
+    if (CONFIG_HAS(_config, "dax_backend", backend)) {
+        /* NOTE: as with the pmem backend, this default is duplicated in the
+         * dax backend itself.
+         */
+        CONFIG_HAS_OR_CREATE(backend, int64, "default_initial_target_size",
+                             1073741824,
+                             "dax_backend.default_initial_target_size", val);
+        BAKE_TRACE(provider->mid, "checking dax_backend object in json");
+        ret = attach_targets(provider, "dax", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "mem_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking mem_backend object in json");
+        ret = attach_targets(provider, "mem", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "null_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking null_backend object in json");
+        ret = attach_targets(provider, "null", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "emu_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking emu_backend object in json");
+        ret = attach_targets(provider, "emu", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "cache_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking cache_backend object in json");
+        ret = attach_targets(provider, "cache", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "hybrid_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking hybrid_backend object in json");
+        ret = attach_targets(provider, "hybrid", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
+    if (CONFIG_HAS(_config, "tier_backend", backend)) {
+        BAKE_TRACE(provider->mid, "checking tier_backend object in json");
+        ret = attach_targets(provider, "tier", backend);
+        if (ret != BAKE_SUCCESS) return (ret);
+    }
+
     return (0);
 }
 
@@ -1206,6 +3584,12 @@ static int validate_and_complete_config(struct json_object* _config,
                                         ABT_pool            _progress_pool)
 {
     struct json_object* val;
+    struct json_object* placement;
+    struct json_object* target_pools;
+    struct json_object* lanes;
+    struct json_object* qos;
+    struct json_object* admission;
+    struct json_object* backpressure;
 
     /* report version number for this component */
     CONFIG_OVERRIDE_STRING(_config, "version", PACKAGE_VERSION, "version", 1);
@@ -1215,18 +3599,232 @@ static int validate_and_complete_config(struct json_object* _config,
     /* pipeline yes or no; implies intermediate buffering */
     CONFIG_HAS_OR_CREATE(_config, boolean, "pipeline_enable", 0,
                          "pipeline_enable", val);
-    /* number of preallocated buffer pools */
+    /* number of buffer size classes; the buffer pool handles at most 16,
+     * and configurations written for the earlier fixed poolset may ask for
+     * more, so out of range values are clamped rather than rejected
+     */
     CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_npools", 4,
                          "pipeline_npools", val);
-    /* buffers per buffer pool */
+    if (json_object_get_int(val) < 1 || json_object_get_int(val) > 16) {
+        fprintf(stderr,
+                "WARNING: pipeline_npools %d is out of range, using %d\n",
+                json_object_get_int(val),
+                json_object_get_int(val) < 1 ? 1 : 16);
+        json_object_object_add(
+            _config, "pipeline_npools",
+            json_object_new_int64(json_object_get_int(val) < 1 ? 1 : 16));
+    }
+    /* buffers kept per frequently used size class when idle */
     CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_nbuffers_per_pool", 32,
                          "pipeline_nbuffers_per_pool", val);
-    /* size of buffers in smallest pool */
+    /* size of buffers in smallest class */
     CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_first_buffer_size", 65536,
                          "pipeline_first_buffer_size", val);
-    /* factor size increase per pool */
+    if (json_object_get_int64(val) <= 0) {
+        fprintf(stderr, "pipeline_first_buffer_size must be positive\n");
+        return -1;
+    }
+    /* factor size increase per class; size classes must grow, so values
+     * below 2 are raised to 2, like out of range pipeline_npools
+     */
     CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_multiplier", 4,
                          "pipeline_multiplier", val);
+    if (json_object_get_int(val) < 2) {
+        fprintf(stderr, "WARNING: pipeline_multiplier %d is below 2, using 2\n",
+                json_object_get_int(val));
+        json_object_object_add(_config, "pipeline_multiplier",
+                               json_object_new_int64(2));
+    }
+    /* memory the buffers may take up in total; a transfer waits for
+     * buffers to be released beyond it
+     */
+    CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_max_memory", 64 * 1048576,
+                         "pipeline_max_memory", val);
+    /* time after which unused buffers are freed */
+    CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_idle_ms", 10000,
+                         "pipeline_idle_ms", val);
+    if (json_object_get_int64(val) <= 0) {
+        fprintf(stderr, "pipeline_idle_ms must be positive\n");
+        return -1;
+    }
+    /* buffers per NUMA node, taken from the node of the execution stream
+     * running the transfer
+     */
+    CONFIG_HAS_OR_CREATE(_config, boolean, "pipeline_numa", 0,
+                         "pipeline_numa", val);
+    /* buffers backed by 2 MiB pages */
+    CONFIG_HAS_OR_CREATE(_config, boolean, "pipeline_hugepages", 0,
+                         "pipeline_hugepages", val);
+    /* execution streams for pipelined transfers; 0 runs them on the pool
+     * of the handler, unless a transfer_pool is given in the init info
+     */
+    CONFIG_HAS_OR_CREATE(_config, int64, "pipeline_transfer_xstreams", 0,
+                         "pipeline_transfer_xstreams", val);
+    if (json_object_get_int(val) < 0) {
+        fprintf(stderr, "pipeline_transfer_xstreams must not be negative\n");
+        return -1;
+    }
+
+    /* placement of regions created without naming a target */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "placement", "placement", placement);
+    CONFIG_HAS_OR_CREATE(placement, string, "policy", "round_robin",
+                         "placement.policy", val);
+    if (parse_placement_policy(json_object_get_string(val), NULL) != 0) {
+        fprintf(stderr, "unknown placement.policy \"%s\"\n",
+                json_object_get_string(val));
+        return -1;
+    }
+    /* size_class: regions up to this size go to small_backends targets */
+    CONFIG_HAS_OR_CREATE(placement, int64, "small_region_size", 65536,
+                         "placement.small_region_size", val);
+    if (!json_object_object_get(placement, "small_backends")) {
+        val = json_object_new_array();
+        json_object_array_add(val, json_object_new_string("pmem"));
+        json_object_array_add(val, json_object_new_string("dax"));
+        json_object_array_add(val, json_object_new_string("mem"));
+        json_object_object_add(placement, "small_backends", val);
+    }
+    CONFIG_HAS_OR_CREATE_ARRAY(placement, "small_backends",
+                               "placement.small_backends", val);
+
+    /* separate handler pools for eager, metadata, and bulk RPCs, scheduled
+     * by weighted round-robin on their own execution streams
+     */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "priority_lanes", "priority_lanes",
+                                lanes);
+    CONFIG_HAS_OR_CREATE(lanes, boolean, "enable", 0, "priority_lanes.enable",
+                         val);
+    CONFIG_HAS_OR_CREATE(lanes, int64, "num_xstreams", 1,
+                         "priority_lanes.num_xstreams", val);
+    if (json_object_get_int(val) < 1) {
+        fprintf(stderr, "priority_lanes.num_xstreams must be positive\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE(lanes, int64, "eager_weight", 8,
+                         "priority_lanes.eager_weight", val);
+    if (json_object_get_int(val) < 1) {
+        fprintf(stderr, "priority_lanes.eager_weight must be positive\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE(lanes, int64, "metadata_weight", 4,
+                         "priority_lanes.metadata_weight", val);
+    if (json_object_get_int(val) < 1) {
+        fprintf(stderr, "priority_lanes.metadata_weight must be positive\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE(lanes, int64, "bulk_weight", 1,
+                         "priority_lanes.bulk_weight", val);
+    if (json_object_get_int(val) < 1) {
+        fprintf(stderr, "priority_lanes.bulk_weight must be positive\n");
+        return -1;
+    }
+    /* bulk reads and writes up to this size stay in the metadata lane */
+    CONFIG_HAS_OR_CREATE(lanes, int64, "small_bulk_size", 65536,
+                         "priority_lanes.small_bulk_size", val);
+
+    /* per-client token buckets; 0 means no limit */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "qos", "qos", qos);
+    CONFIG_HAS_OR_CREATE(qos, int64, "bytes_per_sec", 0, "qos.bytes_per_sec",
+                         val);
+    if (json_object_get_int64(val) < 0) {
+        fprintf(stderr, "qos.bytes_per_sec must not be negative\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE(qos, int64, "ops_per_sec", 0, "qos.ops_per_sec", val);
+    if (json_object_get_int64(val) < 0) {
+        fprintf(stderr, "qos.ops_per_sec must not be negative\n");
+        return -1;
+    }
+    /* how long a client may run above its limits after being idle */
+    CONFIG_HAS_OR_CREATE(qos, int64, "burst_ms", 100, "qos.burst_ms", val);
+    if (json_object_get_int64(val) < 1) {
+        fprintf(stderr, "qos.burst_ms must be positive\n");
+        return -1;
+    }
+
+    /* limits on the operations in progress, per target and over all the
+     * targets, 0 meaning no limit; "targets" can hold per-target max_ops
+     * and max_bytes, keyed by target name
+     */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "admission", "admission", admission);
+    CONFIG_HAS_OR_CREATE(admission, int64, "target_max_ops", 0,
+                         "admission.target_max_ops", val);
+    CONFIG_HAS_OR_CREATE(admission, int64, "target_max_bytes", 0,
+                         "admission.target_max_bytes", val);
+    CONFIG_HAS_OR_CREATE(admission, int64, "provider_max_bytes", 0,
+                         "admission.provider_max_bytes", val);
+    /* credit given to a target on each turn of deficit round-robin */
+    CONFIG_HAS_OR_CREATE(admission, int64, "quantum", 1048576,
+                         "admission.quantum", val);
+    if (json_object_get_int64(val) < 1) {
+        fprintf(stderr, "admission.quantum must be positive\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE_OBJECT(admission, "targets", "admission.targets",
+                                val);
+
+    /* data operations in progress and bytes staged in the pipeline buffers
+     * above which the provider answers BAKE_ERR_BUSY, 0 meaning no limit
+     */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "backpressure", "backpressure",
+                                backpressure);
+    CONFIG_HAS_OR_CREATE(backpressure, int64, "max_pending", 0,
+                         "backpressure.max_pending", val);
+    if (json_object_get_int64(val) < 0) {
+        fprintf(stderr, "backpressure.max_pending must not be negative\n");
+        return -1;
+    }
+    CONFIG_HAS_OR_CREATE(backpressure, int64, "max_buffer_bytes", 0,
+                         "backpressure.max_buffer_bytes", val);
+    if (json_object_get_int64(val) < 0) {
+        fprintf(stderr,
+                "backpressure.max_buffer_bytes must not be negative\n");
+        return -1;
+    }
+    /* base of the retry-after hint, scaled by the overload */
+    CONFIG_HAS_OR_CREATE(backpressure, int64, "retry_after_ms", 10,
+                         "backpressure.retry_after_ms", val);
+    if (json_object_get_int64(val) < 1) {
+        fprintf(stderr, "backpressure.retry_after_ms must be positive\n");
+        return -1;
+    }
+
+    /* pools running the RPCs of specific targets, keyed by target name;
+     * either an index in the pools given to the provider, or an object
+     * describing execution streams for the provider to create
+     */
+    CONFIG_HAS_OR_CREATE_OBJECT(_config, "target_pools", "target_pools",
+                                target_pools);
+    json_object_object_foreach(target_pools, target_name, spec)
+    {
+        if (json_object_is_type(spec, json_type_int)) continue;
+        if (!json_object_is_type(spec, json_type_object)) {
+            fprintf(stderr, "target_pools.%s must be a pool index or an "
+                            "object\n",
+                    target_name);
+            return -1;
+        }
+        CONFIG_HAS_OR_CREATE(spec, int64, "num_xstreams", 1,
+                             "target_pools.<target>.num_xstreams", val);
+        if (json_object_get_int(val) < 1) {
+            fprintf(stderr, "target_pools.%s.num_xstreams must be positive\n",
+                    target_name);
+            return -1;
+        }
+        /* "numa" binds to the cpus of the node of the target's device */
+        if (CONFIG_HAS(spec, "cpus", val)
+            && json_object_is_type(val, json_type_string)) {
+            if (strcmp(json_object_get_string(val), "numa") != 0) {
+                fprintf(stderr, "target_pools.%s.cpus must be an array or "
+                                "\"numa\"\n",
+                        target_name);
+                return -1;
+            }
+            continue;
+        }
+        CONFIG_HAS_OR_CREATE_ARRAY(spec, "cpus", "target_pools.<target>.cpus",
+                                   val);
+    }
 
     return (0);
 }
@@ -1239,10 +3837,49 @@ char* bake_provider_get_config(bake_provider_t provider)
     return strdup(content);
 }
 
+char* bake_provider_get_stats(bake_provider_t provider)
+{
+    struct json_object* stats   = json_object_new_object();
+    struct json_object* targets = json_object_new_object();
+    struct json_object* target_stats;
+    bake_target_t**     pinned;
+    bake_target_t*      p;
+    uint64_t            i, n;
+    char                target_string[37];
+    char*               content;
+
+    json_object_object_add(stats, "targets", targets);
+    json_object_object_add(
+        stats, "expired_requests",
+        json_object_new_int64(
+            __atomic_load_n(&provider->expired, __ATOMIC_RELAXED)));
+
+    pinned = acquire_all_targets(provider, &n);
+    for (i = 0; i < n; i++) {
+        p = pinned[i];
+        if (!p->backend->_get_stats) continue;
+        target_stats = json_object_new_object();
+        if (p->backend->_get_stats(p->context, target_stats) != BAKE_SUCCESS) {
+            json_object_put(target_stats);
+            continue;
+        }
+        bake_target_id_to_string(p->target_id, target_string,
+                                 sizeof(target_string));
+        json_object_object_add(targets, target_string, target_stats);
+    }
+    release_all_targets(pinned, n);
+
+    content = strdup(json_object_to_json_string_ext(
+        stats, JSON_C_TO_STRING_PRETTY | JSON_C_TO_STRING_NOSLASHESCAPE));
+    json_object_put(stats);
+    return content;
+}
+
 int bake_create_raw_target(const char* path, size_t size)
 {
-    char* backend_type = NULL;
-    int   ret;
+    char*          backend_type = NULL;
+    bake_backend_t backend;
+    int            ret;
 
     /* figure out the backend by searching until the ":" in the file name */
     char* tmp = strchr(path, ':');
@@ -1254,43 +3891,211 @@ int bake_create_raw_target(const char* path, size_t size)
         backend_type = strdup("pmem");
     }
 
-    if (strcmp(backend_type, "pmem") == 0) {
-        ret = g_bake_pmem_backend._create_raw_target(path, size);
-    } else if (strcmp(backend_type, "file") == 0) {
-        ret = g_bake_file_backend._create_raw_target(path, size);
-    } else {
+    backend = bake_backend_lookup(backend_type);
+    if (!backend) {
         fprintf(stderr, "ERROR: unknown backend type \"%s\"\n", backend_type);
         free(backend_type);
         return BAKE_ERR_BACKEND_TYPE;
     }
+    ret = backend->_create_raw_target(path, size);
 
     free(backend_type);
     return (ret);
 }
 
-int bake_provider_set_param(bake_provider_t provider,
-                            const char*     key,
-                            const char*     value)
+/* rebuilds the pipeline buffers from the configuration once the transfers
+ * using the current ones are done; transfers starting in the meantime
+ * wait for the new buffers, see bake_provider_get_buffers()
+ */
+static int reload_buffer_pool(bake_provider_t provider)
+{
+    unsigned i;
+    int      ret;
+
+    ABT_mutex_lock(provider->buffer_pool_mutex);
+    __atomic_store_n(&provider->buffer_pool_frozen, 1, __ATOMIC_SEQ_CST);
+    for (i = 0; i < BAKE_READER_SLOTS; i++)
+        while (__atomic_load_n(&provider->buffer_pool_users[i].active,
+                               __ATOMIC_SEQ_CST))
+            ABT_thread_yield();
+    if (provider->buffer_pool) {
+        bake_buffer_pool_destroy(provider->buffer_pool);
+        __atomic_store_n(&provider->buffer_pool, NULL, __ATOMIC_RELEASE);
+    }
+    ret = setup_buffer_pool(provider);
+    __atomic_store_n(&provider->buffer_pool_frozen, 0, __ATOMIC_SEQ_CST);
+    ABT_mutex_unlock(provider->buffer_pool_mutex);
+    return ret;
+}
+
+static int reload_qos(bake_provider_t provider)
+{
+    load_qos(provider);
+    return BAKE_SUCCESS;
+}
+
+static int reload_backpressure(bake_provider_t provider)
+{
+    load_backpressure(provider);
+    return BAKE_SUCCESS;
+}
+
+static int reload_lane_weights(bake_provider_t provider)
+{
+    load_lane_weights(provider);
+    return BAKE_SUCCESS;
+}
+
+/* passes the backend settings on to the targets */
+static int reconfigure_targets(bake_provider_t provider)
+{
+    bake_target_t** pinned;
+    uint64_t        i, n;
+    int             ret = BAKE_SUCCESS;
+
+    pinned = acquire_all_targets(provider, &n);
+    for (i = 0; i < n && ret == BAKE_SUCCESS; i++)
+        if (pinned[i]->backend->_reconfigure)
+            ret = pinned[i]->backend->_reconfigure(pinned[i]->context);
+    release_all_targets(pinned, n);
+    return ret;
+}
+
+/* the targets are asked first, since some backends cannot do without the
+ * pipeline
+ */
+static int reload_pipeline(bake_provider_t provider)
 {
-    int bool_val = 0;
+    int ret = reconfigure_targets(provider);
 
-    if (strcmp(key, "pipeline_enable") == 0) {
-        BAKE_TRACE(provider->mid, "Setting %s to %s", key, value);
+    if (ret != BAKE_SUCCESS) return ret;
+    return reload_buffer_pool(provider);
+}
+
+/* the parameters that can be changed at runtime, with what applies them */
+static const struct {
+    const char*    key;
+    enum json_type type;
+    int (*apply)(bake_provider_t provider);
+} runtime_params[] = {
+    {"pipeline_enable", json_type_boolean, reload_pipeline},
+    {"pipeline_npools", json_type_int, reload_buffer_pool},
+    {"pipeline_nbuffers_per_pool", json_type_int, reload_buffer_pool},
+    {"pipeline_first_buffer_size", json_type_int, reload_buffer_pool},
+    {"pipeline_multiplier", json_type_int, reload_buffer_pool},
+    {"pipeline_max_memory", json_type_int, reload_buffer_pool},
+    {"pipeline_idle_ms", json_type_int, reload_buffer_pool},
+    {"pipeline_numa", json_type_boolean, reload_buffer_pool},
+    {"pipeline_hugepages", json_type_boolean, reload_buffer_pool},
+    {"qos.bytes_per_sec", json_type_int, reload_qos},
+    {"qos.ops_per_sec", json_type_int, reload_qos},
+    {"qos.burst_ms", json_type_int, reload_qos},
+    {"backpressure.max_pending", json_type_int, reload_backpressure},
+    {"backpressure.max_buffer_bytes", json_type_int, reload_backpressure},
+    {"backpressure.retry_after_ms", json_type_int, reload_backpressure},
+    {"priority_lanes.eager_weight", json_type_int, reload_lane_weights},
+    {"priority_lanes.metadata_weight", json_type_int, reload_lane_weights},
+    {"priority_lanes.bulk_weight", json_type_int, reload_lane_weights},
+    {"file_backend.sync", json_type_boolean, reconfigure_targets},
+    {"file_backend.io_max_threads", json_type_int, reconfigure_targets},
+};
+
+static struct json_object* parse_param_value(enum json_type type,
+                                             const char*    value)
+{
+    char*   end;
+    int64_t num;
+
+    if (type == json_type_boolean) {
         if (strcmp(value, "true") == 0 || strcmp(value, "1") == 0)
-            bool_val = 1;
-        else if (strcmp(value, "false") == 0 || strcmp(value, "0") == 0)
-            bool_val = 0;
-        else
-            return (BAKE_ERR_INVALID_ARG);
+            return json_object_new_boolean(1);
+        if (strcmp(value, "false") == 0 || strcmp(value, "0") == 0)
+            return json_object_new_boolean(0);
+        return NULL;
+    }
+    num = strtoll(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || num < 0) return NULL;
+    return json_object_new_int64(num);
+}
 
-        CONFIG_OVERRIDE_BOOL(provider->json_cfg, key, bool_val,
-                             "pipeline_enable", 0);
-        setup_poolset(provider);
-        return (0);
+/* sets (or removes, if val is NULL) a dotted key such as "qos.burst_ms",
+ * creating the objects on the way; returns the previous value, which the
+ * caller then owns
+ */
+static struct json_object* swap_config_value(struct json_object* config,
+                                             const char*         key,
+                                             struct json_object* val)
+{
+    char                path[64];
+    char*               name = path;
+    char*               dot;
+    struct json_object* next;
+    struct json_object* old;
+
+    snprintf(path, sizeof(path), "%s", key);
+    while ((dot = strchr(name, '.')) != NULL) {
+        *dot = '\0';
+        next = json_object_object_get(config, name);
+        if (!next) {
+            next = json_object_new_object();
+            json_object_object_add(config, name, next);
+        }
+        config = next;
+        name   = dot + 1;
     }
+    old = json_object_get(json_object_object_get(config, name));
+    if (val)
+        json_object_object_add(config, name, val);
+    else
+        json_object_object_del(config, name);
+    return old;
+}
+
+int bake_provider_set_param(bake_provider_t provider,
+                            const char*     key,
+                            const char*     value)
+{
+    struct json_object* val;
+    struct json_object* copy;
+    struct json_object* old;
+    unsigned            i;
+    int                 ret;
 
     /* by default return invalid arg; we must whitelist paramters that are
      * valid to modify at runtime, because there are some that cannot be
      */
-    return (BAKE_ERR_INVALID_ARG);
+    for (i = 0; i < sizeof(runtime_params) / sizeof(runtime_params[0]); i++)
+        if (strcmp(key, runtime_params[i].key) == 0) break;
+    if (i == sizeof(runtime_params) / sizeof(runtime_params[0]))
+        return (BAKE_ERR_INVALID_ARG);
+
+    BAKE_TRACE(provider->mid, "Setting %s to %s", key, value);
+    val = parse_param_value(runtime_params[i].type, value);
+    if (!val) return (BAKE_ERR_INVALID_ARG);
+
+    /* check the configuration with the new value before applying it */
+    copy = json_tokener_parse(json_object_to_json_string(provider->json_cfg));
+    json_object_put(swap_config_value(copy, key, json_object_get(val)));
+    ret = validate_and_complete_config(copy, ABT_POOL_NULL);
+    if (ret == 0) {
+        /* apply the value as validated, which may have been clamped */
+        json_object_put(val);
+        val = swap_config_value(copy, key, NULL);
+    }
+    json_object_put(copy);
+    if (ret != 0) {
+        json_object_put(val);
+        return (BAKE_ERR_INVALID_ARG);
+    }
+
+    old = swap_config_value(provider->json_cfg, key, val);
+    ret = runtime_params[i].apply(provider);
+    if (ret != BAKE_SUCCESS) {
+        /* go back to the previous setting */
+        json_object_put(swap_config_value(provider->json_cfg, key, old));
+        runtime_params[i].apply(provider);
+        return (ret);
+    }
+    json_object_put(old);
+    return (0);
 }
@@ -0,0 +1,1247 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <json-c/json.h>
+#include <libpmem.h>
+
+#include "bake-config.h"
+#include "bake.h"
+#include "bake-rpc.h"
+#include "bake-server.h"
+#include "bake-provider.h"
+#include "bake-backend.h"
+#include "bake-macros.h"
+
+/* bake-tier-backend
+ *
+ * This is a composite back end for the Bake provider that presents a fast
+ * target (typically pmem) and a slow one (typically file) as a single
+ * target, and moves regions between them according to how often they are
+ * accessed.  The target name lists both, separated by a comma, e.g.
+ * "tier:/dev/shm/foo.dat,file:/ssd/foo.dat".
+ *
+ * Region ids handed to clients are indices into a persistent region map
+ * (kept in "<fast path>.tiermap", mapped with libpmem) whose entries record
+ * which tier currently holds the region and its region id there.  Region
+ * ids therefore stay valid when a region changes tier.
+ *
+ * New regions go to the fast tier while it has room (fast_capacity bytes).
+ * Every access heats the region up; a background ULT periodically cools
+ * all regions down, demotes the coldest fast regions when the fast tier is
+ * above its high watermark, and promotes regions that stayed hot on the
+ * slow tier while there is room below the low watermark.  The candidates
+ * for both are picked in a single scan of the map per pass.  Migrations
+ * copy the region without blocking accesses, then switch the map entry
+ * only if the region was not written in the meantime, and are paced to
+ * stay under migration_bandwidth bytes per second.  A map entry has two
+ * slots for the inner region id: a migration writes the new one to the
+ * unused slot, then switches tier and slot with a single 8-byte store, so
+ * that a crash leaves the entry either before or after the move.
+ */
+
+#define TIER_MAP_MAGIC    0x62616b6574697232ULL /* "baketir2" */
+#define TIER_MAP_HDR_SIZE 4096
+#define TIER_LOCK_STRIPES 256
+#define TIER_CANDIDATES   64 /* most regions moved per pass, each way */
+
+#define TIER_FREE 0
+#define TIER_FAST 1
+#define TIER_SLOW 2
+
+/* persistent header of the region map */
+typedef struct {
+    uint64_t         magic;
+    bake_target_id_t fast_id;
+    bake_target_id_t slow_id;
+    uint64_t         num_entries;
+} tier_map_root_t;
+
+/* persistent entry of the region map */
+typedef struct {
+    union {
+        struct {
+            uint32_t state; /* TIER_FREE, TIER_FAST, or TIER_SLOW */
+            uint32_t slot;  /* which of inner[] is the current one */
+        };
+        uint64_t location; /* both of the above, updated as one */
+    };
+    uint64_t gen; /* incremented each time the entry is reused */
+    uint64_t size;
+    char     inner[2][BAKE_REGION_ID_DATA_SIZE]; /* region id in its tier */
+} tier_map_entry_t;
+
+/* definition of internal BAKE region_id_t identifier for tier back end */
+typedef struct {
+    uint64_t index;
+    uint64_t gen;
+} tier_region_id_t;
+
+typedef struct {
+    bake_provider_t   provider;
+    bake_backend_t    backend[3]; /* indexed by TIER_FAST / TIER_SLOW */
+    backend_context_t context[3];
+    free_fn           inner_free[3]; /* free functions of inner read_raw */
+    char*             map_path;
+    char*             map_base;
+    size_t            map_mapped_len;
+    int               map_is_pmem;
+    tier_map_root_t*  map_root;
+    tier_map_entry_t* map;
+    uint32_t*         heat;  /* approximate access counts, per entry */
+    uint8_t*          dirty; /* written since the migration copy began */
+    uint64_t*         free_list; /* stack of free entry indices */
+    uint64_t          num_free;
+    uint64_t          fast_used; /* bytes of regions on the fast tier */
+    ABT_mutex         alloc_mutex; /* protects free list and fast_used */
+    ABT_rwlock        stripes[TIER_LOCK_STRIPES]; /* guard map entries */
+    /* policy */
+    uint64_t fast_capacity;
+    double   high_watermark;
+    double   low_watermark;
+    uint32_t promote_threshold;
+    uint64_t max_migrate_size;
+    double   migration_bandwidth; /* bytes/s; 0 means unlimited */
+    double   scan_interval;       /* seconds */
+    /* background engine */
+    ABT_thread engine;
+    ABT_mutex  engine_mutex;
+    ABT_cond   engine_cond;
+    int        shutdown;
+    uint64_t   promotions;
+    uint64_t   demotions;
+    uint64_t   aborted; /* migrations abandoned because of a write */
+} bake_tier_entry_t;
+
+static void tier_engine_ult(void* _arg);
+
+static void tier_persist(bake_tier_entry_t* entry, void* addr, size_t len)
+{
+    if (entry->map_is_pmem)
+        pmem_persist(addr, len);
+    else
+        pmem_msync(addr, len);
+}
+
+static ABT_rwlock tier_stripe(bake_tier_entry_t* entry, uint64_t index)
+{
+    return entry->stripes[index % TIER_LOCK_STRIPES];
+}
+
+/* durably sets the tier and current slot of a map entry, in one store */
+static void tier_set_location(bake_tier_entry_t* entry,
+                              tier_map_entry_t*  e,
+                              uint32_t           state,
+                              uint32_t           slot)
+{
+    tier_map_entry_t loc;
+
+    loc.state = state;
+    loc.slot  = slot;
+    __atomic_store_n(&e->location, loc.location, __ATOMIC_RELEASE);
+    tier_persist(entry, &e->location, sizeof(e->location));
+}
+
+/* looks up a region and read-locks its map entry; on success the caller
+ * must unlock the stripe when it is done with the inner region
+ */
+static int tier_resolve(bake_tier_entry_t* entry,
+                        bake_region_id_t   rid,
+                        int                is_write,
+                        int*               tier,
+                        bake_region_id_t*  inner_rid)
+{
+    tier_region_id_t* trid = (tier_region_id_t*)rid.data;
+    tier_map_entry_t* e;
+
+    if (trid->index >= entry->map_root->num_entries)
+        return BAKE_ERR_UNKNOWN_REGION;
+
+    ABT_rwlock_rdlock(tier_stripe(entry, trid->index));
+    e = &entry->map[trid->index];
+    if (e->state == TIER_FREE || e->gen != trid->gen) {
+        ABT_rwlock_unlock(tier_stripe(entry, trid->index));
+        return BAKE_ERR_UNKNOWN_REGION;
+    }
+    *tier = e->state;
+    memset(inner_rid, 0, sizeof(*inner_rid));
+    inner_rid->type = rid.type;
+    memcpy(inner_rid->data, e->inner[e->slot], BAKE_REGION_ID_DATA_SIZE);
+
+    /* counts are approximate; a lost update only delays a promotion */
+    if (entry->heat[trid->index] < UINT32_MAX) entry->heat[trid->index]++;
+    if (is_write) entry->dirty[trid->index] = 1;
+
+    return BAKE_SUCCESS;
+}
+
+static void tier_release(bake_tier_entry_t* entry, bake_region_id_t rid)
+{
+    tier_region_id_t* trid = (tier_region_id_t*)rid.data;
+    ABT_rwlock_unlock(tier_stripe(entry, trid->index));
+}
+
+/* picks the tier for a new region and accounts for it */
+static int tier_place(bake_tier_entry_t* entry, size_t size)
+{
+    int tier = TIER_SLOW;
+
+    ABT_mutex_lock(entry->alloc_mutex);
+    if (entry->fast_used + size <= entry->fast_capacity) {
+        entry->fast_used += size;
+        tier = TIER_FAST;
+    }
+    ABT_mutex_unlock(entry->alloc_mutex);
+    return tier;
+}
+
+static void tier_unplace(bake_tier_entry_t* entry, int tier, size_t size)
+{
+    if (tier != TIER_FAST) return;
+    ABT_mutex_lock(entry->alloc_mutex);
+    entry->fast_used -= size;
+    ABT_mutex_unlock(entry->alloc_mutex);
+}
+
+/* records a new region in the map and builds its tier region id; if the
+ * map is full, the inner region is removed
+ */
+static int tier_map_insert(bake_tier_entry_t* entry,
+                           int                tier,
+                           size_t             size,
+                           bake_region_id_t   inner_rid,
+                           bake_region_id_t*  rid)
+{
+    tier_region_id_t* trid = (tier_region_id_t*)rid->data;
+    tier_map_entry_t* e;
+    uint64_t          index;
+
+    assert(sizeof(tier_region_id_t) <= BAKE_REGION_ID_DATA_SIZE);
+
+    ABT_mutex_lock(entry->alloc_mutex);
+    if (entry->num_free == 0) {
+        ABT_mutex_unlock(entry->alloc_mutex);
+        entry->backend[tier]->_remove(entry->context[tier], inner_rid);
+        return BAKE_ERR_NOMEM;
+    }
+    index = entry->free_list[--entry->num_free];
+    ABT_mutex_unlock(entry->alloc_mutex);
+
+    ABT_rwlock_wrlock(tier_stripe(entry, index));
+    e = &entry->map[index];
+    e->gen++;
+    e->size = size;
+    memcpy(e->inner[e->slot], inner_rid.data, BAKE_REGION_ID_DATA_SIZE);
+    tier_persist(entry, e, sizeof(*e));
+    /* the entry becomes valid only once the rest of it is durable */
+    tier_set_location(entry, e, tier, e->slot);
+    entry->heat[index]  = 1;
+    entry->dirty[index] = 0;
+    trid->index         = index;
+    trid->gen           = e->gen;
+    ABT_rwlock_unlock(tier_stripe(entry, index));
+
+    return BAKE_SUCCESS;
+}
+
+/* marks a map entry free; returns the tier, inner region and size it had */
+static int tier_map_remove(bake_tier_entry_t* entry,
+                           bake_region_id_t   rid,
+                           int*               tier,
+                           bake_region_id_t*  inner_rid,
+                           size_t*            size_removed)
+{
+    tier_region_id_t* trid = (tier_region_id_t*)rid.data;
+    tier_map_entry_t* e;
+    size_t            size;
+
+    if (trid->index >= entry->map_root->num_entries)
+        return BAKE_ERR_UNKNOWN_REGION;
+
+    ABT_rwlock_wrlock(tier_stripe(entry, trid->index));
+    e = &entry->map[trid->index];
+    if (e->state == TIER_FREE || e->gen != trid->gen) {
+        ABT_rwlock_unlock(tier_stripe(entry, trid->index));
+        return BAKE_ERR_UNKNOWN_REGION;
+    }
+    *tier = e->state;
+    size  = e->size;
+    memset(inner_rid, 0, sizeof(*inner_rid));
+    inner_rid->type = rid.type;
+    memcpy(inner_rid->data, e->inner[e->slot], BAKE_REGION_ID_DATA_SIZE);
+    tier_set_location(entry, e, TIER_FREE, e->slot);
+    ABT_rwlock_unlock(tier_stripe(entry, trid->index));
+
+    ABT_mutex_lock(entry->alloc_mutex);
+    if (*tier == TIER_FAST) entry->fast_used -= size;
+    entry->free_list[entry->num_free++] = trid->index;
+    ABT_mutex_unlock(entry->alloc_mutex);
+
+    *size_removed = size;
+    return BAKE_SUCCESS;
+}
+
+/* splits "<fast>,<slow>" into the two inner target names */
+static int tier_split_path(const char* path, char** fast, char** slow)
+{
+    const char* comma = strchr(path, ',');
+
+    if (!comma || comma == path || !comma[1]) {
+        fprintf(stderr,
+                "ERROR: tier target \"%s\" must be of the form "
+                "<fast target>,<slow target>\n",
+                path);
+        return BAKE_ERR_INVALID_ARG;
+    }
+    *fast = strndup(path, comma - path);
+    *slow = strdup(comma + 1);
+    return BAKE_SUCCESS;
+}
+
+static int bake_tier_makepool(const char* name, size_t size)
+{
+    char*          names[3] = {NULL, NULL, NULL};
+    bake_backend_t backend;
+    const char*    inner_path;
+    int            i;
+    int            ret;
+
+    ret = tier_split_path(name, &names[TIER_FAST], &names[TIER_SLOW]);
+    if (ret != BAKE_SUCCESS) return ret;
+
+    /* the region map is created when the target is first attached */
+    for (i = TIER_FAST; i <= TIER_SLOW && ret == BAKE_SUCCESS; i++) {
+        backend = bake_backend_parse_target(names[i], &inner_path);
+        ret     = backend ? backend->_create_raw_target(inner_path, size)
+                          : BAKE_ERR_BACKEND_TYPE;
+    }
+
+    free(names[TIER_FAST]);
+    free(names[TIER_SLOW]);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_tier_backend_initialize(bake_provider_t    provider,
+                                        const char*        path,
+                                        bake_target_id_t*  target,
+                                        backend_context_t* context)
+{
+    bake_tier_entry_t*  new_entry;
+    struct json_object* tier_backend_json = NULL;
+    struct json_object* target_array      = NULL;
+    struct json_object* val;
+    char*               names[3]    = {NULL, NULL, NULL};
+    const char*         inner_paths[3];
+    bake_target_id_t    ids[3];
+    int64_t             max_regions;
+    size_t              len;
+    uint64_t            i, n;
+    int                 t;
+    int                 ret;
+
+    CONFIG_HAS_OR_CREATE_OBJECT(provider->json_cfg, "tier_backend",
+                                "tier_backend", tier_backend_json);
+    CONFIG_HAS_OR_CREATE_ARRAY(tier_backend_json, "targets",
+                               "tier_backend.targets", target_array);
+    /* number of entries in a newly created region map */
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "max_regions", 1048576,
+                         "tier_backend.max_regions", val);
+    max_regions = json_object_get_int64(val);
+
+    new_entry           = calloc(1, sizeof(*new_entry));
+    new_entry->provider = provider;
+
+    /* bytes of region data the fast tier may hold */
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "fast_capacity",
+                         1073741824, "tier_backend.fast_capacity", val);
+    new_entry->fast_capacity = json_object_get_int64(val);
+    /* demote when the fast tier is above high_watermark percent full, down
+     * to low_watermark percent; promote only below low_watermark
+     */
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "high_watermark", 90,
+                         "tier_backend.high_watermark", val);
+    new_entry->high_watermark = json_object_get_int64(val) / 100.0;
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "low_watermark", 80,
+                         "tier_backend.low_watermark", val);
+    new_entry->low_watermark = json_object_get_int64(val) / 100.0;
+    /* accesses per scan interval (with decay) that make a region hot */
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "promote_threshold", 8,
+                         "tier_backend.promote_threshold", val);
+    new_entry->promote_threshold = json_object_get_int64(val);
+    /* larger regions stay where they were created */
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "max_migrate_size",
+                         67108864, "tier_backend.max_migrate_size", val);
+    new_entry->max_migrate_size = json_object_get_int64(val);
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "migration_bandwidth",
+                         67108864, "tier_backend.migration_bandwidth", val);
+    new_entry->migration_bandwidth = json_object_get_int64(val);
+    CONFIG_HAS_OR_CREATE(tier_backend_json, int64, "scan_interval_ms", 1000,
+                         "tier_backend.scan_interval_ms", val);
+    new_entry->scan_interval = json_object_get_int64(val) / 1e3;
+
+    ret = tier_split_path(path, &names[TIER_FAST], &names[TIER_SLOW]);
+    if (ret != BAKE_SUCCESS) goto error_cleanup;
+
+    for (t = TIER_FAST; t <= TIER_SLOW; t++) {
+        new_entry->backend[t]
+            = bake_backend_parse_target(names[t], &inner_paths[t]);
+        if (!new_entry->backend[t]) {
+            ret = BAKE_ERR_BACKEND_TYPE;
+            goto error_cleanup;
+        }
+        ret = new_entry->backend[t]->_initialize(
+            provider, inner_paths[t], &ids[t], &new_entry->context[t]);
+        if (ret != BAKE_SUCCESS) goto error_cleanup;
+        /* the inner targets are recorded under this back end only */
+        bake_backend_unlist_target(provider, new_entry->backend[t],
+                                   inner_paths[t]);
+    }
+
+    len                 = strlen(inner_paths[TIER_FAST]) + 10;
+    new_entry->map_path = malloc(len);
+    snprintf(new_entry->map_path, len, "%s.tiermap", inner_paths[TIER_FAST]);
+
+    new_entry->map_base
+        = pmem_map_file(new_entry->map_path, 0, 0, 0,
+                        &new_entry->map_mapped_len, &new_entry->map_is_pmem);
+    if (!new_entry->map_base && errno == ENOENT && max_regions > 0) {
+        new_entry->map_base = pmem_map_file(
+            new_entry->map_path,
+            TIER_MAP_HDR_SIZE + max_regions * sizeof(tier_map_entry_t),
+            PMEM_FILE_CREATE | PMEM_FILE_EXCL, 0644,
+            &new_entry->map_mapped_len, &new_entry->map_is_pmem);
+        if (new_entry->map_base) {
+            /* a new file reads as zeroes, i.e., all entries are free */
+            new_entry->map_root = (tier_map_root_t*)new_entry->map_base;
+            new_entry->map_root->magic       = TIER_MAP_MAGIC;
+            new_entry->map_root->fast_id     = ids[TIER_FAST];
+            new_entry->map_root->slow_id     = ids[TIER_SLOW];
+            new_entry->map_root->num_entries = max_regions;
+            tier_persist(new_entry, new_entry->map_root,
+                         sizeof(*new_entry->map_root));
+        }
+    }
+    if (!new_entry->map_base) {
+        BAKE_ERROR(provider->mid, "pmem_map_file(): %s on %s", strerror(errno),
+                   new_entry->map_path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+
+    new_entry->map_root = (tier_map_root_t*)new_entry->map_base;
+    new_entry->map
+        = (tier_map_entry_t*)(new_entry->map_base + TIER_MAP_HDR_SIZE);
+    n = new_entry->map_root->num_entries;
+    if (new_entry->map_root->magic != TIER_MAP_MAGIC
+        || uuid_compare(new_entry->map_root->fast_id.id, ids[TIER_FAST].id)
+        || uuid_compare(new_entry->map_root->slow_id.id, ids[TIER_SLOW].id)
+        || TIER_MAP_HDR_SIZE + n * sizeof(tier_map_entry_t)
+               > new_entry->map_mapped_len) {
+        BAKE_ERROR(provider->mid, "%s is not the region map of target %s",
+                   new_entry->map_path, path);
+        ret = BAKE_ERR_IO;
+        goto error_cleanup;
+    }
+
+    /* rebuild the volatile state from the map */
+    new_entry->heat      = calloc(n, sizeof(uint32_t));
+    new_entry->dirty     = calloc(n, sizeof(uint8_t));
+    new_entry->free_list = malloc(n * sizeof(uint64_t));
+    for (i = n; i > 0; i--) {
+        tier_map_entry_t* e = &new_entry->map[i - 1];
+        if (e->state == TIER_FREE)
+            new_entry->free_list[new_entry->num_free++] = i - 1;
+        else if (e->state == TIER_FAST)
+            new_entry->fast_used += e->size;
+    }
+
+    ABT_mutex_create(&new_entry->alloc_mutex);
+    for (t = 0; t < TIER_LOCK_STRIPES; t++)
+        ABT_rwlock_create(&new_entry->stripes[t]);
+    ABT_mutex_create(&new_entry->engine_mutex);
+    ABT_cond_create(&new_entry->engine_cond);
+    ABT_thread_create(provider->handler_pool, tier_engine_ult, new_entry,
+                      ABT_THREAD_ATTR_NULL, &new_entry->engine);
+
+    /* the tier target goes by the id of its fast target */
+    *target = ids[TIER_FAST];
+
+    free(names[TIER_FAST]);
+    free(names[TIER_SLOW]);
+
+    /* target successfully added; inject it into the json in array of
+     * targets for this backend
+     */
+    json_object_array_add(target_array, json_object_new_string(path));
+
+    *context = new_entry;
+    return 0;
+
+error_cleanup:
+    if (new_entry->map_base)
+        pmem_unmap(new_entry->map_base, new_entry->map_mapped_len);
+    free(new_entry->map_path);
+    for (t = TIER_FAST; t <= TIER_SLOW; t++)
+        if (new_entry->context[t])
+            new_entry->backend[t]->_finalize(new_entry->context[t]);
+    free(names[TIER_FAST]);
+    free(names[TIER_SLOW]);
+    free(new_entry);
+    return (ret);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_tier_backend_finalize(backend_context_t context)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    int                ret   = BAKE_SUCCESS;
+    int                t;
+
+    ABT_mutex_lock(entry->engine_mutex);
+    entry->shutdown = 1;
+    ABT_cond_signal(entry->engine_cond);
+    ABT_mutex_unlock(entry->engine_mutex);
+    ABT_thread_join(entry->engine);
+    ABT_thread_free(&entry->engine);
+
+    ABT_cond_free(&entry->engine_cond);
+    ABT_mutex_free(&entry->engine_mutex);
+    for (t = 0; t < TIER_LOCK_STRIPES; t++)
+        ABT_rwlock_free(&entry->stripes[t]);
+    ABT_mutex_free(&entry->alloc_mutex);
+    pmem_unmap(entry->map_base, entry->map_mapped_len);
+    free(entry->map_path);
+    free(entry->heat);
+    free(entry->dirty);
+    free(entry->free_list);
+
+    for (t = TIER_FAST; t <= TIER_SLOW; t++) {
+        int tret = entry->backend[t]->_finalize(entry->context[t]);
+        if (tret != BAKE_SUCCESS) ret = tret;
+    }
+    free(entry);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int
+bake_tier_create(backend_context_t context, size_t size, bake_region_id_t* rid)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    tier = tier_place(entry, size);
+    memset(&inner_rid, 0, sizeof(inner_rid));
+    ret = entry->backend[tier]->_create(entry->context[tier], size,
+                                        &inner_rid);
+    if (ret != BAKE_SUCCESS && tier == TIER_FAST) {
+        /* the fast target may run out of space before fast_capacity */
+        tier_unplace(entry, tier, size);
+        tier = TIER_SLOW;
+        ret  = entry->backend[tier]->_create(entry->context[tier], size,
+                                            &inner_rid);
+    }
+    if (ret == BAKE_SUCCESS)
+        ret = tier_map_insert(entry, tier, size, inner_rid, rid);
+    if (ret != BAKE_SUCCESS) tier_unplace(entry, tier, size);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_tier_write_raw(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            offset,
+                               size_t            size,
+                               const void*       data)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    ret = tier_resolve(entry, rid, 1, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_write_raw(entry->context[tier], inner_rid,
+                                           offset, size, data);
+    tier_release(entry, rid);
+    return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static int bake_tier_write_bulk(backend_context_t context,
+                                bake_region_id_t  rid,
+                                size_t            region_offset,
+                                size_t            size,
+                                hg_bulk_t         bulk,
+                                hg_addr_t         source,
+                                size_t            bulk_offset)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    ret = tier_resolve(entry, rid, 1, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_write_bulk(entry->context[tier], inner_rid,
+                                            region_offset, size, bulk, source,
+                                            bulk_offset);
+    tier_release(entry, rid);
+    return ret;
+}
+
+/* the free functions of the inner back ends do not change from one call
+ * to the next, so they are remembered per tier
+ */
+static void bake_tier_fast_read_raw_free(backend_context_t context, void* ptr)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    entry->inner_free[TIER_FAST](entry->context[TIER_FAST], ptr);
+}
+
+static void bake_tier_slow_read_raw_free(backend_context_t context, void* ptr)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    entry->inner_free[TIER_SLOW](entry->context[TIER_SLOW], ptr);
+}
+
+static void bake_tier_copy_free(backend_context_t context, void* ptr)
+{
+    free(ptr);
+}
+
+static int bake_tier_read_raw(backend_context_t context,
+                              bake_region_id_t  rid,
+                              size_t            offset,
+                              size_t            size,
+                              void**            data,
+                              uint64_t*         data_size,
+                              free_fn*          free_data)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    free_fn            inner_free = NULL;
+    void*              inner_data = NULL;
+    void*              buffer;
+    int                tier;
+    int                ret;
+
+    *free_data = NULL;
+    *data      = NULL;
+    *data_size = 0;
+
+    ret = tier_resolve(entry, rid, 0, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_read_raw(entry->context[tier], inner_rid,
+                                          offset, size, &inner_data,
+                                          data_size, &inner_free);
+    if (ret == BAKE_SUCCESS && !inner_free && *data_size) {
+        /* the data points into the tier itself (e.g., pmem), where it may
+         * not stay once the region is unlocked and migrated; copy it out
+         */
+        buffer = malloc(*data_size);
+        if (buffer) {
+            memcpy(buffer, inner_data, *data_size);
+            *data      = buffer;
+            *free_data = bake_tier_copy_free;
+        } else {
+            *data_size = 0;
+            ret        = BAKE_ERR_NOMEM;
+        }
+        tier_release(entry, rid);
+        return ret;
+    }
+    tier_release(entry, rid);
+
+    *data = inner_data;
+    if (inner_free) {
+        entry->inner_free[tier] = inner_free;
+        *free_data = tier == TIER_FAST ? bake_tier_fast_read_raw_free
+                                       : bake_tier_slow_read_raw_free;
+    }
+    return ret;
+}
+
+static int bake_tier_read_bulk(backend_context_t context,
+                               bake_region_id_t  rid,
+                               size_t            region_offset,
+                               size_t            size,
+                               hg_bulk_t         bulk,
+                               hg_addr_t         source,
+                               size_t            bulk_offset,
+                               size_t*           bytes_read)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    *bytes_read = 0;
+    ret         = tier_resolve(entry, rid, 0, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_read_bulk(entry->context[tier], inner_rid,
+                                           region_offset, size, bulk, source,
+                                           bulk_offset, bytes_read);
+    tier_release(entry, rid);
+    return ret;
+}
+
+static int bake_tier_persist(backend_context_t context,
+                             bake_region_id_t  rid,
+                             size_t            offset,
+                             size_t            size)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    ret = tier_resolve(entry, rid, 0, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_persist(entry->context[tier], inner_rid,
+                                         offset, size);
+    tier_release(entry, rid);
+    return ret;
+}
+
+static int bake_tier_create_write_persist_raw(backend_context_t context,
+                                              const void*       data,
+                                              size_t            size,
+                                              bake_region_id_t* rid)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_backend_t     backend;
+    backend_context_t  ctx;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    tier = tier_place(entry, size);
+retry:
+    backend = entry->backend[tier];
+    ctx     = entry->context[tier];
+    memset(&inner_rid, 0, sizeof(inner_rid));
+    if (backend->_create_write_persist_raw) {
+        ret = backend->_create_write_persist_raw(ctx, data, size, &inner_rid);
+    } else {
+        ret = backend->_create(ctx, size, &inner_rid);
+        if (ret == BAKE_SUCCESS) {
+            ret = backend->_write_raw(ctx, inner_rid, 0, size, data);
+            if (ret == BAKE_SUCCESS)
+                ret = backend->_persist(ctx, inner_rid, 0, size);
+            if (ret != BAKE_SUCCESS) backend->_remove(ctx, inner_rid);
+        }
+    }
+    if (ret != BAKE_SUCCESS && tier == TIER_FAST) {
+        /* the fast target may run out of space before fast_capacity */
+        tier_unplace(entry, tier, size);
+        tier = TIER_SLOW;
+        goto retry;
+    }
+    if (ret == BAKE_SUCCESS)
+        ret = tier_map_insert(entry, tier, size, inner_rid, rid);
+    if (ret != BAKE_SUCCESS) tier_unplace(entry, tier, size);
+    return ret;
+}
+
+static int bake_tier_create_write_persist_bulk(backend_context_t context,
+                                               hg_bulk_t         bulk,
+                                               hg_addr_t         source,
+                                               size_t            bulk_offset,
+                                               size_t            size,
+                                               bake_region_id_t* rid)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_backend_t     backend;
+    backend_context_t  ctx;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    tier = tier_place(entry, size);
+retry:
+    backend = entry->backend[tier];
+    ctx     = entry->context[tier];
+    memset(&inner_rid, 0, sizeof(inner_rid));
+    if (backend->_create_write_persist_bulk) {
+        ret = backend->_create_write_persist_bulk(ctx, bulk, source,
+                                                  bulk_offset, size,
+                                                  &inner_rid);
+    } else {
+        ret = backend->_create(ctx, size, &inner_rid);
+        if (ret == BAKE_SUCCESS) {
+            ret = backend->_write_bulk(ctx, inner_rid, 0, size, bulk, source,
+                                       bulk_offset);
+            if (ret == BAKE_SUCCESS)
+                ret = backend->_persist(ctx, inner_rid, 0, size);
+            if (ret != BAKE_SUCCESS) backend->_remove(ctx, inner_rid);
+        }
+    }
+    if (ret != BAKE_SUCCESS && tier == TIER_FAST) {
+        /* the fast target may run out of space before fast_capacity */
+        tier_unplace(entry, tier, size);
+        tier = TIER_SLOW;
+        goto retry;
+    }
+    if (ret == BAKE_SUCCESS)
+        ret = tier_map_insert(entry, tier, size, inner_rid, rid);
+    if (ret != BAKE_SUCCESS) tier_unplace(entry, tier, size);
+    return ret;
+}
+
+static int bake_tier_get_region_size(backend_context_t context,
+                                     bake_region_id_t  rid,
+                                     size_t*           size)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    tier_region_id_t*  trid  = (tier_region_id_t*)rid.data;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    ret = tier_resolve(entry, rid, 0, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    *size = entry->map[trid->index].size;
+    tier_release(entry, rid);
+    return BAKE_SUCCESS;
+}
+
+static int bake_tier_get_region_data(backend_context_t context,
+                                     bake_region_id_t  rid,
+                                     void**            data)
+{
+    /* a direct pointer would not survive the region changing tier */
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+
+static int bake_tier_remove(backend_context_t context, bake_region_id_t rid)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    size_t             size;
+    int                tier;
+    int                ret;
+
+    ret = tier_map_remove(entry, rid, &tier, &inner_rid, &size);
+    if (ret != BAKE_SUCCESS) return ret;
+    return entry->backend[tier]->_remove(entry->context[tier], inner_rid);
+}
+
+/* creates the whole batch on one tier, with its batch create if it has
+ * one, then records the regions in the map
+ */
+static int bake_tier_create_multi(backend_context_t context,
+                                  size_t            count,
+                                  const uint64_t*   sizes,
+                                  bake_region_id_t* rids)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t*  inner;
+    size_t             i, j, total = 0, unplaced = 0;
+    int                tier;
+    int                ret;
+
+    if (count == 0) return BAKE_SUCCESS;
+    inner = calloc(count, sizeof(*inner));
+    if (!inner) return BAKE_ERR_NOMEM;
+    for (i = 0; i < count; i++) total += sizes[i];
+
+    tier = tier_place(entry, total);
+    ret  = bake_backend_create_multi(entry->backend[tier], entry->context[tier],
+                                     0, count, sizes, inner);
+    if (ret != BAKE_SUCCESS && tier == TIER_FAST) {
+        /* the fast target may run out of space before fast_capacity */
+        tier_unplace(entry, tier, total);
+        tier = TIER_SLOW;
+        ret  = bake_backend_create_multi(entry->backend[tier],
+                                        entry->context[tier], 0, count, sizes,
+                                        inner);
+    }
+    if (ret != BAKE_SUCCESS) {
+        tier_unplace(entry, tier, total);
+        free(inner);
+        return ret;
+    }
+
+    for (i = 0; i < count; i++) {
+        ret = tier_map_insert(entry, tier, sizes[i], inner[i], &rids[i]);
+        if (ret != BAKE_SUCCESS) break;
+    }
+    if (ret != BAKE_SUCCESS) {
+        /* a failed batch leaves no region behind; the failed insert
+         * removed its inner region, and the regions not yet in the map are
+         * still accounted for by the placement
+         */
+        if (i + 1 < count)
+            bake_backend_remove_multi(entry->backend[tier],
+                                      entry->context[tier], count - i - 1,
+                                      inner + i + 1, NULL);
+        for (j = i; j < count; j++) unplaced += sizes[j];
+        tier_unplace(entry, tier, unplaced);
+        for (j = 0; j < i; j++) bake_tier_remove(context, rids[j]);
+    }
+    free(inner);
+    return ret;
+}
+
+/* unmaps the regions, then removes them from each tier in one batch */
+static int bake_tier_remove_multi(backend_context_t       context,
+                                  size_t                  count,
+                                  const bake_region_id_t* rids,
+                                  size_t*                 bytes_removed)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t*  inner[TIER_SLOW + 1] = {NULL};
+    size_t             n[TIER_SLOW + 1]     = {0};
+    bake_region_id_t   inner_rid;
+    size_t             i, size, removed = 0;
+    int                tier;
+    int                ret = BAKE_SUCCESS, r;
+
+    inner[TIER_FAST] = calloc(count, sizeof(bake_region_id_t));
+    inner[TIER_SLOW] = calloc(count, sizeof(bake_region_id_t));
+    if (count && (!inner[TIER_FAST] || !inner[TIER_SLOW])) {
+        free(inner[TIER_FAST]);
+        free(inner[TIER_SLOW]);
+        return BAKE_ERR_NOMEM;
+    }
+
+    /* a region that is not in the map fails the batch, but the others are
+     * still removed, as with the per-region loop
+     */
+    for (i = 0; i < count; i++) {
+        r = tier_map_remove(entry, rids[i], &tier, &inner_rid, &size);
+        if (r != BAKE_SUCCESS) {
+            if (ret == BAKE_SUCCESS) ret = r;
+            continue;
+        }
+        inner[tier][n[tier]++] = inner_rid;
+        removed += size;
+    }
+    for (tier = TIER_FAST; tier <= TIER_SLOW; tier++) {
+        if (n[tier] == 0) continue;
+        r = bake_backend_remove_multi(entry->backend[tier],
+                                      entry->context[tier], n[tier],
+                                      inner[tier], NULL);
+        if (r != BAKE_SUCCESS && ret == BAKE_SUCCESS) ret = r;
+    }
+    free(inner[TIER_FAST]);
+    free(inner[TIER_SLOW]);
+
+    if (bytes_removed) *bytes_removed = removed;
+    return ret;
+}
+
+static int bake_tier_migrate_region(backend_context_t context,
+                                    bake_region_id_t  source_rid,
+                                    size_t            region_size,
+                                    int               remove_source,
+                                    const char*       dest_addr_str,
+                                    uint16_t          dest_provider_id,
+                                    bake_target_id_t  dest_target_id,
+                                    bake_region_id_t* dest_rid)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    bake_region_id_t   inner_rid;
+    int                tier;
+    int                ret;
+
+    ret = tier_resolve(entry, source_rid, 0, &tier, &inner_rid);
+    if (ret != BAKE_SUCCESS) return ret;
+    ret = entry->backend[tier]->_migrate_region(
+        entry->context[tier], inner_rid, region_size, 0, dest_addr_str,
+        dest_provider_id, dest_target_id, dest_rid);
+    tier_release(entry, source_rid);
+
+    if (ret == BAKE_SUCCESS && remove_source)
+        ret = bake_tier_remove(context, source_rid);
+    return ret;
+}
+
+static int bake_tier_get_stats(backend_context_t   context,
+                               struct json_object* stats)
+{
+    bake_tier_entry_t*  entry      = (bake_tier_entry_t*)context;
+    struct json_object* tier_stats = json_object_new_object();
+
+    ABT_mutex_lock(entry->alloc_mutex);
+    json_object_object_add(tier_stats, "fast_used",
+                           json_object_new_int64(entry->fast_used));
+    json_object_object_add(tier_stats, "fast_capacity",
+                           json_object_new_int64(entry->fast_capacity));
+    json_object_object_add(
+        tier_stats, "regions",
+        json_object_new_int64(entry->map_root->num_entries - entry->num_free));
+    ABT_mutex_unlock(entry->alloc_mutex);
+    ABT_mutex_lock(entry->engine_mutex);
+    json_object_object_add(tier_stats, "promotions",
+                           json_object_new_int64(entry->promotions));
+    json_object_object_add(tier_stats, "demotions",
+                           json_object_new_int64(entry->demotions));
+    json_object_object_add(tier_stats, "aborted_migrations",
+                           json_object_new_int64(entry->aborted));
+    ABT_mutex_unlock(entry->engine_mutex);
+    json_object_object_add(stats, "tier", tier_stats);
+    json_object_object_add(
+        stats, "bytes_used",
+        json_object_new_int64(
+            bake_backend_bytes_used(entry->backend[TIER_FAST],
+                                    entry->context[TIER_FAST])
+            + bake_backend_bytes_used(entry->backend[TIER_SLOW],
+                                      entry->context[TIER_SLOW])));
+
+    return BAKE_SUCCESS;
+}
+
+static int bake_tier_reconfigure(backend_context_t context)
+{
+    bake_tier_entry_t* entry = (bake_tier_entry_t*)context;
+    int                i, ret = BAKE_SUCCESS;
+
+    for (i = TIER_FAST; i <= TIER_SLOW && ret == BAKE_SUCCESS; i++)
+        if (entry->backend[i]->_reconfigure)
+            ret = entry->backend[i]->_reconfigure(entry->context[i]);
+    return ret;
+}
+
+#ifdef USE_REMI
+static int bake_tier_create_fileset(backend_context_t context,
+                                    remi_fileset_t*   fileset)
+{
+    /* spans two targets, possibly of different kinds */
+    return BAKE_ERR_OP_UNSUPPORTED;
+}
+#endif
+
+bake_backend g_bake_tier_backend = {
+    .name                       = "tier",
+    ._initialize                = bake_tier_backend_initialize,
+    ._finalize                  = bake_tier_backend_finalize,
+    ._create                    = bake_tier_create,
+    ._write_raw                 = bake_tier_write_raw,
+    ._write_bulk                = bake_tier_write_bulk,
+    ._read_raw                  = bake_tier_read_raw,
+    ._read_bulk                 = bake_tier_read_bulk,
+    ._persist                   = bake_tier_persist,
+    ._create_write_persist_raw  = bake_tier_create_write_persist_raw,
+    ._create_write_persist_bulk = bake_tier_create_write_persist_bulk,
+    ._get_region_size           = bake_tier_get_region_size,
+    ._get_region_data           = bake_tier_get_region_data,
+    ._remove                    = bake_tier_remove,
+    ._migrate_region            = bake_tier_migrate_region,
+    ._create_raw_target         = bake_tier_makepool,
+    ._get_stats                 = bake_tier_get_stats,
+    ._reconfigure               = bake_tier_reconfigure,
+    ._create_multi              = bake_tier_create_multi,
+    ._remove_multi              = bake_tier_remove_multi,
+#ifdef USE_REMI
+    ._create_fileset = bake_tier_create_fileset,
+#endif
+};
+
+/* moves one region to the other tier; returns nonzero if it moved */
+static int tier_move(bake_tier_entry_t* entry, uint64_t index, int to)
+{
+    tier_map_entry_t* e    = &entry->map[index];
+    int               from = to == TIER_FAST ? TIER_SLOW : TIER_FAST;
+    bake_region_id_t  src_rid, dst_rid;
+    uint64_t          gen, size;
+    uint32_t          slot;
+    void*             data      = NULL;
+    uint64_t          data_size = 0;
+    free_fn           data_free = NULL;
+    void*             copy      = NULL;
+    int               created   = 0;
+    int               moved     = 0;
+    int               ret;
+
+    /* snapshot the entry and start watching for writes */
+    ABT_rwlock_wrlock(tier_stripe(entry, index));
+    if (e->state != from) {
+        ABT_rwlock_unlock(tier_stripe(entry, index));
+        return 0;
+    }
+    gen  = e->gen;
+    size = e->size;
+    slot = e->slot;
+    memset(&src_rid, 0, sizeof(src_rid));
+    memcpy(src_rid.data, e->inner[slot], BAKE_REGION_ID_DATA_SIZE);
+    entry->dirty[index] = 0;
+    ABT_rwlock_unlock(tier_stripe(entry, index));
+
+    /* copy while accesses continue against the source */
+    ret = entry->backend[from]->_read_raw(entry->context[from], src_rid, 0,
+                                          size, &data, &data_size, &data_free);
+    if (ret != BAKE_SUCCESS) return 0;
+    if (data_size == size) {
+        copy = malloc(size ? size : 1);
+        if (copy) memcpy(copy, data, size);
+    }
+    if (data_free) data_free(entry->context[from], data);
+    if (!copy) return 0;
+
+    memset(&dst_rid, 0, sizeof(dst_rid));
+    ret = entry->backend[to]->_create(entry->context[to], size, &dst_rid);
+    if (ret == BAKE_SUCCESS) created = 1;
+    if (ret == BAKE_SUCCESS)
+        ret = entry->backend[to]->_write_raw(entry->context[to], dst_rid, 0,
+                                             size, copy);
+    if (ret == BAKE_SUCCESS)
+        ret = entry->backend[to]->_persist(entry->context[to], dst_rid, 0,
+                                           size);
+    free(copy);
+    if (ret != BAKE_SUCCESS) {
+        if (created)
+            entry->backend[to]->_remove(entry->context[to], dst_rid);
+        return 0;
+    }
+
+    /* switch over unless the region changed under us; the new region id
+     * goes to the unused slot first, so the entry stays valid throughout
+     */
+    ABT_rwlock_wrlock(tier_stripe(entry, index));
+    if (e->state == from && e->gen == gen && !entry->dirty[index]) {
+        memcpy(e->inner[!slot], dst_rid.data, BAKE_REGION_ID_DATA_SIZE);
+        tier_persist(entry, e->inner[!slot], sizeof(e->inner[!slot]));
+        tier_set_location(entry, e, to, !slot);
+        moved = 1;
+    }
+    ABT_rwlock_unlock(tier_stripe(entry, index));
+
+    if (moved) {
+        entry->backend[from]->_remove(entry->context[from], src_rid);
+        ABT_mutex_lock(entry->alloc_mutex);
+        if (to == TIER_FAST)
+            entry->fast_used += size;
+        else
+            entry->fast_used -= size;
+        ABT_mutex_unlock(entry->alloc_mutex);
+    } else {
+        entry->backend[to]->_remove(entry->context[to], dst_rid);
+        ABT_mutex_lock(entry->engine_mutex);
+        entry->aborted++;
+        ABT_mutex_unlock(entry->engine_mutex);
+    }
+
+    /* stay under the migration bandwidth */
+    if (entry->migration_bandwidth > 0)
+        margo_thread_sleep(entry->provider->mid,
+                           size / entry->migration_bandwidth * 1e3);
+
+    return moved;
+}
+
+/* keeps the (at most TIER_CANDIDATES) best candidates for a move, best
+ * first; a region is better than another if its key is larger
+ */
+typedef struct {
+    uint64_t index[TIER_CANDIDATES];
+    int64_t  key[TIER_CANDIDATES];
+    int      count;
+} tier_candidates_t;
+
+static void
+tier_candidates_add(tier_candidates_t* c, uint64_t index, int64_t key)
+{
+    int i;
+
+    if (c->count == TIER_CANDIDATES && key <= c->key[c->count - 1]) return;
+    if (c->count < TIER_CANDIDATES) c->count++;
+    for (i = c->count - 1; i > 0 && c->key[i - 1] < key; i--) {
+        c->index[i] = c->index[i - 1];
+        c->key[i]   = c->key[i - 1];
+    }
+    c->index[i] = index;
+    c->key[i]   = key;
+}
+
+/* one pass of the tiering policy */
+static void tier_rebalance(bake_tier_entry_t* entry)
+{
+    uint64_t          n    = entry->map_root->num_entries;
+    uint64_t          high = entry->fast_capacity * entry->high_watermark;
+    uint64_t          low  = entry->fast_capacity * entry->low_watermark;
+    tier_candidates_t cold = {0}, hot = {0};
+    tier_map_entry_t* e;
+    uint64_t          fast_used, i;
+    uint32_t          heat;
+    int               c;
+
+    /* a single scan picks the coldest fast regions and the hottest slow
+     * ones, and cools everything down so that heat reflects recent
+     * accesses; it yields now and then to the handlers sharing its pool
+     */
+    for (i = 0; i < n; i++) {
+        if (i % 65536 == 65535) ABT_thread_yield();
+        e              = &entry->map[i];
+        heat           = entry->heat[i];
+        entry->heat[i] = heat >> 1;
+        if (e->size > entry->max_migrate_size) continue;
+        if (e->state == TIER_FAST)
+            tier_candidates_add(&cold, i, -(int64_t)heat);
+        else if (e->state == TIER_SLOW && heat >= entry->promote_threshold)
+            tier_candidates_add(&hot, i, heat);
+    }
+
+    ABT_mutex_lock(entry->alloc_mutex);
+    fast_used = entry->fast_used;
+    ABT_mutex_unlock(entry->alloc_mutex);
+
+    /* above the high watermark, demote the coldest regions until the fast
+     * tier is back under its low watermark
+     */
+    if (fast_used <= high) cold.count = 0;
+    for (c = 0; c < cold.count && !entry->shutdown; c++) {
+        /* a region that could not move is retried next pass */
+        if (!tier_move(entry, cold.index[c], TIER_SLOW)) continue;
+        ABT_mutex_lock(entry->engine_mutex);
+        entry->demotions++;
+        ABT_mutex_unlock(entry->engine_mutex);
+        ABT_mutex_lock(entry->alloc_mutex);
+        fast_used = entry->fast_used;
+        ABT_mutex_unlock(entry->alloc_mutex);
+        if (fast_used <= low) break;
+    }
+
+    /* promote the hottest slow regions while there is room */
+    for (c = 0; c < hot.count && !entry->shutdown; c++) {
+        if (fast_used + entry->map[hot.index[c]].size > low) continue;
+        if (!tier_move(entry, hot.index[c], TIER_FAST)) continue;
+        ABT_mutex_lock(entry->engine_mutex);
+        entry->promotions++;
+        ABT_mutex_unlock(entry->engine_mutex);
+        ABT_mutex_lock(entry->alloc_mutex);
+        fast_used = entry->fast_used;
+        ABT_mutex_unlock(entry->alloc_mutex);
+    }
+}
+
+/* background ULT running the tiering policy every scan interval */
+static void tier_engine_ult(void* _arg)
+{
+    bake_tier_entry_t* entry = _arg;
+    struct timespec    deadline;
+    double             t;
+
+    ABT_mutex_lock(entry->engine_mutex);
+    while (!entry->shutdown) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        t = deadline.tv_sec + deadline.tv_nsec / 1e9 + entry->scan_interval;
+        deadline.tv_sec  = (time_t)t;
+        deadline.tv_nsec = (long)((t - (double)deadline.tv_sec) * 1e9);
+        ABT_cond_timedwait(entry->engine_cond, entry->engine_mutex, &deadline);
+        if (entry->shutdown) break;
+        ABT_mutex_unlock(entry->engine_mutex);
+        tier_rebalance(entry);
+        ABT_mutex_lock(entry->engine_mutex);
+    }
+    ABT_mutex_unlock(entry->engine_mutex);
+}
@@ -60,6 +60,12 @@ static char* bake_err_str(int ret)
     case BAKE_ERR_NOMEM:
         return "Out of memory";
         break;
+    case BAKE_ERR_BUSY:
+        return "Provider overloaded, retry later";
+        break;
+    case BAKE_ERR_TIMEOUT:
+        return "Deadline of the request passed";
+        break;
     default:
         return "Unknown error";
         break;
@@ -0,0 +1,79 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# let one read or write at a time through the provider; the clients must
+# retry the ones turned away as busy until they succeed
+TARGET=pmem:$TMPBASE/svr-1.dat
+src/bake-mkpool -s 100M $TARGET
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+cat > $TMPBASE/svr-1.json <<END
+{
+    "pipeline_enable": true,
+    "backpressure": {
+        "max_pending": 1,
+        "max_buffer_bytes": 4,
+        "retry_after_ms": 1
+    }
+}
+END
+run_to 20 src/bake-server-daemon -f $TMPBASE/svr-1.addr -j $TMPBASE/svr-1.json na+sm $TARGET &
+sleep 2
+svr1=`cat $TMPBASE/svr-1.addr`
+
+# actual test case
+#####################
+
+echo "Hello world." > $TMPBASE/foo.dat
+# a concurrent copy keeps the provider busy
+run_to 10 src/bake-copy-to $srcdir/tests/lorem.txt $svr1 1 1 > /dev/null &
+BGCOPY=$!
+CPOUT=`run_to 10 src/bake-copy-to $TMPBASE/foo.dat $svr1 1 1`
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+wait $BGCOPY
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+
+RID=`echo "$CPOUT" | grep -o -P '/tmp.*$'`
+run_to 10 src/bake-copy-from $svr1 1 $RID $TMPBASE/foo-out.dat 13
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+
+cmp $TMPBASE/foo.dat $TMPBASE/foo-out.dat
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+
+#####################
+
+# tear down
+run_to 10 src/bake-shutdown $svr1
+if [ $? -ne 0 ]; then
+    wait
+    exit 1
+fi
+
+wait
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
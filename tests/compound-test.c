@@ -0,0 +1,171 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define REGION_SIZE 64
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_target_id_t       placed;
+    bake_op_t              ops[4];
+    bake_op_result_t       results[4];
+    char                   buf[REGION_SIZE];
+    char                   expected[REGION_SIZE];
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: compound-test <bake server addr> "
+                        "<mplex id>\n");
+        fprintf(stderr, "  Example: ./compound-test "
+                        "tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + i % 26;
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* create, write, persist and read back a region in one request, the
+     * operations after the first working on the region it creates
+     */
+    memset(ops, 0, sizeof(ops));
+    ops[0].type = BAKE_OP_CREATE;
+    ops[0].size = REGION_SIZE;
+    for (i = 1; i < 4; i++) {
+        ops[i].rid_step = 0;
+        ops[i].size     = REGION_SIZE;
+    }
+    ops[1].type = BAKE_OP_WRITE;
+    ops[1].buf  = expected;
+    ops[2].type = BAKE_OP_PERSIST;
+    ops[3].type = BAKE_OP_READ;
+    ops[3].buf  = buf;
+    ret         = bake_compound(bph, &bti, 4, ops, results);
+    if (ret != 0) {
+        bake_perror("Error: bake_compound()", ret);
+        goto cleanup;
+    }
+    if (results[3].size != REGION_SIZE || memcmp(buf, expected, REGION_SIZE)
+        || memcmp(&results[3].rid, &results[0].rid, sizeof(bake_region_id_t))) {
+        fprintf(stderr, "Error: unexpected contents in region\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* remove the region, then fail on an operation referring to a step
+     * that created nothing; the operations after it must not run
+     */
+    memset(ops, 0, sizeof(ops));
+    ops[0].type     = BAKE_OP_REMOVE;
+    ops[0].rid_step = BAKE_OP_RID;
+    ops[0].rid      = results[0].rid;
+    ops[1].type     = BAKE_OP_GET_SIZE;
+    ops[1].rid_step = 0;
+    ops[2].type     = BAKE_OP_CREATE;
+    ops[2].size     = REGION_SIZE;
+    memset(results, 0, sizeof(results));
+    results[2].ret = 1;
+    ret            = bake_compound(bph, &bti, 3, ops, results);
+    if (ret != BAKE_ERR_INVALID_ARG || results[0].ret != 0
+        || results[1].ret != BAKE_ERR_INVALID_ARG || results[2].ret != 1) {
+        fprintf(stderr, "Error: unexpected results of failed request\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* without a target, the provider chooses one and reports it */
+    memset(&placed, 0, sizeof(placed));
+    memset(ops, 0, sizeof(ops));
+    ops[0].type     = BAKE_OP_CREATE;
+    ops[0].size     = REGION_SIZE;
+    ops[1].type     = BAKE_OP_REMOVE;
+    ops[1].rid_step = 0;
+    ret             = bake_compound(bph, &placed, 2, ops, results);
+    if (ret != 0) {
+        bake_perror("Error: bake_compound()", ret);
+        goto cleanup;
+    }
+    if (memcmp(&placed, &bti, sizeof(bti))) {
+        fprintf(stderr, "Error: unexpected target of placed request\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+cleanup:
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -0,0 +1,55 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# a tier target names two pools, so start the server by hand
+TARGET=tier:$TMPBASE/svr-1.dat,file:$TMPBASE/svr-1-slow.dat
+src/bake-mkpool -s 100M $TARGET
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+run_to 20 src/bake-server-daemon -p -f $TMPBASE/svr-1.addr na+sm $TARGET &
+sleep 2
+svr1=`cat $TMPBASE/svr-1.addr`
+
+# actual test case
+#####################
+
+echo "Hello world." > $TMPBASE/foo.dat
+CPOUT=`run_to 10 src/bake-copy-to $TMPBASE/foo.dat $svr1 1 1`
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+
+RID=`echo "$CPOUT" | grep -o -P '/tmp.*$'`
+run_to 10 src/bake-copy-from $svr1 1 $RID $TMPBASE/foo-out.dat 13
+if [ $? -ne 0 ]; then
+    run_to 10 src/bake-shutdown $svr1
+    wait
+    exit 1
+fi
+
+cat $TMPBASE/foo-out.dat
+sleep 1
+
+#####################
+
+# tear down
+run_to 10 src/bake-shutdown $svr1
+if [ $? -ne 0 ]; then
+    wait
+    exit 1
+fi
+
+wait
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
@@ -0,0 +1,147 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define MAX_REGIONS 10000
+#define REGION_SIZE 128
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_region_id_t*      rids;
+    uint64_t*              sizes;
+    uint64_t               count, n;
+    uint64_t               bytes_read;
+    char                   buf[REGION_SIZE];
+    char                   expected[REGION_SIZE];
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: create-remove-multi-test <bake server addr> "
+                        "<mplex id>\n");
+        fprintf(stderr, "  Example: ./create-remove-multi-test "
+                        "tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    rids  = calloc(MAX_REGIONS, sizeof(*rids));
+    sizes = malloc(MAX_REGIONS * sizeof(*sizes));
+    for (i = 0; i < MAX_REGIONS; i++) sizes[i] = REGION_SIZE;
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + i % 26;
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* a small batch travels in the RPC messages, a large one through bulk
+     * transfers
+     */
+    for (count = 4; count <= MAX_REGIONS; count *= 50) {
+        ret = bake_create_multi(bph, bti, count, sizes, rids);
+        if (ret != 0) {
+            bake_perror("Error: bake_create_multi()", ret);
+            goto cleanup;
+        }
+        /* the first and last regions can hold their data */
+        for (n = 0; n < count; n += count - 1) {
+            ret = bake_write(bph, bti, rids[n], 0, expected, REGION_SIZE);
+            if (ret == 0)
+                ret = bake_persist(bph, bti, rids[n], 0, REGION_SIZE);
+            if (ret == 0)
+                ret = bake_read(bph, bti, rids[n], 0, buf, REGION_SIZE,
+                                &bytes_read);
+            if (ret != 0) {
+                bake_perror("Error: writing to a new region", ret);
+                goto cleanup;
+            }
+            if (bytes_read != REGION_SIZE
+                || memcmp(buf, expected, REGION_SIZE)) {
+                fprintf(stderr, "Error: unexpected contents in region\n");
+                ret = -1;
+                goto cleanup;
+            }
+        }
+        ret = bake_remove_multi(bph, bti, count, rids);
+        if (ret != 0) {
+            bake_perror("Error: bake_remove_multi()", ret);
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    free(rids);
+    free(sizes);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -36,18 +36,20 @@ int main(int argc, char* argv[])
     uint64_t    buf_size;
     hg_return_t hret;
     int         ret;
+    int         check_double_remove;
 
-    if (argc != 3) {
-        fprintf(
-            stderr,
-            "Usage: create-write-persist-test <bake server addr> <mplex id>\n");
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr,
+                "Usage: create-write-persist-test <bake server addr> <mplex "
+                "id> [check-double-remove]\n");
         fprintf(
             stderr,
             "  Example: ./create-write-persist-test tcp://localhost:1234 1\n");
         return (-1);
     }
-    bake_svr_addr_str = argv[1];
-    mplex_id          = atoi(argv[2]);
+    bake_svr_addr_str   = argv[1];
+    mplex_id            = atoi(argv[2]);
+    check_double_remove = argc == 4;
 
     /* initialize Margo using the transport portion of the server
      * address (i.e., the part before the first : character if present)
@@ -168,6 +170,22 @@ int main(int argc, char* argv[])
         return (-1);
     }
 
+    /* removing the region again must be reported, not corrupt the target */
+    if (check_double_remove) {
+        ret = bake_remove(bph, bti, the_rid);
+        if (ret != BAKE_ERR_UNKNOWN_REGION) {
+            fprintf(stderr,
+                    "Error: second bake_remove() returned %d, expected %d\n",
+                    ret, BAKE_ERR_UNKNOWN_REGION);
+            free(buf);
+            bake_provider_handle_release(bph);
+            margo_addr_free(mid, svr_addr);
+            bake_client_finalize(bcl);
+            margo_finalize(mid);
+            return (-1);
+        }
+    }
+
     /* shutdown the server */
     ret = bake_shutdown_service(bcl, svr_addr);
 
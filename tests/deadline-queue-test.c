@@ -0,0 +1,146 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-server.h"
+#include "bake-client.h"
+
+/* the provider runs in this process, on a pool that the test stops
+ * serving for a while: a write sent then waits in the pool past its
+ * deadline, and the provider has to drop it rather than apply it once the
+ * pool is served again
+ */
+
+/* small enough to be sent eagerly, so that the data travels with the
+ * request and the provider could still apply it after the client gave up
+ */
+#define REGION_SIZE 64
+
+/* number after "key": in the statistics of the provider */
+static uint64_t get_stat(bake_provider_t provider, const char* key)
+{
+    char*    stats = bake_provider_get_stats(provider);
+    char*    p     = stats ? strstr(stats, key) : NULL;
+    uint64_t value = 0;
+
+    if (p && (p = strchr(p + strlen(key), ':')))
+        value = strtoull(p + 1, NULL, 10);
+    free(stats);
+    return value;
+}
+
+int main(int argc, char* argv[])
+{
+    struct bake_provider_init_info args = {0};
+    margo_instance_id              mid;
+    hg_addr_t                      self_addr;
+    ABT_pool                       rpc_pool;
+    ABT_xstream                    rpc_xstream;
+    bake_provider_t                provider;
+    bake_client_t                  bcl;
+    bake_provider_handle_t         bph;
+    bake_target_id_t               bti;
+    bake_region_id_t               rid;
+    char                           expected[REGION_SIZE];
+    char                           buf[REGION_SIZE];
+    uint64_t                       bytes_read;
+    int                            i;
+    int                            ret;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: deadline-queue-test <target>\n");
+        fprintf(stderr, "  Example: ./deadline-queue-test mem:/tmp/a.dat\n");
+        return (-1);
+    }
+
+    mid = margo_init("na+sm", MARGO_SERVER_MODE, 0, -1);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC, ABT_FALSE,
+                          &rpc_pool);
+    ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &rpc_pool,
+                             ABT_SCHED_CONFIG_NULL, &rpc_xstream);
+
+    args.rpc_pool = rpc_pool;
+    ret           = bake_provider_register(mid, 1, &args, &provider);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_register()", ret);
+        margo_finalize(mid);
+        return (-1);
+    }
+    ret = bake_provider_attach_target(provider, argv[1], &bti);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_attach_target()", ret);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    margo_addr_self(mid, &self_addr);
+    bake_client_init(mid, &bcl);
+    bake_provider_handle_create(bcl, self_addr, 1, &bph);
+
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + i % 26;
+    ret = bake_create_write_persist(bph, bti, expected, REGION_SIZE, &rid);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist()", ret);
+        goto cleanup;
+    }
+
+    /* nothing serves the pool of the provider while the write waits */
+    ABT_xstream_join(rpc_xstream);
+    ABT_xstream_free(&rpc_xstream);
+    memset(buf, 'z', REGION_SIZE);
+    ret = bake_write_timed(bph, bti, rid, 0, buf, REGION_SIZE, 100);
+    if (ret != BAKE_ERR_TIMEOUT) {
+        fprintf(stderr, "Error: expected BAKE_ERR_TIMEOUT, got %d\n", ret);
+        ret = -1;
+        goto cleanup;
+    }
+    ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &rpc_pool,
+                             ABT_SCHED_CONFIG_NULL, &rpc_xstream);
+
+    /* the pool is first in first out, so the write is handled before this
+     * read, and must have been dropped
+     */
+    memset(buf, 0, REGION_SIZE);
+    ret = bake_read(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        goto cleanup;
+    }
+    if (memcmp(buf, expected, REGION_SIZE)) {
+        fprintf(stderr, "Error: expired write modified the region\n");
+        ret = -1;
+        goto cleanup;
+    }
+    if (get_stat(provider, "\"expired_requests\"") != 1) {
+        fprintf(stderr, "Error: the provider did not drop the write\n");
+        ret = -1;
+    }
+
+cleanup:
+    bake_provider_handle_release(bph);
+    bake_client_finalize(bcl);
+    margo_addr_free(mid, self_addr);
+    bake_provider_deregister(provider);
+    margo_finalize(mid);
+    ABT_xstream_join(rpc_xstream);
+    ABT_xstream_free(&rpc_xstream);
+    ABT_pool_free(&rpc_pool);
+    return (ret);
+}
@@ -0,0 +1,20 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+#####################
+
+# run test; it runs its own provider on this target
+run_to 20 tests/deadline-queue-test mem:$TMPBASE/svr-1.dat
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
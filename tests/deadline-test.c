@@ -0,0 +1,147 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+/* larger than the eager limit, to go through bulk transfers */
+#define REGION_SIZE 65536
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_region_id_t       rid;
+    char*                  buf;
+    char*                  expected;
+    uint64_t               bytes_read;
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: deadline-test <bake server addr> <mplex id>\n");
+        fprintf(stderr, "  Example: ./deadline-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    buf      = calloc(1, REGION_SIZE);
+    expected = malloc(REGION_SIZE);
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + i % 26;
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* operations well within their deadline go through */
+    ret = bake_create_write_persist_timed(bph, bti, expected, REGION_SIZE,
+                                          &rid, 10000);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist_timed()", ret);
+        goto cleanup;
+    }
+    ret = bake_read_timed(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read,
+                          10000);
+    if (ret != 0) {
+        bake_perror("Error: bake_read_timed()", ret);
+        goto cleanup;
+    }
+    if (bytes_read != REGION_SIZE || memcmp(buf, expected, REGION_SIZE)) {
+        fprintf(stderr, "Error: unexpected contents in region\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* a deadline of a microsecond passes before the provider can do
+     * anything, and the write must fail without touching the region
+     */
+    memset(buf, 'z', REGION_SIZE);
+    ret = bake_write_timed(bph, bti, rid, 0, buf, REGION_SIZE, 0.001);
+    if (ret != BAKE_ERR_TIMEOUT) {
+        fprintf(stderr, "Error: expected BAKE_ERR_TIMEOUT, got %d\n", ret);
+        ret = -1;
+        goto cleanup;
+    }
+    memset(buf, 0, REGION_SIZE);
+    ret = bake_read(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        goto cleanup;
+    }
+    if (memcmp(buf, expected, REGION_SIZE)) {
+        fprintf(stderr, "Error: expired write modified the region\n");
+        ret = -1;
+    }
+
+cleanup:
+    free(buf);
+    free(expected);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
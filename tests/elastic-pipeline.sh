@@ -0,0 +1,79 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# pipeline buffers of 1, 2 and 4 KiB within 2 KiB of memory, freed after
+# 100 ms of idleness: a large transfer gets a single buffer over the limit,
+# which the next small one has to reclaim
+TARGET=pmem:$TMPBASE/svr-1.dat
+src/bake-mkpool -s 100M $TARGET
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+cat > $TMPBASE/svr-1.json <<END
+{
+    "pipeline_enable": true,
+    "pipeline_npools": 3,
+    "pipeline_first_buffer_size": 1024,
+    "pipeline_multiplier": 2,
+    "pipeline_nbuffers_per_pool": 1,
+    "pipeline_max_memory": 2048,
+    "pipeline_idle_ms": 100
+}
+END
+run_to 20 src/bake-server-daemon -f $TMPBASE/svr-1.addr -j $TMPBASE/svr-1.json na+sm $TARGET &
+sleep 2
+svr1=`cat $TMPBASE/svr-1.addr`
+
+# actual test case
+#####################
+
+echo "Hello world." > $TMPBASE/foo.dat
+for FILE in $srcdir/tests/lorem.txt $TMPBASE/foo.dat; do
+    SIZE=`stat -c %s $FILE`
+    CPOUT=`run_to 10 src/bake-copy-to $FILE $svr1 1 1`
+    if [ $? -ne 0 ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+
+    RID=`echo "$CPOUT" | grep -o -P '/tmp.*$'`
+    run_to 10 src/bake-copy-from $svr1 1 $RID $TMPBASE/out.dat $SIZE
+    if [ $? -ne 0 ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+
+    cmp $FILE $TMPBASE/out.dat
+    if [ $? -ne 0 ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+    rm -f $TMPBASE/out.dat
+
+    # let the idle buffers be freed
+    sleep 0.5
+done
+
+#####################
+
+# tear down
+run_to 10 src/bake-shutdown $svr1
+if [ $? -ne 0 ]; then
+    wait
+    exit 1
+fi
+
+wait
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
@@ -0,0 +1,165 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define NUM_REGIONS 100
+#define REGION_SIZE 128
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_region_id_t*      rids;
+    bake_region_id_t*      kept;
+    uint64_t*              sizes;
+    uint64_t               n;
+    uint64_t               bytes_read;
+    char                   buf[REGION_SIZE];
+    char                   expected[REGION_SIZE];
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: group-test <bake server addr> "
+                        "<mplex id>\n");
+        fprintf(stderr, "  Example: ./group-test "
+                        "tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    rids  = calloc(NUM_REGIONS, sizeof(*rids));
+    kept  = calloc(NUM_REGIONS, sizeof(*kept));
+    sizes = malloc(NUM_REGIONS * sizeof(*sizes));
+    for (i = 0; i < NUM_REGIONS; i++) sizes[i] = REGION_SIZE;
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + i % 26;
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* group 1 is made of two batches, group 2 of one, and each of the
+     * regions gets written
+     */
+    ret = bake_create_group(bph, bti, 1, NUM_REGIONS / 2, sizes, rids);
+    if (ret == 0)
+        ret = bake_create_group(bph, bti, 2, NUM_REGIONS, sizes, kept);
+    if (ret == 0)
+        ret = bake_create_group(bph, bti, 1, NUM_REGIONS / 2, sizes,
+                                rids + NUM_REGIONS / 2);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_group()", ret);
+        goto cleanup;
+    }
+    for (n = 0; n < NUM_REGIONS && ret == 0; n++) {
+        ret = bake_write(bph, bti, rids[n], 0, expected, REGION_SIZE);
+        if (ret == 0)
+            ret = bake_write(bph, bti, kept[n], 0, expected, REGION_SIZE);
+        if (ret == 0) ret = bake_persist(bph, bti, kept[n], 0, REGION_SIZE);
+    }
+    if (ret != 0) {
+        bake_perror("Error: writing to a new region", ret);
+        goto cleanup;
+    }
+
+    /* removing group 1, even twice, leaves group 2 alone */
+    ret = bake_remove_group(bph, bti, 1);
+    if (ret == 0) ret = bake_remove_group(bph, bti, 1);
+    if (ret != 0) {
+        bake_perror("Error: bake_remove_group()", ret);
+        goto cleanup;
+    }
+    for (n = 0; n < NUM_REGIONS; n++) {
+        ret = bake_read(bph, bti, kept[n], 0, buf, REGION_SIZE, &bytes_read);
+        if (ret != 0) {
+            bake_perror("Error: bake_read()", ret);
+            goto cleanup;
+        }
+        if (bytes_read != REGION_SIZE || memcmp(buf, expected, REGION_SIZE)) {
+            fprintf(stderr, "Error: unexpected contents in region\n");
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    ret = bake_remove_group(bph, bti, 2);
+    if (ret != 0) {
+        bake_perror("Error: bake_remove_group()", ret);
+        goto cleanup;
+    }
+
+cleanup:
+    free(rids);
+    free(kept);
+    free(sizes);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -0,0 +1,138 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-server.h"
+#include "bake-client.h"
+
+/* the providers run in this process, so that the test can see their
+ * statistics.  Their file targets share the I/O engine of the process,
+ * and changing file_backend.io_max_threads on one provider must only
+ * change the limit of its own targets.
+ */
+static const char* config = "{ \"pipeline_enable\": true }";
+
+#define REGION_SIZE 65536
+
+/* number after "key": in the statistics of the provider */
+static uint64_t get_stat(bake_provider_t provider, const char* key)
+{
+    char*    stats = bake_provider_get_stats(provider);
+    char*    p     = stats ? strstr(stats, key) : NULL;
+    uint64_t value = 0;
+
+    if (p && (p = strchr(p + strlen(key), ':')))
+        value = strtoull(p + 1, NULL, 10);
+    free(stats);
+    return value;
+}
+
+/* writes a new region on the target of a provider and reads it back */
+static int write_and_check(bake_client_t bcl, hg_addr_t addr, uint16_t id)
+{
+    bake_provider_handle_t bph;
+    bake_target_id_t       bti;
+    bake_region_id_t       rid;
+    uint64_t               num_targets, bytes_read;
+    char*                  buf      = calloc(1, REGION_SIZE);
+    char*                  expected = malloc(REGION_SIZE);
+    int                    i, ret;
+
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = 'a' + (i + id) % 26;
+    bake_provider_handle_create(bcl, addr, id, &bph);
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret == 0)
+        ret = bake_create_write_persist(bph, bti, expected, REGION_SIZE,
+                                        &rid);
+    if (ret == 0)
+        ret = bake_read(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read);
+    if (ret != 0)
+        bake_perror("Error: write and read back", ret);
+    else if (bytes_read != REGION_SIZE || memcmp(buf, expected, REGION_SIZE)) {
+        fprintf(stderr, "Error: unexpected contents in region\n");
+        ret = -1;
+    }
+    bake_provider_handle_release(bph);
+    free(buf);
+    free(expected);
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    struct bake_provider_init_info args = {0};
+    margo_instance_id              mid;
+    hg_addr_t                      self_addr;
+    bake_provider_t                providers[2] = {NULL, NULL};
+    bake_client_t                  bcl;
+    bake_target_id_t               bti;
+    int                            i;
+    int                            ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: io-queue-test <file target> <file target>\n");
+        fprintf(stderr,
+                "  Example: ./io-queue-test file:/tmp/a.dat file:/tmp/b.dat\n");
+        return (-1);
+    }
+
+    mid = margo_init("na+sm", MARGO_SERVER_MODE, 0, -1);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    args.json_config = config;
+    for (i = 0; i < 2 && ret == 0; i++) {
+        ret = bake_provider_register(mid, i + 1, &args, &providers[i]);
+        if (ret != 0) {
+            bake_perror("Error: bake_provider_register()", ret);
+            break;
+        }
+        ret = bake_provider_attach_target(providers[i], argv[i + 1], &bti);
+        if (ret != 0)
+            bake_perror("Error: bake_provider_attach_target()", ret);
+    }
+    if (ret != 0) goto cleanup_providers;
+
+    margo_addr_self(mid, &self_addr);
+    bake_client_init(mid, &bcl);
+
+    ret = bake_provider_set_param(providers[0], "file_backend.io_max_threads",
+                                  "1");
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_set_param()", ret);
+        goto cleanup;
+    }
+    if (get_stat(providers[0], "\"io_max_threads\"") != 1
+        || get_stat(providers[1], "\"io_max_threads\"") != 16) {
+        fprintf(stderr, "Error: io_max_threads changed on both providers\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* both still get their I/O done on the shared engine */
+    ret = write_and_check(bcl, self_addr, 1);
+    if (ret == 0) ret = write_and_check(bcl, self_addr, 2);
+
+cleanup:
+    bake_client_finalize(bcl);
+    margo_addr_free(mid, self_addr);
+cleanup_providers:
+    for (i = 0; i < 2; i++)
+        if (providers[i]) bake_provider_deregister(providers[i]);
+    margo_finalize(mid);
+    return (ret);
+}
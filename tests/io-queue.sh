@@ -0,0 +1,28 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# the test runs its own providers on these targets
+for j in 1 2; do
+    src/bake-mkpool -s 100M file:$TMPBASE/svr-1-prvd-$j.dat
+    if [ $? -ne 0 ]; then
+        exit 1
+    fi
+done
+
+#####################
+
+# run test
+run_to 20 tests/io-queue-test file:$TMPBASE/svr-1-prvd-1.dat file:$TMPBASE/svr-1-prvd-2.dat
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
@@ -0,0 +1,148 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define NUM_REGIONS 1000
+#define EAGER_LIMIT 4096
+#define MSG_SIZE    1024
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_region_id_t       rids[NUM_REGIONS];
+    uint64_t               sizes[NUM_REGIONS];
+    uint64_t               bytes_read[NUM_REGIONS];
+    uint64_t               total = 0;
+    char*                  buf;
+    char*                  expected;
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr,
+                "Usage: multi-region-test <bake server addr> <mplex id>\n");
+        fprintf(stderr,
+                "  Example: ./multi-region-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    /* sizes from 1 to 512 bytes, and one region larger than the eager
+     * limit, which goes through a bulk transfer on its own
+     */
+    for (i = 0; i < NUM_REGIONS; i++) sizes[i] = 1 + (i * 37) % 512;
+    sizes[NUM_REGIONS / 2] = 2 * EAGER_LIMIT;
+    for (i = 0; i < NUM_REGIONS; i++) total += sizes[i];
+    buf      = calloc(1, total);
+    expected = malloc(total);
+    for (i = 0; i < (int)total; i++) expected[i] = 'a' + i % 26;
+
+    /* a small message size splits the regions into several batches */
+    bake_provider_handle_set_eager_limit(bph, EAGER_LIMIT);
+    bake_provider_handle_set_multi_msg_size(bph, MSG_SIZE);
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    ret = bake_create_write_persist_multi(bph, bti, NUM_REGIONS, sizes,
+                                          expected, rids);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist_multi()", ret);
+        goto cleanup;
+    }
+
+    ret = bake_read_multi(bph, bti, NUM_REGIONS, rids, sizes, buf,
+                          bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read_multi()", ret);
+        goto cleanup;
+    }
+    for (i = 0; i < NUM_REGIONS; i++) {
+        if (bytes_read[i] != sizes[i]) {
+            fprintf(stderr, "Error: read %lu bytes of region %d, not %lu\n",
+                    (unsigned long)bytes_read[i], i, (unsigned long)sizes[i]);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+    if (memcmp(buf, expected, total)) {
+        fprintf(stderr, "Error: unexpected contents in regions\n");
+        ret = -1;
+    }
+
+cleanup:
+    free(buf);
+    free(expected);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
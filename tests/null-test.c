@@ -0,0 +1,160 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+/* large enough to go through the pipeline in several chunks */
+#define REGION_SIZE (8 * 1024 * 1024 + 3)
+
+/* writes to a null target are discarded and reads return the (default,
+ * zero) pattern, but the sizes it reports must be those of the regions
+ */
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_region_id_t       rid;
+    char*                  buf;
+    uint64_t               size;
+    uint64_t               bytes_read;
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: null-test <bake server addr> <mplex id>\n");
+        fprintf(stderr, "  Example: ./null-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    buf = malloc(REGION_SIZE);
+    memset(buf, 'a', REGION_SIZE);
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    ret = bake_create_write_persist(bph, bti, buf, REGION_SIZE, &rid);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist()", ret);
+        goto cleanup;
+    }
+
+    ret = bake_get_size(bph, bti, rid, &size);
+    if (ret != 0) {
+        bake_perror("Error: bake_get_size()", ret);
+        goto cleanup;
+    }
+    if (size != REGION_SIZE) {
+        fprintf(stderr, "Error: region size %lu, expected %d\n",
+                (unsigned long)size, REGION_SIZE);
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* a full read returns the whole region, filled with the pattern */
+    ret = bake_read(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        goto cleanup;
+    }
+    if (bytes_read != REGION_SIZE) {
+        fprintf(stderr, "Error: read %lu bytes, expected %d\n",
+                (unsigned long)bytes_read, REGION_SIZE);
+        ret = -1;
+        goto cleanup;
+    }
+    for (i = 0; i < REGION_SIZE; i++) {
+        if (buf[i] != 0) {
+            fprintf(stderr, "Error: unexpected byte at offset %d\n", i);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    /* a read past the end of the region is cut short */
+    ret = bake_read(bph, bti, rid, REGION_SIZE / 2, buf, REGION_SIZE,
+                    &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        goto cleanup;
+    }
+    if (bytes_read != REGION_SIZE - REGION_SIZE / 2) {
+        fprintf(stderr, "Error: read %lu bytes, expected %d\n",
+                (unsigned long)bytes_read, REGION_SIZE - REGION_SIZE / 2);
+        ret = -1;
+        goto cleanup;
+    }
+
+cleanup:
+    free(buf);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -0,0 +1,146 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define NUM_REGIONS 8
+
+int main(int argc, char* argv[])
+{
+    int                    i, j;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       targets[2];
+    bake_target_id_t       bti;
+    bake_region_id_t       rid;
+    int                    hits[2] = {0, 0};
+    char                   buf[64];
+    char                   expected[64];
+    uint64_t               bytes_read;
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr,
+                "Usage: placement-test <bake server addr> <mplex id>\n");
+        fprintf(stderr, "  Example: ./placement-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_probe(bph, 2, targets, &num_targets);
+    if (ret != 0 || num_targets != 2) {
+        fprintf(stderr, "Error: expected 2 targets\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* let the provider place regions, then read each one back from the
+     * target it reported
+     */
+    for (i = 0; i < NUM_REGIONS; i++) {
+        snprintf(expected, sizeof(expected), "placed region %d", i);
+        if (i % 2)
+            ret = bake_create_write_persist_placed(
+                bph, expected, strlen(expected) + 1, &bti, &rid);
+        else {
+            ret = bake_create_placed(bph, strlen(expected) + 1, &bti, &rid);
+            if (ret == 0)
+                ret = bake_write(bph, bti, rid, 0, expected,
+                                 strlen(expected) + 1);
+            if (ret == 0)
+                ret = bake_persist(bph, bti, rid, 0, strlen(expected) + 1);
+        }
+        if (ret != 0) {
+            bake_perror("Error: placed create", ret);
+            goto cleanup;
+        }
+        for (j = 0; j < 2; j++)
+            if (uuid_compare(bti.id, targets[j].id) == 0) hits[j]++;
+
+        memset(buf, 0, sizeof(buf));
+        ret = bake_read(bph, bti, rid, 0, buf, strlen(expected) + 1,
+                        &bytes_read);
+        if (ret != 0) {
+            bake_perror("Error: bake_read()", ret);
+            goto cleanup;
+        }
+        if (strcmp(buf, expected) != 0) {
+            fprintf(stderr, "Error: unexpected contents in region %d\n", i);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    /* the default round_robin policy spreads regions over both targets */
+    if (hits[0] + hits[1] != NUM_REGIONS || hits[0] == 0 || hits[1] == 0) {
+        fprintf(stderr, "Error: regions placed %d/%d on the two targets\n",
+                hits[0], hits[1]);
+        ret = -1;
+    }
+
+cleanup:
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -0,0 +1,200 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+/* larger than the eager limit, to go through the pipeline */
+#define REGION_SIZE (1024 * 1024)
+
+/* changes a parameter and checks the provider's answer */
+static int set_param(bake_provider_handle_t bph,
+                     const char*            key,
+                     const char*            value,
+                     int                    expected)
+{
+    int ret = bake_set_param(bph, key, value);
+
+    if (ret != expected) {
+        fprintf(stderr, "Error: setting %s to %s returned %d, expected %d\n",
+                key, value, ret, expected);
+        return -1;
+    }
+    return 0;
+}
+
+/* writes a new region with the given pattern and reads it back */
+static int write_and_check(bake_provider_handle_t bph,
+                           bake_target_id_t       bti,
+                           char*                  expected,
+                           char*                  buf,
+                           char                   first)
+{
+    bake_region_id_t rid;
+    uint64_t         bytes_read;
+    int              i, ret;
+
+    for (i = 0; i < REGION_SIZE; i++) expected[i] = first + i % 26;
+    ret = bake_create_write_persist(bph, bti, expected, REGION_SIZE, &rid);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist()", ret);
+        return ret;
+    }
+    memset(buf, 0, REGION_SIZE);
+    ret = bake_read(bph, bti, rid, 0, buf, REGION_SIZE, &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        return ret;
+    }
+    if (bytes_read != REGION_SIZE || memcmp(buf, expected, REGION_SIZE)) {
+        fprintf(stderr, "Error: unexpected contents in region\n");
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int                    i;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    char*                  buf;
+    char*                  expected;
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr,
+                "Usage: set-param-test <bake server addr> <mplex id>\n");
+        fprintf(stderr, "  Example: ./set-param-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    buf      = malloc(REGION_SIZE);
+    expected = malloc(REGION_SIZE);
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    ret = write_and_check(bph, bti, expected, buf, 'a');
+    if (ret != 0) goto cleanup;
+
+    /* rebuild the pipeline buffers with other sizes, then change the file
+     * backend's settings
+     */
+    if ((ret = set_param(bph, "pipeline_first_buffer_size", "4096", 0)) != 0
+        || (ret = set_param(bph, "pipeline_npools", "2", 0)) != 0
+        || (ret = set_param(bph, "pipeline_max_memory", "65536", 0)) != 0)
+        goto cleanup;
+    ret = write_and_check(bph, bti, expected, buf, 'b');
+    if (ret != 0) goto cleanup;
+
+    /* size class settings out of range are clamped, not refused */
+    if ((ret = set_param(bph, "pipeline_multiplier", "1", 0)) != 0
+        || (ret = set_param(bph, "pipeline_npools", "64", 0)) != 0)
+        goto cleanup;
+    ret = write_and_check(bph, bti, expected, buf, 'B');
+    if (ret != 0) goto cleanup;
+
+    if ((ret = set_param(bph, "file_backend.sync", "false", 0)) != 0
+        || (ret = set_param(bph, "file_backend.io_max_threads", "2", 0)) != 0
+        || (ret = set_param(bph, "qos.burst_ms", "50", 0)) != 0)
+        goto cleanup;
+    ret = write_and_check(bph, bti, expected, buf, 'c');
+    if (ret != 0) goto cleanup;
+
+    /* unknown keys, malformed values, values that the configuration does
+     * not accept, and turning off the pipeline that the file target needs
+     * are refused, leaving the provider as it was
+     */
+    if ((ret = set_param(bph, "pipeline_transfer_xstreams", "2",
+                         BAKE_ERR_INVALID_ARG))
+            != 0
+        || (ret = set_param(bph, "pipeline_first_buffer_size", "0",
+                            BAKE_ERR_INVALID_ARG))
+               != 0
+        || (ret = set_param(bph, "qos.burst_ms", "soon",
+                            BAKE_ERR_INVALID_ARG))
+               != 0
+        || (ret = set_param(bph, "file_backend.io_max_threads", "0",
+                            BAKE_ERR_INVALID_ARG))
+               != 0
+        || (ret = set_param(bph, "pipeline_enable", "false",
+                            BAKE_ERR_INVALID_ARG))
+               != 0)
+        goto cleanup;
+    ret = write_and_check(bph, bti, expected, buf, 'd');
+
+cleanup:
+    free(buf);
+    free(expected);
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}
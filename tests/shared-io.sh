@@ -0,0 +1,76 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# two providers with a file target each, sharing one pipeline buffer pool
+# and an I/O engine limited to a single execution stream, so that their
+# concurrent transfers have to take turns
+for j in 1 2; do
+    src/bake-mkpool -s 100M file:$TMPBASE/svr-1-prvd-$j.dat
+    if [ $? -ne 0 ]; then
+        exit 1
+    fi
+done
+cat > $TMPBASE/svr-1.json <<END
+{
+    "pipeline_enable": true,
+    "file_backend": {
+        "io_max_threads": 1
+    }
+}
+END
+run_to 20 src/bake-server-daemon -m providers -f $TMPBASE/svr-1.addr -j $TMPBASE/svr-1.json na+sm file:$TMPBASE/svr-1-prvd-1.dat file:$TMPBASE/svr-1-prvd-2.dat &
+sleep 2
+svr1=`cat $TMPBASE/svr-1.addr`
+
+# actual test case
+#####################
+
+CPPIDS=
+for j in 1 2; do
+    run_to 10 src/bake-copy-to $srcdir/tests/lorem.txt $svr1 $j 1 > $TMPBASE/cp-$j.out &
+    CPPIDS="$CPPIDS $!"
+done
+wait $CPPIDS
+for j in 1 2; do
+    RID=`grep -o -P '/tmp.*$' $TMPBASE/cp-$j.out`
+    if [ -z "$RID" ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+
+    run_to 10 src/bake-copy-from $svr1 $j $RID $TMPBASE/out-$j.dat 3760
+    if [ $? -ne 0 ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+
+    cmp $srcdir/tests/lorem.txt $TMPBASE/out-$j.dat
+    if [ $? -ne 0 ]; then
+        run_to 10 src/bake-shutdown $svr1
+        wait
+        exit 1
+    fi
+done
+
+#####################
+
+# tear down
+run_to 10 src/bake-shutdown $svr1
+if [ $? -ne 0 ]; then
+    wait
+    exit 1
+fi
+
+wait
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
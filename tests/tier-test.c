@@ -0,0 +1,171 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-server.h"
+#include "bake-client.h"
+
+/* the provider runs in this process, so that the test can see its
+ * statistics.  A large region too big to migrate and a small one fill the
+ * fast tier past its high watermark, so the small one gets demoted; once
+ * the large one is removed and the small one is read often, it gets
+ * promoted again.
+ */
+static const char* config
+    = "{ \"pipeline_enable\": true,"
+      "  \"tier_backend\": {"
+      "    \"fast_capacity\": 16384,"
+      "    \"high_watermark\": 90,"
+      "    \"low_watermark\": 50,"
+      "    \"promote_threshold\": 2,"
+      "    \"max_migrate_size\": 8192,"
+      "    \"migration_bandwidth\": 0,"
+      "    \"scan_interval_ms\": 50 } }";
+
+#define LARGE_SIZE 12288
+#define SMALL_SIZE 3072
+
+/* number after "key": in the statistics of the provider */
+static uint64_t get_stat(bake_provider_t provider, const char* key)
+{
+    char*    stats = bake_provider_get_stats(provider);
+    char*    p     = stats ? strstr(stats, key) : NULL;
+    uint64_t value = 0;
+
+    if (p && (p = strchr(p + strlen(key), ':')))
+        value = strtoull(p + 1, NULL, 10);
+    free(stats);
+    return value;
+}
+
+/* waits up to 5 seconds for a statistic to become nonzero, reading the
+ * given region all the while if one is given
+ */
+static int wait_for_stat(margo_instance_id      mid,
+                         bake_provider_t        provider,
+                         bake_provider_handle_t bph,
+                         bake_target_id_t       bti,
+                         bake_region_id_t*      rid,
+                         char*                  buf,
+                         const char*            key)
+{
+    uint64_t bytes_read;
+    int      i;
+
+    for (i = 0; i < 500; i++) {
+        if (get_stat(provider, key)) return 0;
+        if (rid) bake_read(bph, bti, *rid, 0, buf, SMALL_SIZE, &bytes_read);
+        margo_thread_sleep(mid, 10);
+    }
+    fprintf(stderr, "Error: no %s after 5 seconds\n", key);
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    struct bake_provider_init_info args = {0};
+    margo_instance_id              mid;
+    hg_addr_t                      self_addr;
+    bake_provider_t                provider;
+    bake_client_t                  bcl;
+    bake_provider_handle_t         bph;
+    bake_target_id_t               bti;
+    bake_region_id_t               large_rid, small_rid;
+    char*                          large;
+    char                           small[SMALL_SIZE];
+    char                           buf[SMALL_SIZE];
+    uint64_t                       bytes_read;
+    int                            i;
+    int                            ret;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: tier-test <tier target>\n");
+        fprintf(stderr,
+                "  Example: ./tier-test tier:/dev/shm/a.dat,file:/tmp/b.dat\n");
+        return (-1);
+    }
+
+    mid = margo_init("na+sm", MARGO_SERVER_MODE, 0, -1);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    args.json_config = config;
+    ret = bake_provider_register(mid, 1, &args, &provider);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_register()", ret);
+        margo_finalize(mid);
+        return (-1);
+    }
+    ret = bake_provider_attach_target(provider, argv[1], &bti);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_attach_target()", ret);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    margo_addr_self(mid, &self_addr);
+    bake_client_init(mid, &bcl);
+    bake_provider_handle_create(bcl, self_addr, 1, &bph);
+
+    large = malloc(LARGE_SIZE);
+    memset(large, 'L', LARGE_SIZE);
+    for (i = 0; i < SMALL_SIZE; i++) small[i] = 'a' + i % 26;
+
+    ret = bake_create_write_persist(bph, bti, large, LARGE_SIZE, &large_rid);
+    if (ret == 0)
+        ret = bake_create_write_persist(bph, bti, small, SMALL_SIZE,
+                                        &small_rid);
+    if (ret != 0) {
+        bake_perror("Error: bake_create_write_persist()", ret);
+        goto cleanup;
+    }
+
+    /* the small region is the only one that may leave the fast tier */
+    ret = wait_for_stat(mid, provider, bph, bti, NULL, buf, "\"demotions\"");
+    if (ret != 0) goto cleanup;
+
+    /* with room on the fast tier, reading it makes it come back */
+    ret = bake_remove(bph, bti, large_rid);
+    if (ret != 0) {
+        bake_perror("Error: bake_remove()", ret);
+        goto cleanup;
+    }
+    ret = wait_for_stat(mid, provider, bph, bti, &small_rid, buf,
+                        "\"promotions\"");
+    if (ret != 0) goto cleanup;
+
+    /* and it holds the same data after both moves */
+    memset(buf, 0, SMALL_SIZE);
+    ret = bake_read(bph, bti, small_rid, 0, buf, SMALL_SIZE, &bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_read()", ret);
+        goto cleanup;
+    }
+    if (bytes_read != SMALL_SIZE || memcmp(buf, small, SMALL_SIZE)) {
+        fprintf(stderr, "Error: unexpected contents after migrations\n");
+        ret = -1;
+    }
+
+cleanup:
+    free(large);
+    bake_provider_handle_release(bph);
+    bake_client_finalize(bcl);
+    margo_addr_free(mid, self_addr);
+    bake_provider_deregister(provider);
+    margo_finalize(mid);
+    return (ret);
+}
@@ -0,0 +1,27 @@
+#!/bin/bash -x
+
+if [ -z $srcdir ]; then
+    echo srcdir variable not set.
+    exit 1
+fi
+source $srcdir/tests/test-util.sh
+
+# the test runs its own provider on this target
+TARGET=tier:$TMPBASE/svr-1.dat,file:$TMPBASE/svr-1-slow.dat
+src/bake-mkpool -s 100M $TARGET
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+
+#####################
+
+# run test
+run_to 20 tests/tier-test $TARGET
+if [ $? -ne 0 ]; then
+    exit 1
+fi
+
+echo cleaning up $TMPBASE
+rm -rf $TMPBASE
+
+exit 0
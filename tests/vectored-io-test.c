@@ -0,0 +1,177 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <mercury.h>
+#include <abt.h>
+#include <margo.h>
+
+#include "bake-client.h"
+
+#define NUM_REGIONS 6
+
+/* small segments, an empty one and one larger than the eager limit, all
+ * written and read in a single RPC; each region is a byte larger than its
+ * segment
+ */
+static const int region_sizes[NUM_REGIONS] = {1, 100, 0, 4096, 65536, 513};
+
+int main(int argc, char* argv[])
+{
+    int                    i, j;
+    char                   cli_addr_prefix[64] = {0};
+    char*                  bake_svr_addr_str;
+    margo_instance_id      mid;
+    hg_addr_t              svr_addr;
+    uint8_t                mplex_id;
+    bake_client_t          bcl;
+    bake_provider_handle_t bph;
+    uint64_t               num_targets;
+    bake_target_id_t       bti;
+    bake_segment_t         segments[NUM_REGIONS];
+    char*                  bufs[NUM_REGIONS];
+    char*                  expected[NUM_REGIONS];
+    uint64_t               bytes_read[NUM_REGIONS];
+    hg_return_t            hret;
+    int                    ret = 0;
+
+    if (argc != 3) {
+        fprintf(stderr,
+                "Usage: vectored-io-test <bake server addr> <mplex id>\n");
+        fprintf(stderr,
+                "  Example: ./vectored-io-test tcp://localhost:1234 1\n");
+        return (-1);
+    }
+    bake_svr_addr_str = argv[1];
+    mplex_id          = atoi(argv[2]);
+
+    /* initialize Margo using the transport portion of the server
+     * address (i.e., the part before the first : character if present)
+     */
+    for (i = 0; (i < 63 && bake_svr_addr_str[i] != '\0'
+                 && bake_svr_addr_str[i] != ':');
+         i++)
+        cli_addr_prefix[i] = bake_svr_addr_str[i];
+
+    mid = margo_init(cli_addr_prefix, MARGO_SERVER_MODE, 0, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        fprintf(stderr, "Error: margo_init()\n");
+        return (-1);
+    }
+
+    ret = bake_client_init(mid, &bcl);
+    if (ret != 0) {
+        bake_perror("Error: bake_client_init()", ret);
+        margo_finalize(mid);
+        return -1;
+    }
+
+    hret = margo_addr_lookup(mid, bake_svr_addr_str, &svr_addr);
+    if (hret != HG_SUCCESS) {
+        fprintf(stderr, "Error: margo_addr_lookup()\n");
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    ret = bake_provider_handle_create(bcl, svr_addr, mplex_id, &bph);
+    if (ret != 0) {
+        bake_perror("Error: bake_provider_handle_create()", ret);
+        margo_addr_free(mid, svr_addr);
+        bake_client_finalize(bcl);
+        margo_finalize(mid);
+        return (-1);
+    }
+
+    for (i = 0; i < NUM_REGIONS; i++) {
+        bufs[i]     = calloc(1, region_sizes[i] + 1);
+        expected[i] = malloc(region_sizes[i] + 1);
+        for (j = 0; j < region_sizes[i]; j++)
+            expected[i][j] = 'a' + (i + j) % 26;
+    }
+
+    ret = bake_probe(bph, 1, &bti, &num_targets);
+    if (ret != 0 || num_targets != 1) {
+        fprintf(stderr, "Error: expected 1 target\n");
+        ret = -1;
+        goto cleanup;
+    }
+
+    for (i = 0; i < NUM_REGIONS; i++) {
+        segments[i].bti           = bti;
+        segments[i].region_offset = 0;
+        segments[i].size          = region_sizes[i];
+        ret = bake_create(bph, bti, region_sizes[i] + 1, &segments[i].rid);
+        if (ret != 0) {
+            bake_perror("Error: bake_create()", ret);
+            goto cleanup;
+        }
+    }
+
+    ret = bake_writev(bph, NUM_REGIONS, segments,
+                      (void const* const*)expected);
+    if (ret != 0) {
+        bake_perror("Error: bake_writev()", ret);
+        goto cleanup;
+    }
+    for (i = 0; i < NUM_REGIONS; i++) {
+        ret = bake_persist(bph, bti, segments[i].rid, 0, region_sizes[i]);
+        if (ret != 0) {
+            bake_perror("Error: bake_persist()", ret);
+            goto cleanup;
+        }
+    }
+
+    /* each region read back on its own holds what was written to it */
+    for (i = 0; i < NUM_REGIONS; i++) {
+        ret = bake_read(bph, bti, segments[i].rid, 0, bufs[i],
+                        region_sizes[i], &bytes_read[i]);
+        if (ret != 0) {
+            bake_perror("Error: bake_read()", ret);
+            goto cleanup;
+        }
+        if (bytes_read[i] != (uint64_t)region_sizes[i]
+            || memcmp(bufs[i], expected[i], region_sizes[i])) {
+            fprintf(stderr, "Error: unexpected contents in region %d\n", i);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+    /* and so does a vectored read of all of them */
+    for (i = 0; i < NUM_REGIONS; i++) memset(bufs[i], 0, region_sizes[i]);
+    ret = bake_readv(bph, NUM_REGIONS, segments, (void* const*)bufs,
+                     bytes_read);
+    if (ret != 0) {
+        bake_perror("Error: bake_readv()", ret);
+        goto cleanup;
+    }
+    for (i = 0; i < NUM_REGIONS; i++) {
+        if (bytes_read[i] != (uint64_t)region_sizes[i]
+            || memcmp(bufs[i], expected[i], region_sizes[i])) {
+            fprintf(stderr, "Error: unexpected contents in segment %d\n", i);
+            ret = -1;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    for (i = 0; i < NUM_REGIONS; i++) {
+        free(bufs[i]);
+        free(expected[i]);
+    }
+    bake_shutdown_service(bcl, svr_addr);
+    bake_provider_handle_release(bph);
+    margo_addr_free(mid, svr_addr);
+    bake_client_finalize(bcl);
+    margo_finalize(mid);
+    return (ret);
+}